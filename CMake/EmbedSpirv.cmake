@@ -0,0 +1,22 @@
+# Script mode: cmake -DSPIRV_FILES="a.spv|b.spv" -DOUTPUT=SpirvShaders.h -P EmbedSpirv.cmake
+# Writes every SPIR-V binary as a constexpr uint32_t array named after the file.
+string(REPLACE "|" ";" SpirvFiles "${SPIRV_FILES}")
+
+set(FileData "#pragma once\n\n#include <cstdint>\n\nnamespace Shaders {\n")
+foreach(file ${SpirvFiles})
+    get_filename_component(name ${file} NAME_WE)
+    file(READ ${file} hex HEX)
+    string(LENGTH "${hex}" hexLength)
+    math(EXPR remainder "${hexLength} % 8")
+    if(NOT remainder EQUAL 0)
+        message(FATAL_ERROR "${file} isn't a SPIR-V binary, size isn't a multiple of 4")
+    endif()
+    # SPIR-V words are little endian on disk
+    string(REGEX REPLACE "(..)(..)(..)(..)" "0x\\4\\3\\2\\1, " words "${hex}")
+    set(word "0x........, ")
+    string(REGEX REPLACE "(${word}${word}${word}${word}${word}${word}${word}${word})" "\\1\n    " words "${words}")
+    set(FileData "${FileData}\ninline constexpr uint32_t ${name}[] = {\n    ${words}\n};\n")
+endforeach()
+set(FileData "${FileData}\n}\n")
+
+file(WRITE ${OUTPUT} "${FileData}")
@@ -0,0 +1,30 @@
+#include "ChunkedFormatter.h"
+#include <algorithm>
+#include <vector>
+
+#include "Library/Concurrency/ThreadPool.h"
+
+namespace Export {
+
+void writeChunked(Files::OutputStream& out, size_t count, size_t chunkSize,
+                  const std::function<void(size_t begin, size_t end, TextBuffer& text)>& format)
+{
+    Concurrency::ThreadPool& pool = Concurrency::ThreadPool::global();
+
+    std::vector<TextBuffer> chunks(pool.threadCount() * 2);
+    size_t batchSize = chunks.size() * chunkSize;
+
+    for (size_t batch = 0; batch < count; batch += batchSize) {
+        size_t chunkCount = (std::min(batchSize, count - batch) + chunkSize - 1) / chunkSize;
+        pool.parallelFor(chunkCount, [&](size_t chunk) {
+            size_t begin = batch + chunk * chunkSize;
+            chunks[chunk].clear();
+            format(begin, std::min(begin + chunkSize, count), chunks[chunk]);
+        });
+        for (size_t chunk = 0; chunk < chunkCount; ++chunk) {
+            out.write(chunks[chunk].data(), chunks[chunk].size());
+        }
+    }
+}
+
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+
+#include "Export/TextBuffer.h"
+#include "Library/Files/OutputStream.h"
+
+namespace Export {
+
+// Formats the records [0, count) in chunks of chunkSize on the thread pool, each worker
+// into its own buffer, and writes the buffers to out in record order. At most two chunks
+// per worker are held in memory at a time.
+void writeChunked(Files::OutputStream& out, size_t count, size_t chunkSize,
+                  const std::function<void(size_t begin, size_t end, TextBuffer& text)>& format);
+
+}
@@ -0,0 +1,236 @@
+#include "DxfExporter.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <numbers>
+#include <vector>
+
+#include "Export/ChunkedFormatter.h"
+#include "Library/Files/OutputStream.h"
+#include "UI/cpp/Geometry/Color.h"
+
+namespace Export {
+
+namespace {
+
+// The AutoCAD color index: 1 to 9 the named colors, 10 to 249 24 hues in steps of 15 degrees at
+// five values, every other one half saturated, 250 to 255 grays. 7 is drawn black on white
+// paper, which is what the document's black is.
+std::array<std::array<uint8_t, 3>, 256> aciPalette()
+{
+    std::array<std::array<uint8_t, 3>, 256> palette = {};
+    const uint8_t named[10][3] = {{0, 0, 0},     {255, 0, 0},   {255, 255, 0}, {0, 255, 0},   {0, 255, 255},
+                                  {0, 0, 255},   {255, 0, 255}, {0, 0, 0},     {65, 65, 65},  {128, 128, 128}};
+    for (int i = 0; i < 10; ++i) {
+        palette[i] = {named[i][0], named[i][1], named[i][2]};
+    }
+    const double values[5] = {255, 165, 127, 76, 38};
+    for (int i = 10; i < 250; ++i) {
+        double hue = (i - 10) / 10 * 15.0;
+        double value = values[(i % 10) / 2];
+        double saturation = i % 2 ? 0.5 : 1.0;
+        double low = value * (1.0 - saturation);
+        double rgb[3];
+        for (int channel = 0; channel < 3; ++channel) {
+            // distance of the hue from the channel's primary, full up to 60 degrees, none from 120 on
+            double distance = std::fabs(std::fmod(hue - channel * 120.0 + 540.0, 360.0) - 180.0);
+            double weight = std::clamp((180.0 - distance - 60.0) / 60.0, 0.0, 1.0);
+            rgb[channel] = low + (value - low) * weight;
+        }
+        palette[i] = {(uint8_t)std::lround(rgb[0]), (uint8_t)std::lround(rgb[1]), (uint8_t)std::lround(rgb[2])};
+    }
+    const uint8_t grays[6] = {51, 91, 132, 173, 214, 255};
+    for (int i = 250; i < 256; ++i) {
+        palette[i] = {grays[i - 250], grays[i - 250], grays[i - 250]};
+    }
+    return palette;
+}
+
+// R12 has no true color, the nearest palette entry by the color cut to 5 bits a channel
+int aciColor(const float color[3])
+{
+    static const std::vector<uint8_t> nearest = []() {
+        std::array<std::array<uint8_t, 3>, 256> palette = aciPalette();
+        std::vector<uint8_t> table(32 * 32 * 32);
+        for (int cell = 0; cell < 32 * 32 * 32; ++cell) {
+            int rgb[3] = {(cell >> 10) * 8 + 4, ((cell >> 5) & 31) * 8 + 4, (cell & 31) * 8 + 4};
+            int best = 1;
+            int bestDistance = std::numeric_limits<int>::max();
+            for (int i = 1; i < 256; ++i) {
+                int distance = 0;
+                for (int channel = 0; channel < 3; ++channel) {
+                    int difference = rgb[channel] - palette[i][channel];
+                    distance += difference * difference;
+                }
+                if (distance < bestDistance) {
+                    best = i;
+                    bestDistance = distance;
+                }
+            }
+            table[cell] = (uint8_t)best;
+        }
+        return table;
+    }();
+    int cell = 0;
+    for (int i = 0; i < 3; ++i) {
+        cell = (cell << 5) | (int)std::lround(std::clamp(color[i], 0.0f, 1.0f) * 31.0f);
+    }
+    return nearest[cell];
+}
+
+int aciColor(uint32_t packed)
+{
+    std::array<float, 3> color = Geometry::unpackColor(packed);
+    return aciColor(color.data());
+}
+
+float degrees(float radians)
+{
+    float value = std::fmod(radians * 180.0f / std::numbers::pi_v<float>, 360.0f);
+    return value < 0.0f ? value + 360.0f : value;
+}
+
+// entity type, layer and color index, the groups every entity starts with
+void appendEntity(const char* type, const std::string& layer, int color, TextBuffer& out)
+{
+    out.append("0\n");
+    out.append(type);
+    out.append("\n8\n");
+    out.append(layer);
+    out.append("\n62\n");
+    out.appendNumber(static_cast<int64_t>(color));
+    out.append('\n');
+}
+
+void appendGroup(int code, float value, TextBuffer& out)
+{
+    out.appendNumber(static_cast<int64_t>(code));
+    out.append('\n');
+    out.appendNumber(value);
+    out.append('\n');
+}
+
+}
+
+DxfExporter::DxfExporter(const Geometry::DocumentSnapshot& document) :
+    _document(document)
+{}
+
+void DxfExporter::exportTo(const std::string& fileName)
+{
+    Files::OutputStream out(fileName, 4 << 20);
+    out.write("0\nSECTION\n2\nHEADER\n9\n$ACADVER\n1\nAC1009\n0\nENDSEC\n");
+    writeTables(out);
+    out.write("0\nSECTION\n2\nENTITIES\n");
+    for (size_t i = 0; i < _document.layers.size(); ++i) {
+        Layer layer{_document.layers[i], _document.styles[i], _document.names[i]};
+        writeChunked(out, layer.entities.lines->size(), chunkSize, [&](size_t begin, size_t end, TextBuffer& text) {
+            formatLines(layer, begin, end, text);
+        });
+        writeChunked(out, layer.entities.circles->size(), chunkSize, [&](size_t begin, size_t end, TextBuffer& text) {
+            formatCircles(layer, begin, end, text);
+        });
+        writeChunked(out, layer.entities.arcs->size(), chunkSize, [&](size_t begin, size_t end, TextBuffer& text) {
+            formatArcs(layer, begin, end, text);
+        });
+        writeChunked(out, layer.entities.polylines.polylines->size(), polylineChunkSize,
+                     [&](size_t begin, size_t end, TextBuffer& text) {
+            formatPolylines(layer, begin, end, text);
+        });
+    }
+    out.write("0\nENDSEC\n0\nEOF\n");
+    out.close();
+}
+
+void DxfExporter::writeTables(Files::OutputStream& out) const
+{
+    // the line type every layer refers to, then a layer per document layer, switched off (a
+    // negative color) when it is hidden
+    TextBuffer text;
+    text.append("0\nSECTION\n2\nTABLES\n"
+                "0\nTABLE\n2\nLTYPE\n70\n1\n"
+                "0\nLTYPE\n2\nCONTINUOUS\n70\n0\n3\nSolid line\n72\n65\n73\n0\n40\n0.0\n"
+                "0\nENDTAB\n"
+                "0\nTABLE\n2\nLAYER\n70\n");
+    text.appendNumber(static_cast<int64_t>(_document.layers.size()));
+    text.append('\n');
+    for (size_t i = 0; i < _document.layers.size(); ++i) {
+        int color = aciColor(_document.styles[i].color);
+        text.append("0\nLAYER\n2\n");
+        text.append(_document.names[i]);
+        text.append("\n70\n0\n62\n");
+        text.appendNumber(static_cast<int64_t>(_document.styles[i].visible() ? color : -color));
+        text.append("\n6\nCONTINUOUS\n");
+    }
+    text.append("0\nENDTAB\n0\nENDSEC\n");
+    out.write(text.data(), text.size());
+}
+
+void DxfExporter::formatLines(const Layer& layer, size_t begin, size_t end, TextBuffer& out) const
+{
+    for (size_t i = begin; i < end; ++i) {
+        const Geometry::Line& line = layer.entities.lines->at(i);
+        appendEntity("LINE", layer.name, aciColor(layer.style.resolve(line.vertices[0].color).data()), out);
+        appendGroup(10, line.vertices[0].pos[0], out);
+        appendGroup(20, -line.vertices[0].pos[1], out);
+        appendGroup(11, line.vertices[1].pos[0], out);
+        appendGroup(21, -line.vertices[1].pos[1], out);
+    }
+}
+
+void DxfExporter::formatCircles(const Layer& layer, size_t begin, size_t end, TextBuffer& out) const
+{
+    for (size_t i = begin; i < end; ++i) {
+        const Geometry::Circle& circle = layer.entities.circles->at(i);
+        appendEntity("CIRCLE", layer.name, aciColor(layer.style.resolve(circle.color)), out);
+        appendGroup(10, circle.center[0], out);
+        appendGroup(20, -circle.center[1], out);
+        appendGroup(40, circle.radius, out);
+    }
+}
+
+void DxfExporter::formatArcs(const Layer& layer, size_t begin, size_t end, TextBuffer& out) const
+{
+    for (size_t i = begin; i < end; ++i) {
+        const Geometry::Arc& arc = layer.entities.arcs->at(i);
+        appendEntity("ARC", layer.name, aciColor(layer.style.resolve(arc.color)), out);
+        appendGroup(10, arc.center[0], out);
+        appendGroup(20, -arc.center[1], out);
+        appendGroup(40, arc.radius, out);
+        // flipping y mirrors the angles, the counterclockwise DXF arc starts at the mirrored end
+        appendGroup(50, degrees(-arc.endAngle()), out);
+        appendGroup(51, degrees(-arc.startAngle), out);
+    }
+}
+
+void DxfExporter::formatPolylines(const Layer& layer, size_t begin, size_t end, TextBuffer& out) const
+{
+    const auto& vertices = *layer.entities.polylines.vertices;
+    for (size_t i = begin; i < end; ++i) {
+        const Geometry::Polyline& polyline = layer.entities.polylines.polylines->at(i);
+        if (polyline.vertexCount == 0) {
+            continue;
+        }
+        // R12 has no LWPOLYLINE, the vertices follow as VERTEX entities up to SEQEND
+        appendEntity("POLYLINE", layer.name, aciColor(layer.style.resolve(vertices.at(polyline.firstVertex).color).data()),
+                     out);
+        out.append(polyline.closed ? "66\n1\n70\n1\n" : "66\n1\n70\n0\n");
+        appendGroup(10, 0.0f, out);
+        appendGroup(20, 0.0f, out);
+        for (uint32_t v = 0; v < polyline.vertexCount; ++v) {
+            const Geometry::Vertex& vertex = vertices.at(polyline.firstVertex + v);
+            out.append("0\nVERTEX\n8\n");
+            out.append(layer.name);
+            out.append('\n');
+            appendGroup(10, vertex.pos[0], out);
+            appendGroup(20, -vertex.pos[1], out);
+        }
+        out.append("0\nSEQEND\n8\n");
+        out.append(layer.name);
+        out.append('\n');
+    }
+}
+
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <string>
+
+#include "Export/TextBuffer.h"
+#include "UI/cpp/Geometry/Document.h"
+
+namespace Files {
+class OutputStream;
+}
+
+namespace Export {
+
+// ASCII DXF (R12 layout) with one LINE, CIRCLE, ARC or POLYLINE entity per document entity,
+// y flipped so the drawing keeps its orientation in y-up CAD tools. Every layer is written,
+// hidden ones too, under its name, into the LAYER table (switched off when hidden). The colors
+// are the ones drawn, as the nearest entry of the AutoCAD color index since R12 has no other.
+class DxfExporter {
+public:
+    DxfExporter(const Geometry::DocumentSnapshot& document);
+
+    void exportTo(const std::string& fileName);
+
+private:
+    struct Layer {
+        const Geometry::LayerSnapshot& entities;
+        const Geometry::LayerStyle& style;
+        const std::string& name;
+    };
+
+    void writeTables(Files::OutputStream& out) const;
+    void formatLines(const Layer& layer, size_t begin, size_t end, TextBuffer& out) const;
+    void formatCircles(const Layer& layer, size_t begin, size_t end, TextBuffer& out) const;
+    void formatArcs(const Layer& layer, size_t begin, size_t end, TextBuffer& out) const;
+    void formatPolylines(const Layer& layer, size_t begin, size_t end, TextBuffer& out) const;
+
+    // taken at construction, edits made while exporting don't show up in the file
+    Geometry::DocumentSnapshot _document;
+
+    static constexpr size_t chunkSize = 32768;
+    static constexpr size_t polylineChunkSize = 512;
+};
+
+}
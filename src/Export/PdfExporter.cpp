@@ -0,0 +1,160 @@
+#include "PdfExporter.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <numbers>
+
+namespace Export {
+
+namespace {
+
+constexpr float pageSize = 1190.0f;
+constexpr float pageMargin = 24.0f;
+
+}
+
+PdfExporter::PdfExporter(const Geometry::DocumentSnapshot& document) :
+    StreamingExporter(document)
+{}
+
+void PdfExporter::beginObject(Files::OutputStream& out, size_t number)
+{
+    _objectOffsets[number] = out.position();
+    TextBuffer text;
+    text.appendNumber(static_cast<int64_t>(number));
+    text.append(" 0 obj\n");
+    out.write(text.data(), text.size());
+}
+
+void PdfExporter::writeHeader(Files::OutputStream& out, const Geometry::BoundingBox& bounds)
+{
+    Geometry::BoundingBox box = bounds;
+    if (box.isEmpty()) {
+        box.expand(0.0f, 0.0f);
+    }
+    float scale = pageSize / std::max({box.width(), box.height(), 1e-6f});
+    float width = box.width() * scale + 2 * pageMargin;
+    float height = box.height() * scale + 2 * pageMargin;
+
+    out.write("%PDF-1.4\n%\xE2\xE3\xCF\xD3\n");
+
+    beginObject(out, 1);
+    out.write("<< /Type /Catalog /Pages 2 0 R >>\nendobj\n");
+
+    beginObject(out, 2);
+    out.write("<< /Type /Pages /Kids [3 0 R] /Count 1 >>\nendobj\n");
+
+    beginObject(out, 3);
+    TextBuffer page;
+    page.append("<< /Type /Page /Parent 2 0 R /MediaBox [0 0 ");
+    page.appendNumber(width);
+    page.append(' ');
+    page.appendNumber(height);
+    page.append("] /Contents 4 0 R >>\nendobj\n");
+    out.write(page.data(), page.size());
+
+    beginObject(out, 4);
+    out.write("<< /Length 5 0 R >>\nstream\n");
+    _streamBegin = out.position();
+
+    // map document coordinates (y down) onto the page (y up) once, so the
+    // streamed path operators carry plain document coordinates
+    TextBuffer content;
+    content.appendNumber(scale);
+    content.append(" 0 0 ");
+    content.appendNumber(-scale);
+    content.append(' ');
+    content.appendNumber(pageMargin - box.min[0] * scale);
+    content.append(' ');
+    content.appendNumber(height - pageMargin + box.min[1] * scale);
+    content.append(" cm\n");
+    content.appendNumber(1.0f / scale);
+    content.append(" w 1 J 1 j\n");
+    out.write(content.data(), content.size());
+}
+
+void PdfExporter::writeFooter(Files::OutputStream& out)
+{
+    size_t streamLength = out.position() - _streamBegin;
+    out.write("endstream\nendobj\n");
+
+    beginObject(out, 5);
+    TextBuffer length;
+    length.appendNumber(static_cast<int64_t>(streamLength));
+    length.append("\nendobj\n");
+    out.write(length.data(), length.size());
+
+    size_t xrefOffset = out.position();
+    out.write("xref\n0 6\n0000000000 65535 f \n");
+    char entry[32];
+    for (size_t i = 1; i < 6; ++i) {
+        snprintf(entry, sizeof(entry), "%010zu 00000 n \n", _objectOffsets[i]);
+        out.write(entry);
+    }
+
+    TextBuffer trailer;
+    trailer.append("trailer\n<< /Size 6 /Root 1 0 R >>\nstartxref\n");
+    trailer.appendNumber(static_cast<int64_t>(xrefOffset));
+    trailer.append("\n%%EOF\n");
+    out.write(trailer.data(), trailer.size());
+}
+
+void PdfExporter::beginStyleRun(const std::array<float, 3>& color, TextBuffer& out) const
+{
+    for (float channel : color) {
+        out.appendNumber(std::clamp(channel, 0.0f, 1.0f));
+        out.append(' ');
+    }
+    out.append("RG\n");
+}
+
+void PdfExporter::writePolyline(const Polyline& polyline, TextBuffer& out) const
+{
+    for (size_t i = 0; i < polyline.points.size(); ++i) {
+        out.appendNumber(polyline.points[i][0]);
+        out.append(' ');
+        out.appendNumber(polyline.points[i][1]);
+        out.append(i == 0 ? " m\n" : " l\n");
+    }
+}
+
+void PdfExporter::writeArc(const Geometry::Arc& arc, TextBuffer& out) const
+{
+    auto appendPoint = [&out](float x, float y) {
+        out.appendNumber(x);
+        out.append(' ');
+        out.appendNumber(y);
+    };
+
+    // cubic Beziers of at most a quarter turn each, their control points are
+    // 4/3 tan(step / 4) radii along the tangents
+    int segments = std::max(1, (int)std::ceil(arc.sweepAngle / (std::numbers::pi_v<float> / 2) - 1e-4f));
+    float step = arc.sweepAngle / segments;
+    float handle = 4.0f / 3.0f * std::tan(step / 4) * arc.radius;
+
+    float point[2];
+    arc.pointAt(arc.startAngle, point);
+    appendPoint(point[0], point[1]);
+    out.append(" m\n");
+    for (int i = 0; i < segments; ++i) {
+        float from = arc.startAngle + step * i;
+        float to = from + step;
+        float start[2];
+        float end[2];
+        arc.pointAt(from, start);
+        arc.pointAt(to, end);
+        appendPoint(start[0] - handle * std::sin(from), start[1] + handle * std::cos(from));
+        out.append(' ');
+        appendPoint(end[0] + handle * std::sin(to), end[1] - handle * std::cos(to));
+        out.append(' ');
+        appendPoint(end[0], end[1]);
+        out.append(" c\n");
+    }
+}
+
+void PdfExporter::endStyleRun(TextBuffer& out) const
+{
+    out.append("S\n");
+}
+
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+
+#include "Export/StreamingExporter.h"
+
+namespace Export {
+
+// single page PDF whose content stream is written while the lines are streamed,
+// its length and the xref offsets are filled in by the footer
+class PdfExporter : public StreamingExporter {
+public:
+    PdfExporter(const Geometry::DocumentSnapshot& document);
+
+protected:
+    void writeHeader(Files::OutputStream& out, const Geometry::BoundingBox& bounds) override;
+    void writeFooter(Files::OutputStream& out) override;
+
+    void beginStyleRun(const std::array<float, 3>& color, TextBuffer& out) const override;
+    void writePolyline(const Polyline& polyline, TextBuffer& out) const override;
+    void writeArc(const Geometry::Arc& arc, TextBuffer& out) const override;
+    void endStyleRun(TextBuffer& out) const override;
+
+private:
+    void beginObject(Files::OutputStream& out, size_t number);
+
+    size_t _objectOffsets[6] = {};
+    size_t _streamBegin = 0;
+};
+
+}
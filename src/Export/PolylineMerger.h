@@ -0,0 +1,80 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include "UI/cpp/Geometry/Line.h"
+
+namespace Export {
+
+struct Polyline
+{
+    std::vector<std::array<float, 2>> points;
+    std::array<float, 3> color;
+};
+
+// Chains segments that arrive in document order into polylines: a segment starting where
+// the previous one ended with the same color continues it, and a point lying on the
+// extension of the last edge replaces that edge's end instead of adding a vertex.
+class PolylineMerger {
+public:
+    template<typename Sink>
+    void add(const Geometry::Line& line, Sink&& sink)
+    {
+        const Geometry::Vertex& start = line.vertices[0];
+        const Geometry::Vertex& end = line.vertices[1];
+
+        if (!continues(line)) {
+            finish(sink);
+            _current.points.push_back({start.pos[0], start.pos[1]});
+            _current.color = {start.color[0], start.color[1], start.color[2]};
+        }
+
+        std::array<float, 2> point = {end.pos[0], end.pos[1]};
+        size_t count = _current.points.size();
+        if (count >= 2 && collinear(_current.points[count - 2], _current.points[count - 1], point)) {
+            _current.points[count - 1] = point;
+        } else {
+            _current.points.push_back(point);
+        }
+    }
+
+    template<typename Sink>
+    void finish(Sink&& sink)
+    {
+        if (!_current.points.empty()) {
+            sink(static_cast<const Polyline&>(_current));
+            _current.points.clear();
+        }
+    }
+
+private:
+    bool continues(const Geometry::Line& line) const
+    {
+        if (_current.points.empty()) {
+            return false;
+        }
+        const Geometry::Vertex& start = line.vertices[0];
+        const std::array<float, 2>& last = _current.points.back();
+        return last[0] == start.pos[0] && last[1] == start.pos[1] &&
+               memcmp(_current.color.data(), start.color, sizeof(start.color)) == 0;
+    }
+
+    static bool collinear(const std::array<float, 2>& a, const std::array<float, 2>& b, const std::array<float, 2>& c)
+    {
+        float abx = b[0] - a[0];
+        float aby = b[1] - a[1];
+        float bcx = c[0] - b[0];
+        float bcy = c[1] - b[1];
+        float cross = abx * bcy - aby * bcx;
+        float dot = abx * bcx + aby * bcy;
+        float scale = std::hypot(abx, aby) * std::hypot(bcx, bcy);
+        return dot > 0 && std::abs(cross) <= 1e-6f * scale;
+    }
+
+    Polyline _current;
+};
+
+}
@@ -0,0 +1,156 @@
+#include "StreamingExporter.h"
+#include <algorithm>
+#include <numbers>
+#include <optional>
+
+#include "Export/ChunkedFormatter.h"
+#include "UI/cpp/Geometry/Color.h"
+
+namespace Export {
+
+StreamingExporter::StreamingExporter(const Geometry::DocumentSnapshot& document) :
+    _document(document)
+{}
+
+void StreamingExporter::exportTo(const std::string& fileName)
+{
+    Geometry::BoundingBox bounds;
+    for (size_t i = 0; i < _document.layers.size(); ++i) {
+        if (_document.styles[i].visible()) {
+            bounds.expand(_document.layers[i].bounds());
+        }
+    }
+
+    Files::OutputStream out(fileName);
+    writeHeader(out, bounds);
+    for (size_t i = 0; i < _document.layers.size(); ++i) {
+        if (_document.styles[i].visible()) {
+            writeLayer(out, _document.layers[i], _document.styles[i]);
+        }
+    }
+    writeFooter(out);
+    out.close();
+}
+
+void StreamingExporter::writeLayer(Files::OutputStream& out, const Geometry::LayerSnapshot& layer,
+                                   const Geometry::LayerStyle& style)
+{
+    writeChunked(out, layer.lines->size(), tileSize, [&](size_t begin, size_t end, TextBuffer& text) {
+        formatTile(layer, style, begin, end, text);
+    });
+    writeChunked(out, layer.circles->size(), tileSize, [&](size_t begin, size_t end, TextBuffer& text) {
+        formatCurves(*layer.circles, style, begin, end, [](const Geometry::Circle& circle) {
+            return Geometry::Arc{{circle.center[0], circle.center[1]}, circle.radius, circle.color,
+                                 0.0f, 2 * std::numbers::pi_v<float>};
+        }, text);
+    });
+    writeChunked(out, layer.arcs->size(), tileSize, [&](size_t begin, size_t end, TextBuffer& text) {
+        formatCurves(*layer.arcs, style, begin, end, [](const Geometry::Arc& arc) { return arc; }, text);
+    });
+    writeChunked(out, layer.polylines.polylines->size(), polylineTileSize,
+                 [&](size_t begin, size_t end, TextBuffer& text) {
+        formatPolylines(layer, style, begin, end, text);
+    });
+}
+
+void StreamingExporter::formatTile(const Geometry::LayerSnapshot& layer, const Geometry::LayerStyle& style,
+                                   size_t begin, size_t end, TextBuffer& out) const
+{
+    PolylineMerger merger;
+    std::optional<std::array<float, 3>> runColor;
+
+    auto sink = [&](const Polyline& polyline) {
+        if (runColor != polyline.color) {
+            if (runColor) {
+                endStyleRun(out);
+            }
+            runColor = polyline.color;
+            beginStyleRun(polyline.color, out);
+        }
+        writePolyline(polyline, out);
+    };
+
+    for (size_t i = begin; i < end; ++i) {
+        if (style.flags & Geometry::LayerStyle::OverrideColor) {
+            Geometry::Line line = layer.lines->at(i);
+            for (Geometry::Vertex& vertex : line.vertices) {
+                std::array<float, 3> color = style.resolve(vertex.color);
+                std::copy(color.begin(), color.end(), vertex.color);
+            }
+            merger.add(line, sink);
+        } else {
+            merger.add(layer.lines->at(i), sink);
+        }
+    }
+    merger.finish(sink);
+
+    if (runColor) {
+        endStyleRun(out);
+    }
+}
+
+void StreamingExporter::formatPolylines(const Geometry::LayerSnapshot& layer, const Geometry::LayerStyle& style,
+                                        size_t begin, size_t end, TextBuffer& out) const
+{
+    const auto& records = *layer.polylines.polylines;
+    const auto& vertices = *layer.polylines.vertices;
+    std::optional<std::array<float, 3>> runColor;
+    Polyline polyline;
+
+    for (size_t i = begin; i < end; ++i) {
+        const Geometry::Polyline& record = records.at(i);
+        // an empty polyline has no first vertex to give its color
+        if (record.vertexCount == 0) {
+            continue;
+        }
+        polyline.points.clear();
+        for (uint32_t v = 0; v < record.vertexCount; ++v) {
+            const Geometry::Vertex& vertex = vertices.at(record.firstVertex + v);
+            polyline.points.push_back({vertex.pos[0], vertex.pos[1]});
+        }
+        if (record.closed) {
+            polyline.points.push_back(polyline.points.front());
+        }
+        // the formats take one color per polyline, the first vertex gives it
+        const Geometry::Vertex& first = vertices.at(record.firstVertex);
+        polyline.color = style.resolve(first.color);
+
+        if (runColor != polyline.color) {
+            if (runColor) {
+                endStyleRun(out);
+            }
+            runColor = polyline.color;
+            beginStyleRun(polyline.color, out);
+        }
+        writePolyline(polyline, out);
+    }
+
+    if (runColor) {
+        endStyleRun(out);
+    }
+}
+
+template<typename List, typename ToArc>
+void StreamingExporter::formatCurves(const List& list, const Geometry::LayerStyle& style, size_t begin, size_t end,
+                                     ToArc&& toArc, TextBuffer& out) const
+{
+    std::optional<uint32_t> runColor;
+    for (size_t i = begin; i < end; ++i) {
+        Geometry::Arc arc = toArc(list.at(i));
+        arc.color = style.resolve(arc.color);
+        if (runColor != arc.color) {
+            if (runColor) {
+                endStyleRun(out);
+            }
+            runColor = arc.color;
+            beginStyleRun(Geometry::unpackColor(arc.color), out);
+        }
+        writeArc(arc, out);
+    }
+
+    if (runColor) {
+        endStyleRun(out);
+    }
+}
+
+}
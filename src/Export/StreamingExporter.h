@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#include "Export/PolylineMerger.h"
+#include "Export/TextBuffer.h"
+#include "Library/Files/OutputStream.h"
+#include "UI/cpp/Geometry/Arc.h"
+#include "UI/cpp/Geometry/BoundingBox.h"
+#include "UI/cpp/Geometry/Document.h"
+#include "UI/cpp/Geometry/Line.h"
+
+namespace Export {
+
+// Writes the document through a bounded window: every tile of lines is merged into
+// polylines and formatted on the thread pool (see writeChunked), tiles are appended in
+// document order so the paint order of the drawing is preserved. Circles, arcs and the
+// document's own polylines follow the lines, tiled the same way. Layers are written in order,
+// hidden ones are left out and the layer style decides the colors.
+class StreamingExporter {
+public:
+    StreamingExporter(const Geometry::DocumentSnapshot& document);
+    virtual ~StreamingExporter() = default;
+
+    void exportTo(const std::string& fileName);
+
+protected:
+    virtual void writeHeader(Files::OutputStream& out, const Geometry::BoundingBox& bounds) = 0;
+    virtual void writeFooter(Files::OutputStream& out) = 0;
+
+    // consecutive polylines of one color share a style run; runs never cross tiles
+    virtual void beginStyleRun(const std::array<float, 3>& color, TextBuffer& out) const = 0;
+    virtual void writePolyline(const Polyline& polyline, TextBuffer& out) const = 0;
+    // circles come in as arcs sweeping 2pi
+    virtual void writeArc(const Geometry::Arc& arc, TextBuffer& out) const = 0;
+    virtual void endStyleRun(TextBuffer& out) const = 0;
+
+    // taken at construction, edits made while exporting don't show up in the file
+    Geometry::DocumentSnapshot _document;
+
+private:
+    void writeLayer(Files::OutputStream& out, const Geometry::LayerSnapshot& layer, const Geometry::LayerStyle& style);
+    void formatTile(const Geometry::LayerSnapshot& layer, const Geometry::LayerStyle& style, size_t begin, size_t end,
+                    TextBuffer& out) const;
+    void formatPolylines(const Geometry::LayerSnapshot& layer, const Geometry::LayerStyle& style, size_t begin,
+                         size_t end, TextBuffer& out) const;
+    template<typename List, typename ToArc>
+    void formatCurves(const List& list, const Geometry::LayerStyle& style, size_t begin, size_t end, ToArc&& toArc,
+                      TextBuffer& out) const;
+
+    static constexpr size_t tileSize = 16384;
+    // polylines run to hundreds of vertices, a tile holds fewer of them
+    static constexpr size_t polylineTileSize = 512;
+};
+
+}
@@ -0,0 +1,116 @@
+#include "SvgExporter.h"
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+
+namespace Export {
+
+namespace {
+
+void appendHexColor(const std::array<float, 3>& color, TextBuffer& out)
+{
+    static constexpr char digits[] = "0123456789abcdef";
+    out.append('#');
+    for (float channel : color) {
+        int value = static_cast<int>(std::lround(std::clamp(channel, 0.0f, 1.0f) * 255.0f));
+        out.append(digits[value >> 4]);
+        out.append(digits[value & 0xF]);
+    }
+}
+
+}
+
+SvgExporter::SvgExporter(const Geometry::DocumentSnapshot& document) :
+    StreamingExporter(document)
+{}
+
+void SvgExporter::writeHeader(Files::OutputStream& out, const Geometry::BoundingBox& bounds)
+{
+    Geometry::BoundingBox box = bounds;
+    if (box.isEmpty()) {
+        box.expand(0.0f, 0.0f);
+    }
+    float extent = std::max({box.width(), box.height(), 1e-6f});
+    float margin = extent * 0.02f;
+
+    TextBuffer header;
+    header.append("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+                  "<svg xmlns=\"http://www.w3.org/2000/svg\" viewBox=\"");
+    header.appendNumber(box.min[0] - margin);
+    header.append(' ');
+    header.appendNumber(box.min[1] - margin);
+    header.append(' ');
+    header.appendNumber(box.width() + 2 * margin);
+    header.append(' ');
+    header.appendNumber(box.height() + 2 * margin);
+    header.append("\">\n<g fill=\"none\" stroke-linecap=\"round\" stroke-linejoin=\"round\" stroke-width=\"");
+    header.appendNumber(extent / 1000.0f);
+    header.append("\">\n");
+    out.write(header.data(), header.size());
+}
+
+void SvgExporter::writeFooter(Files::OutputStream& out)
+{
+    out.write("</g>\n</svg>\n");
+}
+
+void SvgExporter::beginStyleRun(const std::array<float, 3>& color, TextBuffer& out) const
+{
+    out.append("<path stroke=\"");
+    appendHexColor(color, out);
+    out.append("\" d=\"");
+}
+
+void SvgExporter::writePolyline(const Polyline& polyline, TextBuffer& out) const
+{
+    out.append('M');
+    for (size_t i = 0; i < polyline.points.size(); ++i) {
+        if (i == 1) {
+            out.append('L');
+        } else if (i > 1) {
+            out.append(' ');
+        }
+        out.appendNumber(polyline.points[i][0]);
+        out.append(' ');
+        out.appendNumber(polyline.points[i][1]);
+    }
+}
+
+void SvgExporter::writeArc(const Geometry::Arc& arc, TextBuffer& out) const
+{
+    auto appendPoint = [&out](const float point[2]) {
+        out.appendNumber(point[0]);
+        out.append(' ');
+        out.appendNumber(point[1]);
+    };
+    // sweep flag 1 turns from +x towards +y, the direction of growing angles in the document
+    auto appendArcTo = [&](float angle, bool large) {
+        float point[2];
+        arc.pointAt(angle, point);
+        out.append('A');
+        out.appendNumber(arc.radius);
+        out.append(' ');
+        out.appendNumber(arc.radius);
+        out.append(large ? " 0 1 1 " : " 0 0 1 ");
+        appendPoint(point);
+    };
+
+    float start[2];
+    arc.pointAt(arc.startAngle, start);
+    out.append('M');
+    appendPoint(start);
+    // an SVG arc whose end points coincide draws nothing, full circles take two halves
+    if (arc.sweepAngle >= 2 * std::numbers::pi_v<float> * 0.9999f) {
+        appendArcTo(arc.startAngle + std::numbers::pi_v<float>, false);
+        appendArcTo(arc.startAngle, false);
+    } else {
+        appendArcTo(arc.endAngle(), arc.sweepAngle > std::numbers::pi_v<float>);
+    }
+}
+
+void SvgExporter::endStyleRun(TextBuffer& out) const
+{
+    out.append("\"/>\n");
+}
+
+}
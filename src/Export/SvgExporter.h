@@ -0,0 +1,21 @@
+#pragma once
+
+#include "Export/StreamingExporter.h"
+
+namespace Export {
+
+class SvgExporter : public StreamingExporter {
+public:
+    SvgExporter(const Geometry::DocumentSnapshot& document);
+
+protected:
+    void writeHeader(Files::OutputStream& out, const Geometry::BoundingBox& bounds) override;
+    void writeFooter(Files::OutputStream& out) override;
+
+    void beginStyleRun(const std::array<float, 3>& color, TextBuffer& out) const override;
+    void writePolyline(const Polyline& polyline, TextBuffer& out) const override;
+    void writeArc(const Geometry::Arc& arc, TextBuffer& out) const override;
+    void endStyleRun(TextBuffer& out) const override;
+};
+
+}
@@ -0,0 +1,65 @@
+#include "TextBuffer.h"
+#include <charconv>
+#include <system_error>
+
+namespace Export {
+
+namespace {
+
+constexpr size_t maxNumberLength = 64;
+
+}
+
+void TextBuffer::append(std::string_view text)
+{
+    _text.append(text);
+}
+
+void TextBuffer::append(char c)
+{
+    _text.push_back(c);
+}
+
+void TextBuffer::appendNumber(float value)
+{
+    size_t used = _text.size();
+    _text.resize(used + maxNumberLength);
+    // fixed notation: PDF has no exponent syntax and SVG/DXF readers handle it best
+    auto [end, error] = std::to_chars(_text.data() + used, _text.data() + _text.size(), value, std::chars_format::fixed);
+    if (error != std::errc()) {
+        _text.resize(used);
+        _text.push_back('0');
+        return;
+    }
+    _text.resize(end - _text.data());
+}
+
+void TextBuffer::appendNumber(int64_t value)
+{
+    size_t used = _text.size();
+    _text.resize(used + maxNumberLength);
+    auto [end, error] = std::to_chars(_text.data() + used, _text.data() + _text.size(), value);
+    _text.resize(end - _text.data());
+}
+
+void TextBuffer::clear()
+{
+    _text.clear();
+}
+
+bool TextBuffer::empty() const
+{
+    return _text.empty();
+}
+
+size_t TextBuffer::size() const
+{
+    return _text.size();
+}
+
+const char* TextBuffer::data() const
+{
+    return _text.data();
+}
+
+}
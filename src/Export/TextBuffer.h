@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace Export {
+
+// append-only text used by the exporters to format records off the writer thread,
+// numbers go through std::to_chars so no locale or iostream is involved
+class TextBuffer {
+public:
+    void append(std::string_view text);
+    void append(char c);
+    void appendNumber(float value);
+    void appendNumber(int64_t value);
+
+    void clear();
+    bool empty() const;
+    size_t size() const;
+    const char* data() const;
+
+private:
+    std::string _text;
+};
+
+}
@@ -0,0 +1,169 @@
+#include "AsciiGridReader.h"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <limits>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+#include "Library/Concurrency/ThreadPool.h"
+#include "Library/Files/FileStream.h"
+
+namespace Import {
+
+namespace {
+
+// bytes of values per task, cut at the next line end
+constexpr size_t blockSize = 1 << 20;
+
+bool isSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+std::string lower(std::string_view text)
+{
+    std::string result(text);
+    std::transform(result.begin(), result.end(), result.begin(), [](unsigned char c) { return std::tolower(c); });
+    return result;
+}
+
+struct Block {
+    std::string_view text;
+    std::vector<float> values;
+    bool broken = false;
+};
+
+void parse(Block& block, std::optional<float> noData)
+{
+    const char* cursor = block.text.data();
+    const char* end = cursor + block.text.size();
+    while (true) {
+        while (cursor < end && isSpace(*cursor)) {
+            ++cursor;
+        }
+        if (cursor == end) {
+            return;
+        }
+        if (*cursor == '+') {
+            ++cursor;
+        }
+        float value;
+        std::from_chars_result result = std::from_chars(cursor, end, value);
+        if (result.ec != std::errc() || (result.ptr < end && !isSpace(*result.ptr))) {
+            block.broken = true;
+            return;
+        }
+        cursor = result.ptr;
+        block.values.push_back(noData && value == *noData ? std::numeric_limits<float>::quiet_NaN() : value);
+    }
+}
+
+}
+
+AsciiGridReader::AsciiGridReader(const std::string& fileName)
+{
+    Files::FileStream fs(fileName, Files::FileStream::Mode::Mapped);
+    std::span<const char> mapped = fs.span<char>();
+    std::string_view text(mapped.data(), mapped.size());
+    _byteCount = text.size();
+
+    // the header, a keyword and a number a line, up to the first line starting with a number
+    std::optional<double> columns, rows, cellSize, x, y, noData;
+    bool xCenter = false;
+    bool yCenter = false;
+    size_t position = 0;
+    while (position < text.size()) {
+        while (position < text.size() && isSpace(text[position])) {
+            ++position;
+        }
+        if (position == text.size() || !std::isalpha((unsigned char)text[position])) {
+            break;
+        }
+        size_t keyEnd = position;
+        while (keyEnd < text.size() && !isSpace(text[keyEnd])) {
+            ++keyEnd;
+        }
+        std::string key = lower(text.substr(position, keyEnd - position));
+        size_t valueStart = keyEnd;
+        while (valueStart < text.size() && (text[valueStart] == ' ' || text[valueStart] == '\t')) {
+            ++valueStart;
+        }
+        double value;
+        std::from_chars_result result = std::from_chars(text.data() + valueStart, text.data() + text.size(), value);
+        if (result.ec != std::errc()) {
+            throw std::runtime_error("the grid header has no number for " + key);
+        }
+        position = result.ptr - text.data();
+        if (key == "ncols") {
+            columns = value;
+        } else if (key == "nrows") {
+            rows = value;
+        } else if (key == "cellsize") {
+            cellSize = value;
+        } else if (key == "xllcorner" || key == "xllcenter") {
+            x = value;
+            xCenter = key == "xllcenter";
+        } else if (key == "yllcorner" || key == "yllcenter") {
+            y = value;
+            yCenter = key == "yllcenter";
+        } else if (key == "nodata_value") {
+            noData = value;
+        } else {
+            throw std::runtime_error("unknown grid header line " + key);
+        }
+    }
+    if (!columns || !rows || !cellSize || !x || !y) {
+        throw std::runtime_error("the grid header is incomplete");
+    }
+    if (!(*columns >= 1 && *columns < 1 << 30) || !(*rows >= 1 && *rows < 1 << 30) || !(*cellSize > 0)) {
+        throw std::runtime_error("the grid header has no valid size");
+    }
+
+    std::vector<Block> blocks;
+    for (size_t begin = position; begin < text.size();) {
+        size_t end = begin + blockSize < text.size() ? text.find('\n', begin + blockSize) : text.size();
+        end = end == std::string_view::npos ? text.size() : end + 1;
+        blocks.push_back({text.substr(begin, end - begin)});
+        begin = end;
+    }
+    std::optional<float> noDataValue;
+    if (noData) {
+        noDataValue = (float)*noData;
+    }
+    Concurrency::ThreadPool::global().parallelFor(blocks.size(),
+                                                  [&](size_t index) { parse(blocks[index], noDataValue); });
+
+    _grid.columns = (uint32_t)*columns;
+    _grid.rows = (uint32_t)*rows;
+    _grid.spacing = *cellSize;
+    size_t expected = (size_t)_grid.columns * _grid.rows;
+    size_t total = 0;
+    for (const Block& block : blocks) {
+        if (block.broken) {
+            throw std::runtime_error("the grid has a value that isn't a number");
+        }
+        total += block.values.size();
+    }
+    if (total != expected) {
+        throw std::runtime_error("the grid has " + std::to_string(total) + " values instead of " +
+                                 std::to_string(expected));
+    }
+    _grid.values.reserve(expected);
+    for (Block& block : blocks) {
+        _grid.values.insert(_grid.values.end(), block.values.begin(), block.values.end());
+        block = {};
+    }
+
+    // centers of the samples; the first row is the top one, the lowest y once flipped
+    double left = *x + (xCenter ? 0.0 : *cellSize / 2);
+    double bottom = *y + (yCenter ? 0.0 : *cellSize / 2);
+    _grid.origin[0] = left;
+    _grid.origin[1] = -(bottom + (_grid.rows - 1) * *cellSize);
+}
+
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#include "UI/cpp/Geometry/ElevationGrid.h"
+
+namespace Import {
+
+// Reads an Esri ASCII grid (.asc): the header of ncols, nrows, xllcorner or xllcenter,
+// yllcorner or yllcenter, cellsize and an optional NODATA_value, then the values row by row
+// from the top. The mapped values are parsed in blocks of lines on the pool. The coordinates
+// are taken as the document's; y is flipped like in the DXF import, which keeps the rows of
+// the file in order. Throws std::runtime_error on a broken header or a wrong number of values.
+class AsciiGridReader {
+public:
+    AsciiGridReader(const std::string& fileName);
+
+    const Geometry::ElevationGrid& grid() const { return _grid; }
+
+    size_t byteCount() const { return _byteCount; }
+
+private:
+    Geometry::ElevationGrid _grid;
+    size_t _byteCount = 0;
+};
+
+}
@@ -0,0 +1,341 @@
+#include "DxfImporter.h"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <numbers>
+#include <span>
+#include <cstdint>
+#include <stdexcept>
+#include <system_error>
+
+#include "Library/Files/FileStream.h"
+
+namespace Import {
+
+namespace {
+
+std::string_view trim(std::string_view text)
+{
+    while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) {
+        text.remove_prefix(1);
+    }
+    while (!text.empty() && (text.back() == ' ' || text.back() == '\t' || text.back() == '\r')) {
+        text.remove_suffix(1);
+    }
+    return text;
+}
+
+template<typename T>
+bool parseNumber(std::string_view text, T& value)
+{
+    auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+    return error == std::errc() && end == text.data() + text.size();
+}
+
+class GroupReader {
+public:
+    GroupReader(std::string_view text) : _text(text) {}
+
+    bool next(int& code, std::string_view& value)
+    {
+        std::string_view codeLine;
+        if (!readLine(codeLine) || !readLine(value)) {
+            return false;
+        }
+        if (!parseNumber(trim(codeLine), code)) {
+            throw std::runtime_error("invalid DXF group code at line " + std::to_string(_line - 1));
+        }
+        value = trim(value);
+        return true;
+    }
+
+private:
+    bool readLine(std::string_view& line)
+    {
+        if (_position >= _text.size()) {
+            return false;
+        }
+        size_t end = _text.find('\n', _position);
+        if (end == std::string_view::npos) {
+            end = _text.size();
+        }
+        line = _text.substr(_position, end - _position);
+        _position = end + 1;
+        ++_line;
+        return true;
+    }
+
+    std::string_view _text;
+    size_t _position = 0;
+    size_t _line = 0;
+};
+
+enum class Entity {
+    None,
+    Line,
+    Circle,
+    Arc,
+    // POLYLINE header, its vertices come as VERTEX entities up to SEQEND
+    Polyline,
+    Vertex,
+    LwPolyline,
+};
+
+void setColor(int64_t color, float rgb[3])
+{
+    rgb[0] = ((color >> 16) & 0xFF) / 255.0f;
+    rgb[1] = ((color >> 8) & 0xFF) / 255.0f;
+    rgb[2] = (color & 0xFF) / 255.0f;
+}
+
+float radians(float degrees)
+{
+    return degrees * std::numbers::pi_v<float> / 180.0f;
+}
+
+}
+
+DxfImporter::DxfImporter(const std::string& fileName) :
+    _fileName(fileName)
+{
+    Files::FileStream fs(fileName, Files::FileStream::Mode::Mapped);
+    std::span<const char> text = fs.span<char>();
+    parse(std::string_view(text.data(), text.size()));
+}
+
+const std::vector<DxfImporter::Layer>& DxfImporter::layers() const
+{
+    return _layers;
+}
+
+DxfImporter::Layer& DxfImporter::layer(std::string_view name)
+{
+    if (name.empty()) {
+        name = "0";
+    }
+    if (_lastLayer < _layers.size() && _layers[_lastLayer].name == name) {
+        return _layers[_lastLayer];
+    }
+    auto found = std::find_if(_layers.begin(), _layers.end(), [name](const Layer& layer) { return layer.name == name; });
+    if (found == _layers.end()) {
+        _layers.push_back(Layer{std::string(name)});
+        found = _layers.end() - 1;
+    }
+    _lastLayer = found - _layers.begin();
+    return *found;
+}
+
+void DxfImporter::parse(std::string_view text)
+{
+    GroupReader reader(text);
+    bool inEntities = false;
+    Entity entity = Entity::None;
+    Geometry::Line line = {};
+    // circles and arcs are collected together, an arc entity keeps its angles in degrees until it ends
+    Geometry::Arc arc = {};
+    float startDegrees = 0.0f;
+    float endDegrees = 0.0f;
+    // POLYLINE and LWPOLYLINE, the color is applied to every vertex once the entity is complete
+    Polyline polyline;
+    bool inPolyline = false;
+    Geometry::Vertex vertex = {};
+    float polylineColor[3] = {};
+    // group 8 of the current entity, of the POLYLINE header while its vertices are read
+    std::string_view layerName;
+    std::string_view polylineLayer;
+
+    auto finishPolyline = [&]() {
+        if (polyline.vertices.size() >= 2) {
+            for (Geometry::Vertex& point : polyline.vertices) {
+                std::copy(polylineColor, polylineColor + 3, point.color);
+            }
+            layer(polylineLayer).polylines.append(polyline);
+        }
+        polyline = {};
+        inPolyline = false;
+    };
+
+    auto finishEntity = [&]() {
+        switch (entity) {
+            case Entity::Line:
+                layer(layerName).lines.append(line);
+                break;
+            case Entity::Circle:
+                layer(layerName).circles.append(Geometry::Circle{{arc.center[0], arc.center[1]}, arc.radius, arc.color});
+                break;
+            case Entity::Arc: {
+                // DXF arcs run counterclockwise with y up, the document has y down
+                float sweep = std::fmod(endDegrees - startDegrees, 360.0f);
+                if (sweep <= 0.0f) {
+                    sweep += 360.0f;
+                }
+                arc.startAngle = radians(-endDegrees);
+                arc.sweepAngle = radians(sweep);
+                layer(layerName).arcs.append(arc);
+                break;
+            }
+            case Entity::Vertex:
+                polyline.vertices.append(vertex);
+                break;
+            case Entity::LwPolyline:
+                polylineLayer = layerName;
+                finishPolyline();
+                break;
+            case Entity::Polyline:
+                polylineLayer = layerName;
+                break;
+            case Entity::None:
+                break;
+        }
+        entity = Entity::None;
+    };
+
+    int code;
+    std::string_view value;
+    while (reader.next(code, value)) {
+        if (code == 0) {
+            finishEntity();
+            // SEQEND ends the vertex list, so would any other entity in a broken file
+            if (inPolyline && value != "VERTEX") {
+                finishPolyline();
+            }
+            layerName = {};
+            if (value == "ENDSEC") {
+                inEntities = false;
+            } else if (inEntities && value == "LINE") {
+                entity = Entity::Line;
+                line = {};
+            } else if (inEntities && (value == "CIRCLE" || value == "ARC")) {
+                entity = value == "ARC" ? Entity::Arc : Entity::Circle;
+                arc = {};
+                arc.color = Geometry::packColor(0.0f, 0.0f, 0.0f);
+                startDegrees = 0.0f;
+                endDegrees = 360.0f;
+            } else if (inEntities && (value == "POLYLINE" || value == "LWPOLYLINE")) {
+                entity = value == "POLYLINE" ? Entity::Polyline : Entity::LwPolyline;
+                polyline = {};
+                inPolyline = entity == Entity::Polyline;
+                std::fill(polylineColor, polylineColor + 3, 0.0f);
+            } else if (inPolyline && value == "VERTEX") {
+                entity = Entity::Vertex;
+                vertex = {};
+            }
+            continue;
+        }
+        if (code == 2 && value == "ENTITIES") {
+            inEntities = true;
+            continue;
+        }
+        if (entity == Entity::None) {
+            continue;
+        }
+        if (code == 8) {
+            layerName = value;
+            continue;
+        }
+
+        float number = 0.0f;
+        int64_t color = 0;
+        int flags = 0;
+        if (entity == Entity::Polyline || entity == Entity::LwPolyline || entity == Entity::Vertex) {
+            switch (code) {
+                case 10:
+                    parseNumber(value, number);
+                    // every LWPOLYLINE vertex starts with its x
+                    if (entity == Entity::LwPolyline) {
+                        polyline.vertices.append(Geometry::Vertex{});
+                        polyline.vertices.back().pos[0] = number;
+                    } else if (entity == Entity::Vertex) {
+                        vertex.pos[0] = number;
+                    }
+                    break;
+                case 20:
+                    parseNumber(value, number);
+                    if (entity == Entity::LwPolyline && !polyline.vertices.isEmpty()) {
+                        polyline.vertices.back().pos[1] = -number;
+                    } else if (entity == Entity::Vertex) {
+                        vertex.pos[1] = -number;
+                    }
+                    break;
+                case 70:
+                    if (entity != Entity::Vertex && parseNumber(value, flags)) {
+                        polyline.closed = flags & 1;
+                    }
+                    break;
+                case 420:
+                    if (entity != Entity::Vertex && parseNumber(value, color)) {
+                        setColor(color, polylineColor);
+                    }
+                    break;
+                default:
+                    break;
+            }
+            continue;
+        }
+        if (entity != Entity::Line) {
+            switch (code) {
+                case 10:
+                    parseNumber(value, number);
+                    arc.center[0] = number;
+                    break;
+                case 20:
+                    parseNumber(value, number);
+                    arc.center[1] = -number;
+                    break;
+                case 40:
+                    parseNumber(value, arc.radius);
+                    break;
+                case 50:
+                    parseNumber(value, startDegrees);
+                    break;
+                case 51:
+                    parseNumber(value, endDegrees);
+                    break;
+                case 420:
+                    if (parseNumber(value, color)) {
+                        arc.color = Geometry::packColor(((color >> 16) & 0xFF) / 255.0f, ((color >> 8) & 0xFF) / 255.0f,
+                                                        (color & 0xFF) / 255.0f);
+                    }
+                    break;
+                default:
+                    break;
+            }
+            continue;
+        }
+
+        switch (code) {
+            case 10:
+                parseNumber(value, number);
+                line.vertices[0].pos[0] = number;
+                break;
+            case 20:
+                parseNumber(value, number);
+                line.vertices[0].pos[1] = -number;
+                break;
+            case 11:
+                parseNumber(value, number);
+                line.vertices[1].pos[0] = number;
+                break;
+            case 21:
+                parseNumber(value, number);
+                line.vertices[1].pos[1] = -number;
+                break;
+            case 420:
+                if (parseNumber(value, color)) {
+                    for (Geometry::Vertex& lineVertex : line.vertices) {
+                        setColor(color, lineVertex.color);
+                    }
+                }
+                break;
+            default:
+                break;
+        }
+    }
+
+    finishEntity();
+    if (inPolyline) {
+        finishPolyline();
+    }
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "ImportedLayer.h"
+#include "UI/cpp/Geometry/Color.h"
+
+namespace Import {
+
+// Reads the LINE, CIRCLE, ARC, POLYLINE and LWPOLYLINE entities of an ASCII DXF, the inverse
+// of Export::DxfExporter. Other entities are skipped. Entities are grouped by their layer (group 8),
+// entities without one go to layer "0".
+class DxfImporter {
+public:
+    // the vertices of a polyline are all in the color of the entity
+    using Polyline = ImportedPolyline;
+    using Layer = ImportedLayer;
+
+    DxfImporter(const std::string& fileName);
+
+    // in the order their first entity appears in the file
+    const std::vector<Layer>& layers() const;
+
+private:
+    void parse(std::string_view text);
+    Layer& layer(std::string_view name);
+
+    std::string _fileName;
+    std::vector<Layer> _layers;
+    // consecutive entities are mostly on the same layer
+    size_t _lastLayer = 0;
+};
+
+}
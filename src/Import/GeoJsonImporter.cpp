@@ -0,0 +1,318 @@
+#include "GeoJsonImporter.h"
+#include <charconv>
+#include <filesystem>
+#include <span>
+#include <stdexcept>
+#include <system_error>
+
+#include "Library/Concurrency/ThreadPool.h"
+#include "Library/Files/FileStream.h"
+#include "Library/Geodesy/Transform.h"
+
+namespace Import {
+
+namespace {
+
+// Pull tokenizer over JSON text. Strings are handed out raw, between their quotes and with
+// their escapes left in; a string followed by a colon comes as a key. Commas and colons are
+// skipped, the parser's own stack knows where it is.
+class JsonTokenizer {
+public:
+    enum class Token {
+        End,
+        BeginObject,
+        EndObject,
+        BeginArray,
+        EndArray,
+        Key,
+        String,
+        Number,
+        // true, false and null
+        Literal,
+    };
+
+    JsonTokenizer(std::string_view text) : _text(text) {}
+
+    Token next(std::string_view& value)
+    {
+        skipSeparators();
+        if (_position >= _text.size()) {
+            return Token::End;
+        }
+        char c = _text[_position];
+        switch (c) {
+            case '{':
+                ++_position;
+                return Token::BeginObject;
+            case '}':
+                ++_position;
+                return Token::EndObject;
+            case '[':
+                ++_position;
+                return Token::BeginArray;
+            case ']':
+                ++_position;
+                return Token::EndArray;
+            case '"': {
+                value = readString();
+                skipWhitespace();
+                if (_position < _text.size() && _text[_position] == ':') {
+                    ++_position;
+                    return Token::Key;
+                }
+                return Token::String;
+            }
+            default:
+                break;
+        }
+        size_t begin = _position;
+        while (_position < _text.size() && !isDelimiter(_text[_position])) {
+            ++_position;
+        }
+        value = _text.substr(begin, _position - begin);
+        if (value.empty()) {
+            fail();
+        }
+        return c == '-' || (c >= '0' && c <= '9') ? Token::Number : Token::Literal;
+    }
+
+    [[noreturn]] void fail() const
+    {
+        throw std::runtime_error("invalid GeoJSON at byte " + std::to_string(_position));
+    }
+
+private:
+    static bool isDelimiter(char c)
+    {
+        return c == ',' || c == ':' || c == ']' || c == '}' || c == ' ' || c == '\n' || c == '\r' || c == '\t';
+    }
+
+    void skipWhitespace()
+    {
+        while (_position < _text.size() &&
+               (_text[_position] == ' ' || _text[_position] == '\n' || _text[_position] == '\r' ||
+                _text[_position] == '\t')) {
+            ++_position;
+        }
+    }
+
+    void skipSeparators()
+    {
+        skipWhitespace();
+        while (_position < _text.size() && _text[_position] == ',') {
+            ++_position;
+            skipWhitespace();
+        }
+    }
+
+    std::string_view readString()
+    {
+        size_t begin = ++_position;
+        while (_position < _text.size() && _text[_position] != '"') {
+            // the escaped character can't end the string
+            _position += _text[_position] == '\\' ? 2 : 1;
+        }
+        if (_position >= _text.size()) {
+            fail();
+        }
+        return _text.substr(begin, _position++ - begin);
+    }
+
+    std::string_view _text;
+    size_t _position = 0;
+};
+
+// an object or an array the parser is in
+struct Frame {
+    bool object;
+    // value of the object's "type" key
+    std::string_view type;
+    // parts read from the object's "coordinates" key
+    bool hasCoordinates = false;
+    size_t partsBegin = 0;
+    size_t partsEnd = 0;
+};
+
+}
+
+GeoJsonImporter::GeoJsonImporter(const std::string& fileName, const Geodesy::Transform* transform)
+{
+    _layer.name = std::filesystem::path(fileName).stem().string();
+    {
+        Files::FileStream fs(fileName, Files::FileStream::Mode::Mapped);
+        std::span<const char> text = fs.span<char>();
+        _byteCount = text.size();
+        parse(std::string_view(text.data(), text.size()));
+    }
+    finish(transform);
+}
+
+void GeoJsonImporter::parse(std::string_view text)
+{
+    JsonTokenizer tokenizer(text);
+    std::vector<Frame> stack;
+    std::string_view value;
+
+    // The value of a "coordinates" key: nested arrays with positions innermost. Every array
+    // directly holding positions becomes a part; a lone position (a Point) is dropped.
+    auto readCoordinates = [&]() {
+        // per open array: the first point read inside it, whether its children were positions,
+        // and for a position its numbers so far
+        struct Level {
+            size_t first = 0;
+            bool holdsPositions = false;
+            int numbers = 0;
+        };
+        std::vector<Level> levels;
+        JsonTokenizer::Token token = tokenizer.next(value);
+        if (token != JsonTokenizer::Token::BeginArray) {
+            // null or anything else that isn't an array of positions
+            if (token != JsonTokenizer::Token::Literal) {
+                tokenizer.fail();
+            }
+            return;
+        }
+        levels.push_back({_x.size()});
+        double x = 0.0;
+        double y = 0.0;
+        while (!levels.empty()) {
+            token = tokenizer.next(value);
+            Level& level = levels.back();
+            switch (token) {
+                case JsonTokenizer::Token::BeginArray:
+                    levels.push_back({_x.size()});
+                    break;
+                case JsonTokenizer::Token::Number: {
+                    double number = 0.0;
+                    std::from_chars(value.data(), value.data() + value.size(), number);
+                    // heights and measures after x and y are ignored
+                    if (level.numbers == 0) {
+                        x = number;
+                    } else if (level.numbers == 1) {
+                        y = number;
+                    }
+                    ++level.numbers;
+                    break;
+                }
+                case JsonTokenizer::Token::EndArray: {
+                    Level closed = level;
+                    levels.pop_back();
+                    if (closed.numbers >= 2 && !levels.empty()) {
+                        _x.push_back(x);
+                        _y.push_back(y);
+                        levels.back().holdsPositions = true;
+                    } else if (closed.holdsPositions) {
+                        _parts.push_back({closed.first, _x.size() - closed.first, false});
+                    }
+                    break;
+                }
+                default:
+                    tokenizer.fail();
+            }
+        }
+    };
+
+    // the previous token was the key "type" of the innermost object
+    bool typeValue = false;
+    for (JsonTokenizer::Token token = tokenizer.next(value); token != JsonTokenizer::Token::End;
+         token = tokenizer.next(value)) {
+        if (typeValue && token == JsonTokenizer::Token::String) {
+            stack.back().type = value;
+        }
+        typeValue = false;
+        switch (token) {
+            case JsonTokenizer::Token::BeginObject:
+                stack.push_back({true});
+                break;
+            case JsonTokenizer::Token::BeginArray:
+                stack.push_back({false});
+                break;
+            case JsonTokenizer::Token::EndObject:
+            case JsonTokenizer::Token::EndArray: {
+                if (stack.empty() || stack.back().object != (token == JsonTokenizer::Token::EndObject)) {
+                    tokenizer.fail();
+                }
+                Frame frame = stack.back();
+                stack.pop_back();
+                if (!frame.hasCoordinates) {
+                    break;
+                }
+                bool lines = frame.type == "LineString" || frame.type == "MultiLineString";
+                bool rings = frame.type == "Polygon" || frame.type == "MultiPolygon";
+                if (!lines && !rings) {
+                    // points, unknown types; geometries nested in the object were read after its own parts
+                    _parts.erase(_parts.begin() + frame.partsBegin, _parts.begin() + frame.partsEnd);
+                    break;
+                }
+                for (size_t i = frame.partsBegin; i < frame.partsEnd; ++i) {
+                    _parts[i].ring = rings;
+                }
+                ++_geometryCount;
+                break;
+            }
+            case JsonTokenizer::Token::Key: {
+                if (stack.empty() || !stack.back().object) {
+                    tokenizer.fail();
+                }
+                if (value == "type") {
+                    typeValue = true;
+                } else if (value == "coordinates") {
+                    Frame& frame = stack.back();
+                    frame.hasCoordinates = true;
+                    frame.partsBegin = _parts.size();
+                    readCoordinates();
+                    frame.partsEnd = _parts.size();
+                }
+                break;
+            }
+            default:
+                // scalar values of keys nobody reads
+                break;
+        }
+    }
+    if (!stack.empty()) {
+        tokenizer.fail();
+    }
+}
+
+void GeoJsonImporter::finish(const Geodesy::Transform* transform)
+{
+    if (transform) {
+        transform->apply(_x.data(), _y.data(), _x.size(), Concurrency::ThreadPool::global());
+    }
+
+    auto vertex = [this](size_t index) {
+        Geometry::Vertex vertex = {};
+        vertex.pos[0] = (float)_x[index];
+        vertex.pos[1] = (float)-_y[index];
+        return vertex;
+    };
+
+    for (const Part& part : _parts) {
+        size_t count = part.count;
+        // rings repeat their first position at the end, the polyline closes itself
+        if (part.ring && count > 1 && _x[part.first] == _x[part.first + count - 1] &&
+            _y[part.first] == _y[part.first + count - 1]) {
+            --count;
+        }
+        if (count < 2) {
+            continue;
+        }
+        if (count == 2) {
+            _layer.lines.append(Geometry::Line{{vertex(part.first), vertex(part.first + 1)}});
+            continue;
+        }
+        ImportedPolyline polyline;
+        polyline.vertices.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            polyline.vertices.append(vertex(part.first + i));
+        }
+        polyline.closed = part.ring;
+        _layer.polylines.append(std::move(polyline));
+    }
+    _x = {};
+    _y = {};
+    _parts = {};
+}
+
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "ImportedLayer.h"
+
+namespace Geodesy {
+class Transform;
+}
+
+namespace Import {
+
+// Reads the LineString, MultiLineString, Polygon and MultiPolygon geometries of a GeoJSON file
+// into one layer named after the file, wherever they appear (features, collections, bare
+// geometries); other geometries and all properties are skipped. The mapped file is read by a
+// pull tokenizer in one pass without building a document tree, so memory grows with the
+// geometry read, not with the file.
+class GeoJsonImporter {
+public:
+    // the transform, when given, takes the coordinates (longitude and latitude of WGS 84, see
+    // RFC 7946) into the document's system before they are narrowed to floats; y is flipped
+    // like in the DXF import
+    GeoJsonImporter(const std::string& fileName, const Geodesy::Transform* transform = nullptr);
+
+    const ImportedLayer& layer() const { return _layer; }
+    size_t geometryCount() const { return _geometryCount; }
+    size_t byteCount() const { return _byteCount; }
+
+private:
+    // a part is an array of positions: a line string or a ring
+    struct Part {
+        size_t first;
+        size_t count;
+        bool ring;
+    };
+
+    void parse(std::string_view text);
+    void finish(const Geodesy::Transform* transform);
+
+    ImportedLayer _layer;
+    size_t _geometryCount = 0;
+    size_t _byteCount = 0;
+    std::vector<double> _x;
+    std::vector<double> _y;
+    std::vector<Part> _parts;
+};
+
+}
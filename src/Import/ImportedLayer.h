@@ -0,0 +1,28 @@
+#pragma once
+
+#include <QVector>
+#include <string>
+
+#include "UI/cpp/Geometry/Arc.h"
+#include "UI/cpp/Geometry/Circle.h"
+#include "UI/cpp/Geometry/Line.h"
+#include "UI/cpp/Geometry/Vertex.h"
+
+namespace Import {
+
+// vertices for Geometry::PolylineList::add()
+struct ImportedPolyline {
+    QVector<Geometry::Vertex> vertices;
+    bool closed = false;
+};
+
+// what an importer read for one layer of the document, added with bulk appends
+struct ImportedLayer {
+    std::string name;
+    QVector<Geometry::Line> lines;
+    QVector<Geometry::Circle> circles;
+    QVector<Geometry::Arc> arcs;
+    QVector<ImportedPolyline> polylines;
+};
+
+}
@@ -0,0 +1,172 @@
+#include "LasReader.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include "Library/Files/FileStream.h"
+
+namespace Import {
+
+namespace {
+
+// the 1.0 header, later versions only append to it
+constexpr size_t minimumHeaderSize = 227;
+// where 1.4 keeps the 64 bit point count
+constexpr size_t pointCount64Offset = 247;
+constexpr size_t header14Size = 375;
+
+template<typename T>
+T littleEndian(const unsigned char* data)
+{
+    T value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+// offset of red in the record, 0 when the format has no color
+size_t colorOffset(uint8_t format)
+{
+    switch (format) {
+        case 2:
+            return 20;
+        case 3:
+        case 5:
+            return 28;
+        case 7:
+        case 8:
+        case 10:
+            return 30;
+        default:
+            return 0;
+    }
+}
+
+// bytes of the fields a format defines, records may be longer with extra bytes
+size_t minimumRecordLength(uint8_t format)
+{
+    static constexpr size_t lengths[] = {20, 28, 26, 34, 57, 63, 30, 36, 38, 59, 67};
+    return lengths[format];
+}
+
+}
+
+bool LasReader::Header::hasColor() const
+{
+    return colorOffset(pointFormat) != 0;
+}
+
+LasReader::LasReader(const std::string& fileName) :
+    _fileName(fileName),
+    _file(std::make_unique<Files::FileStream>(fileName, Files::FileStream::Mode::Streaming))
+{
+    readHeader();
+}
+
+LasReader::~LasReader() = default;
+
+size_t LasReader::byteCount() const
+{
+    return _file->getSize();
+}
+
+void LasReader::readHeader()
+{
+    std::vector<unsigned char> header(header14Size);
+    size_t headerRead = _file->read(header.data(), header.size());
+    if (headerRead < minimumHeaderSize || std::memcmp(header.data(), "LASF", 4) != 0) {
+        throw std::runtime_error(_fileName + " isn't a LAS file");
+    }
+
+    _header.versionMajor = header[24];
+    _header.versionMinor = header[25];
+    size_t headerSize = littleEndian<uint16_t>(header.data() + 94);
+    uint32_t pointOffset = littleEndian<uint32_t>(header.data() + 96);
+    uint8_t format = header[104];
+    // LAZ sets the top bits of the format, the records are compressed
+    if (format & 0xC0) {
+        throw std::runtime_error(_fileName + " is compressed (LAZ), only LAS can be read");
+    }
+    if (format > 10) {
+        throw std::runtime_error(_fileName + " has the unknown point format " + std::to_string(format));
+    }
+    _header.pointFormat = format;
+    _header.recordLength = littleEndian<uint16_t>(header.data() + 105);
+    if (_header.recordLength < minimumRecordLength(format)) {
+        throw std::runtime_error(_fileName + " has records shorter than its point format");
+    }
+
+    _header.pointCount = littleEndian<uint32_t>(header.data() + 107);
+    if (headerSize >= header14Size && headerRead >= header14Size) {
+        uint64_t count = littleEndian<uint64_t>(header.data() + pointCount64Offset);
+        if (count != 0) {
+            _header.pointCount = count;
+        }
+    }
+    for (int axis = 0; axis < 3; ++axis) {
+        _header.scale[axis] = littleEndian<double>(header.data() + 131 + axis * 8);
+        _header.offset[axis] = littleEndian<double>(header.data() + 155 + axis * 8);
+        // max x, min x, max y, min y, max z, min z
+        _header.max[axis] = littleEndian<double>(header.data() + 179 + axis * 16);
+        _header.min[axis] = littleEndian<double>(header.data() + 187 + axis * 16);
+    }
+
+    // the variable length records between header and points aren't read, the stream is
+    // only moved past them
+    if (pointOffset < headerRead) {
+        if (pointOffset < minimumHeaderSize) {
+            throw std::runtime_error(_fileName + " has its points inside its header");
+        }
+        // the points start inside what was read as header
+        _carried.assign(header.begin() + pointOffset, header.begin() + headerRead);
+    } else {
+        std::vector<unsigned char> skipped(pointOffset - headerRead);
+        if (_file->read(skipped.data(), skipped.size()) != skipped.size()) {
+            throw std::runtime_error(_fileName + " ends before its points");
+        }
+    }
+
+    if (_header.pointCount > (byteCount() - pointOffset) / _header.recordLength) {
+        throw std::runtime_error(_fileName + " is truncated");
+    }
+}
+
+size_t LasReader::read(Block& block, size_t maxCount)
+{
+    size_t count = (size_t)std::min<uint64_t>(maxCount, _header.pointCount - _pointsRead);
+    size_t recordLength = _header.recordLength;
+
+    // bytes left over from the header read come first
+    _records.resize(count * recordLength);
+    size_t carried = std::min(_records.size(), _carried.size());
+    std::copy(_carried.begin(), _carried.begin() + carried, _records.begin());
+    _carried.erase(_carried.begin(), _carried.begin() + carried);
+    if (carried < _records.size() &&
+        _file->read(_records.data() + carried, _records.size() - carried) != _records.size() - carried) {
+        throw std::runtime_error(_fileName + " is truncated");
+    }
+
+    size_t color = colorOffset(_header.pointFormat);
+    block.x.resize(count);
+    block.y.resize(count);
+    block.z.resize(count);
+    block.intensity.resize(count);
+    block.red.resize(color ? count : 0);
+    block.green.resize(color ? count : 0);
+    block.blue.resize(color ? count : 0);
+    for (size_t i = 0; i < count; ++i) {
+        const unsigned char* record = _records.data() + i * recordLength;
+        block.x[i] = littleEndian<int32_t>(record) * _header.scale[0] + _header.offset[0];
+        block.y[i] = littleEndian<int32_t>(record + 4) * _header.scale[1] + _header.offset[1];
+        block.z[i] = littleEndian<int32_t>(record + 8) * _header.scale[2] + _header.offset[2];
+        block.intensity[i] = littleEndian<uint16_t>(record + 12);
+        if (color) {
+            block.red[i] = littleEndian<uint16_t>(record + color);
+            block.green[i] = littleEndian<uint16_t>(record + color + 2);
+            block.blue[i] = littleEndian<uint16_t>(record + color + 4);
+        }
+    }
+    _pointsRead += count;
+    return count;
+}
+
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Files {
+class FileStream;
+}
+
+namespace Import {
+
+// Reads the points of an uncompressed ASPRS LAS file (versions 1.0 to 1.4, point formats 0 to
+// 10) front to back in blocks, so a scan of any size is read with the memory of one block.
+// Coordinates come scaled and offset as in the file's system; only what the point cloud layer
+// draws is decoded, classification, returns and GPS time are skipped.
+class LasReader {
+public:
+    struct Header {
+        uint8_t versionMajor = 0;
+        uint8_t versionMinor = 0;
+        uint8_t pointFormat = 0;
+        uint16_t recordLength = 0;
+        uint64_t pointCount = 0;
+        double scale[3] = {};
+        double offset[3] = {};
+        double min[3] = {};
+        double max[3] = {};
+
+        // formats 2, 3, 5, 7, 8 and 10 carry red, green and blue
+        bool hasColor() const;
+    };
+
+    // the decoded points, one entry per point in every vector
+    struct Block {
+        std::vector<double> x;
+        std::vector<double> y;
+        std::vector<double> z;
+        std::vector<uint16_t> intensity;
+        // 16 bit per channel as stored, empty when the format has no color
+        std::vector<uint16_t> red;
+        std::vector<uint16_t> green;
+        std::vector<uint16_t> blue;
+
+        size_t size() const { return x.size(); }
+    };
+
+    explicit LasReader(const std::string& fileName);
+    ~LasReader();
+
+    LasReader(const LasReader&) = delete;
+    LasReader& operator=(const LasReader&) = delete;
+
+    const Header& header() const { return _header; }
+    size_t byteCount() const;
+
+    // replaces the block's points by the next ones, at most maxCount; returns how many were
+    // read, 0 after the last point
+    size_t read(Block& block, size_t maxCount);
+
+private:
+    void readHeader();
+
+    std::string _fileName;
+    std::unique_ptr<Files::FileStream> _file;
+    Header _header;
+    uint64_t _pointsRead = 0;
+    // records of one read() before they are decoded
+    std::vector<unsigned char> _records;
+    // point bytes that came with the header read
+    std::vector<unsigned char> _carried;
+};
+
+}
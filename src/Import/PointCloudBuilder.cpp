@@ -0,0 +1,590 @@
+#include "PointCloudBuilder.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <limits>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <system_error>
+#include <unistd.h>
+#include <vector>
+
+#include "Import/LasReader.h"
+#include "Library/Concurrency/ThreadPool.h"
+#include "Library/Files/FileStream.h"
+#include "Library/Files/OutputStream.h"
+#include "Library/Geodesy/Transform.h"
+#include "UI/cpp/Geometry/Color.h"
+#include "UI/cpp/Geometry/PointCloud.h"
+
+namespace Import {
+
+namespace {
+
+using Geometry::BoundingBox;
+using Geometry::CloudPoint;
+using Geometry::PointCloud;
+
+// a point of the scan in the document's system, before its color is decided
+struct ScanPoint {
+    float pos[2];
+    float z;
+    uint16_t rgb[3];
+    uint16_t intensity;
+};
+
+static_assert(sizeof(ScanPoint) == 20);
+
+// points read, counted or distributed at a time
+constexpr size_t blockPoints = 1 << 20;
+// points one task of a pass over a block handles
+constexpr size_t batchPoints = 1 << 16;
+// the grid the quadtree is cut from has at most 4^maxDepth cells
+constexpr uint32_t maxDepth = 10;
+
+// the temporary files go however the build ends
+struct RemoveOnExit {
+    std::string fileName;
+
+    ~RemoveOnExit()
+    {
+        std::error_code error;
+        std::filesystem::remove(fileName, error);
+    }
+};
+
+struct FileDescriptor {
+    int value = -1;
+
+    ~FileDescriptor()
+    {
+        if (value >= 0) {
+            ::close(value);
+        }
+    }
+};
+
+void writeFully(int file, const void* data, size_t size, uint64_t offset, const std::string& fileName)
+{
+    const char* bytes = static_cast<const char*>(data);
+    while (size > 0) {
+        ssize_t count = pwrite(file, bytes, size, (off_t)offset);
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count <= 0) {
+            throw std::runtime_error("can't write file " + fileName + strerror(errno));
+        }
+        bytes += count;
+        size -= (size_t)count;
+        offset += (uint64_t)count;
+    }
+}
+
+void readFully(int file, void* data, size_t size, uint64_t offset, const std::string& fileName)
+{
+    char* bytes = static_cast<char*>(data);
+    while (size > 0) {
+        ssize_t count = pread(file, bytes, size, (off_t)offset);
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count <= 0) {
+            throw std::runtime_error("can't read file " + fileName + (count < 0 ? strerror(errno) : " (truncated)"));
+        }
+        bytes += count;
+        size -= (size_t)count;
+        offset += (uint64_t)count;
+    }
+}
+
+int64_t modifiedTime(const std::string& fileName)
+{
+    return std::filesystem::last_write_time(fileName).time_since_epoch().count();
+}
+
+// what the later passes need to know of the scan, gathered while it is read
+struct ScanStats {
+    BoundingBox bounds;
+    float minZ = std::numeric_limits<float>::max();
+    float maxZ = std::numeric_limits<float>::lowest();
+    uint16_t maxColor = 0;
+    uint16_t maxIntensity = 0;
+    uint64_t count = 0;
+};
+
+// the colors of the scan, else its intensity as gray, else a ramp over the heights
+uint32_t pointColor(const ScanPoint& point, const ScanStats& stats)
+{
+    auto pack = [](uint32_t r, uint32_t g, uint32_t b) { return r | g << 8 | b << 16 | 0xFFu << 24; };
+    if (stats.maxColor > 0) {
+        // 8 bit values in the 16 bit fields aren't rare
+        int shift = stats.maxColor > 255 ? 8 : 0;
+        return pack(point.rgb[0] >> shift, point.rgb[1] >> shift, point.rgb[2] >> shift);
+    }
+    if (stats.maxIntensity > 0) {
+        uint32_t gray = point.intensity * 255u / stats.maxIntensity;
+        return pack(gray, gray, gray);
+    }
+    float range = stats.maxZ - stats.minZ;
+    float t = range > 0.0f ? (point.z - stats.minZ) / range : 0.5f;
+    // blue over green to red
+    return Geometry::packColor(std::clamp(2.0f * t - 1.0f, 0.0f, 1.0f), 1.0f - std::abs(2.0f * t - 1.0f),
+                               std::clamp(1.0f - 2.0f * t, 0.0f, 1.0f));
+}
+
+// Reads the scan once into a flat file of converted points, the later passes read that one.
+// Points the transform can't convert are dropped.
+ScanStats readScan(const std::string& lasFileName, const std::string& scanName, const Geodesy::Transform* transform,
+                   size_t& byteCount)
+{
+    LasReader reader(lasFileName);
+    if (reader.header().pointCount == 0) {
+        throw std::runtime_error(lasFileName + " has no points");
+    }
+    byteCount += reader.byteCount();
+
+    ScanStats stats;
+    Files::OutputStream scan(scanName);
+    LasReader::Block block;
+    std::vector<ScanPoint> points;
+    while (size_t count = reader.read(block, blockPoints)) {
+        if (transform) {
+            transform->apply(block.x.data(), block.y.data(), count, Concurrency::ThreadPool::global());
+        }
+        points.clear();
+        for (size_t i = 0; i < count; ++i) {
+            ScanPoint point = {};
+            point.pos[0] = (float)block.x[i];
+            point.pos[1] = (float)-block.y[i];
+            point.z = (float)block.z[i];
+            if (!std::isfinite(point.pos[0]) || !std::isfinite(point.pos[1]) || !std::isfinite(point.z)) {
+                continue;
+            }
+            if (!block.red.empty()) {
+                point.rgb[0] = block.red[i];
+                point.rgb[1] = block.green[i];
+                point.rgb[2] = block.blue[i];
+                stats.maxColor = std::max({stats.maxColor, point.rgb[0], point.rgb[1], point.rgb[2]});
+            }
+            point.intensity = block.intensity[i];
+            stats.maxIntensity = std::max(stats.maxIntensity, point.intensity);
+            stats.bounds.expand(point.pos[0], point.pos[1]);
+            stats.minZ = std::min(stats.minZ, point.z);
+            stats.maxZ = std::max(stats.maxZ, point.z);
+            points.push_back(point);
+        }
+        scan.write(reinterpret_cast<const char*>(points.data()), points.size() * sizeof(ScanPoint));
+        stats.count += points.size();
+    }
+    scan.close();
+    byteCount += stats.count * sizeof(ScanPoint);
+    if (stats.count == 0) {
+        throw std::runtime_error(lasFileName + " has no points in the document's system");
+    }
+    return stats;
+}
+
+// calls visit(points, count) for every block of the flat scan file
+template<typename Visit>
+void forEachBlock(const std::string& scanName, Visit&& visit)
+{
+    Files::FileStream scan(scanName, Files::FileStream::Mode::Streaming);
+    std::vector<ScanPoint> points(blockPoints);
+    while (size_t bytes = scan.read(points.data(), points.size() * sizeof(ScanPoint))) {
+        visit(points.data(), bytes / sizeof(ScanPoint));
+    }
+}
+
+// the finest cells over the square around the scan, row by row
+class Grid {
+public:
+    Grid(const BoundingBox& bounds, uint32_t depth) :
+        _depth(depth),
+        _side(1u << depth),
+        _origin{bounds.min[0], bounds.min[1]}
+    {
+        _size = std::max((double)bounds.max[0] - bounds.min[0], (double)bounds.max[1] - bounds.min[1]);
+        if (!(_size > 0.0)) {
+            _size = 1.0;
+        }
+    }
+
+    uint32_t depth() const { return _depth; }
+    uint32_t side() const { return _side; }
+
+    size_t cellOf(const float (&pos)[2]) const
+    {
+        auto coordinate = [this](float value, double origin) {
+            double cell = std::floor((value - origin) / _size * _side);
+            return (size_t)std::clamp(cell, 0.0, _side - 1.0);
+        };
+        return coordinate(pos[1], _origin[1]) * _side + coordinate(pos[0], _origin[0]);
+    }
+
+    // the cell (x, y) of the grid with 2^level cells per side
+    BoundingBox cell(uint32_t level, uint32_t x, uint32_t y) const
+    {
+        double size = _size / (1u << level);
+        BoundingBox box;
+        box.expand((float)(_origin[0] + x * size), (float)(_origin[1] + y * size));
+        box.expand((float)(_origin[0] + (x + 1) * size), (float)(_origin[1] + (y + 1) * size));
+        return box;
+    }
+
+private:
+    uint32_t _depth;
+    uint32_t _side;
+    double _origin[2];
+    double _size;
+};
+
+std::vector<uint64_t> countCells(const std::string& scanName, const Grid& grid)
+{
+    std::vector<std::atomic<uint64_t>> counts(size_t(grid.side()) * grid.side());
+    forEachBlock(scanName, [&](const ScanPoint* points, size_t count) {
+        Concurrency::ThreadPool::global().parallelFor((count + batchPoints - 1) / batchPoints, [&](size_t batch) {
+            size_t end = std::min(count, (batch + 1) * batchPoints);
+            for (size_t i = batch * batchPoints; i < end; ++i) {
+                counts[grid.cellOf(points[i].pos)].fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+    });
+    return std::vector<uint64_t>(counts.begin(), counts.end());
+}
+
+struct Tree {
+    // breadth first, so the root is 0 and every level is one range
+    std::vector<PointCloud::Node> nodes;
+    std::vector<PointCloud::Page> pages;
+    // first node of every level and the end of the last
+    std::vector<size_t> levelBegin;
+    // the leaf every cell of the grid went to
+    std::vector<uint32_t> leafOfCell;
+    uint64_t storedCount = 0;
+};
+
+// A node is split while it has more points than a page holds and the grid is finer, empty
+// quadrants get no child. Leaves keep all their points, a leaf at the grid's depth may need
+// several pages; inner nodes keep one page of samples.
+Tree cutTree(const Grid& grid, std::vector<uint64_t> counts, uint32_t capacity)
+{
+    // the counts of every coarser grid, level 0 is the whole square
+    std::vector<std::vector<uint64_t>> pyramid(grid.depth() + 1);
+    pyramid[grid.depth()] = std::move(counts);
+    for (uint32_t level = grid.depth(); level > 0; --level) {
+        uint32_t side = 1u << (level - 1);
+        std::vector<uint64_t>& coarse = pyramid[level - 1];
+        coarse.assign(size_t(side) * side, 0);
+        for (uint32_t y = 0; y < side * 2; ++y) {
+            for (uint32_t x = 0; x < side * 2; ++x) {
+                coarse[size_t(y / 2) * side + x / 2] += pyramid[level][size_t(y) * side * 2 + x];
+            }
+        }
+    }
+    auto countOf = [&pyramid](uint32_t level, uint32_t x, uint32_t y) {
+        return pyramid[level][(size_t(y) << level) + x];
+    };
+
+    Tree tree;
+    // cell of every node in its level's grid
+    std::vector<std::pair<uint32_t, uint32_t>> positions;
+    tree.nodes.push_back(PointCloud::Node{grid.cell(0, 0, 0), {}, 0, 0, 0});
+    positions.emplace_back(0, 0);
+    for (size_t i = 0; i < tree.nodes.size(); ++i) {
+        uint32_t level = tree.nodes[i].level;
+        auto [x, y] = positions[i];
+        if (level == grid.depth() || countOf(level, x, y) <= capacity) {
+            continue;
+        }
+        for (uint32_t quadrant = 0; quadrant < 4; ++quadrant) {
+            uint32_t childX = x * 2 + (quadrant & 1);
+            uint32_t childY = y * 2 + (quadrant >> 1);
+            if (countOf(level + 1, childX, childY) == 0) {
+                continue;
+            }
+            tree.nodes[i].children[quadrant] = (uint32_t)tree.nodes.size();
+            tree.nodes.push_back(PointCloud::Node{grid.cell(level + 1, childX, childY), {}, 0, 0, level + 1});
+            positions.emplace_back(childX, childY);
+        }
+    }
+    for (size_t i = 0; i < tree.nodes.size(); ++i) {
+        if (i == 0 || tree.nodes[i].level != tree.nodes[i - 1].level) {
+            tree.levelBegin.push_back(i);
+        }
+    }
+    tree.levelBegin.push_back(tree.nodes.size());
+
+    // bottom up, an inner node keeps as many samples as its children hold up to a page
+    std::vector<uint64_t> stored(tree.nodes.size());
+    for (size_t i = tree.nodes.size(); i-- > 0;) {
+        const PointCloud::Node& node = tree.nodes[i];
+        if (node.isLeaf()) {
+            stored[i] = countOf(node.level, positions[i].first, positions[i].second);
+            continue;
+        }
+        for (uint32_t child : node.children) {
+            stored[i] += child ? stored[child] : 0;
+        }
+        stored[i] = std::min<uint64_t>(stored[i], capacity);
+    }
+
+    tree.leafOfCell.resize(size_t(grid.side()) * grid.side());
+    for (size_t i = 0; i < tree.nodes.size(); ++i) {
+        PointCloud::Node& node = tree.nodes[i];
+        node.firstPage = (uint32_t)tree.pages.size();
+        for (uint64_t first = 0; first < stored[i]; first += capacity) {
+            uint32_t count = (uint32_t)std::min<uint64_t>(capacity, stored[i] - first);
+            tree.pages.push_back(PointCloud::Page{tree.storedCount + first, count, (uint32_t)i});
+        }
+        node.pageCount = (uint32_t)tree.pages.size() - node.firstPage;
+        tree.storedCount += stored[i];
+
+        if (node.isLeaf()) {
+            uint32_t span = 1u << (grid.depth() - node.level);
+            for (uint32_t y = positions[i].second * span; y < (positions[i].second + 1) * span; ++y) {
+                std::fill_n(tree.leafOfCell.begin() + size_t(y) * grid.side() + positions[i].first * span, span,
+                            (uint32_t)i);
+            }
+        }
+    }
+    return tree;
+}
+
+// Writes every point to its leaf's pages. The points of a leaf are collected in a buffer of
+// their own and written when it is full, the buffers together stay around bufferBytes.
+void distribute(const std::string& scanName, const Grid& grid, const Tree& tree, const ScanStats& stats, int file,
+                const std::string& fileName, uint64_t pointsOffset, size_t bufferBytes)
+{
+    std::vector<uint64_t> cursors(tree.nodes.size());
+    size_t leafCount = 0;
+    for (size_t i = 0; i < tree.nodes.size(); ++i) {
+        if (tree.nodes[i].isLeaf()) {
+            cursors[i] = tree.pages[tree.nodes[i].firstPage].first;
+            ++leafCount;
+        }
+    }
+    size_t bufferPoints = std::clamp<size_t>(bufferBytes / (leafCount * sizeof(CloudPoint)), 64, 4096);
+    std::vector<std::vector<CloudPoint>> buffers(tree.nodes.size());
+    auto flush = [&](size_t leaf) {
+        std::vector<CloudPoint>& buffer = buffers[leaf];
+        writeFully(file, buffer.data(), buffer.size() * sizeof(CloudPoint),
+                   pointsOffset + cursors[leaf] * sizeof(CloudPoint), fileName);
+        cursors[leaf] += buffer.size();
+        buffer.clear();
+    };
+
+    std::vector<uint32_t> leaves(blockPoints);
+    std::vector<CloudPoint> converted(blockPoints);
+    forEachBlock(scanName, [&](const ScanPoint* points, size_t count) {
+        Concurrency::ThreadPool::global().parallelFor((count + batchPoints - 1) / batchPoints, [&](size_t batch) {
+            size_t end = std::min(count, (batch + 1) * batchPoints);
+            for (size_t i = batch * batchPoints; i < end; ++i) {
+                leaves[i] = tree.leafOfCell[grid.cellOf(points[i].pos)];
+                converted[i] = CloudPoint{{points[i].pos[0], points[i].pos[1]}, pointColor(points[i], stats)};
+            }
+        });
+        for (size_t i = 0; i < count; ++i) {
+            std::vector<CloudPoint>& buffer = buffers[leaves[i]];
+            if (buffer.capacity() == 0) {
+                buffer.reserve(bufferPoints);
+            }
+            buffer.push_back(converted[i]);
+            if (buffer.size() == bufferPoints) {
+                flush(leaves[i]);
+            }
+        }
+    });
+
+    for (size_t i = 0; i < tree.nodes.size(); ++i) {
+        if (!tree.nodes[i].isLeaf()) {
+            continue;
+        }
+        flush(i);
+        const PointCloud::Page& last = tree.pages[tree.nodes[i].firstPage + tree.nodes[i].pageCount - 1];
+        if (cursors[i] != last.first + last.count) {
+            throw std::runtime_error("the scan changed while its point cloud was built");
+        }
+    }
+}
+
+// Picks a page of points spread evenly over a cell: the first point in every cell of a grid
+// with about as many cells as the page holds, then random ones of the rest until the page is
+// full. The rest is a reservoir sample, so its memory is a page whatever is fed.
+class Sampler {
+public:
+    Sampler(const BoundingBox& cell, size_t capacity, uint32_t seed) :
+        _cell(cell),
+        _capacity(capacity),
+        _side(std::max<size_t>(1, (size_t)std::sqrt((double)capacity))),
+        _taken(_side * _side),
+        _random(seed)
+    {
+        _selected.reserve(capacity);
+    }
+
+    void add(const CloudPoint& point)
+    {
+        size_t cell = cellOf(point.pos[1], 1) * _side + cellOf(point.pos[0], 0);
+        if (!_taken[cell] && _selected.size() < _capacity) {
+            _taken[cell] = true;
+            _selected.push_back(point);
+            return;
+        }
+        ++_rejected;
+        if (_reservoir.size() < _capacity) {
+            _reservoir.push_back(point);
+        } else if (size_t index = _random() % _rejected; index < _capacity) {
+            _reservoir[index] = point;
+        }
+    }
+
+    std::vector<CloudPoint> finish()
+    {
+        size_t fill = std::min(_capacity - _selected.size(), _reservoir.size());
+        _selected.insert(_selected.end(), _reservoir.begin(), _reservoir.begin() + fill);
+        return std::move(_selected);
+    }
+
+private:
+    size_t cellOf(float value, int axis) const
+    {
+        float size = _cell.max[axis] - _cell.min[axis];
+        float cell = size > 0.0f ? std::floor((value - _cell.min[axis]) / size * _side) : 0.0f;
+        return (size_t)std::clamp(cell, 0.0f, _side - 1.0f);
+    }
+
+    BoundingBox _cell;
+    size_t _capacity;
+    size_t _side;
+    std::vector<bool> _taken;
+    std::vector<CloudPoint> _selected;
+    std::vector<CloudPoint> _reservoir;
+    uint64_t _rejected = 0;
+    std::mt19937_64 _random;
+};
+
+// level by level from the deepest, the children of a level are written before it is sampled
+void sampleInnerNodes(const Tree& tree, uint32_t capacity, int file, const std::string& fileName,
+                      uint64_t pointsOffset)
+{
+    for (size_t level = tree.levelBegin.size() - 1; level-- > 0;) {
+        size_t begin = tree.levelBegin[level];
+        size_t count = tree.levelBegin[level + 1] - begin;
+        Concurrency::ThreadPool::global().parallelFor(count, [&](size_t index) {
+            size_t i = begin + index;
+            const PointCloud::Node& node = tree.nodes[i];
+            if (node.isLeaf()) {
+                return;
+            }
+            Sampler sampler(node.cell, capacity, (uint32_t)i);
+            std::vector<CloudPoint> points;
+            for (uint32_t child : node.children) {
+                if (!child) {
+                    continue;
+                }
+                const PointCloud::Node& childNode = tree.nodes[child];
+                for (uint32_t page = childNode.firstPage; page < childNode.firstPage + childNode.pageCount; ++page) {
+                    points.resize(tree.pages[page].count);
+                    readFully(file, points.data(), points.size() * sizeof(CloudPoint),
+                              pointsOffset + tree.pages[page].first * sizeof(CloudPoint), fileName);
+                    for (const CloudPoint& point : points) {
+                        sampler.add(point);
+                    }
+                }
+            }
+            std::vector<CloudPoint> sample = sampler.finish();
+            const PointCloud::Page& page = tree.pages[node.firstPage];
+            writeFully(file, sample.data(), std::min<size_t>(sample.size(), page.count) * sizeof(CloudPoint),
+                       pointsOffset + page.first * sizeof(CloudPoint), fileName);
+        });
+    }
+}
+
+}
+
+PointCloudBuilder::PointCloudBuilder(const std::string& lasFileName, const std::string& cacheFileName,
+                                     const Options& options)
+{
+    if (upToDate(lasFileName, cacheFileName, options)) {
+        _reused = true;
+        _pointCount = PointCloud::open(cacheFileName, lasFileName)->pointCount();
+        return;
+    }
+    if (options.nodeCapacity == 0) {
+        throw std::runtime_error("a point cloud page has to hold points");
+    }
+
+    RemoveOnExit scanFile{cacheFileName + ".scan"};
+    ScanStats stats = readScan(lasFileName, scanFile.fileName, options.transform, _byteCount);
+    _pointCount = stats.count;
+
+    // cells of about a sixteenth of a page on average, so leaves follow the density a few levels down
+    uint32_t depth = 0;
+    while (depth < maxDepth && (uint64_t(1) << (2 * depth)) * options.nodeCapacity < stats.count * 16) {
+        ++depth;
+    }
+    Grid grid(stats.bounds, depth);
+    Tree tree = cutTree(grid, countCells(scanFile.fileName, grid), options.nodeCapacity);
+    _byteCount += stats.count * sizeof(ScanPoint) * 2;
+
+    RemoveOnExit partFile{cacheFileName + ".part"};
+    FileDescriptor file{::open(partFile.fileName.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644)};
+    if (file.value < 0) {
+        throw std::runtime_error("can't open file " + partFile.fileName + strerror(errno));
+    }
+    uint64_t pagesOffset = sizeof(PointCloud::FileHeader) + tree.nodes.size() * sizeof(PointCloud::Node);
+    uint64_t pointsOffset = pagesOffset + tree.pages.size() * sizeof(PointCloud::Page);
+
+    distribute(scanFile.fileName, grid, tree, stats, file.value, partFile.fileName, pointsOffset,
+               options.bufferBytes);
+    sampleInnerNodes(tree, options.nodeCapacity, file.value, partFile.fileName, pointsOffset);
+    _byteCount += tree.storedCount * sizeof(CloudPoint);
+
+    PointCloud::FileHeader header = {};
+    std::memcpy(header.magic, PointCloud::FileHeader::magicValue, sizeof(header.magic));
+    header.version = PointCloud::FileHeader::currentVersion;
+    header.nodeCapacity = options.nodeCapacity;
+    header.pointCount = stats.count;
+    header.storedCount = tree.storedCount;
+    header.nodeCount = (uint32_t)tree.nodes.size();
+    header.pageCount = (uint32_t)tree.pages.size();
+    header.bounds = stats.bounds;
+    header.sourceSize = std::filesystem::file_size(lasFileName);
+    header.sourceModified = modifiedTime(lasFileName);
+    header.sourceEpsg = options.sourceEpsg;
+    header.documentEpsg = options.documentEpsg;
+    writeFully(file.value, &header, sizeof(header), 0, partFile.fileName);
+    writeFully(file.value, tree.nodes.data(), tree.nodes.size() * sizeof(PointCloud::Node), sizeof(header),
+               partFile.fileName);
+    writeFully(file.value, tree.pages.data(), tree.pages.size() * sizeof(PointCloud::Page), pagesOffset,
+               partFile.fileName);
+
+    // only a complete cache ever has the name a later import looks for
+    std::filesystem::rename(partFile.fileName, cacheFileName);
+}
+
+bool PointCloudBuilder::upToDate(const std::string& lasFileName, const std::string& cacheFileName,
+                                 const Options& options)
+{
+    try {
+        if (!std::filesystem::exists(cacheFileName)) {
+            return false;
+        }
+        std::shared_ptr<const PointCloud> cache = PointCloud::open(cacheFileName, lasFileName);
+        const PointCloud::FileHeader& header = cache->header();
+        return header.nodeCapacity == options.nodeCapacity && header.sourceSize == std::filesystem::file_size(lasFileName) &&
+               header.sourceModified == modifiedTime(lasFileName) && header.sourceEpsg == options.sourceEpsg &&
+               header.documentEpsg == options.documentEpsg;
+    } catch (const std::exception&) {
+        // unreadable or of another version, built again
+        return false;
+    }
+}
+
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace Geodesy {
+class Transform;
+}
+
+namespace Import {
+
+// Turns a LAS scan into the cache file of a Geometry::PointCloud. The scan is read once and
+// kept as a flat temporary file of converted points; a counting pass over that file sizes a
+// grid of cells, the quadtree is cut from the grid so no leaf holds much more than a node's
+// capacity, a distributing pass writes every point straight to its leaf's place in the cache
+// and the inner nodes are sampled from their children level by level, bottom up. Every pass
+// streams, memory is bounded by the options and the grid, not by the scan. Meant to run off
+// the GUI thread, it blocks for as long as reading and writing the scan a few times takes.
+class PointCloudBuilder {
+public:
+    struct Options {
+        // takes the coordinates into the document's system before they are narrowed to floats
+        const Geodesy::Transform* transform = nullptr;
+        // of the transform, kept in the cache; a cache built for other codes is built again
+        int sourceEpsg = 0;
+        int documentEpsg = 0;
+        // points per page, what a view streams and keeps resident at a time
+        uint32_t nodeCapacity = 16384;
+        // for the buffers collecting the points of every leaf during distribution
+        size_t bufferBytes = 64 << 20;
+    };
+
+    // writes the cache unless an up to date one is there already; y is flipped like in the
+    // DXF import
+    PointCloudBuilder(const std::string& lasFileName, const std::string& cacheFileName, const Options& options);
+
+    // whether the cache was there already and nothing was read
+    bool reused() const { return _reused; }
+    uint64_t pointCount() const { return _pointCount; }
+    // read and written, the scan's bytes once per pass
+    size_t byteCount() const { return _byteCount; }
+
+    // the cache was built from the scan as it is now, with the same options
+    static bool upToDate(const std::string& lasFileName, const std::string& cacheFileName, const Options& options);
+
+private:
+    bool _reused = false;
+    uint64_t _pointCount = 0;
+    size_t _byteCount = 0;
+};
+
+}
@@ -0,0 +1,315 @@
+#include "RasterPyramidBuilder.h"
+#include <QByteArray>
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <stdexcept>
+#include <system_error>
+#include <unistd.h>
+#include <vector>
+
+#include "Import/TiffReader.h"
+#include "Library/Concurrency/ThreadPool.h"
+#include "Library/Geodesy/Transform.h"
+#include "UI/cpp/Geometry/Raster.h"
+
+namespace Import {
+
+namespace {
+
+using Geometry::Raster;
+
+// zlib's fastest, decompressing is what the views wait for and it hardly depends on the level
+constexpr int compressionLevel = 1;
+
+// the temporary file goes however the build ends
+struct RemoveOnExit {
+    std::string fileName;
+
+    ~RemoveOnExit()
+    {
+        std::error_code error;
+        std::filesystem::remove(fileName, error);
+    }
+};
+
+struct FileDescriptor {
+    int value = -1;
+
+    ~FileDescriptor()
+    {
+        if (value >= 0) {
+            ::close(value);
+        }
+    }
+};
+
+void writeFully(int file, const void* data, size_t size, uint64_t offset, const std::string& fileName)
+{
+    const char* bytes = static_cast<const char*>(data);
+    while (size > 0) {
+        ssize_t count = pwrite(file, bytes, size, (off_t)offset);
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count <= 0) {
+            throw std::runtime_error("can't write file " + fileName + strerror(errno));
+        }
+        bytes += count;
+        size -= (size_t)count;
+        offset += (uint64_t)count;
+    }
+}
+
+int64_t modifiedTime(const std::string& fileName)
+{
+    return std::filesystem::last_write_time(fileName).time_since_epoch().count();
+}
+
+// the image's georeference taken into the document, through its corners
+TiffReader::Affine documentGeoreference(const TiffReader& reader, const Geodesy::Transform* transform)
+{
+    const TiffReader::Affine& a = reader.georeference();
+    double width = reader.width();
+    double height = reader.height();
+    double x[3] = {a[0], a[0] + a[1] * width, a[0] + a[2] * height};
+    double y[3] = {a[3], a[3] + a[4] * width, a[3] + a[5] * height};
+    if (transform) {
+        transform->apply(x, y, 3);
+    }
+    for (int i = 0; i < 3; ++i) {
+        if (!std::isfinite(x[i]) || !std::isfinite(y[i])) {
+            throw std::runtime_error("the image's corners aren't in the document's system");
+        }
+    }
+    return {x[0], (x[1] - x[0]) / width, (x[2] - x[0]) / height,
+            -y[0], -(y[1] - y[0]) / width, -(y[2] - y[0]) / height};
+}
+
+// The rows of every level waiting to become a row of tiles. A full band, or the last one of
+// its level, is cut into tiles and halved into the band of the level above.
+class PyramidWriter {
+public:
+    PyramidWriter(uint32_t width, uint32_t height, uint32_t tileSize, int file, const std::string& fileName) :
+        _tileSize(tileSize),
+        _file(file),
+        _fileName(fileName),
+        _offset(sizeof(Raster::FileHeader))
+    {
+        uint64_t firstTile = 0;
+        while (true) {
+            Raster::Level level = {width, height, (width + tileSize - 1) / tileSize, (height + tileSize - 1) / tileSize,
+                                   firstTile};
+            _levels.push_back(level);
+            firstTile += (uint64_t)level.tilesX * level.tilesY;
+            if (width <= tileSize && height <= tileSize) {
+                break;
+            }
+            width = (width + 1) / 2;
+            height = (height + 1) / 2;
+        }
+        _tiles.assign(firstTile, Raster::Tile{});
+        _bands.resize(_levels.size());
+        for (size_t level = 0; level < _levels.size(); ++level) {
+            _bands[level].rgba.resize((size_t)_levels[level].width * tileSize * 4);
+        }
+    }
+
+    const std::vector<Raster::Level>& levels() const { return _levels; }
+    const std::vector<Raster::Tile>& tiles() const { return _tiles; }
+    // end of the tiles written so far
+    uint64_t offset() const { return _offset; }
+
+    // where the next rows of level 0 go, width * 4 bytes per row
+    uint8_t* levelZeroRows() { return _bands[0].rgba.data(); }
+
+    void addLevelZeroRows(uint32_t rows)
+    {
+        _bands[0].rows = rows;
+        finishBand(0);
+    }
+
+private:
+    struct Band {
+        std::vector<uint8_t> rgba;
+        uint32_t rows = 0;
+        // rows of the level finished before this band
+        uint32_t done = 0;
+        uint32_t tileRow = 0;
+    };
+
+    void finishBand(size_t level)
+    {
+        Band& band = _bands[level];
+        const Raster::Level& info = _levels[level];
+        writeTiles(level);
+
+        if (level + 1 < _levels.size()) {
+            Band& above = _bands[level + 1];
+            const Raster::Level& aboveInfo = _levels[level + 1];
+            uint32_t rows = (band.rows + 1) / 2;
+            Concurrency::ThreadPool::global().parallelFor(rows, [&](size_t row) {
+                halveRow(band, info.width, (uint32_t)row,
+                         above.rgba.data() + ((size_t)above.rows + row) * aboveInfo.width * 4, aboveInfo.width);
+            });
+            above.rows += rows;
+            if (above.rows == _tileSize || above.done + above.rows == aboveInfo.height) {
+                finishBand(level + 1);
+            }
+        }
+
+        band.done += band.rows;
+        band.rows = 0;
+        ++band.tileRow;
+    }
+
+    // the band's tiles compressed on the pool, written in order
+    void writeTiles(size_t level)
+    {
+        const Band& band = _bands[level];
+        const Raster::Level& info = _levels[level];
+        std::vector<QByteArray> packed(info.tilesX);
+        Concurrency::ThreadPool::global().parallelFor(info.tilesX, [&](size_t x) {
+            std::vector<uint8_t> tile((size_t)_tileSize * _tileSize * 4, 0);
+            uint32_t left = (uint32_t)x * _tileSize;
+            uint32_t columns = std::min(_tileSize, info.width - left);
+            bool opaque = false;
+            for (uint32_t row = 0; row < band.rows; ++row) {
+                const uint8_t* source = band.rgba.data() + ((size_t)row * info.width + left) * 4;
+                std::memcpy(tile.data() + (size_t)row * _tileSize * 4, source, (size_t)columns * 4);
+                for (uint32_t column = 0; column < columns && !opaque; ++column) {
+                    opaque = source[column * 4 + 3] != 0;
+                }
+            }
+            if (opaque) {
+                packed[x] = qCompress(tile.data(), (qsizetype)tile.size(), compressionLevel);
+            }
+        });
+        for (uint32_t x = 0; x < info.tilesX; ++x) {
+            Raster::Tile& tile = _tiles[info.firstTile + (uint64_t)band.tileRow * info.tilesX + x];
+            if (packed[x].isEmpty()) {
+                continue;
+            }
+            writeFully(_file, packed[x].constData(), packed[x].size(), _offset, _fileName);
+            tile.offset = _offset;
+            tile.size = (uint32_t)packed[x].size();
+            _offset += tile.size;
+        }
+    }
+
+    // one row of the level above from two of the band, averaged by alpha so the transparent
+    // outside doesn't darken the edges
+    static void halveRow(const Band& band, uint32_t width, uint32_t row, uint8_t* target, uint32_t targetWidth)
+    {
+        const uint8_t* rows[2] = {band.rgba.data() + (size_t)(2 * row) * width * 4,
+                                  band.rgba.data() + (size_t)std::min(2 * row + 1, band.rows - 1) * width * 4};
+        for (uint32_t x = 0; x < targetWidth; ++x) {
+            uint32_t columns[2] = {2 * x, std::min(2 * x + 1, width - 1)};
+            uint32_t sum[3] = {};
+            uint32_t alpha = 0;
+            for (const uint8_t* source : rows) {
+                for (uint32_t column : columns) {
+                    const uint8_t* texel = source + (size_t)column * 4;
+                    for (int c = 0; c < 3; ++c) {
+                        sum[c] += texel[c] * texel[3];
+                    }
+                    alpha += texel[3];
+                }
+            }
+            uint8_t* texel = target + (size_t)x * 4;
+            for (int c = 0; c < 3; ++c) {
+                texel[c] = alpha ? (uint8_t)((sum[c] + alpha / 2) / alpha) : 0;
+            }
+            texel[3] = (uint8_t)((alpha + 2) / 4);
+        }
+    }
+
+    uint32_t _tileSize;
+    int _file;
+    const std::string& _fileName;
+    uint64_t _offset;
+    std::vector<Raster::Level> _levels;
+    std::vector<Raster::Tile> _tiles;
+    std::vector<Band> _bands;
+};
+
+}
+
+RasterPyramidBuilder::RasterPyramidBuilder(const std::string& imageFileName, const std::string& cacheFileName,
+                                           const Options& options)
+{
+    if (upToDate(imageFileName, cacheFileName, options)) {
+        _reused = true;
+        _tileCount = Raster::open(cacheFileName, imageFileName)->tiles().size();
+        return;
+    }
+    if (options.tileSize == 0) {
+        throw std::runtime_error("a raster tile has to hold texels");
+    }
+
+    TiffReader reader(imageFileName);
+    TiffReader::Affine georeference = documentGeoreference(reader, options.transform);
+
+    RemoveOnExit partFile{cacheFileName + ".part"};
+    FileDescriptor file{::open(partFile.fileName.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644)};
+    if (file.value < 0) {
+        throw std::runtime_error("can't open file " + partFile.fileName + strerror(errno));
+    }
+
+    PyramidWriter writer(reader.width(), reader.height(), options.tileSize, file.value, partFile.fileName);
+    for (uint32_t row = 0; row < reader.height(); row += options.tileSize) {
+        uint32_t rows = std::min(options.tileSize, reader.height() - row);
+        reader.readRows(row, rows, writer.levelZeroRows());
+        writer.addLevelZeroRows(rows);
+    }
+    _byteCount = reader.byteCount() + writer.offset();
+
+    const std::vector<Raster::Level>& levels = writer.levels();
+    const std::vector<Raster::Tile>& tiles = writer.tiles();
+    _tileCount = tiles.size();
+    Raster::FileHeader header = {};
+    std::memcpy(header.magic, Raster::FileHeader::magicValue, sizeof(header.magic));
+    header.version = Raster::FileHeader::currentVersion;
+    header.tileSize = options.tileSize;
+    header.width = reader.width();
+    header.height = reader.height();
+    header.levelCount = (uint32_t)levels.size();
+    header.tileCount = tiles.size();
+    header.tablesOffset = writer.offset();
+    std::copy(georeference.begin(), georeference.end(), header.georeference);
+    header.sourceSize = std::filesystem::file_size(imageFileName);
+    header.sourceModified = modifiedTime(imageFileName);
+    header.sourceEpsg = options.sourceEpsg;
+    header.documentEpsg = options.documentEpsg;
+    writeFully(file.value, levels.data(), levels.size() * sizeof(Raster::Level), header.tablesOffset,
+               partFile.fileName);
+    writeFully(file.value, tiles.data(), tiles.size() * sizeof(Raster::Tile),
+               header.tablesOffset + levels.size() * sizeof(Raster::Level), partFile.fileName);
+    writeFully(file.value, &header, sizeof(header), 0, partFile.fileName);
+
+    // only a complete cache ever has the name a later import looks for
+    std::filesystem::rename(partFile.fileName, cacheFileName);
+}
+
+bool RasterPyramidBuilder::upToDate(const std::string& imageFileName, const std::string& cacheFileName,
+                                    const Options& options)
+{
+    try {
+        if (!std::filesystem::exists(cacheFileName)) {
+            return false;
+        }
+        std::shared_ptr<const Raster> cache = Raster::open(cacheFileName, imageFileName);
+        const Raster::FileHeader& header = cache->header();
+        return header.tileSize == options.tileSize && header.sourceSize == std::filesystem::file_size(imageFileName) &&
+               header.sourceModified == modifiedTime(imageFileName) && header.sourceEpsg == options.sourceEpsg &&
+               header.documentEpsg == options.documentEpsg;
+    } catch (const std::exception&) {
+        // unreadable or of another version, built again
+        return false;
+    }
+}
+
+}
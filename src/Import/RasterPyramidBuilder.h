@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace Geodesy {
+class Transform;
+}
+
+namespace Import {
+
+// Turns a TIFF orthophoto into the tile pyramid cache of a Geometry::Raster. The image is read
+// once, a band of one tile row at a time; every band is cut into tiles and halved into the
+// band of the level above, which is cut and halved in turn once it is full, so all levels are
+// written in one pass and memory holds about two bands of the full width. Tiles are
+// compressed on the thread pool. Meant to run off the GUI thread like PointCloudBuilder.
+class RasterPyramidBuilder {
+public:
+    struct Options {
+        // takes the image's corners into the document's system; the image is placed by the
+        // affine map through three of them, so a transform bending it over its extent isn't
+        // followed
+        const Geodesy::Transform* transform = nullptr;
+        // of the transform, kept in the cache; a cache built for other codes is built again
+        int sourceEpsg = 0;
+        int documentEpsg = 0;
+        uint32_t tileSize = 256;
+    };
+
+    // writes the cache unless an up to date one is there already; y is flipped like in the
+    // DXF import
+    RasterPyramidBuilder(const std::string& imageFileName, const std::string& cacheFileName, const Options& options);
+
+    // whether the cache was there already and nothing was read
+    bool reused() const { return _reused; }
+    uint64_t tileCount() const { return _tileCount; }
+    // read and written
+    size_t byteCount() const { return _byteCount; }
+
+    // the cache was built from the image as it is now, with the same options
+    static bool upToDate(const std::string& imageFileName, const std::string& cacheFileName, const Options& options);
+
+private:
+    bool _reused = false;
+    uint64_t _tileCount = 0;
+    size_t _byteCount = 0;
+};
+
+}
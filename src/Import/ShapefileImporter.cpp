@@ -0,0 +1,260 @@
+#include "ShapefileImporter.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <system_error>
+
+#include "Library/Concurrency/ThreadPool.h"
+#include "Library/Files/FileStream.h"
+#include "Library/Geodesy/Transform.h"
+
+namespace Import {
+
+namespace {
+
+static_assert(std::endian::native == std::endian::little, "shapefile doubles are read in place");
+
+constexpr int32_t fileCode = 9994;
+constexpr size_t headerSize = 100;
+constexpr size_t indexEntrySize = 8;
+// records decoded by one task
+constexpr size_t batchSize = 4096;
+
+enum ShapeType : int32_t {
+    Null = 0,
+    PolyLine = 3,
+    Polygon = 5,
+    PolyLineZ = 13,
+    PolygonZ = 15,
+    PolyLineM = 23,
+    PolygonM = 25,
+};
+
+using Bytes = std::span<const unsigned char>;
+
+uint32_t bigEndian32(const unsigned char* data)
+{
+    return (uint32_t(data[0]) << 24) | (uint32_t(data[1]) << 16) | (uint32_t(data[2]) << 8) | data[3];
+}
+
+uint32_t littleEndian32(const unsigned char* data)
+{
+    return (uint32_t(data[3]) << 24) | (uint32_t(data[2]) << 16) | (uint32_t(data[1]) << 8) | data[0];
+}
+
+uint16_t littleEndian16(const unsigned char* data)
+{
+    return uint16_t(data[0] | (data[1] << 8));
+}
+
+double littleEndianDouble(const unsigned char* data)
+{
+    double value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+// the file next to it with the other extension, in either case
+std::optional<std::string> sibling(const std::string& fileName, const char* lower, const char* upper)
+{
+    for (const char* extension : {lower, upper}) {
+        std::filesystem::path path(fileName);
+        path.replace_extension(extension);
+        if (std::filesystem::exists(path)) {
+            return path.string();
+        }
+    }
+    return std::nullopt;
+}
+
+// what one task decoded, appended to the layer in batch order
+struct Batch {
+    QVector<Geometry::Line> lines;
+    QVector<ImportedPolyline> polylines;
+    size_t skipped = 0;
+    // coordinates of the batch, converted in one call before they become floats
+    std::vector<double> x;
+    std::vector<double> y;
+    // per part: first coordinate, point count and whether it is a polygon ring
+    struct Part {
+        size_t first;
+        uint32_t count;
+        bool ring;
+    };
+    std::vector<Part> parts;
+};
+
+void decodeRecord(Bytes shp, size_t offset, size_t length, Batch& batch)
+{
+    if (offset + 8 + length > shp.size() || length < 4) {
+        throw std::runtime_error("shapefile record at byte " + std::to_string(offset) + " is truncated");
+    }
+    const unsigned char* content = shp.data() + offset + 8;
+    int32_t type = (int32_t)littleEndian32(content);
+    bool ring = type == Polygon || type == PolygonZ || type == PolygonM;
+    if (!ring && type != PolyLine && type != PolyLineZ && type != PolyLineM) {
+        ++batch.skipped;
+        return;
+    }
+    // type, box, part count and point count come before the part starts
+    if (length < 44) {
+        throw std::runtime_error("shapefile record at byte " + std::to_string(offset) + " is truncated");
+    }
+    uint32_t partCount = littleEndian32(content + 36);
+    uint32_t pointCount = littleEndian32(content + 40);
+    size_t pointsOffset = 44 + size_t(partCount) * 4;
+    if (pointsOffset + size_t(pointCount) * 16 > length) {
+        throw std::runtime_error("shapefile record at byte " + std::to_string(offset) + " is truncated");
+    }
+    if (partCount == 0 || pointCount == 0) {
+        ++batch.skipped;
+        return;
+    }
+
+    size_t first = batch.x.size();
+    for (uint32_t i = 0; i < pointCount; ++i) {
+        const unsigned char* point = content + pointsOffset + size_t(i) * 16;
+        batch.x.push_back(littleEndianDouble(point));
+        batch.y.push_back(littleEndianDouble(point + 8));
+    }
+    for (uint32_t part = 0; part < partCount; ++part) {
+        uint32_t begin = littleEndian32(content + 44 + size_t(part) * 4);
+        uint32_t end = part + 1 < partCount ? littleEndian32(content + 48 + size_t(part) * 4) : pointCount;
+        if (begin < end && end <= pointCount) {
+            batch.parts.push_back({first + begin, end - begin, ring});
+        }
+    }
+}
+
+void buildEntities(Batch& batch)
+{
+    auto vertex = [&batch](size_t index) {
+        Geometry::Vertex vertex = {};
+        vertex.pos[0] = (float)batch.x[index];
+        vertex.pos[1] = (float)-batch.y[index];
+        return vertex;
+    };
+
+    for (const Batch::Part& part : batch.parts) {
+        uint32_t count = part.count;
+        // rings repeat their first point at the end, the polyline closes itself
+        if (part.ring && count > 1 && batch.x[part.first] == batch.x[part.first + count - 1] &&
+            batch.y[part.first] == batch.y[part.first + count - 1]) {
+            --count;
+        }
+        if (count < 2) {
+            continue;
+        }
+        if (count == 2) {
+            batch.lines.append(Geometry::Line{{vertex(part.first), vertex(part.first + 1)}});
+            continue;
+        }
+        ImportedPolyline polyline;
+        polyline.vertices.reserve(count);
+        for (uint32_t i = 0; i < count; ++i) {
+            polyline.vertices.append(vertex(part.first + i));
+        }
+        polyline.closed = part.ring;
+        batch.polylines.append(std::move(polyline));
+    }
+    batch.x = {};
+    batch.y = {};
+    batch.parts = {};
+}
+
+}
+
+ShapefileImporter::ShapefileImporter(const std::string& fileName, const Geodesy::Transform* transform)
+{
+    std::filesystem::path path(fileName);
+    _layer.name = path.stem().string();
+
+    std::optional<std::string> shx = sibling(fileName, ".shx", ".SHX");
+    if (!shx) {
+        throw std::runtime_error("the index of " + fileName + " (.shx) is missing");
+    }
+    readShapes(fileName, *shx, transform);
+    if (std::optional<std::string> dbf = sibling(fileName, ".dbf", ".DBF")) {
+        readAttributes(*dbf);
+    }
+}
+
+void ShapefileImporter::readShapes(const std::string& shpName, const std::string& shxName,
+                                   const Geodesy::Transform* transform)
+{
+    Files::FileStream shpFile(shpName, Files::FileStream::Mode::Mapped);
+    Files::FileStream shxFile(shxName, Files::FileStream::Mode::Mapped);
+    Bytes shp = shpFile.span<unsigned char>();
+    Bytes shx = shxFile.span<unsigned char>();
+    _byteCount += shp.size() + shx.size();
+
+    if (shp.size() < headerSize || shx.size() < headerSize || (int32_t)bigEndian32(shp.data()) != fileCode ||
+        (int32_t)bigEndian32(shx.data()) != fileCode) {
+        throw std::runtime_error(shpName + " isn't a shapefile");
+    }
+
+    _recordCount = (shx.size() - headerSize) / indexEntrySize;
+    std::vector<Batch> batches((_recordCount + batchSize - 1) / batchSize);
+    Concurrency::ThreadPool::global().parallelFor(batches.size(), [&](size_t index) {
+        Batch& batch = batches[index];
+        size_t end = std::min(_recordCount, (index + 1) * batchSize);
+        for (size_t record = index * batchSize; record < end; ++record) {
+            // offsets and lengths are in 16 bit words
+            const unsigned char* entry = shx.data() + headerSize + record * indexEntrySize;
+            decodeRecord(shp, size_t(bigEndian32(entry)) * 2, size_t(bigEndian32(entry + 4)) * 2, batch);
+        }
+        if (transform) {
+            transform->apply(batch.x.data(), batch.y.data(), batch.x.size());
+        }
+        buildEntities(batch);
+    });
+
+    size_t lineCount = 0;
+    size_t polylineCount = 0;
+    for (const Batch& batch : batches) {
+        lineCount += batch.lines.size();
+        polylineCount += batch.polylines.size();
+    }
+    _layer.lines.reserve(lineCount);
+    _layer.polylines.reserve(polylineCount);
+    for (Batch& batch : batches) {
+        _layer.lines.append(batch.lines);
+        for (ImportedPolyline& polyline : batch.polylines) {
+            _layer.polylines.append(std::move(polyline));
+        }
+        _skippedCount += batch.skipped;
+        batch = {};
+    }
+}
+
+void ShapefileImporter::readAttributes(const std::string& dbfName)
+{
+    // only the header and the field descriptors are read, the rows aren't touched
+    Files::FileStream dbfFile(dbfName, Files::FileStream::Mode::Mapped);
+    Bytes dbf = dbfFile.span<unsigned char>();
+    if (dbf.size() < 32) {
+        throw std::runtime_error(dbfName + " isn't a dBASE file");
+    }
+
+    size_t rowCount = littleEndian32(dbf.data() + 4);
+    size_t dataOffset = littleEndian16(dbf.data() + 8);
+    size_t rowSize = littleEndian16(dbf.data() + 10);
+    if (dataOffset > dbf.size() || rowSize == 0) {
+        throw std::runtime_error(dbfName + " isn't a dBASE file");
+    }
+    _attributeRowCount = std::min(rowCount, (dbf.size() - dataOffset) / rowSize);
+    _byteCount += dataOffset;
+
+    // 32 byte field descriptors up to the 0x0D terminator
+    for (size_t descriptor = 32; descriptor + 32 <= dataOffset && dbf[descriptor] != 0x0D; descriptor += 32) {
+        const char* name = reinterpret_cast<const char*>(dbf.data() + descriptor);
+        _attributes.push_back(Column{std::string(name, strnlen(name, 11)), (char)dbf[descriptor + 11]});
+    }
+}
+
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "ImportedLayer.h"
+
+namespace Geodesy {
+class Transform;
+}
+
+namespace Import {
+
+// Reads the polylines and polygons of an ESRI shapefile into one layer named after the file.
+// The .shp is mapped and cut into batches of records through its .shx index; the batches are
+// decoded on the thread pool straight into lines (parts of two points) and polylines (longer
+// parts, polygon rings closed), in file order. Points and multipatches are skipped. Of the .dbf
+// next to it, when there is one, only the columns and the row count are read; the document
+// has nowhere to keep the values yet.
+class ShapefileImporter {
+public:
+    struct Column {
+        std::string name;
+        // dBASE field type: N and F are numbers, everything else is text
+        char type;
+        bool numeric() const { return type == 'N' || type == 'F'; }
+    };
+
+    // the transform, when given, takes the coordinates into the document's system before they
+    // are narrowed to floats; y is flipped like in the DXF import
+    ShapefileImporter(const std::string& fileName, const Geodesy::Transform* transform = nullptr);
+
+    const ImportedLayer& layer() const { return _layer; }
+    const std::vector<Column>& attributes() const { return _attributes; }
+    // rows of the .dbf, one per shape record
+    size_t attributeRowCount() const { return _attributeRowCount; }
+    size_t recordCount() const { return _recordCount; }
+    // records that weren't lines or polygons, or were empty
+    size_t skippedCount() const { return _skippedCount; }
+    // of the .shp and .shx and the header of the .dbf
+    size_t byteCount() const { return _byteCount; }
+
+private:
+    void readShapes(const std::string& shpName, const std::string& shxName, const Geodesy::Transform* transform);
+    void readAttributes(const std::string& dbfName);
+
+    ImportedLayer _layer;
+    std::vector<Column> _attributes;
+    size_t _attributeRowCount = 0;
+    size_t _recordCount = 0;
+    size_t _skippedCount = 0;
+    size_t _byteCount = 0;
+};
+
+}
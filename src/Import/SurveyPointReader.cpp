@@ -0,0 +1,130 @@
+#include "SurveyPointReader.h"
+#include <algorithm>
+#include <charconv>
+#include <span>
+#include <string_view>
+
+#include "Library/Concurrency/ThreadPool.h"
+#include "Library/Files/FileStream.h"
+#include "Library/Geodesy/Transform.h"
+
+namespace Import {
+
+namespace {
+
+// bytes of text per task, cut at the next line end
+constexpr size_t blockSize = 1 << 20;
+
+bool isSeparator(char c)
+{
+    return c == ' ' || c == '\t' || c == ',' || c == ';' || c == '\r';
+}
+
+struct Block {
+    std::string_view text;
+    std::vector<double> x;
+    std::vector<double> y;
+    std::vector<double> z;
+    // blank lines, as the number of the block's points before each
+    std::vector<size_t> breaks;
+    size_t skipped = 0;
+};
+
+void parse(Block& block)
+{
+    std::string_view text = block.text;
+    size_t position = 0;
+    while (position < text.size()) {
+        size_t end = std::min(text.find('\n', position), text.size());
+        const char* cursor = text.data() + position;
+        const char* lineEnd = text.data() + end;
+        position = end + 1;
+
+        double values[3];
+        int count = 0;
+        while (count < 3) {
+            while (cursor < lineEnd && isSeparator(*cursor)) {
+                ++cursor;
+            }
+            if (cursor == lineEnd) {
+                break;
+            }
+            // from_chars takes no plus sign
+            if (*cursor == '+') {
+                ++cursor;
+            }
+            std::from_chars_result result = std::from_chars(cursor, lineEnd, values[count]);
+            if (result.ec != std::errc() || (result.ptr < lineEnd && !isSeparator(*result.ptr))) {
+                break;
+            }
+            cursor = result.ptr;
+            ++count;
+        }
+        if (count == 3) {
+            block.x.push_back(values[0]);
+            block.y.push_back(values[1]);
+            block.z.push_back(values[2]);
+        } else if (count == 0 && cursor == lineEnd) {
+            block.breaks.push_back(block.x.size());
+        } else {
+            ++block.skipped;
+        }
+    }
+}
+
+}
+
+SurveyPointReader::SurveyPointReader(const std::string& fileName, const Geodesy::Transform* transform)
+{
+    Files::FileStream fs(fileName, Files::FileStream::Mode::Mapped);
+    std::span<const char> mapped = fs.span<char>();
+    std::string_view text(mapped.data(), mapped.size());
+    _byteCount = text.size();
+
+    std::vector<Block> blocks;
+    for (size_t begin = 0; begin < text.size();) {
+        size_t end = begin + blockSize < text.size() ? text.find('\n', begin + blockSize) : text.size();
+        end = end == std::string_view::npos ? text.size() : end + 1;
+        blocks.push_back({text.substr(begin, end - begin)});
+        begin = end;
+    }
+    Concurrency::ThreadPool::global().parallelFor(blocks.size(), [&](size_t index) {
+        Block& block = blocks[index];
+        parse(block);
+        if (transform) {
+            transform->apply(block.x.data(), block.y.data(), block.x.size());
+        }
+    });
+
+    size_t total = 0;
+    for (const Block& block : blocks) {
+        total += block.x.size();
+    }
+    _points.reserve(total);
+    for (Block& block : blocks) {
+        for (size_t blank : block.breaks) {
+            _breaks.push_back(_points.size() + blank);
+        }
+        for (size_t i = 0; i < block.x.size(); ++i) {
+            _points.push_back({{block.x[i], -block.y[i], block.z[i]}});
+        }
+        _skippedLineCount += block.skipped;
+        block = {};
+    }
+}
+
+std::vector<std::vector<Geometry::TinPoint>> SurveyPointReader::polylines() const
+{
+    std::vector<std::vector<Geometry::TinPoint>> polylines;
+    size_t first = 0;
+    for (size_t i = 0; i <= _breaks.size(); ++i) {
+        size_t end = i < _breaks.size() ? _breaks[i] : _points.size();
+        if (end >= first + 2) {
+            polylines.emplace_back(_points.begin() + first, _points.begin() + end);
+        }
+        first = std::max(first, end);
+    }
+    return polylines;
+}
+
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "UI/cpp/Geometry/Tin.h"
+
+namespace Geodesy {
+class Transform;
+}
+
+namespace Import {
+
+// Reads survey points from text, one "x y z" a line, the numbers separated by spaces, tabs,
+// commas or semicolons. Lines that don't start with three numbers (headers, codes, comments)
+// are skipped, whatever follows the third number is ignored. The mapped file is parsed in
+// blocks of lines on the pool. Breakline files are read the same way, a blank line ends a line.
+class SurveyPointReader {
+public:
+    // the transform, when given, takes x and y into the document's system; y is flipped like
+    // in the DXF import
+    SurveyPointReader(const std::string& fileName, const Geodesy::Transform* transform = nullptr);
+
+    const std::vector<Geometry::TinPoint>& points() const { return _points; }
+    // moves the points out, the builder takes them without a copy
+    std::vector<Geometry::TinPoint> takePoints() { return std::move(_points); }
+    // the points cut at the blank lines, those of fewer than two points left out
+    std::vector<std::vector<Geometry::TinPoint>> polylines() const;
+
+    size_t skippedLineCount() const { return _skippedLineCount; }
+    size_t byteCount() const { return _byteCount; }
+
+private:
+    std::vector<Geometry::TinPoint> _points;
+    // for every blank line, the number of points before it
+    std::vector<size_t> _breaks;
+    size_t _skippedLineCount = 0;
+    size_t _byteCount = 0;
+};
+
+}
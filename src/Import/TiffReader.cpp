@@ -0,0 +1,660 @@
+#include "TiffReader.h"
+#include <QByteArray>
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "Library/Concurrency/ThreadPool.h"
+
+namespace Import {
+
+namespace {
+
+enum Tag : uint16_t {
+    ImageWidth = 256,
+    ImageLength = 257,
+    BitsPerSample = 258,
+    Compression = 259,
+    Photometric = 262,
+    StripOffsets = 273,
+    SamplesPerPixel = 277,
+    RowsPerStrip = 278,
+    StripByteCounts = 279,
+    PlanarConfiguration = 284,
+    Predictor = 317,
+    ColorMap = 320,
+    TileWidth = 322,
+    TileLength = 323,
+    TileOffsets = 324,
+    TileByteCounts = 325,
+    ExtraSamples = 338,
+    SampleFormat = 339,
+    ModelPixelScale = 33550,
+    ModelTiepoint = 33922,
+    ModelTransformation = 34264,
+    GeoKeyDirectory = 34735,
+    GdalNoData = 42113,
+};
+
+enum GeoKey : uint16_t {
+    RasterType = 1025,
+    GeographicType = 2048,
+    ProjectedType = 3072,
+};
+
+constexpr uint16_t userDefined = 32767;
+constexpr uint16_t pixelIsPoint = 2;
+
+size_t typeSize(uint16_t type)
+{
+    switch (type) {
+    case 1: case 2: case 6: case 7:
+        return 1;
+    case 3: case 8:
+        return 2;
+    case 4: case 9: case 11:
+        return 4;
+    case 5: case 10: case 12: case 16: case 17: case 18:
+        return 8;
+    default:
+        return 0;
+    }
+}
+
+void unpackBits(const uint8_t* in, size_t size, uint8_t* out, size_t outSize)
+{
+    size_t i = 0;
+    size_t o = 0;
+    while (i < size && o < outSize) {
+        int n = (int8_t)in[i++];
+        if (n >= 0) {
+            size_t count = std::min({(size_t)n + 1, size - i, outSize - o});
+            std::memcpy(out + o, in + i, count);
+            i += (size_t)n + 1;
+            o += count;
+        } else if (n != -128 && i < size) {
+            size_t count = std::min((size_t)(1 - n), outSize - o);
+            std::memset(out + o, in[i++], count);
+            o += count;
+        }
+    }
+}
+
+// TIFF's LZW: codes read most significant bit first, the width growing one code early
+void unpackLzw(const uint8_t* in, size_t size, uint8_t* out, size_t outSize)
+{
+    constexpr uint32_t clearCode = 256;
+    constexpr uint32_t endCode = 257;
+    uint16_t prefix[4096];
+    uint8_t suffix[4096];
+    uint8_t first[4096];
+    uint16_t length[4096];
+    for (uint32_t i = 0; i < 256; ++i) {
+        suffix[i] = first[i] = (uint8_t)i;
+        length[i] = 1;
+    }
+
+    uint32_t nextCode = 258;
+    uint32_t width = 9;
+    uint64_t bits = 0;
+    uint32_t bitCount = 0;
+    size_t i = 0;
+    size_t o = 0;
+    int32_t previous = -1;
+
+    // the string of a code written backwards from its end, cut where the output ends
+    auto emit = [&](uint32_t code) {
+        size_t end = o + length[code];
+        for (size_t at = end; at > o; --at) {
+            if (at - 1 < outSize) {
+                out[at - 1] = suffix[code];
+            }
+            code = prefix[code];
+        }
+        o = end;
+    };
+
+    while (o < outSize) {
+        while (bitCount < width && i < size) {
+            bits = bits << 8 | in[i++];
+            bitCount += 8;
+        }
+        if (bitCount < width) {
+            break;
+        }
+        uint32_t code = (uint32_t)(bits >> (bitCount - width)) & ((1u << width) - 1);
+        bitCount -= width;
+        if (code == endCode) {
+            break;
+        }
+        if (code == clearCode) {
+            nextCode = 258;
+            width = 9;
+            previous = -1;
+            continue;
+        }
+        if (previous < 0) {
+            if (code >= 256) {
+                throw std::runtime_error("broken LZW data");
+            }
+            emit(code);
+            previous = (int32_t)code;
+            continue;
+        }
+        if (code > nextCode || (code == nextCode && nextCode >= 4096)) {
+            throw std::runtime_error("broken LZW data");
+        }
+        // the code about to be added stands for the previous string and the first byte of this
+        // one, the table stays full until the next clear code
+        if (nextCode < 4096) {
+            prefix[nextCode] = (uint16_t)previous;
+            suffix[nextCode] = code < nextCode ? first[code] : first[previous];
+            first[nextCode] = first[previous];
+            length[nextCode] = length[previous] + 1;
+            ++nextCode;
+        }
+        emit(code);
+        previous = (int32_t)code;
+        if (nextCode + 1 >= (1u << width) && width < 12) {
+            ++width;
+        }
+    }
+}
+
+void unpackDeflate(const uint8_t* in, size_t size, uint8_t* out, size_t outSize)
+{
+    // qUncompress takes zlib data behind the expected size, big endian
+    QByteArray data(4 + (qsizetype)size, Qt::Uninitialized);
+    uint32_t expected = (uint32_t)outSize;
+    for (int i = 0; i < 4; ++i) {
+        data[i] = (char)(expected >> (24 - 8 * i));
+    }
+    std::memcpy(data.data() + 4, in, size);
+    QByteArray unpacked = qUncompress(data);
+    if (unpacked.isEmpty() && outSize > 0) {
+        throw std::runtime_error("broken Deflate data");
+    }
+    std::memcpy(out, unpacked.constData(), std::min(outSize, (size_t)unpacked.size()));
+}
+
+}
+
+TiffReader::TiffReader(const std::string& fileName) :
+    _fileName(fileName)
+{
+    _file = ::open(fileName.c_str(), O_RDONLY | O_CLOEXEC);
+    if (_file < 0) {
+        throw std::runtime_error("can't open file " + fileName + strerror(errno));
+    }
+    try {
+        struct stat info;
+        if (fstat(_file, &info) != 0) {
+            throw std::runtime_error("can't read file " + fileName + strerror(errno));
+        }
+        _byteCount = (size_t)info.st_size;
+
+        uint8_t header[16] = {};
+        read(header, std::min<size_t>(sizeof(header), _byteCount), 0);
+        if (header[0] == 'M' && header[1] == 'M') {
+            _bigEndian = true;
+        } else if (header[0] != 'I' || header[1] != 'I') {
+            throw std::runtime_error(fileName + " isn't a TIFF file");
+        }
+        uint16_t version = get16(header + 2);
+        if (version == 43) {
+            _bigTiff = true;
+            readDirectory(get64(header + 8));
+        } else if (version == 42) {
+            readDirectory(get32(header + 4));
+        } else {
+            throw std::runtime_error(fileName + " isn't a TIFF file");
+        }
+
+        std::vector<uint64_t> width = integers(ImageWidth);
+        std::vector<uint64_t> height = integers(ImageLength);
+        if (width.empty() || height.empty() || width[0] == 0 || height[0] == 0 || width[0] > UINT32_MAX ||
+            height[0] > UINT32_MAX) {
+            throw std::runtime_error(fileName + " has no image size");
+        }
+        _width = (uint32_t)width[0];
+        _height = (uint32_t)height[0];
+
+        auto single = [this](uint16_t tag, uint64_t fallback) {
+            std::vector<uint64_t> values = integers(tag);
+            return values.empty() ? fallback : values[0];
+        };
+        _samples = (uint32_t)single(SamplesPerPixel, 1);
+        _photometric = (uint32_t)single(Photometric, 1);
+        _compression = (uint32_t)single(Compression, 1);
+        _predictor = (uint32_t)single(Predictor, 1);
+        for (uint64_t bits : integers(BitsPerSample)) {
+            if (bits != 8) {
+                throw std::runtime_error(fileName + ": only 8 bit samples are supported");
+            }
+        }
+        if (single(SampleFormat, 1) != 1) {
+            throw std::runtime_error(fileName + ": only unsigned integer samples are supported");
+        }
+        if (_samples > 1 && single(PlanarConfiguration, 1) != 1) {
+            throw std::runtime_error(fileName + ": separate planes aren't supported");
+        }
+        if (_compression != 1 && _compression != 5 && _compression != 8 && _compression != 32946 &&
+            _compression != 32773) {
+            throw std::runtime_error(fileName + ": compression " + std::to_string(_compression) + " isn't supported");
+        }
+        if (_predictor != 1 && _predictor != 2) {
+            throw std::runtime_error(fileName + ": predictor " + std::to_string(_predictor) + " isn't supported");
+        }
+
+        uint32_t colorSamples = 0;
+        if (_photometric == 0 || _photometric == 1 || _photometric == 3) {
+            colorSamples = 1;
+        } else if (_photometric == 2) {
+            colorSamples = 3;
+        } else {
+            throw std::runtime_error(fileName + ": photometric interpretation " + std::to_string(_photometric) +
+                                     " isn't supported");
+        }
+        if (_samples < colorSamples) {
+            throw std::runtime_error(fileName + " has fewer samples than its colors need");
+        }
+        std::vector<uint64_t> extra = integers(ExtraSamples);
+        _hasAlpha = _samples > colorSamples && !extra.empty() && (extra[0] == 1 || extra[0] == 2);
+
+        if (_photometric == 3) {
+            std::vector<uint64_t> map = integers(ColorMap);
+            if (map.size() < 3 * 256) {
+                throw std::runtime_error(fileName + " has no color map");
+            }
+            _palette.resize(256);
+            for (size_t i = 0; i < 256; ++i) {
+                _palette[i] = (uint32_t)(map[i] >> 8) | (uint32_t)(map[256 + i] >> 8) << 8 |
+                              (uint32_t)(map[512 + i] >> 8) << 16 | 0xFFu << 24;
+            }
+        }
+        std::string noData = ascii(GdalNoData);
+        if (!noData.empty()) {
+            try {
+                double value = std::stod(noData);
+                if (value >= 0.0 && value <= 255.0 && value == (int)value) {
+                    _noData = (int)value;
+                }
+            } catch (const std::exception&) {
+                // "nan" and the like, nothing of an 8 bit image matches it
+            }
+        }
+
+        _tiled = find(TileOffsets) != nullptr;
+        if (_tiled) {
+            _chunkWidth = (uint32_t)single(TileWidth, 0);
+            _chunkHeight = (uint32_t)single(TileLength, 0);
+            _chunkOffsets = integers(TileOffsets);
+            _chunkSizes = integers(TileByteCounts);
+        } else {
+            _chunkWidth = _width;
+            _chunkHeight = (uint32_t)std::min<uint64_t>(single(RowsPerStrip, _height), _height);
+            _chunkOffsets = integers(StripOffsets);
+            _chunkSizes = integers(StripByteCounts);
+        }
+        if (_chunkWidth == 0 || _chunkHeight == 0) {
+            throw std::runtime_error(fileName + " has no strip or tile size");
+        }
+        _chunksAcross = (_width + _chunkWidth - 1) / _chunkWidth;
+        size_t chunksDown = (_height + _chunkHeight - 1) / _chunkHeight;
+        if (_chunkOffsets.size() < _chunksAcross * chunksDown || _chunkSizes.size() < _chunkOffsets.size()) {
+            throw std::runtime_error(fileName + " has a broken strip or tile table");
+        }
+
+        readGeoreference(fileName);
+    } catch (...) {
+        ::close(_file);
+        throw;
+    }
+}
+
+TiffReader::~TiffReader()
+{
+    if (_file >= 0) {
+        ::close(_file);
+    }
+}
+
+void TiffReader::read(void* data, size_t size, uint64_t offset) const
+{
+    char* bytes = static_cast<char*>(data);
+    while (size > 0) {
+        ssize_t count = pread(_file, bytes, size, (off_t)offset);
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count <= 0) {
+            throw std::runtime_error("can't read file " + _fileName + (count < 0 ? strerror(errno) : " (truncated)"));
+        }
+        bytes += count;
+        size -= (size_t)count;
+        offset += (uint64_t)count;
+    }
+}
+
+uint16_t TiffReader::get16(const uint8_t* bytes) const
+{
+    return _bigEndian ? (uint16_t)(bytes[0] << 8 | bytes[1]) : (uint16_t)(bytes[1] << 8 | bytes[0]);
+}
+
+uint32_t TiffReader::get32(const uint8_t* bytes) const
+{
+    uint32_t value = 0;
+    for (int i = 0; i < 4; ++i) {
+        value |= (uint32_t)bytes[_bigEndian ? 3 - i : i] << (8 * i);
+    }
+    return value;
+}
+
+uint64_t TiffReader::get64(const uint8_t* bytes) const
+{
+    uint64_t value = 0;
+    for (int i = 0; i < 8; ++i) {
+        value |= (uint64_t)bytes[_bigEndian ? 7 - i : i] << (8 * i);
+    }
+    return value;
+}
+
+void TiffReader::readDirectory(uint64_t offset)
+{
+    size_t countSize = _bigTiff ? 8 : 2;
+    size_t entrySize = _bigTiff ? 20 : 12;
+    size_t fieldSize = _bigTiff ? 8 : 4;
+
+    uint8_t countBytes[8];
+    read(countBytes, countSize, offset);
+    uint64_t count = _bigTiff ? get64(countBytes) : get16(countBytes);
+    if (count == 0 || count > 65535) {
+        throw std::runtime_error(_fileName + " has a broken image directory");
+    }
+    std::vector<uint8_t> bytes(count * entrySize);
+    read(bytes.data(), bytes.size(), offset + countSize);
+
+    for (size_t i = 0; i < count; ++i) {
+        const uint8_t* raw = bytes.data() + i * entrySize;
+        Entry entry;
+        uint16_t tag = get16(raw);
+        entry.type = get16(raw + 2);
+        entry.count = _bigTiff ? get64(raw + 4) : get32(raw + 4);
+        const uint8_t* field = raw + (_bigTiff ? 12 : 8);
+        if (typeSize(entry.type) == 0) {
+            continue;
+        }
+        if (typeSize(entry.type) * entry.count <= fieldSize) {
+            entry.isInlined = true;
+            std::memcpy(entry.inlined, field, fieldSize);
+        } else {
+            entry.offset = _bigTiff ? get64(field) : get32(field);
+        }
+        _entries.emplace_back(tag, entry);
+    }
+}
+
+const TiffReader::Entry* TiffReader::find(uint16_t tag) const
+{
+    for (const auto& [key, entry] : _entries) {
+        if (key == tag) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+std::vector<uint8_t> TiffReader::valueBytes(const Entry& entry) const
+{
+    size_t size = typeSize(entry.type) * entry.count;
+    if (entry.isInlined) {
+        return std::vector<uint8_t>(entry.inlined, entry.inlined + size);
+    }
+    if (entry.count > _byteCount || entry.offset + size > _byteCount) {
+        throw std::runtime_error(_fileName + " has a tag past its end");
+    }
+    std::vector<uint8_t> bytes(size);
+    read(bytes.data(), size, entry.offset);
+    return bytes;
+}
+
+std::vector<uint64_t> TiffReader::integers(uint16_t tag) const
+{
+    const Entry* entry = find(tag);
+    if (!entry) {
+        return {};
+    }
+    std::vector<uint8_t> bytes = valueBytes(*entry);
+    size_t size = typeSize(entry->type);
+    std::vector<uint64_t> values(entry->count);
+    for (size_t i = 0; i < values.size(); ++i) {
+        const uint8_t* value = bytes.data() + i * size;
+        switch (entry->type) {
+        case 1: case 6: case 7:
+            values[i] = value[0];
+            break;
+        case 3: case 8:
+            values[i] = get16(value);
+            break;
+        case 4: case 9:
+            values[i] = get32(value);
+            break;
+        case 16: case 17: case 18:
+            values[i] = get64(value);
+            break;
+        default:
+            throw std::runtime_error(_fileName + ": tag " + std::to_string(tag) + " isn't an integer");
+        }
+    }
+    return values;
+}
+
+std::vector<double> TiffReader::doubles(uint16_t tag) const
+{
+    const Entry* entry = find(tag);
+    if (!entry) {
+        return {};
+    }
+    if (entry->type != 11 && entry->type != 12) {
+        std::vector<uint64_t> values = integers(tag);
+        return std::vector<double>(values.begin(), values.end());
+    }
+    std::vector<uint8_t> bytes = valueBytes(*entry);
+    std::vector<double> values(entry->count);
+    for (size_t i = 0; i < values.size(); ++i) {
+        values[i] = entry->type == 11 ? std::bit_cast<float>(get32(bytes.data() + 4 * i))
+                                      : std::bit_cast<double>(get64(bytes.data() + 8 * i));
+    }
+    return values;
+}
+
+std::string TiffReader::ascii(uint16_t tag) const
+{
+    const Entry* entry = find(tag);
+    if (!entry || entry->type != 2) {
+        return {};
+    }
+    std::vector<uint8_t> bytes = valueBytes(*entry);
+    std::string value(bytes.begin(), bytes.end());
+    return value.substr(0, value.find('\0'));
+}
+
+void TiffReader::readGeoreference(const std::string& fileName)
+{
+    std::vector<uint64_t> keys = integers(GeoKeyDirectory);
+    uint64_t rasterType = 1;
+    for (size_t i = 4; i + 3 < keys.size(); i += 4) {
+        // only keys stored in the directory itself, the codes are short values
+        if (keys[i + 1] != 0) {
+            continue;
+        }
+        if (keys[i] == RasterType) {
+            rasterType = keys[i + 3];
+        } else if (keys[i] == ProjectedType && keys[i + 3] != userDefined) {
+            _epsg = (int)keys[i + 3];
+        } else if (keys[i] == GeographicType && keys[i + 3] != userDefined && _epsg == 0) {
+            _epsg = (int)keys[i + 3];
+        }
+    }
+
+    std::vector<double> transformation = doubles(ModelTransformation);
+    std::vector<double> scale = doubles(ModelPixelScale);
+    std::vector<double> tiepoint = doubles(ModelTiepoint);
+    if (transformation.size() >= 16) {
+        _georeference = {transformation[3], transformation[0], transformation[1],
+                         transformation[7], transformation[4], transformation[5]};
+        _georeferenced = true;
+    } else if (scale.size() >= 2 && tiepoint.size() >= 6) {
+        _georeference = {tiepoint[3] - tiepoint[0] * scale[0], scale[0], 0.0,
+                         tiepoint[4] + tiepoint[1] * scale[1], 0.0, -scale[1]};
+        _georeferenced = true;
+    }
+    if (_georeferenced) {
+        if (rasterType == pixelIsPoint) {
+            // the coordinates are of the pixel centers
+            _georeference[0] -= 0.5 * (_georeference[1] + _georeference[2]);
+            _georeference[3] -= 0.5 * (_georeference[4] + _georeference[5]);
+        }
+        return;
+    }
+
+    // A, D, B, E, C, F of the world file, C and F at the center of the first pixel
+    std::filesystem::path path(fileName);
+    for (const char* extension : {".tfw", ".tifw", ".wld", ".TFW", ".TIFW", ".WLD"}) {
+        std::ifstream world(std::filesystem::path(path).replace_extension(extension));
+        double values[6];
+        if (!world || !(world >> values[0] >> values[1] >> values[2] >> values[3] >> values[4] >> values[5])) {
+            continue;
+        }
+        _georeference = {values[4] - 0.5 * (values[0] + values[2]), values[0], values[2],
+                         values[5] - 0.5 * (values[1] + values[3]), values[1], values[3]};
+        _georeferenced = true;
+        return;
+    }
+}
+
+void TiffReader::decodeChunk(size_t chunk, std::vector<uint8_t>& samples) const
+{
+    size_t rowBytes = (size_t)_chunkWidth * _samples;
+    samples.assign(rowBytes * _chunkHeight, 0);
+    uint64_t size = _chunkSizes[chunk];
+    if (size == 0) {
+        // sparse files leave chunks out, they read as zeros
+        return;
+    }
+    if (_chunkOffsets[chunk] + size > _byteCount) {
+        throw std::runtime_error(_fileName + " has a strip or tile past its end");
+    }
+    std::vector<uint8_t> packed(size);
+    read(packed.data(), size, _chunkOffsets[chunk]);
+    switch (_compression) {
+    case 1:
+        std::memcpy(samples.data(), packed.data(), std::min<size_t>(size, samples.size()));
+        break;
+    case 5:
+        unpackLzw(packed.data(), size, samples.data(), samples.size());
+        break;
+    case 8:
+    case 32946:
+        unpackDeflate(packed.data(), size, samples.data(), samples.size());
+        break;
+    case 32773:
+        unpackBits(packed.data(), size, samples.data(), samples.size());
+        break;
+    }
+    if (_predictor == 2) {
+        for (size_t row = 0; row < _chunkHeight; ++row) {
+            uint8_t* bytes = samples.data() + row * rowBytes;
+            for (size_t i = _samples; i < rowBytes; ++i) {
+                bytes[i] = (uint8_t)(bytes[i] + bytes[i - _samples]);
+            }
+        }
+    }
+}
+
+void TiffReader::toRgba(const uint8_t* samples, size_t count, uint8_t* rgba) const
+{
+    for (size_t i = 0; i < count; ++i, samples += _samples, rgba += 4) {
+        bool noData = false;
+        if (_photometric == 2) {
+            rgba[0] = samples[0];
+            rgba[1] = samples[1];
+            rgba[2] = samples[2];
+            rgba[3] = _hasAlpha ? samples[3] : 255;
+            noData = samples[0] == _noData && samples[1] == _noData && samples[2] == _noData;
+        } else if (_photometric == 3) {
+            std::memcpy(rgba, &_palette[samples[0]], 4);
+            noData = samples[0] == _noData;
+        } else {
+            uint8_t gray = _photometric == 0 ? (uint8_t)(255 - samples[0]) : samples[0];
+            rgba[0] = rgba[1] = rgba[2] = gray;
+            rgba[3] = _hasAlpha ? samples[1] : 255;
+            noData = samples[0] == _noData;
+        }
+        if (noData) {
+            rgba[3] = 0;
+        }
+    }
+}
+
+void TiffReader::readRows(uint32_t first, uint32_t count, uint8_t* rgba)
+{
+    if (count == 0 || first >= _height || count > _height - first) {
+        throw std::runtime_error(_fileName + ": rows past the end of the image");
+    }
+    Concurrency::ThreadPool& pool = Concurrency::ThreadPool::global();
+    size_t rowBytes = (size_t)_width * _samples;
+
+    if (!_tiled && _compression == 1) {
+        // uncompressed strips are read right where the rows are, however tall the strips are
+        std::vector<uint8_t> samples;
+        for (uint32_t row = first; row < first + count;) {
+            uint32_t strip = row / _chunkHeight;
+            uint32_t rows = std::min(first + count, (strip + 1) * _chunkHeight) - row;
+            uint64_t offset = (uint64_t)(row - strip * _chunkHeight) * rowBytes;
+            samples.assign(rows * rowBytes, 0);
+            if (offset < _chunkSizes[strip]) {
+                read(samples.data(), std::min<uint64_t>(samples.size(), _chunkSizes[strip] - offset),
+                     _chunkOffsets[strip] + offset);
+            }
+            uint8_t* target = rgba + (size_t)(row - first) * _width * 4;
+            pool.parallelFor(rows, [&](size_t i) {
+                toRgba(samples.data() + i * rowBytes, _width, target + i * _width * 4);
+            });
+            row += rows;
+        }
+        return;
+    }
+
+    for (uint32_t row = first; row < first + count;) {
+        uint32_t chunkRow = row / _chunkHeight;
+        if (chunkRow != _cachedChunkRow) {
+            _cached.resize(_chunksAcross);
+            _cachedChunkRow = UINT32_MAX;
+            pool.parallelFor(_chunksAcross, [&](size_t across) {
+                decodeChunk((size_t)chunkRow * _chunksAcross + across, _cached[across]);
+            });
+            _cachedChunkRow = chunkRow;
+        }
+        uint32_t rows = std::min(first + count, (chunkRow + 1) * _chunkHeight) - row;
+        uint32_t top = row - chunkRow * _chunkHeight;
+        pool.parallelFor(rows, [&](size_t i) {
+            uint8_t* target = rgba + (size_t)(row - first + i) * _width * 4;
+            for (uint32_t across = 0; across < _chunksAcross; ++across) {
+                uint32_t x = across * _chunkWidth;
+                const uint8_t* samples = _cached[across].data() + (top + i) * _chunkWidth * _samples;
+                toRgba(samples, std::min(_chunkWidth, _width - x), target + (size_t)x * 4);
+            }
+        });
+        row += rows;
+    }
+}
+
+}
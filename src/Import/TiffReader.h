@@ -0,0 +1,104 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Import {
+
+// Reads the first image of a TIFF or BigTIFF file band by band, so an orthophoto larger than
+// memory can be streamed, along with its GeoTIFF georeferencing. Strips and tiles, uncompressed,
+// PackBits, LZW and Deflate with or without the horizontal predictor; 8 bit gray, gray with
+// alpha, palette, RGB and RGBA in one plane. Other layouts (JPEG, separate planes, 16 bit) are
+// rejected when the file is opened. Throws std::runtime_error on broken files.
+class TiffReader {
+public:
+    // from the pixel grid, (0, 0) being the outer corner of the first pixel, to the image's
+    // coordinates: x = a[0] + a[1] * column + a[2] * row, y = a[3] + a[4] * column + a[5] * row
+    using Affine = std::array<double, 6>;
+
+    explicit TiffReader(const std::string& fileName);
+    ~TiffReader();
+
+    TiffReader(const TiffReader&) = delete;
+    TiffReader& operator=(const TiffReader&) = delete;
+
+    uint32_t width() const { return _width; }
+    uint32_t height() const { return _height; }
+    // the GeoTIFF tags, else a world file next to the image (.tfw, .tifw or .wld), else a unit
+    // per pixel with the rows going down like in the DXF import's flipped y
+    const Affine& georeference() const { return _georeference; }
+    bool georeferenced() const { return _georeferenced; }
+    // of the projected or geographic system in the GeoKeys, 0 when the file doesn't name one
+    int epsg() const { return _epsg; }
+    // of the file
+    size_t byteCount() const { return _byteCount; }
+
+    // rows [first, first + count) as RGBA, width() * 4 bytes per row. The chunks of a row of
+    // strips or tiles are decoded on the thread pool and kept until a band needs the next row.
+    void readRows(uint32_t first, uint32_t count, uint8_t* rgba);
+
+private:
+    struct Entry {
+        uint16_t type = 0;
+        uint64_t count = 0;
+        // of the values, or where they are when they don't fit into the entry
+        uint64_t offset = 0;
+        uint8_t inlined[8] = {};
+        bool isInlined = false;
+    };
+
+    void readDirectory(uint64_t offset);
+    const Entry* find(uint16_t tag) const;
+    std::vector<uint64_t> integers(uint16_t tag) const;
+    std::vector<double> doubles(uint16_t tag) const;
+    std::string ascii(uint16_t tag) const;
+    std::vector<uint8_t> valueBytes(const Entry& entry) const;
+    void readGeoreference(const std::string& fileName);
+
+    void read(void* data, size_t size, uint64_t offset) const;
+    uint16_t get16(const uint8_t* bytes) const;
+    uint32_t get32(const uint8_t* bytes) const;
+    uint64_t get64(const uint8_t* bytes) const;
+
+    // decompressed samples of a chunk, chunkWidth * chunkHeight * samples bytes
+    void decodeChunk(size_t chunk, std::vector<uint8_t>& samples) const;
+    void toRgba(const uint8_t* samples, size_t count, uint8_t* rgba) const;
+
+    std::string _fileName;
+    int _file = -1;
+    size_t _byteCount = 0;
+    bool _bigEndian = false;
+    bool _bigTiff = false;
+    std::vector<std::pair<uint16_t, Entry>> _entries;
+
+    uint32_t _width = 0;
+    uint32_t _height = 0;
+    uint32_t _samples = 1;
+    uint32_t _photometric = 1;
+    uint32_t _compression = 1;
+    uint32_t _predictor = 1;
+    bool _hasAlpha = false;
+    bool _tiled = false;
+    uint32_t _chunkWidth = 0;
+    uint32_t _chunkHeight = 0;
+    uint32_t _chunksAcross = 1;
+    std::vector<uint64_t> _chunkOffsets;
+    std::vector<uint64_t> _chunkSizes;
+    // palette as RGBA, for photometric 3
+    std::vector<uint32_t> _palette;
+    // GDAL's no data value, pixels of it are transparent; -1 when there is none
+    int _noData = -1;
+
+    Affine _georeference = {0.0, 1.0, 0.0, 0.0, 0.0, -1.0};
+    bool _georeferenced = false;
+    int _epsg = 0;
+
+    // the decoded chunks of one row of chunks
+    uint32_t _cachedChunkRow = UINT32_MAX;
+    std::vector<std::vector<uint8_t>> _cached;
+};
+
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <optional>
+#include <utility>
+
+namespace Concurrency {
+
+// Bounded lock-free ring for exactly one producer thread and one consumer thread.
+// Neither side ever blocks, tryPush() fails when the ring is full. Each side keeps a
+// cached copy of the other side's index so the shared cache lines are only touched
+// when the cached one says the ring looks full (or empty).
+template<typename T, size_t Capacity>
+class SpscQueue {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "capacity must be a power of two");
+
+public:
+    SpscQueue() = default;
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // producer thread, value is only moved from when it was queued
+    bool tryPush(T&& value)
+    {
+        size_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail - _cachedHead == Capacity) {
+            _cachedHead = _head.load(std::memory_order_acquire);
+            if (tail - _cachedHead == Capacity) {
+                return false;
+            }
+        }
+        _slots[tail & (Capacity - 1)] = std::move(value);
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // consumer thread
+    std::optional<T> tryPop()
+    {
+        size_t head = _head.load(std::memory_order_relaxed);
+        if (head == _cachedTail) {
+            _cachedTail = _tail.load(std::memory_order_acquire);
+            if (head == _cachedTail) {
+                return std::nullopt;
+            }
+        }
+        std::optional<T> value(std::move(_slots[head & (Capacity - 1)]));
+        _slots[head & (Capacity - 1)] = T();
+        _head.store(head + 1, std::memory_order_release);
+        return value;
+    }
+
+    // consumer thread, hands everything pushed so far to f in order and returns how many there were;
+    // commands pushed while draining are left for the next call
+    template<typename F>
+    size_t drain(F&& f)
+    {
+        size_t head = _head.load(std::memory_order_relaxed);
+        _cachedTail = _tail.load(std::memory_order_acquire);
+        size_t count = _cachedTail - head;
+        for (; head != _cachedTail; ++head) {
+            T& slot = _slots[head & (Capacity - 1)];
+            f(std::move(slot));
+            // don't keep whatever the value owns alive until the slot is reused
+            slot = T();
+        }
+        _head.store(head, std::memory_order_release);
+        return count;
+    }
+
+    // either thread, only a hint while the other side is running
+    size_t sizeApprox() const
+    {
+        return _tail.load(std::memory_order_acquire) - _head.load(std::memory_order_acquire);
+    }
+
+    static constexpr size_t capacity() { return Capacity; }
+
+private:
+    static constexpr size_t cacheLine = 64;
+
+    // written by the consumer
+    alignas(cacheLine) std::atomic<size_t> _head{0};
+    size_t _cachedTail = 0;
+    // written by the producer
+    alignas(cacheLine) std::atomic<size_t> _tail{0};
+    size_t _cachedHead = 0;
+
+    alignas(cacheLine) std::array<T, Capacity> _slots{};
+};
+
+} // namespace Concurrency
@@ -0,0 +1,135 @@
+#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+
+namespace Concurrency {
+
+namespace {
+
+struct ParallelForState {
+    ParallelForState(size_t count, const std::function<void(size_t)>& task) :
+        count(count),
+        task(task)
+    {}
+
+    void run()
+    {
+        for (size_t i = next.fetch_add(1); i < count; i = next.fetch_add(1)) {
+            try {
+                task(i);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+            }
+            if (done.fetch_add(1) + 1 == count) {
+                std::lock_guard<std::mutex> lock(mutex);
+                finished.notify_all();
+            }
+        }
+    }
+
+    const size_t count;
+    const std::function<void(size_t)>& task;
+    std::atomic<size_t> next = 0;
+    std::atomic<size_t> done = 0;
+    std::mutex mutex;
+    std::condition_variable finished;
+    std::exception_ptr error;
+};
+
+}
+
+ThreadPool::ThreadPool(size_t threadCount)
+{
+    threadCount = std::max<size_t>(threadCount, 1);
+    _workers.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; ++i) {
+        _workers.emplace_back([this] { workerLoop(); });
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stopping = true;
+    }
+    _condition.notify_all();
+    for (auto& worker : _workers) {
+        worker.join();
+    }
+}
+
+size_t ThreadPool::threadCount() const
+{
+    return _workers.size();
+}
+
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t index)>& task)
+{
+    if (count == 0) {
+        return;
+    }
+
+    // helpers which start after every index is taken return immediately, so the caller
+    // never waits for queued helpers and nested calls from a worker can't deadlock
+    auto state = std::make_shared<ParallelForState>(count, task);
+    size_t helpers = std::min(count - 1, _workers.size());
+    for (size_t i = 0; i < helpers; ++i) {
+        enqueue([state] { state->run(); });
+    }
+
+    state->run();
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->finished.wait(lock, [&state] { return state->done.load() == state->count; });
+    if (state->error) {
+        std::rethrow_exception(state->error);
+    }
+}
+
+std::future<void> ThreadPool::submit(std::function<void()> task)
+{
+    auto packaged = std::make_shared<std::packaged_task<void()>>(std::move(task));
+    std::future<void> result = packaged->get_future();
+    enqueue([packaged] { (*packaged)(); });
+    return result;
+}
+
+ThreadPool& ThreadPool::global()
+{
+    static ThreadPool pool;
+    return pool;
+}
+
+void ThreadPool::enqueue(std::function<void()> task)
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _tasks.push_back(std::move(task));
+    }
+    _condition.notify_one();
+}
+
+void ThreadPool::workerLoop()
+{
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _condition.wait(lock, [this] { return _stopping || !_tasks.empty(); });
+            if (_stopping && _tasks.empty()) {
+                return;
+            }
+            task = std::move(_tasks.front());
+            _tasks.pop_front();
+        }
+        task();
+    }
+}
+
+} // namespace Concurrency
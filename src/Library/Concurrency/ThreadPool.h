@@ -0,0 +1,43 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Concurrency {
+
+class ThreadPool {
+public:
+    ThreadPool(size_t threadCount = std::thread::hardware_concurrency());
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t threadCount() const;
+
+    // runs task(i) for every i in [0, count) on the workers and the calling thread,
+    // returns when all of them finished and rethrows the first exception
+    void parallelFor(size_t count, const std::function<void(size_t index)>& task);
+
+    std::future<void> submit(std::function<void()> task);
+
+    static ThreadPool& global();
+
+private:
+    void enqueue(std::function<void()> task);
+    void workerLoop();
+
+    std::vector<std::thread> _workers;
+    std::deque<std::function<void()>> _tasks;
+    std::mutex _mutex;
+    std::condition_variable _condition;
+    bool _stopping = false;
+};
+
+} // namespace Concurrency
@@ -2,68 +2,113 @@
 #include <cstddef>
 #include <cstdint>
 #include <cstdio>
+#include <cstring>
+#include <fcntl.h>
 #include <stdexcept>
 #include <errno.h>
 #include <string.h>
+#include <sys/mman.h>
 #include <vector>
 
 namespace Files {
 
-FileStream::FileStream(const std::string& fileName) :
-    _fileName(fileName)
-{
-    _fileStream = fopen(_fileName.c_str(), "rb");
-    if (!_fileStream) {
-        throw std::runtime_error("can't open file " + fileName + strerror(errno));
-    }
+namespace {
+
+constexpr size_t streamBufferSize = 4 << 20;
 
-    fseek(_fileStream, 0, SEEK_END);
-    _size = ftell(_fileStream);
-    fseek(_fileStream, 0, SEEK_SET);
 }
 
-FileStream::FileStream(std::string&& fileName) :
+FileStream::FileStream(const std::string& fileName, Mode mode) :
     _fileName(fileName)
 {
-    _fileStream = fopen(_fileName.c_str(), "rb");
-    if (!_fileStream) {
-        throw std::runtime_error("can't open file " + fileName + strerror(errno));
-    }
+    open(mode);
+}
 
-    fseek(_fileStream, 0, SEEK_END);
-    _size = ftell(_fileStream);
-    fseek(_fileStream, 0, SEEK_SET);
+FileStream::FileStream(std::string&& fileName, Mode mode) :
+    _fileName(std::move(fileName))
+{
+    open(mode);
 }
 
-FileStream::FileStream(const char* fileName) :
+FileStream::FileStream(const char* fileName, Mode mode) :
     _fileName(fileName)
+{
+    open(mode);
+}
+
+void FileStream::open(Mode mode)
 {
     _fileStream = fopen(_fileName.c_str(), "rb");
     if (!_fileStream) {
-        throw std::runtime_error("can't open file " + _fileName + strerror(errno));
+        throw std::runtime_error("can't open file " + _fileName + ": " + strerror(errno));
+    }
+    // the buffer has to be set before any other operation on the stream
+    if (mode == Mode::Streaming) {
+        _streamBuffer.resize(streamBufferSize);
+        setvbuf(_fileStream, _streamBuffer.data(), _IOFBF, _streamBuffer.size());
     }
 
     fseek(_fileStream, 0, SEEK_END);
     _size = ftell(_fileStream);
     fseek(_fileStream, 0, SEEK_SET);
+
+    switch (mode) {
+        case Mode::Buffered:
+            break;
+        case Mode::Mapped:
+            if (_size != 0) {
+                _mapping = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fileno(_fileStream), 0);
+                if (_mapping == MAP_FAILED) {
+                    _mapping = nullptr;
+                    fclose(_fileStream);
+                    throw std::runtime_error("can't map file " + _fileName + ": " + strerror(errno));
+                }
+                madvise(_mapping, _size, MADV_WILLNEED);
+                madvise(_mapping, _size, MADV_SEQUENTIAL);
+            }
+            break;
+        case Mode::Streaming:
+            posix_fadvise(fileno(_fileStream), 0, 0, POSIX_FADV_SEQUENTIAL);
+            break;
+    }
 }
 
 FileStream::~FileStream()
 {
+    if (_mapping) {
+        munmap(_mapping, _size);
+    }
     if (_fileStream) {
         fclose(_fileStream);
     }
 }
 
+size_t FileStream::read(void* data, size_t size)
+{
+    size_t count = fread(data, 1, size, _fileStream);
+    if (count < size && ferror(_fileStream)) {
+        throw std::runtime_error("can't read file " + _fileName + ": " + strerror(errno));
+    }
+    return count;
+}
+
 std::vector<uint32_t> FileStream::readBinary() const
 {
     if (_size == 0) {
         return {};
     }
 
-    std::vector<uint32_t> v(_size);
+    std::vector<uint32_t> v((_size + sizeof(uint32_t) - 1) / sizeof(uint32_t));
+
+    if (_mapping) {
+        memcpy(v.data(), _mapping, _size);
+        return v;
+    }
 
-    fread(v.data(), 1, _size, _fileStream);
+    fseek(_fileStream, 0, SEEK_SET);
+    if (fread(v.data(), 1, _size, _fileStream) != _size) {
+        throw std::runtime_error("can't read file " + _fileName + ": " + strerror(errno));
+    }
     return v;
 }
 
@@ -77,4 +122,4 @@ size_t FileStream::getSize() const
     return _size;
 }
 
-}
\ No newline at end of file
+}
@@ -1,8 +1,10 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdio>
 #include <filesystem>
 #include <optional>
+#include <span>
 #include <string>
 #include <vector>
 
@@ -12,21 +14,48 @@ namespace Files {
 
 class FileStream {
 public:
-    FileStream(const std::string& fileName);
-    FileStream(std::string&& fileName);
-    FileStream(const char* fileName);
+    enum class Mode {
+        Buffered,
+        // whole file mapped read-only, read through span()
+        Mapped,
+        // large stdio buffer and sequential read-ahead, read through read()
+        Streaming,
+    };
+
+    FileStream(const std::string& fileName, Mode mode = Mode::Buffered);
+    FileStream(std::string&& fileName, Mode mode = Mode::Buffered);
+    FileStream(const char* fileName, Mode mode = Mode::Buffered);
 
     ~FileStream();
 
+    FileStream(const FileStream&) = delete;
+    FileStream& operator=(const FileStream&) = delete;
+
     size_t getSize() const;
     Vulkan::SpirvByteCode getSpirvByteCode() const;
 
+    // valid while the stream lives, only in Mapped mode
+    template<typename T>
+    std::span<const T> span() const
+    {
+        return std::span<const T>(static_cast<const T*>(_mapping), _mapping ? _size / sizeof(T) : 0);
+    }
+
+    // next bytes of the file, returns how many were read (0 at the end)
+    size_t read(void* data, size_t size);
+
 protected:
     std::vector<uint32_t> readBinary() const;
 
     size_t _size;
     std::string _fileName;
     FILE* _fileStream;
+
+private:
+    void open(Mode mode);
+
+    void* _mapping = nullptr;
+    std::vector<char> _streamBuffer;
 };
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,95 @@
+#include "OutputStream.h"
+#include <cstring>
+#include <errno.h>
+#include <stdexcept>
+#include <string.h>
+
+namespace Files {
+
+OutputStream::OutputStream(const std::string& fileName, size_t bufferSize) :
+    _fileName(fileName),
+    _buffer(bufferSize)
+{
+    _fileStream = fopen(_fileName.c_str(), "wb");
+    if (!_fileStream) {
+        throw std::runtime_error("can't open file " + _fileName + ": " + strerror(errno));
+    }
+    setvbuf(_fileStream, nullptr, _IONBF, 0);
+}
+
+OutputStream::~OutputStream()
+{
+    if (_fileStream) {
+        if (_used != 0) {
+            fwrite(_buffer.data(), 1, _used, _fileStream);
+        }
+        fclose(_fileStream);
+    }
+}
+
+void OutputStream::write(const char* data, size_t size)
+{
+    _position += size;
+    if (_used + size <= _buffer.size()) {
+        memcpy(_buffer.data() + _used, data, size);
+        _used += size;
+        return;
+    }
+
+    flush();
+    if (size >= _buffer.size()) {
+        writeThrough(data, size);
+    } else {
+        memcpy(_buffer.data(), data, size);
+        _used = size;
+    }
+}
+
+void OutputStream::write(std::string_view text)
+{
+    write(text.data(), text.size());
+}
+
+void OutputStream::flush()
+{
+    if (_used != 0) {
+        writeThrough(_buffer.data(), _used);
+        _used = 0;
+    }
+}
+
+void OutputStream::close()
+{
+    if (!_fileStream) {
+        return;
+    }
+    try {
+        flush();
+    } catch (...) {
+        fclose(_fileStream);
+        _fileStream = nullptr;
+        throw;
+    }
+    int result = fclose(_fileStream);
+    _fileStream = nullptr;
+    if (result != 0) {
+        throw std::runtime_error("can't close file " + _fileName + ": " + strerror(errno));
+    }
+}
+
+size_t OutputStream::position() const
+{
+    return _position;
+}
+
+void OutputStream::writeThrough(const char* data, size_t size)
+{
+    if (!_fileStream) {
+        throw std::runtime_error("can't write file " + _fileName + ": it is closed");
+    }
+    if (fwrite(data, 1, size, _fileStream) != size) {
+        throw std::runtime_error("can't write file " + _fileName + ": " + strerror(errno));
+    }
+}
+
+}
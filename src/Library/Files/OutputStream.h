@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Files {
+
+class OutputStream {
+public:
+    OutputStream(const std::string& fileName, size_t bufferSize = 1 << 20);
+    // closes the file if close() wasn't called, errors are lost then
+    ~OutputStream();
+
+    OutputStream(const OutputStream&) = delete;
+    OutputStream& operator=(const OutputStream&) = delete;
+
+    void write(const char* data, size_t size);
+    void write(std::string_view text);
+    void flush();
+    // writes what is buffered and closes the file, throws when either fails (a full disk); the
+    // stream takes no more writes after it
+    void close();
+
+    // bytes written so far, including the ones still in the buffer
+    size_t position() const;
+
+private:
+    void writeThrough(const char* data, size_t size);
+
+    std::string _fileName;
+    FILE* _fileStream;
+    std::vector<char> _buffer;
+    size_t _used = 0;
+    size_t _position = 0;
+};
+
+}
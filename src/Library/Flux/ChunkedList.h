@@ -0,0 +1,228 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace Flux {
+
+// summary policy of lists that don't need one
+struct NoSummary {
+    template<typename T>
+    void expand(const T&) {}
+};
+
+// Persistent sequence stored in fixed-size chunks. Copying a list copies only the chunk
+// handles, the elements stay shared: appends write behind the end every copy can see, so they
+// copy only when the storage of the last chunk grows, an in-place update clones its chunk only
+// when another copy still holds it.
+// That makes a copy an immutable snapshot other threads can read while this list keeps changing.
+//
+// Every chunk keeps a Summary (anything with expand(const T&), e.g. Geometry::BoundingBox),
+// a version and a short log of its in-place updates, so consumers can skip chunks by region and
+// re-process only what changed since the version they saw.
+template<typename T, typename Summary = NoSummary, size_t ChunkSize = 65536>
+class ChunkedList
+{
+    static_assert(std::has_single_bit(ChunkSize), "chunk size has to be a power of two");
+
+    struct Storage {
+        explicit Storage(size_t capacity) : items(capacity) {}
+
+        std::vector<T> items;
+        // slots handed out to appenders, lists sharing the storage each see a prefix of it
+        std::atomic<size_t> filled = 0;
+    };
+
+public:
+    static constexpr size_t chunkSize = ChunkSize;
+    static constexpr size_t editLogSize = 16;
+    // storage of a new chunk, doubled whenever the chunk fills it up to chunkSize, so a short
+    // list doesn't hold a whole chunk
+    static constexpr size_t firstCapacity = std::min<size_t>(256, ChunkSize);
+
+    class Chunk {
+    public:
+        const T* data() const { return _storage->items.data(); }
+        size_t size() const { return _size; }
+        const T& operator[](size_t index) const { return _storage->items[index]; }
+        const T* begin() const { return data(); }
+        const T* end() const { return data() + _size; }
+        // elements the storage has room for
+        size_t capacity() const { return _storage->items.size(); }
+
+        // Calls function(begin, end) for the ranges updated in place after `version`. Returns
+        // false when the log doesn't reach back that far (or the chunk is younger), then the
+        // whole chunk has to be treated as changed. Appends aren't reported, they lie behind
+        // the size the caller saw at `version`.
+        template<typename Function>
+        bool changesSince(uint64_t version, Function&& function) const
+        {
+            if (version < _completeSince) {
+                return false;
+            }
+            for (size_t i = 0; i < _editCount; ++i) {
+                if (_edits[i].version > version) {
+                    function(_edits[i].begin, _edits[i].end);
+                }
+            }
+            return true;
+        }
+
+        Summary summary;
+        // taken from a list-wide counter on every change, so a chunk rebuilt after clear()
+        // never repeats a version of the chunk it replaced
+        uint64_t version = 0;
+
+    private:
+        friend class ChunkedList;
+
+        struct Edit {
+            uint64_t version;
+            uint32_t begin;
+            uint32_t end;
+        };
+
+        std::shared_ptr<Storage> _storage;
+        size_t _size = 0;
+        std::array<Edit, editLogSize> _edits;
+        size_t _editCount = 0;
+        // the log holds every update newer than this version
+        uint64_t _completeSince = 0;
+    };
+
+    const T& at(size_t index) const
+    {
+        return _chunks[index / ChunkSize][index % ChunkSize];
+    }
+
+    const T& operator[](size_t index) const
+    {
+        return at(index);
+    }
+
+    size_t size() const
+    {
+        return _size;
+    }
+
+    bool empty() const
+    {
+        return _size == 0;
+    }
+
+    size_t chunkCount() const
+    {
+        return _chunks.size();
+    }
+
+    // version of the latest change, a copy taken later never has a smaller one
+    uint64_t version() const
+    {
+        return _version;
+    }
+
+    // version of the last clear(), 0 when there was none; consumers following the appends have
+    // to start over when it changed
+    uint64_t clearedVersion() const
+    {
+        return _clearedVersion;
+    }
+
+    const Chunk& chunk(size_t index) const
+    {
+        return _chunks[index];
+    }
+
+    void push_back(const T& value)
+    {
+        if (_size % ChunkSize == 0) {
+            Chunk chunk;
+            chunk._storage = std::make_shared<Storage>(firstCapacity);
+            _chunks.push_back(std::move(chunk));
+        }
+        Chunk& last = _chunks.back();
+
+        // a full storage moves into one twice the size, copies keep reading the old one; so does
+        // an append when another copy already appended behind our end, into a private clone
+        size_t expected = last._size;
+        if (last._size == last.capacity()) {
+            detach(last, last._size * 2);
+            last._storage->filled = last._size + 1;
+        } else if (!last._storage->filled.compare_exchange_strong(expected, last._size + 1)) {
+            detach(last, last.capacity());
+            last._storage->filled = last._size + 1;
+        }
+
+        last._storage->items[last._size] = value;
+        ++last._size;
+        last.summary.expand(value);
+        last.version = ++_version;
+        if (last._size == 1) {
+            last._completeSince = last.version;
+        }
+        ++_size;
+    }
+
+    // rebuilds the chunk summary, so it stays exact when an element shrinks it
+    void update(size_t index, const T& value)
+    {
+        Chunk& chunk = _chunks[index / ChunkSize];
+        size_t offset = index % ChunkSize;
+        if (chunk._storage.use_count() > 1) {
+            detach(chunk, chunk.capacity());
+            chunk._storage->filled = chunk._size;
+        }
+        chunk._storage->items[offset] = value;
+
+        chunk.summary = Summary();
+        for (const T& item : chunk) {
+            chunk.summary.expand(item);
+        }
+        chunk.version = ++_version;
+
+        if (chunk._editCount == editLogSize) {
+            chunk._completeSince = chunk._edits[0].version;
+            std::move(chunk._edits.begin() + 1, chunk._edits.end(), chunk._edits.begin());
+            --chunk._editCount;
+        }
+        chunk._edits[chunk._editCount++] = {chunk.version, (uint32_t)offset, (uint32_t)offset + 1};
+    }
+
+    void clear()
+    {
+        _chunks.clear();
+        _size = 0;
+        _clearedVersion = ++_version;
+    }
+
+    template<typename Function>
+    void forEach(Function&& function) const
+    {
+        for (const Chunk& chunk : _chunks) {
+            for (const T& item : chunk) {
+                function(item);
+            }
+        }
+    }
+
+private:
+    static void detach(Chunk& chunk, size_t capacity)
+    {
+        auto storage = std::make_shared<Storage>(capacity);
+        std::copy(chunk.begin(), chunk.end(), storage->items.begin());
+        chunk._storage = std::move(storage);
+    }
+
+    std::vector<Chunk> _chunks;
+    size_t _size = 0;
+    uint64_t _version = 0;
+    uint64_t _clearedVersion = 0;
+};
+
+} // namespace Flux
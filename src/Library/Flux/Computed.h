@@ -0,0 +1,163 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "MutableList.h"
+#include "Signal.h"
+
+namespace Flux {
+
+// A value derived from Mutables, MutableLists and other Computeds. It is computed on the first
+// read and memoized until an input changes; reading it again costs nothing until then. Lists
+// registered with extendsWith() are followed incrementally: elements appended since the last
+// read are folded into the memoized value, only updates of elements it already saw (a set()
+// of the list, or a list that shrank) compute it from scratch. Copies share the value, everything happens on the
+// thread owning the inputs.
+template<typename T>
+class Computed
+{
+public:
+    explicit Computed(std::function<T()> compute) : _state(std::make_shared<State>())
+    {
+        _state->compute = std::move(compute);
+    }
+    Computed(const Computed&) = default;
+    Computed& operator=(const Computed&) = default;
+
+    // the fold of every element of the list into initial, fold(T&, const E&)
+    template<typename E, typename S, typename Fold>
+    static Computed fold(const MutableList<E, S>& list, T initial, Fold fold)
+    {
+        MutableList<E, S> source = list;
+        Computed computed([source, initial, fold]() {
+            T value = initial;
+            source.value().forEach([&value, &fold](const E& element) { fold(value, element); });
+            return value;
+        });
+        computed.extendsWith(list, [source, fold](T& value, size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                fold(value, source.at(i));
+            }
+        });
+        return computed;
+    }
+
+    // any change of the source (anything with subscribe()) computes the value from scratch
+    template<typename Source>
+    Computed& dependsOn(Source& source)
+    {
+        State* state = _state.get();
+        _state->subscriptions.push_back(source.subscribe([state](auto&&...) { state->invalidate(); }));
+        return *this;
+    }
+
+    // extend(value, begin, end) brings the value up to date with the elements [begin, end)
+    // appended to the list; without extend, appends don't change the value at all
+    template<typename E, typename S>
+    Computed& extendsWith(const MutableList<E, S>& list, std::function<void(T&, size_t, size_t)> extend = nullptr)
+    {
+        // copies share the observers, subscribing to one follows the list
+        MutableList<E, S> source = list;
+        State* state = _state.get();
+        size_t input = _state->inputs.size();
+        _state->inputs.push_back(Input{[source]() { return source.size(); }, std::move(extend), list.size()});
+        _state->subscriptions.push_back(source.subscribe([state, input](size_t begin, size_t) {
+            state->changed(input, begin);
+        }));
+        return *this;
+    }
+
+    const T& value() const
+    {
+        State& state = *_state;
+        if (state.value && state.stale) {
+            for (Input& input : state.inputs) {
+                size_t size = input.size();
+                if (size < input.seen) {
+                    state.value.reset();
+                    break;
+                }
+                if (input.extend && size > input.seen) {
+                    input.extend(*state.value, input.seen, size);
+                }
+                input.seen = size;
+            }
+        }
+        if (!state.value) {
+            state.value = state.compute();
+            for (Input& input : state.inputs) {
+                input.seen = input.size();
+            }
+        }
+        state.stale = false;
+        return *state.value;
+    }
+
+    // the next read computes the value from scratch
+    void invalidate()
+    {
+        _state->invalidate();
+    }
+
+    // called when the memoized value stops being current, once until it is read again
+    [[nodiscard]] Subscription subscribe(std::function<void()> observer)
+    {
+        return _state->outdated.subscribe(std::move(observer));
+    }
+
+private:
+    struct Input
+    {
+        std::function<size_t()> size;
+        std::function<void(T&, size_t, size_t)> extend;
+        // size of the list the value includes
+        size_t seen;
+    };
+
+    struct State
+    {
+        void invalidate()
+        {
+            bool current = value && !stale;
+            value.reset();
+            if (current) {
+                outdated.notify();
+            }
+        }
+
+        // elements from begin on were added or updated; a set() notifies from 0 whatever the
+        // sizes, so a list replaced by a shorter one is computed again
+        void changed(size_t input, size_t begin)
+        {
+            if (!value) {
+                return;
+            }
+            if (begin < inputs[input].seen) {
+                invalidate();
+                return;
+            }
+            if (!stale) {
+                stale = true;
+                outdated.notify();
+            }
+        }
+
+        std::function<T()> compute;
+        std::optional<T> value;
+        // elements were appended to extendsWith() lists since the value was brought up to date
+        bool stale = false;
+        std::vector<Input> inputs;
+        Signal<> outdated;
+        // last, so the slots pointing at the state are gone before the rest of it
+        std::vector<Subscription> subscriptions;
+    };
+
+    std::shared_ptr<State> _state;
+};
+
+} // namespace Flux
@@ -1,25 +1,25 @@
 #pragma once
 
 #include <memory>
-#include <vector>
 #include <functional>
 
+#include "Signal.h"
+
 namespace Flux {
 
+// Copies share the value and the observers.
 template<typename T>
 class Mutable
 {
 public:
-    Mutable()
-    : _v(std::make_shared<T>()),
-      _observers((std::make_shared<std::vector<std::function<void(const T &)>>>()))
-    {}
+    Mutable() : _v(std::make_shared<T>()) {}
 
     Mutable(const T &value) : _v(std::make_shared<T>(value)) {}
-    Mutable(const Mutable<T> &other) : _v(other._v) {}
+    Mutable(const Mutable<T> &other) : _v(other._v), _changed(other._changed) {}
     Mutable<T> &operator=(const Mutable<T> &other) {
         if (this != &other) {
         _v = other._v;
+        _changed = other._changed;
         }
         return *this;
     }
@@ -34,17 +34,21 @@ public:
 
     void set(const T& value) {
         *_v = value;
-        for (const auto& observer : _observers) {
-            observer(*_v);
-        }
+        _changed.notify(*_v);
+    }
+
+    // the observer is called until the subscription is dropped
+    [[nodiscard]] Subscription subscribe(std::function<void(const T&)> observer) {
+        return _changed.subscribe(std::move(observer));
     }
 
-    void subscribe(std::function<void(const T&)> observer) {
-        _observers.push_back(observer);
+    // the observer is called once in the dispatcher's next flush, however often the value changed
+    [[nodiscard]] Subscription subscribe(DeferredDispatcher& dispatcher, std::function<void()> observer) {
+        return _changed.subscribe(dispatcher, std::move(observer));
     }
 private:
     std::shared_ptr<T> _v;
-    std::shared_ptr<std::vector<std::function<void(const T&)>>> _observers;
+    Signal<const T&> _changed;
 };
 
-} // namespace Flux
\ No newline at end of file
+} // namespace Flux
@@ -1,80 +1,135 @@
 #pragma once
 
+#include <atomic>
 #include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <QVector>
 #include <qcontainerfwd.h>
 #include <vector>
 
+#include "ChunkedList.h"
+#include "Signal.h"
+
 namespace Flux {
 
-template<typename T>
+// Mutated and read through value() on the thread owning it (the GUI thread). Every mutation
+// publishes an immutable snapshot of the list, snapshot() is taken on that thread too and stays
+// consistent on any thread it's handed to, however the list changes afterwards; it shares all
+// unmodified chunks.
+template<typename T, typename Summary = NoSummary>
 class MutableList
 {
 public:
+    using Storage = ChunkedList<T, Summary>;
+    using Snapshot = std::shared_ptr<const Storage>;
+
     MutableList()
-        : _list(std::make_shared<QVector<T>>()),
-          _observers(std::make_shared<std::vector<std::function<void(const T &, size_t)>>>())
-    {}
+        : _id(nextId()),
+          _list(std::make_shared<Storage>()),
+          _published(std::make_shared<std::atomic<Snapshot>>())
+    {
+        publish();
+    }
 
     MutableList(const QVector<T> &list)
-        : _list(std::make_shared<QVector<T>>(list)),
-          _observers(std::make_shared<std::vector<std::function<void(const T &, size_t)>>>()) 
-    {}
+        : _id(nextId()),
+          _list(std::make_shared<Storage>()),
+          _published(std::make_shared<std::atomic<Snapshot>>())
+    {
+        for (const T& value : list) {
+            _list->push_back(value);
+        }
+        publish();
+    }
 
-    MutableList(const MutableList<T> &other)
-        : _list(other._list), _observers(other._observers)
+    MutableList(const MutableList &other)
+        : _id(other._id), _list(other._list), _published(other._published), _changed(other._changed)
     {}
 
-    MutableList<T> &operator=(const MutableList<T> &other) {
+    MutableList &operator=(const MutableList &other) {
         if (this != &other) {
+        _id = other._id;
         _list = other._list;
-        _observers = other._observers;
+        _published = other._published;
+        _changed = other._changed;
         }
         return *this;
     }
 
+    // the same for every copy of this list and never reused by another one
+    uint64_t id() const {
+        return _id;
+    }
+
+    Snapshot snapshot() const {
+        return _published->load(std::memory_order_acquire);
+    }
+
     QVector<T> get() const {
-        return *_list;
+        QVector<T> values;
+        values.reserve(_list->size());
+        _list->forEach([&values](const T& value) {
+            values.append(value);
+        });
+        return values;
     }
 
-    const QVector<T>& value() const {
+    const Storage& value() const {
         return *_list;
     }
 
     const T& at(size_t index) const {
-        return (*_list)[index];
+        return _list->at(index);
     }
 
     void add(const T& value) {
-        _list->append(value);
-        size_t index = _list->size() - 1;
-        for (const auto& observer : *_observers) {
-            observer(value, index);
+        _list->push_back(value);
+        publish();
+        _changed.notify(_list->size() - 1, _list->size());
+    }
+
+    void append(const QVector<T>& values) {
+        size_t first = _list->size();
+        for (const T& value : values) {
+            _list->push_back(value);
         }
+        publish();
+        _changed.notify(first, _list->size());
     }
 
     void update(size_t index, const T& value) {
         if (index < _list->size()) {
-            (*_list)[index] = value;
-            for (const auto& observer : *_observers) {
-                observer(value, index);
-            }
+            // an unread publication isn't a reader, dropping it first lets the update write into
+            // the chunk in place unless a snapshot taken earlier still holds it
+            _published->store(nullptr, std::memory_order_release);
+            _list->update(index, value);
+            publish();
+            _changed.notify(index, index + 1);
         }
     }
 
+    // replaces every element, notified as a reset: [0, size()) of the new list, an empty one too,
+    // so observers that saw elements past the new end don't keep them
     void set(const QVector<T>& list) {
-        *_list = list;
-        for (size_t i = 0; i < _list->size(); ++i) {
-            for (const auto& observer : *_observers) {
-                observer((*_list)[i], i);
-            }
+        _list->clear();
+        for (const T& value : list) {
+            _list->push_back(value);
         }
+        publish();
+        _changed.notify(0, _list->size());
+    }
+
+    // the observer is called with the range [begin, end) of the elements added or updated by a
+    // mutation until the subscription is dropped
+    [[nodiscard]] Subscription subscribe(std::function<void(size_t begin, size_t end)> observer) {
+        return _changed.subscribe(std::move(observer));
     }
 
-    void subscribe(std::function<void(const T&, size_t index)> observer) {
-        _observers->push_back(observer);
+    // the observer is called once in the dispatcher's next flush, however many elements changed
+    [[nodiscard]] Subscription subscribe(DeferredDispatcher& dispatcher, std::function<void()> observer) {
+        return _changed.subscribe(dispatcher, std::move(observer));
     }
 
     size_t size() const {
@@ -83,8 +138,19 @@ public:
 
     using value_type = T;
 private:
-    std::shared_ptr<QVector<T>> _list;
-    std::shared_ptr<std::vector<std::function<void(const T&, size_t index)>>> _observers;
+    static uint64_t nextId() {
+        static std::atomic<uint64_t> id{0};
+        return ++id;
+    }
+
+    void publish() {
+        _published->store(std::make_shared<const Storage>(*_list), std::memory_order_release);
+    }
+
+    uint64_t _id;
+    std::shared_ptr<Storage> _list;
+    std::shared_ptr<std::atomic<Snapshot>> _published;
+    Signal<size_t, size_t> _changed;
 };
 
 } //namespace Flux
\ No newline at end of file
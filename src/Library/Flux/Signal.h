@@ -0,0 +1,270 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace Flux {
+
+namespace detail {
+
+class SignalState
+{
+public:
+    virtual ~SignalState() = default;
+    virtual void disconnect(uint64_t id) = 0;
+};
+
+} // namespace detail
+
+// Keeps a slot connected to a Signal and disconnects it when destroyed or reset, so an object
+// holding the subscription can capture itself in the slot. Outliving the signal is fine.
+class Subscription
+{
+public:
+    Subscription() = default;
+    Subscription(std::weak_ptr<detail::SignalState> signal, uint64_t id)
+        : _signal(std::move(signal)), _id(id)
+    {}
+
+    Subscription(const Subscription&) = delete;
+    Subscription& operator=(const Subscription&) = delete;
+
+    Subscription(Subscription&& other) noexcept
+        : _signal(std::move(other._signal)), _id(std::exchange(other._id, 0))
+    {}
+
+    Subscription& operator=(Subscription&& other) noexcept
+    {
+        if (this != &other) {
+            reset();
+            _signal = std::move(other._signal);
+            _id = std::exchange(other._id, 0);
+        }
+        return *this;
+    }
+
+    ~Subscription()
+    {
+        reset();
+    }
+
+    void reset()
+    {
+        if (auto signal = _signal.lock()) {
+            signal->disconnect(_id);
+        }
+        _signal.reset();
+        _id = 0;
+    }
+
+    // leaves the slot connected for as long as the signal lives, for slots that only
+    // reference what owns the signal
+    void release()
+    {
+        _signal.reset();
+        _id = 0;
+    }
+
+    explicit operator bool() const
+    {
+        return !_signal.expired();
+    }
+
+private:
+    std::weak_ptr<detail::SignalState> _signal;
+    uint64_t _id = 0;
+};
+
+// Collects deferred slots notified since the last flush and calls each once on flush(), however
+// often it was notified, so a burst of edits turns into one update per frame. Queuing doesn't
+// allocate once the queue has grown to the number of slots. The dispatcher has to outlive the
+// subscriptions made with it; everything happens on the thread owning it.
+class DeferredDispatcher
+{
+public:
+    DeferredDispatcher() = default;
+    DeferredDispatcher(const DeferredDispatcher&) = delete;
+    DeferredDispatcher& operator=(const DeferredDispatcher&) = delete;
+
+    // called when a slot is queued into an empty dispatcher, to schedule the flush
+    void setWakeUp(std::function<void()> wakeUp)
+    {
+        _wakeUp = std::move(wakeUp);
+    }
+
+    // slots notified while flushing are queued for the next flush
+    void flush()
+    {
+        std::swap(_queue, _flushing);
+        for (const auto& slot : _flushing) {
+            slot->queued = false;
+            if (slot->connected) {
+                slot->callback();
+            }
+        }
+        _flushing.clear();
+    }
+
+    bool empty() const
+    {
+        return _queue.empty();
+    }
+
+private:
+    template<typename... Args>
+    friend class Signal;
+
+    struct Slot
+    {
+        std::function<void()> callback;
+        bool queued = false;
+        bool connected = true;
+    };
+
+    void post(const std::shared_ptr<Slot>& slot)
+    {
+        if (slot->queued) {
+            return;
+        }
+        slot->queued = true;
+        _queue.push_back(slot);
+        if (_queue.size() == 1 && _wakeUp) {
+            _wakeUp();
+        }
+    }
+
+    std::vector<std::shared_ptr<Slot>> _queue;
+    std::vector<std::shared_ptr<Slot>> _flushing;
+    std::function<void()> _wakeUp;
+};
+
+// Calls the connected slots on notify(), in the order they subscribed. Slots live in one vector
+// and are called in place, notifying allocates nothing. Slots may subscribe and unsubscribe
+// while being called: new slots are first called by the next notification, removed ones are not
+// called anymore. Copies share the slots, like copies of a MutableList share its data.
+template<typename... Args>
+class Signal
+{
+public:
+    Signal() : _state(std::make_shared<State>()) {}
+    // no moves, a moved from signal would have no slots to notify
+    Signal(const Signal&) = default;
+    Signal& operator=(const Signal&) = default;
+
+    [[nodiscard]] Subscription subscribe(std::function<void(Args...)> slot)
+    {
+        return _state->add(Connection{0, std::move(slot), nullptr, nullptr});
+    }
+
+    // the slot runs once in the dispatcher's next flush, without the arguments of the notifications
+    [[nodiscard]] Subscription subscribe(DeferredDispatcher& dispatcher, std::function<void()> slot)
+    {
+        auto deferred = std::make_shared<DeferredDispatcher::Slot>();
+        deferred->callback = std::move(slot);
+        return _state->add(Connection{0, nullptr, std::move(deferred), &dispatcher});
+    }
+
+    void notify(Args... args) const
+    {
+        State& state = *_state;
+        ++state.dispatching;
+        // slots added meanwhile wait in state.added, the vector isn't reallocated under a running slot
+        for (size_t i = 0; i < state.connections.size(); ++i) {
+            Connection& connection = state.connections[i];
+            if (connection.dead) {
+                continue;
+            }
+            if (connection.direct) {
+                connection.direct(args...);
+            } else if (connection.deferred) {
+                connection.dispatcher->post(connection.deferred);
+            }
+        }
+        if (--state.dispatching == 0) {
+            state.settle();
+        }
+    }
+
+    size_t slotCount() const
+    {
+        return _state->connections.size() + _state->added.size();
+    }
+
+private:
+    struct Connection
+    {
+        uint64_t id;
+        std::function<void(Args...)> direct;
+        std::shared_ptr<DeferredDispatcher::Slot> deferred;
+        DeferredDispatcher* dispatcher;
+        // disconnected while dispatching, skipped until settle() erases it
+        bool dead = false;
+    };
+
+    struct State : detail::SignalState, std::enable_shared_from_this<State>
+    {
+        Subscription add(Connection connection)
+        {
+            connection.id = ++nextId;
+            (dispatching > 0 ? added : connections).push_back(std::move(connection));
+            return Subscription(this->weak_from_this(), nextId);
+        }
+
+        void disconnect(uint64_t id) override
+        {
+            for (std::vector<Connection>* list : {&connections, &added}) {
+                for (size_t i = 0; i < list->size(); ++i) {
+                    Connection& connection = (*list)[i];
+                    if (connection.id != id) {
+                        continue;
+                    }
+                    if (connection.deferred) {
+                        connection.deferred->connected = false;
+                    }
+                    if (dispatching > 0 && list == &connections) {
+                        // a running slot may be the one removed, destroying its callable now would
+                        // pull the function out from under it; it's erased once dispatching ends
+                        connection.dead = true;
+                        removed = true;
+                    } else {
+                        list->erase(list->begin() + i);
+                    }
+                    return;
+                }
+            }
+        }
+
+        void settle()
+        {
+            // destroyed last, the slots' captures may disconnect other slots of this signal
+            std::vector<Connection> dead;
+            if (removed) {
+                auto end = std::stable_partition(connections.begin(), connections.end(),
+                                                 [](const Connection& connection) { return !connection.dead; });
+                dead.assign(std::make_move_iterator(end), std::make_move_iterator(connections.end()));
+                connections.erase(end, connections.end());
+                removed = false;
+            }
+            for (Connection& connection : added) {
+                connections.push_back(std::move(connection));
+            }
+            added.clear();
+        }
+
+        std::vector<Connection> connections;
+        std::vector<Connection> added;
+        uint64_t nextId = 0;
+        int dispatching = 0;
+        bool removed = false;
+    };
+
+    std::shared_ptr<State> _state;
+};
+
+} // namespace Flux
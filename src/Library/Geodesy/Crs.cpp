@@ -0,0 +1,102 @@
+#include "Crs.h"
+
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace Geodesy {
+
+Crs::Crs() : _name("WGS 84"), _epsg(4326), _datum(Datum::wgs84()) {}
+
+Crs Crs::geographic(const Datum& datum, int epsg)
+{
+    Crs crs;
+    crs._name = datum.name;
+    crs._epsg = epsg;
+    crs._datum = datum;
+    return crs;
+}
+
+Crs Crs::transverseMercator(const Datum& datum, const TransverseMercator& projection, std::string name, int epsg)
+{
+    Crs crs;
+    crs._name = std::move(name);
+    crs._epsg = epsg;
+    crs._datum = datum;
+    crs._projection = projection;
+    return crs;
+}
+
+Crs Crs::utm(int zone, bool north, const Datum& datum)
+{
+    if (zone < 1 || zone > 60) {
+        throw std::runtime_error("UTM zone " + std::to_string(zone) + " doesn't exist");
+    }
+    TransverseMercator projection;
+    projection.centralMeridian = zone * 6.0 - 183.0;
+    projection.scale = 0.9996;
+    projection.falseEasting = 500000.0;
+    projection.falseNorthing = north ? 0.0 : 10000000.0;
+
+    int epsg = 0;
+    if (datum.name == Datum::wgs84().name) {
+        epsg = (north ? 32600 : 32700) + zone;
+    } else if (datum.name == Datum::etrs89().name && north && zone >= 28 && zone <= 38) {
+        epsg = 25800 + zone;
+    } else if (datum.name == Datum::nad83().name && north && zone <= 23) {
+        epsg = 26900 + zone;
+    } else if (datum.name == Datum::ed50().name && north && zone >= 28 && zone <= 38) {
+        epsg = 23000 + zone;
+    }
+    return transverseMercator(datum, projection,
+                              datum.name + " / UTM zone " + std::to_string(zone) + (north ? "N" : "S"), epsg);
+}
+
+Crs Crs::fromEpsg(int code)
+{
+    switch (code) {
+    case 4326:
+        return geographic(Datum::wgs84(), code);
+    case 4258:
+        return geographic(Datum::etrs89(), code);
+    case 4269:
+        return geographic(Datum::nad83(), code);
+    case 4277:
+        return geographic(Datum::osgb36(), code);
+    case 4314:
+        return geographic(Datum::dhdn(), code);
+    case 4230:
+        return geographic(Datum::ed50(), code);
+    case 27700: {
+        TransverseMercator projection{49.0, -2.0, 0.9996012717, 400000.0, -100000.0};
+        return transverseMercator(Datum::osgb36(), projection, "OSGB36 / British National Grid", code);
+    }
+    default:
+        break;
+    }
+    if (code >= 32601 && code <= 32660) {
+        return utm(code - 32600, true, Datum::wgs84());
+    }
+    if (code >= 32701 && code <= 32760) {
+        return utm(code - 32700, false, Datum::wgs84());
+    }
+    if (code >= 25828 && code <= 25838) {
+        return utm(code - 25800, true, Datum::etrs89());
+    }
+    if (code >= 26901 && code <= 26923) {
+        return utm(code - 26900, true, Datum::nad83());
+    }
+    if (code >= 23028 && code <= 23038) {
+        return utm(code - 23000, true, Datum::ed50());
+    }
+    if (code >= 31466 && code <= 31469) {
+        // DHDN / 3-degree Gauss-Kruger zones 2 to 5, the zone number leads the easting
+        int zone = code - 31464;
+        TransverseMercator projection{0.0, zone * 3.0, 1.0, zone * 1000000.0 + 500000.0, 0.0};
+        return transverseMercator(Datum::dhdn(), projection,
+                                  "DHDN / 3-degree Gauss-Kruger zone " + std::to_string(zone), code);
+    }
+    throw std::runtime_error("EPSG:" + std::to_string(code) + " isn't a known coordinate reference system");
+}
+
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <optional>
+#include <string>
+
+#include "Datum.h"
+
+namespace Geodesy {
+
+// angles in degrees, distances in meters
+struct TransverseMercator
+{
+    double latitudeOfOrigin = 0.0;
+    double centralMeridian = 0.0;
+    double scale = 1.0;
+    double falseEasting = 0.0;
+    double falseNorthing = 0.0;
+
+    bool operator==(const TransverseMercator&) const = default;
+};
+
+// Coordinate reference system of a document or of data brought into it. Geographic systems
+// have x longitude and y latitude in degrees, projected ones easting and northing in meters.
+class Crs
+{
+public:
+    // WGS 84 longitude and latitude
+    Crs();
+
+    static Crs geographic(const Datum& datum, int epsg = 0);
+    static Crs transverseMercator(const Datum& datum, const TransverseMercator& projection, std::string name,
+                                  int epsg = 0);
+    // zone 1 to 60
+    static Crs utm(int zone, bool north, const Datum& datum = Datum::wgs84());
+    // geographic WGS 84, ETRS89, NAD83, OSGB36, DHDN and ED50, their UTM zones, the British
+    // National Grid and the German Gauss-Krüger zones; throws for other codes
+    static Crs fromEpsg(int code);
+
+    const std::string& name() const { return _name; }
+    // 0 when the system wasn't made from a code
+    int epsg() const { return _epsg; }
+    const Datum& datum() const { return _datum; }
+    bool isGeographic() const { return !_projection; }
+    const std::optional<TransverseMercator>& projection() const { return _projection; }
+
+    // same datum and projection, whatever the name
+    bool sameAs(const Crs& other) const
+    {
+        return _datum.sameAs(other._datum) && _projection == other._projection;
+    }
+
+private:
+    std::string _name;
+    int _epsg = 0;
+    Datum _datum;
+    std::optional<TransverseMercator> _projection;
+};
+
+}
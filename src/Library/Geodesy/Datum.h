@@ -0,0 +1,93 @@
+#pragma once
+
+#include <string>
+
+namespace Geodesy {
+
+struct Ellipsoid
+{
+    // semi-major axis in meters and flattening
+    double a;
+    double f;
+
+    double eccentricitySquared() const
+    {
+        return f * (2.0 - f);
+    }
+
+    // third flattening, the series of the transverse Mercator are in it
+    double thirdFlattening() const
+    {
+        return f / (2.0 - f);
+    }
+
+    bool operator==(const Ellipsoid&) const = default;
+
+    static constexpr Ellipsoid wgs84() { return {6378137.0, 1.0 / 298.257223563}; }
+    static constexpr Ellipsoid grs80() { return {6378137.0, 1.0 / 298.257222101}; }
+    static constexpr Ellipsoid airy1830() { return {6377563.396, 1.0 / 299.3249646}; }
+    static constexpr Ellipsoid bessel1841() { return {6377397.155, 1.0 / 299.1528128}; }
+    static constexpr Ellipsoid international1924() { return {6378388.0, 1.0 / 297.0}; }
+};
+
+// Seven parameter Helmert transformation, position vector convention (EPSG method 9606):
+// translations in meters, rotations in arc seconds, scale in parts per million.
+struct Helmert
+{
+    double tx = 0.0;
+    double ty = 0.0;
+    double tz = 0.0;
+    double rx = 0.0;
+    double ry = 0.0;
+    double rz = 0.0;
+    double scale = 0.0;
+
+    bool isIdentity() const
+    {
+        return tx == 0.0 && ty == 0.0 && tz == 0.0 && rx == 0.0 && ry == 0.0 && rz == 0.0 && scale == 0.0;
+    }
+
+    // the parameters negated, exact to well below a millimeter for the small rotations of datum shifts
+    Helmert inverse() const
+    {
+        return {-tx, -ty, -tz, -rx, -ry, -rz, -scale};
+    }
+
+    bool operator==(const Helmert&) const = default;
+};
+
+// A geodetic datum as its ellipsoid and the shift of its geocentric coordinates to WGS 84.
+struct Datum
+{
+    std::string name;
+    Ellipsoid ellipsoid;
+    Helmert toWgs84;
+
+    // same ellipsoid and shift, whatever the name
+    bool sameAs(const Datum& other) const
+    {
+        return ellipsoid == other.ellipsoid && toWgs84 == other.toWgs84;
+    }
+
+    static Datum wgs84() { return {"WGS 84", Ellipsoid::wgs84(), {}}; }
+    // the difference to WGS 84 stays below a meter, they are treated as the same
+    static Datum etrs89() { return {"ETRS89", Ellipsoid::grs80(), {}}; }
+    static Datum nad83() { return {"NAD83", Ellipsoid::grs80(), {}}; }
+    // EPSG:1314, about 2 m
+    static Datum osgb36()
+    {
+        return {"OSGB36", Ellipsoid::airy1830(), {446.448, -125.157, 542.06, 0.15, 0.247, 0.842, -20.489}};
+    }
+    // EPSG:1777, about 3 m
+    static Datum dhdn()
+    {
+        return {"DHDN", Ellipsoid::bessel1841(), {598.1, 73.7, 418.2, 0.202, 0.045, -2.455, 6.7}};
+    }
+    // EPSG:1133, about 3 m
+    static Datum ed50()
+    {
+        return {"ED50", Ellipsoid::international1924(), {-87.0, -98.0, -121.0, 0.0, 0.0, 0.0, 0.0}};
+    }
+};
+
+}
@@ -0,0 +1,231 @@
+#include "Transform.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+
+#include "Library/Concurrency/ThreadPool.h"
+
+namespace Geodesy {
+
+namespace {
+
+constexpr double degree = std::numbers::pi / 180.0;
+constexpr double arcSecond = degree / 3600.0;
+
+// X = T + (1 + s) R X, position vector rotation
+void helmert(const Helmert& h, double* x, double* y, double* z, size_t count)
+{
+    double m = 1.0 + h.scale * 1e-6;
+    double rx = h.rx * arcSecond;
+    double ry = h.ry * arcSecond;
+    double rz = h.rz * arcSecond;
+    for (size_t i = 0; i < count; ++i) {
+        double px = x[i];
+        double py = y[i];
+        double pz = z[i];
+        x[i] = h.tx + m * (px - rz * py + ry * pz);
+        y[i] = h.ty + m * (rz * px + py - rx * pz);
+        z[i] = h.tz + m * (-ry * px + rx * py + pz);
+    }
+}
+
+}
+
+Transform::Transform(const Crs& from, const Crs& to) :
+    _identity(from.sameAs(to)),
+    _shift(!from.datum().sameAs(to.datum())),
+    _fromEllipsoid{from.datum().ellipsoid.a, from.datum().ellipsoid.eccentricitySquared()},
+    _toEllipsoid{to.datum().ellipsoid.a, to.datum().ellipsoid.eccentricitySquared()},
+    _toWgs84(from.datum().toWgs84),
+    _fromWgs84(to.datum().toWgs84.inverse())
+{
+    if (from.projection()) {
+        _fromProjection = projectionFor(from.datum().ellipsoid, *from.projection());
+    }
+    if (to.projection()) {
+        _toProjection = projectionFor(to.datum().ellipsoid, *to.projection());
+    }
+}
+
+Transform::Projection Transform::projectionFor(const Ellipsoid& ellipsoid, const TransverseMercator& projection)
+{
+    double n = ellipsoid.thirdFlattening();
+    double n2 = n * n;
+    double n3 = n2 * n;
+    double n4 = n3 * n;
+
+    Projection result;
+    result.centralMeridian = projection.centralMeridian * degree;
+    result.falseEasting = projection.falseEasting;
+    result.falseNorthing = projection.falseNorthing;
+    result.k0A = projection.scale * ellipsoid.a / (1.0 + n) * (1.0 + n2 / 4.0 + n4 / 64.0);
+    result.eccentricity = std::sqrt(ellipsoid.eccentricitySquared());
+
+    // Karney, Transverse Mercator with an accuracy of a few nanometers, eq. 35 and 36
+    result.alpha[0] = n / 2.0 - 2.0 * n2 / 3.0 + 5.0 * n3 / 16.0 + 41.0 * n4 / 180.0;
+    result.alpha[1] = 13.0 * n2 / 48.0 - 3.0 * n3 / 5.0 + 557.0 * n4 / 1440.0;
+    result.alpha[2] = 61.0 * n3 / 240.0 - 103.0 * n4 / 140.0;
+    result.alpha[3] = 49561.0 * n4 / 161280.0;
+    result.beta[0] = n / 2.0 - 2.0 * n2 / 3.0 + 37.0 * n3 / 96.0 - n4 / 360.0;
+    result.beta[1] = n2 / 48.0 + n3 / 15.0 - 437.0 * n4 / 1440.0;
+    result.beta[2] = 17.0 * n3 / 480.0 - 37.0 * n4 / 840.0;
+    result.beta[3] = 4397.0 * n4 / 161280.0;
+
+    // northing of the latitude of origin on the central meridian, where eta' is 0
+    double xi = std::atan(conformal(projection.latitudeOfOrigin * degree, result.eccentricity));
+    double northing = xi;
+    for (int j = 1; j <= 4; ++j) {
+        northing += result.alpha[j - 1] * std::sin(2 * j * xi);
+    }
+    result.originNorthing = result.k0A * northing;
+    return result;
+}
+
+double Transform::conformal(double latitude, double eccentricity)
+{
+    double tau = std::tan(latitude);
+    double root = std::sqrt(1.0 + tau * tau);
+    double sigma = std::sinh(eccentricity * std::atanh(eccentricity * tau / root));
+    return tau * std::sqrt(1.0 + sigma * sigma) - sigma * root;
+}
+
+double Transform::geodetic(double conformalTangent, double eccentricity)
+{
+    // Newton on tan(latitude), four steps reach double precision from this start everywhere
+    double e2m = 1.0 - eccentricity * eccentricity;
+    double tau = conformalTangent / e2m;
+    for (int i = 0; i < 4; ++i) {
+        double root = std::sqrt(1.0 + tau * tau);
+        double sigma = std::sinh(eccentricity * std::atanh(eccentricity * tau / root));
+        double tauPrime = tau * std::sqrt(1.0 + sigma * sigma) - sigma * root;
+        tau += (conformalTangent - tauPrime) * (1.0 + e2m * tau * tau) /
+               (e2m * root * std::sqrt(1.0 + tauPrime * tauPrime));
+    }
+    return std::atan(tau);
+}
+
+void Transform::apply(double* x, double* y, size_t count) const
+{
+    if (_identity) {
+        return;
+    }
+    for (size_t begin = 0; begin < count; begin += blockSize) {
+        applyBlock(x + begin, y + begin, std::min(blockSize, count - begin));
+    }
+}
+
+void Transform::apply(double* x, double* y, size_t count, Concurrency::ThreadPool& pool) const
+{
+    if (_identity) {
+        return;
+    }
+    // several blocks per task keep the pool's bookkeeping out of the way
+    constexpr size_t taskSize = 16 * blockSize;
+    pool.parallelFor((count + taskSize - 1) / taskSize, [&](size_t task) {
+        size_t begin = task * taskSize;
+        apply(x + begin, y + begin, std::min(taskSize, count - begin));
+    });
+}
+
+void Transform::applyBlock(double* x, double* y, size_t count) const
+{
+    // to longitude and latitude in radians on the source datum
+    if (_fromProjection) {
+        unproject(*_fromProjection, x, y, count);
+    } else {
+        for (size_t i = 0; i < count; ++i) {
+            x[i] *= degree;
+            y[i] *= degree;
+        }
+    }
+
+    if (_shift) {
+        shiftDatum(x, y, count);
+    }
+
+    if (_toProjection) {
+        project(*_toProjection, x, y, count);
+    } else {
+        for (size_t i = 0; i < count; ++i) {
+            x[i] = std::remainder(x[i], 2.0 * std::numbers::pi) / degree;
+            y[i] /= degree;
+        }
+    }
+}
+
+void Transform::unproject(const Projection& p, double* x, double* y, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        double xi = (y[i] - p.falseNorthing + p.originNorthing) / p.k0A;
+        double eta = (x[i] - p.falseEasting) / p.k0A;
+        double xiPrime = xi;
+        double etaPrime = eta;
+        for (int j = 1; j <= 4; ++j) {
+            xiPrime -= p.beta[j - 1] * std::sin(2 * j * xi) * std::cosh(2 * j * eta);
+            etaPrime -= p.beta[j - 1] * std::cos(2 * j * xi) * std::sinh(2 * j * eta);
+        }
+        double sinhEta = std::sinh(etaPrime);
+        double cosXi = std::cos(xiPrime);
+        x[i] = p.centralMeridian + std::atan2(sinhEta, cosXi);
+        y[i] = geodetic(std::sin(xiPrime) / std::hypot(sinhEta, cosXi), p.eccentricity);
+    }
+}
+
+void Transform::project(const Projection& p, double* x, double* y, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        double longitude = std::remainder(x[i] - p.centralMeridian, 2.0 * std::numbers::pi);
+        double tauPrime = conformal(y[i], p.eccentricity);
+        double cosLongitude = std::cos(longitude);
+        double xiPrime = std::atan2(tauPrime, cosLongitude);
+        double etaPrime = std::asinh(std::sin(longitude) / std::hypot(tauPrime, cosLongitude));
+        double easting = etaPrime;
+        double northing = xiPrime;
+        for (int j = 1; j <= 4; ++j) {
+            easting += p.alpha[j - 1] * std::cos(2 * j * xiPrime) * std::sinh(2 * j * etaPrime);
+            northing += p.alpha[j - 1] * std::sin(2 * j * xiPrime) * std::cosh(2 * j * etaPrime);
+        }
+        x[i] = p.falseEasting + p.k0A * easting;
+        y[i] = p.falseNorthing + p.k0A * northing - p.originNorthing;
+    }
+}
+
+void Transform::shiftDatum(double* longitude, double* latitude, size_t count) const
+{
+    double z[blockSize];
+
+    // geocentric on the source ellipsoid, longitude and latitude arrays take x and y
+    const Geocentric& from = _fromEllipsoid;
+    for (size_t i = 0; i < count; ++i) {
+        double sinLatitude = std::sin(latitude[i]);
+        double cosLatitude = std::cos(latitude[i]);
+        double radius = from.a / std::sqrt(1.0 - from.e2 * sinLatitude * sinLatitude);
+        double lambda = longitude[i];
+        longitude[i] = radius * cosLatitude * std::cos(lambda);
+        latitude[i] = radius * cosLatitude * std::sin(lambda);
+        z[i] = radius * (1.0 - from.e2) * sinLatitude;
+    }
+
+    helmert(_toWgs84, longitude, latitude, z, count);
+    helmert(_fromWgs84, longitude, latitude, z, count);
+
+    // back to the target ellipsoid; the fixed point converges to below a millimeter in three
+    // steps for points near the surface, four leave a margin
+    const Geocentric& to = _toEllipsoid;
+    for (size_t i = 0; i < count; ++i) {
+        double x = longitude[i];
+        double y = latitude[i];
+        double p = std::hypot(x, y);
+        double phi = std::atan2(z[i], p * (1.0 - to.e2));
+        for (int j = 0; j < 4; ++j) {
+            double sinPhi = std::sin(phi);
+            double radius = to.a / std::sqrt(1.0 - to.e2 * sinPhi * sinPhi);
+            phi = std::atan2(z[i] + to.e2 * radius * sinPhi, p);
+        }
+        longitude[i] = std::atan2(y, x);
+        latitude[i] = phi;
+    }
+}
+
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+
+#include "Crs.h"
+
+namespace Concurrency {
+class ThreadPool;
+}
+
+namespace Geodesy {
+
+// Converts coordinates between two systems: the inverse projection of the source, a Helmert
+// shift through WGS 84 when the datums differ, the projection of the target. Coordinates are
+// converted in place in blocks of structure-of-arrays, every step one branch free loop over
+// the block, so the compiler can vectorize them where the math functions allow it. Transverse
+// Mercator uses Krüger's series to the fourth order in the third flattening, good to a few
+// micrometers within 4000 km of the central meridian.
+class Transform
+{
+public:
+    // points per block, the blocks of one call are spread over the pool
+    static constexpr size_t blockSize = 1024;
+
+    Transform(const Crs& from, const Crs& to);
+
+    bool isIdentity() const { return _identity; }
+
+    // x and y as described by Crs, heights are taken as 0 on the ellipsoid
+    void apply(double* x, double* y, size_t count) const;
+    void apply(double* x, double* y, size_t count, Concurrency::ThreadPool& pool) const;
+
+private:
+    struct Projection
+    {
+        double centralMeridian;
+        double falseEasting;
+        double falseNorthing;
+        // scale times the rectifying radius, and the northing of the latitude of origin
+        double k0A;
+        double originNorthing;
+        double eccentricity;
+        double alpha[4];
+        double beta[4];
+    };
+
+    struct Geocentric
+    {
+        double a;
+        double e2;
+    };
+
+    static Projection projectionFor(const Ellipsoid& ellipsoid, const TransverseMercator& projection);
+    // latitude in radians to the tangent of the conformal latitude and back
+    static double conformal(double latitude, double eccentricity);
+    static double geodetic(double conformalTangent, double eccentricity);
+
+    void applyBlock(double* x, double* y, size_t count) const;
+    static void unproject(const Projection& projection, double* x, double* y, size_t count);
+    static void project(const Projection& projection, double* x, double* y, size_t count);
+    void shiftDatum(double* longitude, double* latitude, size_t count) const;
+
+    bool _identity;
+    std::optional<Projection> _fromProjection;
+    std::optional<Projection> _toProjection;
+    bool _shift;
+    Geocentric _fromEllipsoid;
+    Geocentric _toEllipsoid;
+    // source datum to WGS 84 and WGS 84 to the target datum
+    Helmert _toWgs84;
+    Helmert _fromWgs84;
+};
+
+}
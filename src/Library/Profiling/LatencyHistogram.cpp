@@ -0,0 +1,99 @@
+#include "LatencyHistogram.h"
+#include <QtGlobal>
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace Profiling {
+
+size_t LatencyHistogram::bucketIndex(uint64_t micros)
+{
+    if (micros < subBuckets) {
+        return micros;
+    }
+    int octave = std::bit_width(micros) - 1;
+    size_t sub = (micros >> (octave - subBucketBits)) & (subBuckets - 1);
+    size_t index = subBuckets + size_t(octave - subBucketBits) * subBuckets + sub;
+    return std::min(index, bucketCount - 1);
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(size_t index)
+{
+    if (index < subBuckets) {
+        return index;
+    }
+    int shift = int((index - subBuckets) / subBuckets);
+    uint64_t sub = (index - subBuckets) % subBuckets;
+    return ((subBuckets + sub + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(std::chrono::nanoseconds duration)
+{
+    uint64_t micros = uint64_t(std::max<int64_t>(0, std::chrono::duration_cast<Duration>(duration).count()));
+    _buckets[bucketIndex(micros)].fetch_add(1, std::memory_order_relaxed);
+    _sum.fetch_add(micros, std::memory_order_relaxed);
+    _count.fetch_add(1, std::memory_order_relaxed);
+
+    uint64_t max = _max.load(std::memory_order_relaxed);
+    while (micros > max && !_max.compare_exchange_weak(max, micros, std::memory_order_relaxed)) {
+    }
+}
+
+void LatencyHistogram::reset()
+{
+    for (auto& bucket : _buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    _count.store(0, std::memory_order_relaxed);
+    _sum.store(0, std::memory_order_relaxed);
+    _max.store(0, std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::count() const
+{
+    return _count.load(std::memory_order_relaxed);
+}
+
+LatencyHistogram::Duration LatencyHistogram::max() const
+{
+    return Duration(_max.load(std::memory_order_relaxed));
+}
+
+LatencyHistogram::Duration LatencyHistogram::mean() const
+{
+    uint64_t count = this->count();
+    return Duration(count ? _sum.load(std::memory_order_relaxed) / count : 0);
+}
+
+LatencyHistogram::Duration LatencyHistogram::percentile(double fraction) const
+{
+    // the buckets may move on while we walk them, count what we see instead of using _count
+    std::array<uint64_t, bucketCount> counts;
+    uint64_t total = 0;
+    for (size_t i = 0; i < bucketCount; ++i) {
+        counts[i] = _buckets[i].load(std::memory_order_relaxed);
+        total += counts[i];
+    }
+    if (total == 0) {
+        return Duration(0);
+    }
+
+    uint64_t rank = std::max<uint64_t>(1, uint64_t(std::ceil(std::clamp(fraction, 0.0, 1.0) * double(total))));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < bucketCount; ++i) {
+        seen += counts[i];
+        if (seen >= rank) {
+            return Duration(std::min(bucketUpperBound(i), uint64_t(max().count())));
+        }
+    }
+    return max();
+}
+
+void LatencyHistogram::print(const char* name) const
+{
+    qDebug("%s: %llu samples, mean %lld us, p50 %lld us, p90 %lld us, p99 %lld us, max %lld us", name,
+           (unsigned long long)count(), (long long)mean().count(), (long long)percentile(0.5).count(),
+           (long long)percentile(0.9).count(), (long long)percentile(0.99).count(), (long long)max().count());
+}
+
+} // namespace Profiling
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace Profiling {
+
+// Log-linear histogram of durations in microseconds: every power of two is split into
+// 8 buckets, so any percentile is off by at most 12.5%. record() only does relaxed
+// atomic increments, it can be called from one thread while another one reads.
+class LatencyHistogram {
+public:
+    using Duration = std::chrono::microseconds;
+
+    void record(std::chrono::nanoseconds duration);
+    void reset();
+
+    uint64_t count() const;
+    Duration max() const;
+    Duration mean() const;
+    // upper bound of the bucket holding the given fraction (0..1] of the samples
+    Duration percentile(double fraction) const;
+
+    // one line with count, mean, p50/p90/p99 and max
+    void print(const char* name) const;
+
+private:
+    static constexpr int subBucketBits = 3;
+    static constexpr int subBuckets = 1 << subBucketBits;
+    // up to 2^24 us, about 16 s, longer samples land in the last bucket
+    static constexpr int octaves = 24 - subBucketBits;
+    static constexpr size_t bucketCount = subBuckets + octaves * subBuckets;
+
+    static size_t bucketIndex(uint64_t micros);
+    static uint64_t bucketUpperBound(size_t index);
+
+    std::array<std::atomic<uint64_t>, bucketCount> _buckets{};
+    std::atomic<uint64_t> _count{0};
+    std::atomic<uint64_t> _sum{0};
+    std::atomic<uint64_t> _max{0};
+};
+
+} // namespace Profiling
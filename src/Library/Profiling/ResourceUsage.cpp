@@ -0,0 +1,16 @@
+#include "ResourceUsage.h"
+#include <sys/resource.h>
+
+namespace Profiling {
+
+size_t peakResidentBytes()
+{
+    rusage usage = {};
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+    // kilobytes on Linux
+    return size_t(usage.ru_maxrss) * 1024;
+}
+
+} // namespace Profiling
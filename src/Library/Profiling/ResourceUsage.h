@@ -0,0 +1,10 @@
+#pragma once
+
+#include <cstddef>
+
+namespace Profiling {
+
+// the most memory the process ever had resident, in bytes
+size_t peakResidentBytes();
+
+} // namespace Profiling
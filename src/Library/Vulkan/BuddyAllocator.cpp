@@ -0,0 +1,113 @@
+#include "BuddyAllocator.h"
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+
+namespace Vulkan {
+
+BuddyAllocator::BuddyAllocator(uint64_t size, uint64_t minNodeSize) :
+    _minNodeSize(std::bit_ceil(minNodeSize))
+{
+    if (size < _minNodeSize || !std::has_single_bit(size)) {
+        throw std::runtime_error("buddy allocator size has to be a power of two not less than the node size");
+    }
+    _maxOrder = std::countr_zero(size / _minNodeSize);
+    _freeNodes.resize(_maxOrder + 1);
+    _freeNodes[_maxOrder].insert(0);
+}
+
+uint64_t BuddyAllocator::nodeSize(uint32_t order) const
+{
+    return _minNodeSize << order;
+}
+
+std::optional<uint64_t> BuddyAllocator::allocate(uint64_t size, uint64_t alignment)
+{
+    uint64_t needed = std::bit_ceil(std::max({size, alignment, _minNodeSize}));
+    uint32_t order = std::countr_zero(needed / _minNodeSize);
+    if (order > _maxOrder) {
+        return std::nullopt;
+    }
+
+    uint32_t available = order;
+    while (available <= _maxOrder && _freeNodes[available].empty()) {
+        ++available;
+    }
+    if (available > _maxOrder) {
+        return std::nullopt;
+    }
+
+    uint64_t offset = *_freeNodes[available].begin();
+    _freeNodes[available].erase(_freeNodes[available].begin());
+    // split down, keeping the lower half and freeing the upper buddy at every level
+    while (available > order) {
+        --available;
+        _freeNodes[available].insert(offset + nodeSize(available));
+    }
+
+    _allocated.emplace(offset, Node{order, size});
+    _usedBytes += nodeSize(order);
+    _requestedBytes += size;
+    return offset;
+}
+
+void BuddyAllocator::free(uint64_t offset)
+{
+    auto it = _allocated.find(offset);
+    if (it == _allocated.end()) {
+        throw std::runtime_error("buddy allocator: freeing an offset which isn't allocated");
+    }
+    uint32_t order = it->second.order;
+    _usedBytes -= nodeSize(order);
+    _requestedBytes -= it->second.requested;
+    _allocated.erase(it);
+
+    while (order < _maxOrder) {
+        uint64_t buddy = offset ^ nodeSize(order);
+        auto buddyIt = _freeNodes[order].find(buddy);
+        if (buddyIt == _freeNodes[order].end()) {
+            break;
+        }
+        _freeNodes[order].erase(buddyIt);
+        offset = std::min(offset, buddy);
+        ++order;
+    }
+    _freeNodes[order].insert(offset);
+}
+
+uint64_t BuddyAllocator::size() const
+{
+    return nodeSize(_maxOrder);
+}
+
+uint64_t BuddyAllocator::usedBytes() const
+{
+    return _usedBytes;
+}
+
+uint64_t BuddyAllocator::requestedBytes() const
+{
+    return _requestedBytes;
+}
+
+uint64_t BuddyAllocator::largestFreeNode() const
+{
+    for (uint32_t order = _maxOrder + 1; order-- > 0;) {
+        if (!_freeNodes[order].empty()) {
+            return nodeSize(order);
+        }
+    }
+    return 0;
+}
+
+size_t BuddyAllocator::allocationCount() const
+{
+    return _allocated.size();
+}
+
+bool BuddyAllocator::empty() const
+{
+    return _allocated.empty();
+}
+
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+namespace Vulkan {
+
+// Binary buddy scheme over [0, size) of one memory block. Nodes are powers of two and
+// placed at multiples of their size, so any power of two alignment up to the node size
+// holds without padding.
+class BuddyAllocator {
+public:
+    BuddyAllocator(uint64_t size, uint64_t minNodeSize = 256);
+
+    std::optional<uint64_t> allocate(uint64_t size, uint64_t alignment);
+    void free(uint64_t offset);
+
+    uint64_t size() const;
+    // bytes taken by nodes, including the rounding up to powers of two
+    uint64_t usedBytes() const;
+    uint64_t requestedBytes() const;
+    uint64_t largestFreeNode() const;
+    size_t allocationCount() const;
+    bool empty() const;
+
+private:
+    struct Node {
+        uint32_t order;
+        uint64_t requested;
+    };
+
+    uint64_t nodeSize(uint32_t order) const;
+
+    uint64_t _minNodeSize;
+    uint32_t _maxOrder;
+    std::vector<std::set<uint64_t>> _freeNodes;
+    std::unordered_map<uint64_t, Node> _allocated;
+    uint64_t _usedBytes = 0;
+    uint64_t _requestedBytes = 0;
+};
+
+}
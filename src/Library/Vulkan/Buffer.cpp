@@ -1,7 +1,9 @@
 #include <cstdint>
+#include <cstring>
 #include <vulkan/vulkan.h>
 #include <stdexcept>
 #include "Buffer.h"
+#include "Library/Vulkan/StagingRing.h"
 #include "Library/Vulkan/VulkanManager.h"
 #include <cstddef>
 #include <memory>
@@ -14,65 +16,65 @@ Buffer::Buffer(const std::shared_ptr<VulkanManager>& vkManager) :
 {
 }
 
-void Buffer::allocateMemory(size_t size)
+void Buffer::allocateMemory(size_t size, VkBufferUsageFlags usage, Location location)
 {
+    // frames in flight may still read the old buffer
+    _vkManager->memoryAllocator().release(_vkBuffer, _allocation);
+    _hostVisible = location == Location::HostVisible || _vkManager->isUnifiedMemory();
+
     VkBufferCreateInfo bufferInfo = {};
     bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
     bufferInfo.size = size;
-    bufferInfo.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+    bufferInfo.usage = _hostVisible ? usage : usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
     bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
     bufferInfo.pNext = nullptr;
 
     _vkBuffer = _vkManager->createBuffer(&bufferInfo);
+    _size = size;
 
-    vkGetBufferMemoryRequirements(_vkManager->device(), _vkBuffer,  &_memReq);
-    _memoryIndex = findMemoryType(_vkManager->physicalDevice(), _memReq.memoryTypeBits,
-                       VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-
-    VkMemoryAllocateInfo allocInfo;
-    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    allocInfo.memoryTypeIndex = _memoryIndex;
-    allocInfo.allocationSize = _memReq.size;
-    allocInfo.pNext = nullptr;
+    VkMemoryRequirements memReq;
+    vkGetBufferMemoryRequirements(_vkManager->device(), _vkBuffer, &memReq);
+    _allocation = _vkManager->memoryAllocator().allocate(memReq,
+                       _hostVisible ? VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+                                    : VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    vkBindBufferMemory(_vkManager->device(), _vkBuffer, _allocation.memory, _allocation.offset);
+}
 
-    VkDeviceMemory devMemory;
+void Buffer::updateMemory(uint32_t offsetInBytes, const void* data, uint32_t size)
+{
+    memcpy(static_cast<char*>(map()) + offsetInBytes, data, size);
+}
 
-    VkResult res = vkAllocateMemory(_vkManager->device(), &allocInfo, nullptr, &devMemory);
-    if (res != VK_SUCCESS) {
-        throw std::runtime_error(QString("can't allocate memory with size %1, return: %2").arg(size).arg(res).toStdString());
+bool Buffer::upload(StagingRing& ring, VkDeviceSize offsetInBytes, const void* data, VkDeviceSize size)
+{
+    if (_hostVisible) {
+        updateMemory(offsetInBytes, data, size);
+        return true;
     }
-    _memory = devMemory;
-    vkBindBufferMemory(_vkManager->device(), _vkBuffer, devMemory, 0);
+    return ring.upload(_vkBuffer, offsetInBytes, data, size);
 }
 
-void Buffer::updateMemory(uint32_t offsetInBytes, void* data, uint32_t size)
+void* Buffer::map()
 {
-    void* d;
-    VkResult res = vkMapMemory(_vkManager->device(), _memory, offsetInBytes, size, 0, &d);
-    if (res != VK_SUCCESS) {
-        throw std::runtime_error("can't map error");
+    if (!_allocation.mapped) {
+        throw std::runtime_error("can't map device local buffer");
     }
-    memcpy(d, data, size);
-    vkUnmapMemory(_vkManager->device(), _memory);
+    return _allocation.mapped;
 }
 
-uint32_t Buffer::findMemoryType(VkPhysicalDevice physicalDevice, uint32_t memoryBits, int flagBits) const
+bool Buffer::isHostVisible() const
 {
-    VkPhysicalDeviceMemoryProperties memProperties;
-    vkGetPhysicalDeviceMemoryProperties(physicalDevice, & memProperties);
+    return _hostVisible;
+}
 
-    for (uint32_t i  = 0; i < memProperties.memoryTypeCount; ++i) {
-        if (((1 << i) & memoryBits) && ((memProperties.memoryTypes[i].propertyFlags & flagBits)) == flagBits) {
-            return i;
-        }
-    }
-    return 0;
+VkDeviceSize Buffer::size() const
+{
+    return _size;
 }
 
 Buffer::~Buffer()
 {
-    vkFreeMemory(_vkManager->device(), _memory, nullptr);
-    vkDestroyBuffer(_vkManager->device(), _vkBuffer, nullptr);
+    _vkManager->memoryAllocator().release(_vkBuffer, _allocation);
 }
 
-}
\ No newline at end of file
+}
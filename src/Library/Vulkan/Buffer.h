@@ -1,5 +1,6 @@
 #pragma once
 
+#include "Library/Vulkan/MemoryAllocator.h"
 #include "Library/Vulkan/VulkanComponent.h"
 #include "Library/Vulkan/VulkanManager.h"
 #include <cstddef>
@@ -10,24 +11,40 @@
 
 namespace Vulkan {
 
+class StagingRing;
+
 class Buffer : protected VulkanComponent {
 public:
+    enum class Location {
+        HostVisible,
+        // filled through a StagingRing, falls back to HostVisible on unified memory devices
+        DeviceLocal,
+    };
+
     Buffer(const std::shared_ptr<VulkanManager>& vkManager);
     ~Buffer();
     // returns index of memory (needed for update)
-    void allocateMemory(size_t size);
-    void updateMemory(uint32_t offsetInBytes, void* data, uint32_t size);
+    void allocateMemory(size_t size, VkBufferUsageFlags usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                        Location location = Location::HostVisible);
+    // only for host visible buffers
+    void updateMemory(uint32_t offsetInBytes, const void* data, uint32_t size);
+    // writes directly when host visible, otherwise queues a copy in the ring;
+    // false when the ring has no room left in this frame
+    bool upload(StagingRing& ring, VkDeviceSize offsetInBytes, const void* data, VkDeviceSize size);
 
-    operator VkBuffer() { return _vkBuffer; }
+    // the allocator keeps host visible blocks mapped, only for host visible buffers
+    void* map();
 
-private:
-    VkBuffer _vkBuffer;
-    VkMemoryRequirements _memReq;
-    uint32_t _memoryIndex;
-    VkDeviceMemory _memory;
+    bool isHostVisible() const;
+    VkDeviceSize size() const;
 
-    uint32_t findMemoryType(VkPhysicalDevice physicalDevice, uint32_t memoryBits, int flags) const;
+    operator VkBuffer() { return _vkBuffer; }
 
+private:
+    VkBuffer _vkBuffer = VK_NULL_HANDLE;
+    Allocation _allocation;
+    VkDeviceSize _size = 0;
+    bool _hostVisible = true;
 };
 
-}
\ No newline at end of file
+}
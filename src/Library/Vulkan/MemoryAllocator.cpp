@@ -0,0 +1,267 @@
+#include "MemoryAllocator.h"
+#include <QtGlobal>
+#include <algorithm>
+#include <bit>
+#include <map>
+#include <stdexcept>
+#include <string>
+
+namespace Vulkan {
+
+MemoryAllocator::MemoryAllocator(VkDevice device, VkPhysicalDevice physicalDevice, VkDeviceSize blockSize) :
+    _device(device),
+    _blockSize(std::bit_ceil(blockSize))
+{
+    vkGetPhysicalDeviceMemoryProperties(physicalDevice, &_memoryProperties);
+}
+
+MemoryAllocator::~MemoryAllocator()
+{
+    // nothing renders with the device anymore
+    for (Release& release : _releases) {
+        vkDestroyBuffer(_device, release.buffer, nullptr);
+        free(release.allocation);
+    }
+    for (auto& block : _blocks) {
+        if (block) {
+            releaseDeviceMemory(block->memory, block->mapped);
+        }
+    }
+}
+
+std::shared_ptr<MemoryAllocator> MemoryAllocator::shared(VkDevice device, VkPhysicalDevice physicalDevice)
+{
+    static std::mutex mutex;
+    static std::map<VkDevice, std::weak_ptr<MemoryAllocator>> allocators;
+
+    std::lock_guard lock(mutex);
+    std::erase_if(allocators, [](const auto& entry) { return entry.second.expired(); });
+
+    auto& entry = allocators[device];
+    std::shared_ptr<MemoryAllocator> allocator = entry.lock();
+    if (!allocator) {
+        allocator = std::make_shared<MemoryAllocator>(device, physicalDevice);
+        entry = allocator;
+    }
+    return allocator;
+}
+
+const VkPhysicalDeviceMemoryProperties& MemoryAllocator::memoryProperties() const
+{
+    return _memoryProperties;
+}
+
+bool MemoryAllocator::isHostVisible(uint32_t memoryType) const
+{
+    return _memoryProperties.memoryTypes[memoryType].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+}
+
+uint32_t MemoryAllocator::findMemoryType(uint32_t memoryBits, VkMemoryPropertyFlags properties) const
+{
+    for (uint32_t i = 0; i < _memoryProperties.memoryTypeCount; ++i) {
+        if (((1u << i) & memoryBits) && (_memoryProperties.memoryTypes[i].propertyFlags & properties) == properties) {
+            return i;
+        }
+    }
+    throw std::runtime_error("no memory type with properties " + std::to_string(properties));
+}
+
+VkDeviceMemory MemoryAllocator::allocateDeviceMemory(VkDeviceSize size, uint32_t memoryType, void** mapped)
+{
+    VkMemoryAllocateInfo allocInfo = {};
+    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocInfo.memoryTypeIndex = memoryType;
+    allocInfo.allocationSize = size;
+
+    VkDeviceMemory memory;
+    VkResult res = vkAllocateMemory(_device, &allocInfo, nullptr, &memory);
+    if (res != VK_SUCCESS) {
+        throw std::runtime_error("can't allocate memory with size " + std::to_string(size) + ", return: " + std::to_string(res));
+    }
+
+    *mapped = nullptr;
+    if (isHostVisible(memoryType)) {
+        res = vkMapMemory(_device, memory, 0, VK_WHOLE_SIZE, 0, mapped);
+        if (res != VK_SUCCESS) {
+            vkFreeMemory(_device, memory, nullptr);
+            throw std::runtime_error("can't map memory, return: " + std::to_string(res));
+        }
+    }
+    return memory;
+}
+
+void MemoryAllocator::releaseDeviceMemory(VkDeviceMemory memory, void* mapped)
+{
+    if (mapped) {
+        vkUnmapMemory(_device, memory);
+    }
+    vkFreeMemory(_device, memory, nullptr);
+}
+
+Allocation MemoryAllocator::allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties, Kind kind)
+{
+    uint32_t memoryType = findMemoryType(requirements.memoryTypeBits, properties);
+
+    std::lock_guard lock(_mutex);
+
+    Allocation allocation;
+    allocation.size = requirements.size;
+    allocation.memoryType = memoryType;
+
+    if (requirements.size > _blockSize / 2) {
+        allocation.memory = allocateDeviceMemory(requirements.size, memoryType, &allocation.mapped);
+        ++_dedicatedCount;
+        _dedicatedBytes += requirements.size;
+        return allocation;
+    }
+
+    auto place = [&](uint32_t index) {
+        Block& block = *_blocks[index];
+        auto offset = block.buddy.allocate(requirements.size, requirements.alignment);
+        if (!offset) {
+            return false;
+        }
+        allocation.memory = block.memory;
+        allocation.offset = *offset;
+        allocation.mapped = block.mapped ? static_cast<char*>(block.mapped) + *offset : nullptr;
+        allocation._block = index;
+        return true;
+    };
+
+    uint32_t freeSlot = _blocks.size();
+    for (uint32_t i = 0; i < _blocks.size(); ++i) {
+        if (!_blocks[i]) {
+            freeSlot = std::min(freeSlot, i);
+            continue;
+        }
+        if (_blocks[i]->memoryType == memoryType && _blocks[i]->kind == kind && place(i)) {
+            return allocation;
+        }
+    }
+
+    auto block = std::make_unique<Block>(Block{VK_NULL_HANDLE, nullptr, memoryType, kind, BuddyAllocator(_blockSize)});
+    block->memory = allocateDeviceMemory(_blockSize, memoryType, &block->mapped);
+    if (freeSlot == _blocks.size()) {
+        _blocks.push_back(std::move(block));
+    } else {
+        _blocks[freeSlot] = std::move(block);
+    }
+    place(freeSlot);
+    return allocation;
+}
+
+void MemoryAllocator::free(Allocation& allocation)
+{
+    if (!allocation) {
+        return;
+    }
+
+    std::lock_guard lock(_mutex);
+
+    if (allocation._block == Allocation::dedicatedBlock) {
+        releaseDeviceMemory(allocation.memory, allocation.mapped);
+        --_dedicatedCount;
+        _dedicatedBytes -= allocation.size;
+        allocation = Allocation();
+        return;
+    }
+
+    Block& block = *_blocks[allocation._block];
+    block.buddy.free(allocation.offset);
+    if (block.buddy.empty()) {
+        // keep one empty block per type around so a buffer recreated every frame doesn't
+        // hit vkAllocateMemory each time
+        bool otherEmpty = std::any_of(_blocks.begin(), _blocks.end(), [&](const auto& other) {
+            return other && other.get() != &block && other->memoryType == block.memoryType
+                && other->kind == block.kind && other->buddy.empty();
+        });
+        if (otherEmpty) {
+            releaseDeviceMemory(block.memory, block.mapped);
+            _blocks[allocation._block].reset();
+        }
+    }
+    allocation = Allocation();
+}
+
+void MemoryAllocator::release(VkBuffer buffer, Allocation& allocation)
+{
+    if (buffer != VK_NULL_HANDLE || allocation) {
+        std::lock_guard lock(_mutex);
+        _releases.push_back({buffer, allocation, _frameCount});
+    }
+    allocation = Allocation();
+}
+
+void MemoryAllocator::beginFrame(uint32_t framesInFlight)
+{
+    std::deque<Release> done;
+    {
+        std::lock_guard lock(_mutex);
+        if (_frameOpen) {
+            return;
+        }
+        _frameOpen = true;
+        // Qt waited for the frame framesInFlight before this one, the frames begun before a
+        // release are done once framesInFlight frames began after it
+        uint64_t frame = _frameCount++;
+        while (!_releases.empty() && _releases.front().frame + std::max<uint32_t>(framesInFlight, 1) <= frame + 1) {
+            done.push_back(_releases.front());
+            _releases.pop_front();
+        }
+    }
+    for (Release& release : done) {
+        vkDestroyBuffer(_device, release.buffer, nullptr);
+        free(release.allocation);
+    }
+}
+
+void MemoryAllocator::endFrame()
+{
+    std::lock_guard lock(_mutex);
+    _frameOpen = false;
+}
+
+MemoryAllocator::Statistics MemoryAllocator::statistics() const
+{
+    std::lock_guard lock(_mutex);
+
+    Statistics stats;
+    stats.dedicatedCount = _dedicatedCount;
+    stats.allocationCount = _dedicatedCount;
+    stats.reservedBytes = _dedicatedBytes;
+    stats.requestedBytes = _dedicatedBytes;
+
+    VkDeviceSize freeBytes = 0;
+    VkDeviceSize scatteredBytes = 0;
+    for (const auto& block : _blocks) {
+        if (!block) {
+            continue;
+        }
+        const BuddyAllocator& buddy = block->buddy;
+        ++stats.blockCount;
+        stats.allocationCount += buddy.allocationCount();
+        stats.reservedBytes += buddy.size();
+        stats.requestedBytes += buddy.requestedBytes();
+        stats.internalWaste += buddy.usedBytes() - buddy.requestedBytes();
+        stats.largestFreeRange = std::max(stats.largestFreeRange, buddy.largestFreeNode());
+        freeBytes += buddy.size() - buddy.usedBytes();
+        scatteredBytes += buddy.size() - buddy.usedBytes() - buddy.largestFreeNode();
+    }
+    if (freeBytes > 0) {
+        stats.fragmentation = float(scatteredBytes) / float(freeBytes);
+    }
+    return stats;
+}
+
+void MemoryAllocator::printStatistics() const
+{
+    Statistics stats = statistics();
+    qDebug("gpu memory: %zu blocks, %zu dedicated, %zu allocations, reserved %llu KiB, requested %llu KiB, "
+           "rounding waste %llu KiB, largest free %llu KiB, fragmentation %.2f",
+           stats.blockCount, stats.dedicatedCount, stats.allocationCount,
+           (unsigned long long)(stats.reservedBytes >> 10), (unsigned long long)(stats.requestedBytes >> 10),
+           (unsigned long long)(stats.internalWaste >> 10), (unsigned long long)(stats.largestFreeRange >> 10),
+           stats.fragmentation);
+}
+
+}
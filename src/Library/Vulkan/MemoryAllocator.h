@@ -0,0 +1,120 @@
+#pragma once
+
+#include "Library/Vulkan/BuddyAllocator.h"
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+namespace Vulkan {
+
+struct Allocation {
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    VkDeviceSize offset = 0;
+    VkDeviceSize size = 0;
+    uint32_t memoryType = 0;
+    // points at offset inside the persistently mapped block, nullptr for device local memory
+    void* mapped = nullptr;
+
+    explicit operator bool() const { return memory != VK_NULL_HANDLE; }
+
+private:
+    friend class MemoryAllocator;
+    // index into the allocator's blocks, dedicated allocations have none
+    static constexpr uint32_t dedicatedBlock = UINT32_MAX;
+    uint32_t _block = dedicatedBlock;
+};
+
+// Sub-allocates buffers from large VkDeviceMemory blocks, one set of blocks per memory type,
+// so the driver sees a handful of vkAllocateMemory calls instead of one per buffer.
+// Requests bigger than half a block get their own dedicated memory.
+class MemoryAllocator {
+public:
+    struct Statistics {
+        size_t blockCount = 0;
+        size_t dedicatedCount = 0;
+        size_t allocationCount = 0;
+        // memory taken from the driver, blocks and dedicated allocations
+        VkDeviceSize reservedBytes = 0;
+        // bytes the callers asked for
+        VkDeviceSize requestedBytes = 0;
+        // bytes lost to power of two rounding inside the blocks
+        VkDeviceSize internalWaste = 0;
+        VkDeviceSize largestFreeRange = 0;
+        // share of free block memory outside the largest free range of its block,
+        // 0 when every block has its free space in one piece
+        float fragmentation = 0.0f;
+    };
+
+    // linear resources (buffers) and optimal tiling images never share a block,
+    // which keeps bufferImageGranularity out of the sub-allocation
+    enum class Kind {
+        Linear,
+        OptimalImage,
+    };
+
+    MemoryAllocator(VkDevice device, VkPhysicalDevice physicalDevice, VkDeviceSize blockSize = 64ull << 20);
+    ~MemoryAllocator();
+
+    MemoryAllocator(const MemoryAllocator&) = delete;
+    MemoryAllocator& operator=(const MemoryAllocator&) = delete;
+
+    // one allocator per device, shared by all its VulkanManagers: buffers outliving the item
+    // that created them (the shared document store) are still released by the others' frames
+    static std::shared_ptr<MemoryAllocator> shared(VkDevice device, VkPhysicalDevice physicalDevice);
+
+    // host visible types are mapped once for the lifetime of the block
+    Allocation allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties,
+                        Kind kind = Kind::Linear);
+    void free(Allocation& allocation);
+    // destroys the buffer and frees its allocation once the frames begun until now are done,
+    // for buffers recorded command buffers may still read
+    void release(VkBuffer buffer, Allocation& allocation);
+    // called when a frame starts, after Qt waited for its slot; the first call of a frame does
+    // the releases no frame still in flight can see
+    void beginFrame(uint32_t framesInFlight);
+    void endFrame();
+
+    // throws when no memory type matches
+    uint32_t findMemoryType(uint32_t memoryBits, VkMemoryPropertyFlags properties) const;
+    const VkPhysicalDeviceMemoryProperties& memoryProperties() const;
+    bool isHostVisible(uint32_t memoryType) const;
+
+    Statistics statistics() const;
+    void printStatistics() const;
+
+private:
+    struct Block {
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        void* mapped = nullptr;
+        uint32_t memoryType = 0;
+        Kind kind = Kind::Linear;
+        BuddyAllocator buddy;
+    };
+
+    struct Release {
+        VkBuffer buffer;
+        Allocation allocation;
+        // frames begun before the release
+        uint64_t frame;
+    };
+
+    VkDeviceMemory allocateDeviceMemory(VkDeviceSize size, uint32_t memoryType, void** mapped);
+    void releaseDeviceMemory(VkDeviceMemory memory, void* mapped);
+
+    VkDevice _device;
+    VkPhysicalDeviceMemoryProperties _memoryProperties;
+    VkDeviceSize _blockSize;
+    // released blocks leave a nullptr so indices held by allocations stay valid
+    std::vector<std::unique_ptr<Block>> _blocks;
+    size_t _dedicatedCount = 0;
+    VkDeviceSize _dedicatedBytes = 0;
+    std::deque<Release> _releases;
+    uint64_t _frameCount = 0;
+    bool _frameOpen = false;
+    mutable std::mutex _mutex;
+};
+
+}
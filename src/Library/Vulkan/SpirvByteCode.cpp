@@ -5,37 +5,64 @@
 namespace Vulkan {
 
 SpirvByteCode::SpirvByteCode(const std::vector<uint32_t>& byteCode) :
-    _byteCode(byteCode)
+    _byteCode(byteCode),
+    _code(_byteCode.data()),
+    _wordCount(_byteCode.size())
 {}
 
 SpirvByteCode::SpirvByteCode(std::vector<uint32_t>&& byteCode) :
-    _byteCode(byteCode)
+    _byteCode(std::move(byteCode)),
+    _code(_byteCode.data()),
+    _wordCount(_byteCode.size())
 {}
 
+SpirvByteCode::SpirvByteCode(const uint32_t* code, size_t wordCount) noexcept :
+    _code(code),
+    _wordCount(wordCount)
+{}
+
+SpirvByteCode::SpirvByteCode(const SpirvByteCode& other)
+{
+    *this = other;
+}
+
 SpirvByteCode::SpirvByteCode(SpirvByteCode&& other)
 {
-    _byteCode = std::move(other._byteCode);
+    *this = std::move(other);
 }
 
-SpirvByteCode& SpirvByteCode::operator=(SpirvByteCode&& other)
+SpirvByteCode& SpirvByteCode::operator=(const SpirvByteCode& other)
 {
-    _byteCode = std::move(other._byteCode);
+    if (this != &other) {
+        bool owning = !other._byteCode.empty();
+        _byteCode = other._byteCode;
+        _code = owning ? _byteCode.data() : other._code;
+        _wordCount = other._wordCount;
+    }
     return *this;
 }
 
-size_t SpirvByteCode::size() const noexcept
+SpirvByteCode& SpirvByteCode::operator=(SpirvByteCode&& other)
 {
-    return _byteCode.size();
+    if (this != &other) {
+        // moving a vector keeps its buffer, so _code stays valid for owned code too
+        _byteCode = std::move(other._byteCode);
+        _code = other._code;
+        _wordCount = other._wordCount;
+        other._code = nullptr;
+        other._wordCount = 0;
+    }
+    return *this;
 }
 
-uint32_t* SpirvByteCode::data() noexcept
+size_t SpirvByteCode::size() const noexcept
 {
-    return _byteCode.data();
+    return _wordCount * sizeof(uint32_t);
 }
 
 const uint32_t* SpirvByteCode::data() const noexcept
 {
-    return _byteCode.data();
+    return _code;
 }
 
-}
\ No newline at end of file
+}
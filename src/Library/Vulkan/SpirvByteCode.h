@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <vector>
 #include <cstdint>
 
@@ -9,20 +10,26 @@ class SpirvByteCode {
 public:
     SpirvByteCode(const std::vector<uint32_t>& byteCode);
     SpirvByteCode(std::vector<uint32_t>&& byteCode);
+    // non-owning view, code has to outlive the object (e.g. the arrays of SpirvShaders.h)
+    SpirvByteCode(const uint32_t* code, size_t wordCount) noexcept;
+    template<size_t N>
+    SpirvByteCode(const uint32_t (&code)[N]) noexcept : SpirvByteCode(code, N) {}
     SpirvByteCode() = default;
 
-    SpirvByteCode(const SpirvByteCode&) = default;
+    SpirvByteCode(const SpirvByteCode&);
     SpirvByteCode(SpirvByteCode&&);
 
-    SpirvByteCode& operator=(const SpirvByteCode&) = default;
+    SpirvByteCode& operator=(const SpirvByteCode&);
     SpirvByteCode& operator=(SpirvByteCode&&);
 
+    // in bytes, as VkShaderModuleCreateInfo::codeSize expects
     size_t size() const noexcept;
-    uint32_t* data() noexcept;
     const uint32_t* data() const noexcept;
 
 private:
     std::vector<uint32_t> _byteCode;
+    const uint32_t* _code = nullptr;
+    size_t _wordCount = 0;
 };
 
-}
\ No newline at end of file
+}
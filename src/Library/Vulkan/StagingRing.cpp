@@ -0,0 +1,167 @@
+#include "StagingRing.h"
+#include <algorithm>
+#include <cstring>
+
+namespace Vulkan {
+
+namespace {
+
+constexpr VkDeviceSize copyAlignment = 16;
+
+}
+
+StagingRing::StagingRing(const std::shared_ptr<VulkanManager>& vkManager, VkDeviceSize bytesPerFrame) :
+    VulkanComponent(vkManager),
+    _bytesPerFrame(bytesPerFrame)
+{}
+
+void StagingRing::beginFrame(uint32_t frameSlot, uint32_t framesInFlight)
+{
+    framesInFlight = std::max<uint32_t>(framesInFlight, 1);
+    if (framesInFlight != _framesInFlight) {
+        _buffer = std::make_unique<Buffer>(_vkManager);
+        _buffer->allocateMemory(_bytesPerFrame * framesInFlight, VK_BUFFER_USAGE_TRANSFER_SRC_BIT);
+        _mapped = static_cast<char*>(_buffer->map());
+        _framesInFlight = framesInFlight;
+    }
+
+    _regionBegin = (frameSlot % _framesInFlight) * _bytesPerFrame;
+    _head = 0;
+    _copies.clear();
+    _imageCopies.clear();
+}
+
+bool StagingRing::upload(VkBuffer destination, VkDeviceSize destinationOffset, const void* data, VkDeviceSize size)
+{
+    if (!_buffer || _head + size > _bytesPerFrame) {
+        return false;
+    }
+
+    VkDeviceSize source = _regionBegin + _head;
+    memcpy(_mapped + source, data, size);
+    _copies.push_back({destination, {source, destinationOffset, size}});
+    _head = (_head + size + copyAlignment - 1) & ~(copyAlignment - 1);
+    return true;
+}
+
+bool StagingRing::upload(VkImage destination, VkImageLayout layout, VkOffset2D offset, VkExtent2D extent,
+                         const void* data, VkDeviceSize size)
+{
+    if (!_buffer || _head + size > _bytesPerFrame) {
+        return false;
+    }
+
+    VkDeviceSize source = _regionBegin + _head;
+    memcpy(_mapped + source, data, size);
+    VkBufferImageCopy region = {};
+    region.bufferOffset = source;
+    region.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+    region.imageOffset = {offset.x, offset.y, 0};
+    region.imageExtent = {extent.width, extent.height, 1};
+    _imageCopies.push_back({destination, layout, region});
+    _head = (_head + size + copyAlignment - 1) & ~(copyAlignment - 1);
+    return true;
+}
+
+void StagingRing::transitionImages(VkCommandBuffer commandBuffer, bool toTransfer)
+{
+    _imageBarriers.clear();
+    for (const ImageCopy& copy : _imageCopies) {
+        if (!_imageBarriers.empty() && _imageBarriers.back().image == copy.destination) {
+            continue;
+        }
+        VkImageMemoryBarrier barrier = {};
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.srcAccessMask = toTransfer ? 0 : VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = toTransfer ? VK_ACCESS_TRANSFER_WRITE_BIT : VK_ACCESS_SHADER_READ_BIT;
+        barrier.oldLayout = toTransfer ? copy.layout : VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.newLayout = toTransfer ? VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image = copy.destination;
+        barrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+        _imageBarriers.push_back(barrier);
+    }
+    if (toTransfer) {
+        // waits for the fragment shaders of earlier frames still sampling the image
+        _vkManager->vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                                         VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr,
+                                         _imageBarriers.size(), _imageBarriers.data());
+    } else {
+        _vkManager->vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                         VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr,
+                                         _imageBarriers.size(), _imageBarriers.data());
+    }
+}
+
+void StagingRing::flush(VkCommandBuffer commandBuffer)
+{
+    if (!_imageCopies.empty()) {
+        std::stable_sort(_imageCopies.begin(), _imageCopies.end(), [](const ImageCopy& a, const ImageCopy& b) {
+            return a.destination < b.destination;
+        });
+        transitionImages(commandBuffer, true);
+        for (size_t begin = 0; begin < _imageCopies.size();) {
+            size_t end = begin;
+            _imageRegions.clear();
+            while (end < _imageCopies.size() && _imageCopies[end].destination == _imageCopies[begin].destination) {
+                _imageRegions.push_back(_imageCopies[end].region);
+                ++end;
+            }
+            _vkManager->vkCmdCopyBufferToImage(commandBuffer, *_buffer, _imageCopies[begin].destination,
+                                               VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, _imageRegions.size(),
+                                               _imageRegions.data());
+            begin = end;
+        }
+        transitionImages(commandBuffer, false);
+        _imageCopies.clear();
+    }
+
+    if (_copies.empty()) {
+        return;
+    }
+
+    // the copies may overwrite ranges earlier commands still read (another view, the previous frame)
+    _vkManager->vkCmdPipelineBarrier(commandBuffer,
+                                     VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT |
+                                     VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                     VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 0, nullptr);
+
+    std::stable_sort(_copies.begin(), _copies.end(), [](const Copy& a, const Copy& b) {
+        return a.destination < b.destination;
+    });
+
+    for (size_t begin = 0; begin < _copies.size();) {
+        size_t end = begin;
+        _regions.clear();
+        while (end < _copies.size() && _copies[end].destination == _copies[begin].destination) {
+            _regions.push_back(_copies[end].region);
+            ++end;
+        }
+        _vkManager->vkCmdCopyBuffer(commandBuffer, *_buffer, _copies[begin].destination,
+                                    _regions.size(), _regions.data());
+        begin = end;
+    }
+
+    VkMemoryBarrier barrier = {};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+    _vkManager->vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                     VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT |
+                                     VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                     0, 1, &barrier, 0, nullptr, 0, nullptr);
+    _copies.clear();
+}
+
+VkDeviceSize StagingRing::bytesPerFrame() const
+{
+    return _bytesPerFrame;
+}
+
+VkDeviceSize StagingRing::available() const
+{
+    return _buffer && _head < _bytesPerFrame ? _bytesPerFrame - _head : 0;
+}
+
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+#include "Library/Vulkan/Buffer.h"
+#include "Library/Vulkan/VulkanComponent.h"
+#include "Library/Vulkan/VulkanManager.h"
+
+namespace Vulkan {
+
+// Host visible upload buffer split into one region per frame in flight. Uploads of a
+// frame are copied into that frame's region and recorded by flush() as one
+// vkCmdCopyBuffer (or vkCmdCopyBufferToImage) per destination, so a region is reused only
+// after the GPU finished the frame that read it. Used from the render thread only.
+class StagingRing : protected VulkanComponent {
+public:
+    StagingRing(const std::shared_ptr<VulkanManager>& vkManager, VkDeviceSize bytesPerFrame);
+
+    void beginFrame(uint32_t frameSlot, uint32_t framesInFlight);
+    bool upload(VkBuffer destination, VkDeviceSize destinationOffset, const void* data, VkDeviceSize size);
+    // tightly packed texels into the first mip level and layer of a color image. flush() takes
+    // the image from the layout the first upload of the frame names (UNDEFINED discards what
+    // it holds) and leaves it SHADER_READ_ONLY_OPTIMAL for the fragment stage
+    bool upload(VkImage destination, VkImageLayout layout, VkOffset2D offset, VkExtent2D extent, const void* data,
+                VkDeviceSize size);
+    // must be recorded outside of a render pass, before the draws reading the destinations
+    void flush(VkCommandBuffer commandBuffer);
+
+    VkDeviceSize bytesPerFrame() const;
+    // bytes the next upload of this frame may take
+    VkDeviceSize available() const;
+
+private:
+    struct Copy {
+        VkBuffer destination;
+        VkBufferCopy region;
+    };
+
+    std::unique_ptr<Buffer> _buffer;
+    char* _mapped = nullptr;
+    VkDeviceSize _bytesPerFrame;
+    uint32_t _framesInFlight = 0;
+    VkDeviceSize _regionBegin = 0;
+    VkDeviceSize _head = 0;
+    struct ImageCopy {
+        VkImage destination;
+        VkImageLayout layout;
+        VkBufferImageCopy region;
+    };
+
+    // the barriers taking the images of the frame's image copies into and out of TRANSFER_DST
+    void transitionImages(VkCommandBuffer commandBuffer, bool toTransfer);
+
+    std::vector<Copy> _copies;
+    std::vector<VkBufferCopy> _regions;
+    std::vector<ImageCopy> _imageCopies;
+    std::vector<VkBufferImageCopy> _imageRegions;
+    std::vector<VkImageMemoryBarrier> _imageBarriers;
+};
+
+}
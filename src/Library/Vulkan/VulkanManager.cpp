@@ -35,6 +35,33 @@ VulkanManager::VulkanManager(QQuickItem* item) :
     _device = *static_cast<VkDevice*>(_rif->getResource(_itemWindow, QSGRendererInterface::Resource::DeviceResource));
     _physicalDevice = *static_cast<VkPhysicalDevice*>(_rif->getResource(_itemWindow, QSGRendererInterface::Resource::PhysicalDeviceResource));
 
+    _memoryAllocator = MemoryAllocator::shared(_device, _physicalDevice);
+    // emitted on the render thread once the frame is submitted
+    _frameEnd = QObject::connect(_itemWindow, &QQuickWindow::afterFrameEnd, _itemWindow,
+                                 [allocator = _memoryAllocator.get()] { allocator->endFrame(); },
+                                 Qt::DirectConnection);
+
+    VkPhysicalDeviceProperties props;
+    vkGetPhysicalDeviceProperties(_physicalDevice, &props);
+    if (props.deviceType == VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU || props.deviceType == VK_PHYSICAL_DEVICE_TYPE_CPU) {
+        _unifiedMemory = true;
+    } else {
+        // no device local memory type without host access means staging buys nothing
+        const VkPhysicalDeviceMemoryProperties& memProperties = _memoryAllocator->memoryProperties();
+        _unifiedMemory = true;
+        for (uint32_t i = 0; i < memProperties.memoryTypeCount; ++i) {
+            VkMemoryPropertyFlags flags = memProperties.memoryTypes[i].propertyFlags;
+            if ((flags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) && !(flags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)) {
+                _unifiedMemory = false;
+            }
+        }
+    }
+
+}
+
+VulkanManager::~VulkanManager()
+{
+    QObject::disconnect(_frameEnd);
 }
 
 VkShaderModule VulkanManager::createShaderModule(const SpirvByteCode& spirv) const
@@ -84,11 +111,118 @@ void VulkanManager::vkCmdDraw(VkCommandBuffer commandBuffer, uint32_t vertexCoun
     ::vkCmdDraw(commandBuffer, vertexCount, instanceCount, firstVertex, firstInstance);
 }
 
+void VulkanManager::vkCmdBindIndexBuffer(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset, VkIndexType indexType) const
+{
+    ::vkCmdBindIndexBuffer(commandBuffer, buffer, offset, indexType);
+}
+
+void VulkanManager::vkCmdDrawIndexed(VkCommandBuffer commandBuffer, uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex, int32_t vertexOffset, uint32_t firstInstance) const
+{
+    ::vkCmdDrawIndexed(commandBuffer, indexCount, instanceCount, firstIndex, vertexOffset, firstInstance);
+}
+
+void VulkanManager::vkCmdDrawIndirect(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset, uint32_t drawCount, uint32_t stride) const
+{
+    ::vkCmdDrawIndirect(commandBuffer, buffer, offset, drawCount, stride);
+}
+
+void VulkanManager::vkCmdDispatch(VkCommandBuffer commandBuffer, uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ) const
+{
+    ::vkCmdDispatch(commandBuffer, groupCountX, groupCountY, groupCountZ);
+}
+
+void VulkanManager::vkCmdBindDescriptorSets(VkCommandBuffer commandBuffer, VkPipelineBindPoint pipelineBindPoint, VkPipelineLayout layout, uint32_t firstSet,
+                                            uint32_t descriptorSetCount, const VkDescriptorSet* pDescriptorSets, uint32_t dynamicOffsetCount, const uint32_t* pDynamicOffsets) const
+{
+    ::vkCmdBindDescriptorSets(commandBuffer, pipelineBindPoint, layout, firstSet, descriptorSetCount, pDescriptorSets, dynamicOffsetCount, pDynamicOffsets);
+}
+
+void VulkanManager::vkCmdPushConstants(VkCommandBuffer commandBuffer, VkPipelineLayout layout, VkShaderStageFlags stageFlags, uint32_t offset, uint32_t size, const void* pValues) const
+{
+    ::vkCmdPushConstants(commandBuffer, layout, stageFlags, offset, size, pValues);
+}
+
+void VulkanManager::vkCmdBeginRenderPass(VkCommandBuffer commandBuffer, const VkRenderPassBeginInfo* pRenderPassBegin, VkSubpassContents contents) const
+{
+    ::vkCmdBeginRenderPass(commandBuffer, pRenderPassBegin, contents);
+}
+
+void VulkanManager::vkCmdEndRenderPass(VkCommandBuffer commandBuffer) const
+{
+    ::vkCmdEndRenderPass(commandBuffer);
+}
+
+void VulkanManager::vkCmdCopyImageToBuffer(VkCommandBuffer commandBuffer, VkImage srcImage, VkImageLayout srcImageLayout, VkBuffer dstBuffer, uint32_t regionCount, const VkBufferImageCopy* pRegions) const
+{
+    ::vkCmdCopyImageToBuffer(commandBuffer, srcImage, srcImageLayout, dstBuffer, regionCount, pRegions);
+}
+
+void VulkanManager::vkCmdUpdateBuffer(VkCommandBuffer commandBuffer, VkBuffer dstBuffer, VkDeviceSize dstOffset, VkDeviceSize dataSize, const void* pData) const
+{
+    ::vkCmdUpdateBuffer(commandBuffer, dstBuffer, dstOffset, dataSize, pData);
+}
+
+void VulkanManager::vkCmdCopyBuffer(VkCommandBuffer commandBuffer, VkBuffer srcBuffer, VkBuffer dstBuffer, uint32_t regionCount, const VkBufferCopy* pRegions) const
+{
+    ::vkCmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, regionCount, pRegions);
+}
+
+void VulkanManager::vkCmdCopyBufferToImage(VkCommandBuffer commandBuffer, VkBuffer srcBuffer, VkImage dstImage, VkImageLayout dstImageLayout, uint32_t regionCount, const VkBufferImageCopy* pRegions) const
+{
+    ::vkCmdCopyBufferToImage(commandBuffer, srcBuffer, dstImage, dstImageLayout, regionCount, pRegions);
+}
+
+void VulkanManager::vkCmdPipelineBarrier(VkCommandBuffer commandBuffer, VkPipelineStageFlags srcStageMask, VkPipelineStageFlags dstStageMask, VkDependencyFlags dependencyFlags,
+                                         uint32_t memoryBarrierCount, const VkMemoryBarrier* pMemoryBarriers,
+                                         uint32_t bufferMemoryBarrierCount, const VkBufferMemoryBarrier* pBufferMemoryBarriers,
+                                         uint32_t imageMemoryBarrierCount, const VkImageMemoryBarrier* pImageMemoryBarriers) const
+{
+    ::vkCmdPipelineBarrier(commandBuffer, srcStageMask, dstStageMask, dependencyFlags,
+                           memoryBarrierCount, pMemoryBarriers,
+                           bufferMemoryBarrierCount, pBufferMemoryBarriers,
+                           imageMemoryBarrierCount, pImageMemoryBarriers);
+}
+
 void VulkanManager::vkDestroyPipeline(VkPipeline pipeline, const VkAllocationCallbacks* pAllocator) const
 {
     ::vkDestroyPipeline(_device, pipeline, pAllocator);
 }
 
+void VulkanManager::vkDestroyDescriptorSetLayout(VkDescriptorSetLayout descriptorSetLayout, const VkAllocationCallbacks* pAllocator) const
+{
+    ::vkDestroyDescriptorSetLayout(_device, descriptorSetLayout, pAllocator);
+}
+
+void VulkanManager::vkDestroyDescriptorPool(VkDescriptorPool descriptorPool, const VkAllocationCallbacks* pAllocator) const
+{
+    ::vkDestroyDescriptorPool(_device, descriptorPool, pAllocator);
+}
+
+void VulkanManager::vkDestroyImage(VkImage image, const VkAllocationCallbacks* pAllocator) const
+{
+    ::vkDestroyImage(_device, image, pAllocator);
+}
+
+void VulkanManager::vkDestroyImageView(VkImageView imageView, const VkAllocationCallbacks* pAllocator) const
+{
+    ::vkDestroyImageView(_device, imageView, pAllocator);
+}
+
+void VulkanManager::vkDestroySampler(VkSampler sampler, const VkAllocationCallbacks* pAllocator) const
+{
+    ::vkDestroySampler(_device, sampler, pAllocator);
+}
+
+void VulkanManager::vkDestroyRenderPass(VkRenderPass renderPass, const VkAllocationCallbacks* pAllocator) const
+{
+    ::vkDestroyRenderPass(_device, renderPass, pAllocator);
+}
+
+void VulkanManager::vkDestroyFramebuffer(VkFramebuffer framebuffer, const VkAllocationCallbacks* pAllocator) const
+{
+    ::vkDestroyFramebuffer(_device, framebuffer, pAllocator);
+}
+
 void VulkanManager::vkDestroyPipelineLayout(VkPipelineLayout pipelineLayout, const VkAllocationCallbacks* pAllocator) const
 {
     ::vkDestroyPipelineLayout(_device, pipelineLayout, pAllocator);
@@ -99,6 +233,61 @@ VkResult VulkanManager::vkCreateGraphicsPipelines(VkPipelineCache pipelineCache,
     return ::vkCreateGraphicsPipelines(_device, pipelineCache, createInfoCount, pCreateInfos, pAllocator, pPipelines);
 }
 
+VkResult VulkanManager::vkCreateComputePipelines(VkPipelineCache pipelineCache, uint32_t createInfoCount, const VkComputePipelineCreateInfo* pCreateInfos, const VkAllocationCallbacks* pAllocator, VkPipeline* pPipelines) const
+{
+    return ::vkCreateComputePipelines(_device, pipelineCache, createInfoCount, pCreateInfos, pAllocator, pPipelines);
+}
+
+VkResult VulkanManager::vkCreateDescriptorSetLayout(const VkDescriptorSetLayoutCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkDescriptorSetLayout* pSetLayout) const
+{
+    return ::vkCreateDescriptorSetLayout(_device, pCreateInfo, pAllocator, pSetLayout);
+}
+
+VkResult VulkanManager::vkCreateDescriptorPool(const VkDescriptorPoolCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkDescriptorPool* pDescriptorPool) const
+{
+    return ::vkCreateDescriptorPool(_device, pCreateInfo, pAllocator, pDescriptorPool);
+}
+
+VkResult VulkanManager::vkAllocateDescriptorSets(const VkDescriptorSetAllocateInfo* pAllocateInfo, VkDescriptorSet* pDescriptorSets) const
+{
+    return ::vkAllocateDescriptorSets(_device, pAllocateInfo, pDescriptorSets);
+}
+
+void VulkanManager::vkUpdateDescriptorSets(uint32_t descriptorWriteCount, const VkWriteDescriptorSet* pDescriptorWrites, uint32_t descriptorCopyCount, const VkCopyDescriptorSet* pDescriptorCopies) const
+{
+    ::vkUpdateDescriptorSets(_device, descriptorWriteCount, pDescriptorWrites, descriptorCopyCount, pDescriptorCopies);
+}
+
+VkResult VulkanManager::vkCreateImage(const VkImageCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkImage* pImage) const
+{
+    return ::vkCreateImage(_device, pCreateInfo, pAllocator, pImage);
+}
+
+VkResult VulkanManager::vkCreateImageView(const VkImageViewCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkImageView* pView) const
+{
+    return ::vkCreateImageView(_device, pCreateInfo, pAllocator, pView);
+}
+
+VkResult VulkanManager::vkCreateSampler(const VkSamplerCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkSampler* pSampler) const
+{
+    return ::vkCreateSampler(_device, pCreateInfo, pAllocator, pSampler);
+}
+
+VkResult VulkanManager::vkCreateRenderPass(const VkRenderPassCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkRenderPass* pRenderPass) const
+{
+    return ::vkCreateRenderPass(_device, pCreateInfo, pAllocator, pRenderPass);
+}
+
+VkResult VulkanManager::vkCreateFramebuffer(const VkFramebufferCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkFramebuffer* pFramebuffer) const
+{
+    return ::vkCreateFramebuffer(_device, pCreateInfo, pAllocator, pFramebuffer);
+}
+
+bool VulkanManager::isUnifiedMemory() const
+{
+    return _unifiedMemory;
+}
+
 void VulkanManager::printDebug() const
 {
         // Test that device functions work with a simple call
@@ -109,6 +298,8 @@ void VulkanManager::printDebug() const
     VkPhysicalDeviceFeatures features;
     vkGetPhysicalDeviceFeatures(_physicalDevice, &features);
     qDebug("wideline supported: %d", features.wideLines);
+
+    _memoryAllocator->printStatistics();
 }
 
 VkResult VulkanManager::vkCreateCommandPool(const VkCommandPoolCreateInfo* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkCommandPool* pCommandPool) const
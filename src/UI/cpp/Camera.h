@@ -0,0 +1,23 @@
+#pragma once
+
+#include <QMatrix4x4>
+#include <QPointF>
+#include <QSizeF>
+
+// 2D view of the document: offset is the pan in item pixels, zoom the scale around the item center
+struct Camera
+{
+    float zoom = 1.0f;
+    QPointF offset;
+
+    // document coordinates to clip space for an item of the given size
+    QMatrix4x4 documentToClip(const QSizeF& itemSize) const
+    {
+        QMatrix4x4 mvp;
+        mvp.scale(zoom);
+        mvp.translate((float)(offset.x() / itemSize.width()) / zoom, (float)(offset.y() / itemSize.height()) / zoom, 0);
+        return mvp;
+    }
+
+    bool operator==(const Camera&) const = default;
+};
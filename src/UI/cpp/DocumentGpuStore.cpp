@@ -0,0 +1,76 @@
+#include "DocumentGpuStore.h"
+#include <map>
+#include <mutex>
+#include <utility>
+
+DocumentGpuStore::Layer::Layer(std::shared_ptr<Vulkan::VulkanManager>& vkManager) :
+    lines(vkManager, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT),
+    circles(vkManager, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT),
+    arcs(vkManager, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT),
+    polylines(vkManager)
+{
+    // the culler binds line chunks as storage buffers, their offsets stay multiples of 256,
+    // the largest minStorageBufferOffsetAlignment allowed, for every power of two capacity
+    static_assert(Lines::minCapacity * sizeof(Geometry::Line) % 256 == 0);
+}
+
+DocumentGpuStore::DocumentGpuStore(std::shared_ptr<Vulkan::VulkanManager>& vkManager, uint64_t document) :
+    VulkanComponent(vkManager),
+    _document(document),
+    _culler(vkManager),
+    _styleTable(vkManager)
+{}
+
+std::shared_ptr<DocumentGpuStore> DocumentGpuStore::shared(std::shared_ptr<Vulkan::VulkanManager>& vkManager,
+                                                           uint64_t document)
+{
+    // windows may render on different threads, each with its own device
+    static std::mutex mutex;
+    static std::map<std::pair<VkDevice, uint64_t>, std::weak_ptr<DocumentGpuStore>> stores;
+
+    std::lock_guard lock(mutex);
+    std::erase_if(stores, [](const auto& entry) { return entry.second.expired(); });
+
+    auto& entry = stores[{vkManager->device(), document}];
+    std::shared_ptr<DocumentGpuStore> store = entry.lock();
+    if (!store) {
+        store = std::make_shared<DocumentGpuStore>(vkManager, document);
+        entry = store;
+    }
+    return store;
+}
+
+void DocumentGpuStore::setSnapshot(const Geometry::DocumentSnapshot& snapshot)
+{
+    // a style change only replaces the table, the lists below see the same chunks and skip them
+    if (snapshot.layersVersion > _layersVersion) {
+        _layersVersion = snapshot.layersVersion;
+        _styles = snapshot.styles;
+        _styleTable.setStyles(snapshot.styles, snapshot.layersVersion);
+    }
+    while (_layers.size() < snapshot.layers.size()) {
+        _layers.push_back(std::make_unique<Layer>(_vkManager));
+    }
+    for (size_t i = 0; i < snapshot.layers.size(); ++i) {
+        Layer& layer = *_layers[i];
+        layer.lines.setSnapshot(snapshot.layers[i].lines);
+        layer.circles.setSnapshot(snapshot.layers[i].circles);
+        layer.arcs.setSnapshot(snapshot.layers[i].arcs);
+        layer.polylines.setSnapshot(snapshot.layers[i].polylines);
+    }
+}
+
+void DocumentGpuStore::upload(Vulkan::StagingRing& ring)
+{
+    // the table first, a restyle shows up even while a large import is still uploading;
+    // a full ring stops everything after it too, the next frame continues in the same order
+    if (!_styleTable.upload(ring)) {
+        return;
+    }
+    for (const std::unique_ptr<Layer>& layer : _layers) {
+        if (!layer->lines.upload(ring) || !layer->circles.upload(ring) || !layer->arcs.upload(ring) ||
+            !layer->polylines.upload(ring)) {
+            return;
+        }
+    }
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+#include "Library/Vulkan/StagingRing.h"
+#include "Library/Vulkan/VulkanComponent.h"
+#include "Library/Vulkan/VulkanManager.h"
+#include "UI/cpp/Geometry/Document.h"
+#include "UI/cpp/GpuChunkList.h"
+#include "UI/cpp/GpuPolylineList.h"
+#include "UI/cpp/LineCuller.h"
+#include "UI/cpp/StyleTable.h"
+
+// GPU copy of the document, a GpuChunkList per entity list of every layer plus the style table.
+// There is one store per device and document, every view showing the document culls and draws
+// from the same buffers through its own DocumentView. Works on the newest document snapshot any
+// of the views was sent, so the render thread never touches the lists the GUI thread edits.
+// Circles and arcs are stored as they are and drawn as one instanced quad each, polylines as
+// indexed line strips.
+class DocumentGpuStore : protected Vulkan::VulkanComponent {
+public:
+    using Lines = GpuChunkList<Geometry::Line, Geometry::BoundingBox>;
+    using Circles = GpuChunkList<Geometry::Circle, Geometry::BoundingBox>;
+    using Arcs = GpuChunkList<Geometry::Arc, Geometry::BoundingBox>;
+
+    struct Layer {
+        Layer(std::shared_ptr<Vulkan::VulkanManager>& vkManager);
+
+        Lines lines;
+        Circles circles;
+        Arcs arcs;
+        GpuPolylineList polylines;
+    };
+
+    DocumentGpuStore(std::shared_ptr<Vulkan::VulkanManager>& vkManager, uint64_t document);
+
+    // the store of the document on the manager's device, created when no view holds one yet
+    static std::shared_ptr<DocumentGpuStore> shared(std::shared_ptr<Vulkan::VulkanManager>& vkManager, uint64_t document);
+
+    uint64_t document() const { return _document; }
+
+    // lists the store already has newer snapshots of keep them
+    void setSnapshot(const Geometry::DocumentSnapshot& snapshot);
+
+    // every view calls it, there's nothing left to do once the snapshot is on the GPU;
+    // chunks that don't fit into the ring are continued by the next call
+    void upload(Vulkan::StagingRing& ring);
+
+    // layers are never removed, an index stays the same layer
+    size_t layerCount() const { return _layers.size(); }
+    const Layer& layer(size_t index) const { return *_layers[index]; }
+    // of the newest snapshot, drawing needs their visibility and widths on the CPU as well
+    const std::vector<Geometry::LayerStyle>& styles() const { return _styles; }
+    const StyleTable& styleTable() const { return _styleTable; }
+    LineCuller& culler() { return _culler; }
+
+private:
+    uint64_t _document;
+    LineCuller _culler;
+    StyleTable _styleTable;
+    std::vector<Geometry::LayerStyle> _styles;
+    uint64_t _layersVersion = 0;
+    std::vector<std::unique_ptr<Layer>> _layers;
+};
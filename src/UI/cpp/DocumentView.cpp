@@ -0,0 +1,213 @@
+#include "DocumentView.h"
+#include <algorithm>
+#include <utility>
+
+namespace {
+
+Geometry::BoundingBox toBox(const QRectF& rect)
+{
+    QRectF normalized = rect.normalized();
+    Geometry::BoundingBox box;
+    box.expand((float)normalized.left(), (float)normalized.top());
+    box.expand((float)normalized.right(), (float)normalized.bottom());
+    return box;
+}
+
+bool contains(const Geometry::BoundingBox& outer, const Geometry::BoundingBox& inner)
+{
+    return outer.min[0] <= inner.min[0] && outer.min[1] <= inner.min[1] &&
+           inner.max[0] <= outer.max[0] && inner.max[1] <= outer.max[1];
+}
+
+}
+
+DocumentView::DocumentView(std::shared_ptr<Vulkan::VulkanManager>& vkManager) :
+    VulkanComponent(vkManager)
+{}
+
+void DocumentView::setStore(std::shared_ptr<DocumentGpuStore> store)
+{
+    if (_store == store) {
+        return;
+    }
+    // the descriptor sets point into the old store's buffers and were allocated from its culler
+    _layers.clear();
+    _store = std::move(store);
+}
+
+void DocumentView::allocateChunk(Chunk& chunk, const DocumentGpuStore::Lines::Chunk& lines)
+{
+    // the buffer before is released once the frames drawing it are done; its descriptor set stays
+    // in the culler's pools, at most once for every doubling of the store's buffer
+    chunk.capacity = lines.capacity;
+    chunk.linesBytes = lines.capacity * sizeof(Geometry::Line);
+    chunk.culled = std::make_unique<Vulkan::Buffer>(_vkManager);
+    chunk.culled->allocateMemory(chunk.linesBytes + sizeof(VkDrawIndirectCommand),
+                                 VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                                 VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                 Vulkan::Buffer::Location::DeviceLocal);
+
+    VkBuffer culled = *chunk.culled;
+    VkDescriptorBufferInfo ranges[3] = {
+        {*lines.buffer, 0, chunk.linesBytes},
+        {culled, 0, chunk.linesBytes},
+        {culled, chunk.linesBytes, sizeof(VkDrawIndirectCommand)},
+    };
+    chunk.descriptorSet = _store->culler().createDescriptorSet(ranges);
+}
+
+template<typename List>
+void DocumentView::cullByBox(const List& list, const Geometry::BoundingBox& view, std::vector<BoxChunk>& chunks)
+{
+    chunks.resize(list.chunkCount());
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        chunks[i].count = list.chunk(i).uploadedCount;
+        chunks[i].visible = chunks[i].count > 0 && i < list.snapshot()->chunkCount() &&
+                            view.intersects(list.snapshot()->chunk(i).summary);
+    }
+}
+
+template<typename List>
+void DocumentView::drawCurves(VkCommandBuffer commandBuffer, const List& list, const std::vector<BoxChunk>& chunks)
+{
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        if (!chunks[i].visible) {
+            continue;
+        }
+        // see draw(), another view's upload may have moved the chunk into a bigger buffer since
+        size_t count = std::min(chunks[i].count, list.chunk(i).uploadedCount);
+        if (count == 0) {
+            continue;
+        }
+        VkBuffer buffer = *list.chunk(i).buffer;
+        VkDeviceSize offset = 0;
+        _vkManager->vkCmdBindVertexBuffers(commandBuffer, 0, 1, &buffer, &offset);
+        // a quad as triangle strip per instance
+        _vkManager->vkCmdDraw(commandBuffer, 4, count, 0, 0);
+    }
+}
+
+void DocumentView::cullLines(LayerView& layer, const DocumentGpuStore::Lines& lines, const Geometry::BoundingBox& view)
+{
+    if (!lines.snapshot()) {
+        return;
+    }
+    const auto& storage = *lines.snapshot();
+
+    if (layer.chunks.size() < lines.chunkCount()) {
+        layer.chunks.resize(lines.chunkCount());
+    }
+
+    for (size_t i = 0; i < layer.chunks.size(); ++i) {
+        Chunk& chunk = layer.chunks[i];
+        chunk.visibility = Visibility::Hidden;
+        chunk.count = lines.chunk(i).uploadedCount;
+        if (chunk.count == 0 || i >= storage.chunkCount()) {
+            continue;
+        }
+
+        const Geometry::BoundingBox& box = storage.chunk(i).summary;
+        if (contains(view, box)) {
+            chunk.visibility = Visibility::Inside;
+        } else if (view.intersects(box)) {
+            if (chunk.capacity != lines.chunk(i).capacity) {
+                allocateChunk(chunk, lines.chunk(i));
+            }
+            chunk.visibility = Visibility::Partial;
+            _jobs.push_back({chunk.descriptorSet, *chunk.culled, chunk.linesBytes, (uint32_t)chunk.count});
+        }
+    }
+}
+
+void DocumentView::cull(VkCommandBuffer commandBuffer, const QRectF& view)
+{
+    if (!_store) {
+        return;
+    }
+    Geometry::BoundingBox viewBox = toBox(view);
+    const std::vector<Geometry::LayerStyle>& styles = _store->styles();
+
+    // layers past the style table have no style to be drawn with
+    _layers.resize(std::min(_store->layerCount(), StyleTable::capacity));
+    _jobs.clear();
+    for (size_t i = 0; i < _layers.size(); ++i) {
+        LayerView& layer = _layers[i];
+        layer.visible = i < styles.size() && styles[i].visible();
+        if (!layer.visible) {
+            continue;
+        }
+        const DocumentGpuStore::Layer& source = _store->layer(i);
+        cullByBox(source.circles, viewBox, layer.circleChunks);
+        cullByBox(source.arcs, viewBox, layer.arcChunks);
+        cullByBox(source.polylines.vertices(), viewBox, layer.polylineChunks);
+        cullLines(layer, source.lines, viewBox);
+    }
+
+    _store->culler().record(commandBuffer, view, _jobs);
+}
+
+void DocumentView::draw(VkCommandBuffer commandBuffer, size_t layer)
+{
+    if (!_layers[layer].visible) {
+        return;
+    }
+    const DocumentGpuStore::Lines& lines = _store->layer(layer).lines;
+    for (size_t i = 0; i < _layers[layer].chunks.size(); ++i) {
+        Chunk& chunk = _layers[layer].chunks[i];
+        if (chunk.visibility == Visibility::Hidden) {
+            continue;
+        }
+
+        VkDeviceSize offset = 0;
+        if (chunk.visibility == Visibility::Inside) {
+            // the buffer and its count are read together now: a view sharing the store uploads in
+            // its prepare() after this one culled, growing a chunk swaps in a buffer that only holds
+            // what was uploaded into it since
+            size_t count = std::min(chunk.count, lines.chunk(i).uploadedCount);
+            if (count == 0) {
+                continue;
+            }
+            VkBuffer buffer = *lines.chunk(i).buffer;
+            _vkManager->vkCmdBindVertexBuffers(commandBuffer, 0, 1, &buffer, &offset);
+            _vkManager->vkCmdDraw(commandBuffer, count * 2, 1, 0, 0);
+        } else {
+            VkBuffer buffer = *chunk.culled;
+            _vkManager->vkCmdBindVertexBuffers(commandBuffer, 0, 1, &buffer, &offset);
+            _vkManager->vkCmdDrawIndirect(commandBuffer, buffer, chunk.linesBytes, 1, sizeof(VkDrawIndirectCommand));
+        }
+    }
+}
+
+void DocumentView::drawCircles(VkCommandBuffer commandBuffer, size_t layer)
+{
+    if (_layers[layer].visible) {
+        drawCurves(commandBuffer, _store->layer(layer).circles, _layers[layer].circleChunks);
+    }
+}
+
+void DocumentView::drawArcs(VkCommandBuffer commandBuffer, size_t layer)
+{
+    if (_layers[layer].visible) {
+        drawCurves(commandBuffer, _store->layer(layer).arcs, _layers[layer].arcChunks);
+    }
+}
+
+void DocumentView::drawPolylines(VkCommandBuffer commandBuffer, size_t layer)
+{
+    if (!_layers[layer].visible) {
+        return;
+    }
+    const GpuPolylineList& polylines = _store->layer(layer).polylines;
+    const std::vector<BoxChunk>& chunks = _layers[layer].polylineChunks;
+    for (size_t i = 0; i < chunks.size() && i < polylines.indexChunkCount(); ++i) {
+        const GpuPolylineList::IndexChunk& indices = polylines.indexChunk(i);
+        if (!chunks[i].visible || indices.uploadedCount == 0) {
+            continue;
+        }
+        VkBuffer buffer = *polylines.vertices().chunk(i).buffer;
+        VkDeviceSize offset = 0;
+        _vkManager->vkCmdBindVertexBuffers(commandBuffer, 0, 1, &buffer, &offset);
+        _vkManager->vkCmdBindIndexBuffer(commandBuffer, *indices.buffer, 0, VK_INDEX_TYPE_UINT32);
+        _vkManager->vkCmdDrawIndexed(commandBuffer, indices.uploadedCount, 1, 0, 0, 0);
+    }
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <QRectF>
+#include <memory>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+#include "Library/Vulkan/Buffer.h"
+#include "Library/Vulkan/VulkanComponent.h"
+#include "Library/Vulkan/VulkanManager.h"
+#include "UI/cpp/DocumentGpuStore.h"
+#include "UI/cpp/LineCuller.h"
+
+// What one view sees of a DocumentGpuStore. The geometry stays in the store, a view only owns
+// the culling output: per line chunk crossing the view's border a device local buffer
+// [culled lines | VkDrawIndirectCommand] as big as the store's buffer of the chunk.
+// Line chunks entirely inside the view are drawn straight from the store, chunks crossing its
+// border go through the culling pass, so another view costs a dispatch and its draws, not a copy
+// of the document. Circle, arc and polyline chunks are only tested by their boxes, whatever of
+// them lies outside the view is clipped. Hidden layers are skipped as a whole, neither culled
+// nor drawn.
+class DocumentView : protected Vulkan::VulkanComponent {
+public:
+    DocumentView(std::shared_ptr<Vulkan::VulkanManager>& vkManager);
+
+    void setStore(std::shared_ptr<DocumentGpuStore> store);
+    const std::shared_ptr<DocumentGpuStore>& store() const { return _store; }
+
+    // after the ring holding the store's uploads was flushed, outside of the render pass
+    void cull(VkCommandBuffer commandBuffer, const QRectF& view);
+
+    // layers of the last cull(), the draws of a hidden one record nothing
+    size_t layerCount() const { return _layers.size(); }
+    bool layerVisible(size_t layer) const { return _layers[layer].visible; }
+
+    // inside the render pass with the document line pipeline bound and the layer pushed
+    void draw(VkCommandBuffer commandBuffer, size_t layer);
+    // inside the render pass with the circle, respectively arc pipeline bound, one instance per entity
+    void drawCircles(VkCommandBuffer commandBuffer, size_t layer);
+    void drawArcs(VkCommandBuffer commandBuffer, size_t layer);
+    // inside the render pass with the document line strip pipeline bound and the layer pushed
+    void drawPolylines(VkCommandBuffer commandBuffer, size_t layer);
+
+private:
+    enum class Visibility {
+        Hidden,
+        Inside,
+        Partial,
+    };
+
+    struct Chunk {
+        std::unique_ptr<Vulkan::Buffer> culled;
+        // of the store's buffer the descriptor set reads, it only grows and a bigger one is a new buffer
+        size_t capacity = 0;
+        // offset of the VkDrawIndirectCommand
+        VkDeviceSize linesBytes = 0;
+        VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+        Visibility visibility = Visibility::Hidden;
+        // uploaded lines at cull(), drawn when the chunk is inside the view unless the store has fewer by then
+        size_t count = 0;
+    };
+
+    // a chunk culled by its bounding box only
+    struct BoxChunk {
+        bool visible = false;
+        // like Chunk::count
+        size_t count = 0;
+    };
+
+    struct LayerView {
+        bool visible = false;
+        std::vector<Chunk> chunks;
+        std::vector<BoxChunk> circleChunks;
+        std::vector<BoxChunk> arcChunks;
+        std::vector<BoxChunk> polylineChunks;
+    };
+
+    void allocateChunk(Chunk& chunk, const DocumentGpuStore::Lines::Chunk& lines);
+    void cullLines(LayerView& layer, const DocumentGpuStore::Lines& lines, const Geometry::BoundingBox& view);
+    template<typename List>
+    static void cullByBox(const List& list, const Geometry::BoundingBox& view, std::vector<BoxChunk>& chunks);
+    template<typename List>
+    void drawCurves(VkCommandBuffer commandBuffer, const List& list, const std::vector<BoxChunk>& chunks);
+
+    std::shared_ptr<DocumentGpuStore> _store;
+    std::vector<LayerView> _layers;
+    // of all layers, dispatched together
+    std::vector<LineCuller::Job> _jobs;
+};
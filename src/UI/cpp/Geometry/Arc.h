@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+namespace Geometry {
+
+// the part of a circle from startAngle to startAngle + sweepAngle, in radians with positive
+// angles turning from +x towards +y of the document; sweepAngle is in (0, 2pi]
+struct Arc
+{
+    float center[2];
+    float radius;
+    // see packColor(), kept at the same offset as in Circle
+    uint32_t color;
+    float startAngle;
+    float sweepAngle;
+
+    float endAngle() const
+    {
+        return startAngle + sweepAngle;
+    }
+
+    void pointAt(float angle, float point[2]) const
+    {
+        point[0] = center[0] + radius * std::cos(angle);
+        point[1] = center[1] + radius * std::sin(angle);
+    }
+};
+
+static_assert(sizeof(Arc) == 24);
+
+}
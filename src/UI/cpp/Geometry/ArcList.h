@@ -0,0 +1,13 @@
+#pragma once
+
+#include "Library/Flux/MutableList.h"
+#include "Arc.h"
+#include "BoundingBox.h"
+
+namespace Geometry {
+
+// document arcs, every storage chunk carries the bounding box of its arcs
+using ArcList = Flux::MutableList<Arc, BoundingBox>;
+using ArcSnapshot = ArcList::Snapshot;
+
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numbers>
+
+#include "Arc.h"
+#include "Circle.h"
+#include "Line.h"
+#include "Vertex.h"
+
+namespace Geometry {
+
+struct BoundingBox
+{
+    float min[2] = {std::numeric_limits<float>::max(), std::numeric_limits<float>::max()};
+    float max[2] = {std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest()};
+
+    bool isEmpty() const
+    {
+        return min[0] > max[0] || min[1] > max[1];
+    }
+
+    float width() const
+    {
+        return isEmpty() ? 0.0f : max[0] - min[0];
+    }
+
+    float height() const
+    {
+        return isEmpty() ? 0.0f : max[1] - min[1];
+    }
+
+    void expand(float x, float y)
+    {
+        min[0] = std::min(min[0], x);
+        min[1] = std::min(min[1], y);
+        max[0] = std::max(max[0], x);
+        max[1] = std::max(max[1], y);
+    }
+
+    void expand(const Vertex& vertex)
+    {
+        expand(vertex.pos[0], vertex.pos[1]);
+    }
+
+    void expand(const Line& line)
+    {
+        expand(line.vertices[0]);
+        expand(line.vertices[1]);
+    }
+
+    void expand(const Circle& circle)
+    {
+        expand(circle.center[0] - circle.radius, circle.center[1] - circle.radius);
+        expand(circle.center[0] + circle.radius, circle.center[1] + circle.radius);
+    }
+
+    // the end points and every axis extreme the arc passes
+    void expand(const Arc& arc)
+    {
+        float point[2];
+        arc.pointAt(arc.startAngle, point);
+        expand(point[0], point[1]);
+        arc.pointAt(arc.endAngle(), point);
+        expand(point[0], point[1]);
+
+        constexpr float quarter = std::numbers::pi_v<float> / 2;
+        float extreme = std::ceil(arc.startAngle / quarter) * quarter;
+        for (int i = 0; i < 4 && extreme < arc.endAngle(); ++i, extreme += quarter) {
+            arc.pointAt(extreme, point);
+            expand(point[0], point[1]);
+        }
+    }
+
+    void expand(const BoundingBox& other)
+    {
+        if (!other.isEmpty()) {
+            expand(other.min[0], other.min[1]);
+            expand(other.max[0], other.max[1]);
+        }
+    }
+
+    bool intersects(const BoundingBox& other) const
+    {
+        return min[0] <= other.max[0] && other.min[0] <= max[0] &&
+               min[1] <= other.max[1] && other.min[1] <= max[1];
+    }
+};
+
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Geometry {
+
+// drawn analytically as one instanced quad, no tessellation is stored
+struct Circle
+{
+    float center[2];
+    float radius;
+    // see packColor()
+    uint32_t color;
+};
+
+static_assert(sizeof(Circle) == 16);
+
+}
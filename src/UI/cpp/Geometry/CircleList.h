@@ -0,0 +1,13 @@
+#pragma once
+
+#include "Library/Flux/MutableList.h"
+#include "BoundingBox.h"
+#include "Circle.h"
+
+namespace Geometry {
+
+// document circles, every storage chunk carries the bounding box of its circles
+using CircleList = Flux::MutableList<Circle, BoundingBox>;
+using CircleSnapshot = CircleList::Snapshot;
+
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+
+namespace Geometry {
+
+// RGBA8 with red in the lowest byte, read by the shaders as VK_FORMAT_R8G8B8A8_UNORM
+inline uint32_t packColor(float r, float g, float b, float a = 1.0f)
+{
+    auto channel = [](float value) {
+        return static_cast<uint32_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * 255.0f));
+    };
+    return channel(r) | channel(g) << 8 | channel(b) << 16 | channel(a) << 24;
+}
+
+inline std::array<float, 3> unpackColor(uint32_t color)
+{
+    return {(color & 0xFF) / 255.0f, (color >> 8 & 0xFF) / 255.0f, (color >> 16 & 0xFF) / 255.0f};
+}
+
+}
@@ -0,0 +1,437 @@
+#include "ContourGenerator.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+#include "Library/Concurrency/ThreadPool.h"
+
+namespace Geometry {
+
+namespace {
+
+constexpr uint32_t none = std::numeric_limits<uint32_t>::max();
+// bits of a crossing key taken by the edge, the level is above them
+constexpr int edgeBits = 40;
+constexpr uint64_t edgeMask = (uint64_t(1) << edgeBits) - 1;
+constexpr int64_t maxLevels = int64_t(1) << (64 - edgeBits);
+// cells along a side of a tile of a grid
+constexpr uint32_t tileCells = 256;
+
+// where a line crosses an edge at a level; the same from the faces on both sides
+uint64_t crossingKey(uint32_t level, uint64_t edge)
+{
+    return (uint64_t)level << edgeBits | edge;
+}
+
+// the multiples of the interval from the base between two elevations, numbered from the lowest
+class Levels
+{
+public:
+    Levels(double lowest, double highest, const ContourGenerator::Options& options) :
+        _base(options.base),
+        _interval(options.interval)
+    {
+        if (!(_interval > 0.0) || !std::isfinite(_interval) || !std::isfinite(_base)) {
+            throw std::runtime_error("the contour interval must be positive");
+        }
+        if (!(lowest <= highest)) {
+            return;
+        }
+        double first = std::floor((lowest - _base) / _interval) + 1.0;
+        double last = std::floor((highest - _base) / _interval);
+        // the level numbers stay exact in doubles
+        if (last - first + 1.0 > (double)maxLevels || std::abs(first) > 0x1p52) {
+            throw std::runtime_error("the contour interval gives too many levels");
+        }
+        _first = (int64_t)first;
+        _count = std::max<int64_t>(0, above(highest));
+    }
+
+    uint32_t count() const { return (uint32_t)_count; }
+
+    double at(int64_t level) const { return _base + (double)(_first + level) * _interval; }
+
+    // the levels a face with these elevations is cut at, [begin, end) with low < at() <= high;
+    // a height on a level counts as above it
+    std::pair<uint32_t, uint32_t> crossing(double low, double high) const
+    {
+        int64_t begin = std::clamp<int64_t>(above(low), 0, _count);
+        int64_t end = std::clamp<int64_t>(above(high), 0, _count);
+        return {(uint32_t)begin, (uint32_t)std::max(begin, end)};
+    }
+
+private:
+    // the first level higher than the value, exact whatever the division rounded to
+    int64_t above(double value) const
+    {
+        int64_t level = (int64_t)std::floor((value - _base) / _interval) + 1 - _first;
+        while (at(level - 1) > value) {
+            --level;
+        }
+        while (at(level) <= value) {
+            ++level;
+        }
+        return level;
+    }
+
+    double _base;
+    double _interval;
+    int64_t _first = 0;
+    int64_t _count = 0;
+};
+
+struct Segment
+{
+    uint64_t start;
+    uint64_t end;
+};
+
+// The segments of a face at a level. Corners counterclockwise, edge i from corner i to the next
+// one; a segment runs from the edge where the ground goes below the level to the one where it
+// comes up again, which keeps the higher ground on its left. A saddle of a grid cell has two,
+// joined across the cell's middle when that is above.
+template<int n>
+void cut(const double (&z)[n], const uint64_t (&edges)[n], uint32_t level, double height, bool middleAbove,
+         std::vector<Segment>& segments)
+{
+    int starts[2];
+    int ends[2];
+    int startCount = 0;
+    int endCount = 0;
+    for (int i = 0; i < n; ++i) {
+        bool from = z[i] >= height;
+        bool to = z[(i + 1) % n] >= height;
+        if (from && !to) {
+            starts[startCount++] = i;
+        } else if (!from && to) {
+            ends[endCount++] = i;
+        }
+    }
+    if (startCount == 1) {
+        segments.push_back({crossingKey(level, edges[starts[0]]), crossingKey(level, edges[ends[0]])});
+        return;
+    }
+    for (int j = 0; j < startCount; ++j) {
+        int end = middleAbove ? (starts[j] + 1) % n : (starts[j] + n - 1) % n;
+        segments.push_back({crossingKey(level, edges[starts[j]]), crossingKey(level, edges[end])});
+    }
+}
+
+// the edges of a Tin are its half-edges, the lower of the two of an inner edge
+class TinSurface
+{
+public:
+    TinSurface(const Tin& tin) :
+        _tin(tin)
+    {}
+
+    size_t tileCount() const { return _tin.chunks().size(); }
+
+    void segments(size_t tile, const Levels& levels, std::vector<Segment>& segments) const
+    {
+        const std::vector<TinPoint>& points = _tin.points();
+        const std::vector<uint32_t>& triangles = _tin.triangles();
+        const std::vector<uint32_t>& opposites = _tin.opposites();
+        const Tin::Chunk& chunk = _tin.chunks()[tile];
+        for (uint32_t t = chunk.firstTriangle; t < chunk.firstTriangle + chunk.triangleCount; ++t) {
+            double z[3] = {points[triangles[3 * t]].pos[2], points[triangles[3 * t + 1]].pos[2],
+                           points[triangles[3 * t + 2]].pos[2]};
+            auto [begin, end] = levels.crossing(std::min({z[0], z[1], z[2]}), std::max({z[0], z[1], z[2]}));
+            if (begin == end) {
+                continue;
+            }
+            uint64_t edges[3];
+            for (uint32_t i = 0; i < 3; ++i) {
+                uint32_t opposite = opposites[3 * t + i];
+                edges[i] = opposite == Tin::none ? 3 * t + i : std::min(3 * t + i, opposite);
+            }
+            for (uint32_t level = begin; level < end; ++level) {
+                cut(z, edges, level, levels.at(level), false, segments);
+            }
+        }
+    }
+
+    // from the start of the half-edge, both faces of the edge interpolate in the same direction
+    void point(uint64_t edge, double height, double position[2]) const
+    {
+        const TinPoint& from = _tin.points()[_tin.triangles()[edge]];
+        const TinPoint& to = _tin.points()[_tin.triangles()[Tin::next((uint32_t)edge)]];
+        double t = (height - from.pos[2]) / (to.pos[2] - from.pos[2]);
+        position[0] = from.pos[0] + t * (to.pos[0] - from.pos[0]);
+        position[1] = from.pos[1] + t * (to.pos[1] - from.pos[1]);
+    }
+
+private:
+    const Tin& _tin;
+};
+
+// edge 2i runs from sample i along its row to the next column, edge 2i + 1 to the next row
+class GridSurface
+{
+public:
+    GridSurface(const ElevationGrid& grid) :
+        _grid(grid),
+        _tileColumns(grid.columns > 1 ? (grid.columns - 2) / tileCells + 1 : 0),
+        _tileRows(grid.rows > 1 ? (grid.rows - 2) / tileCells + 1 : 0)
+    {}
+
+    size_t tileCount() const { return (size_t)_tileColumns * _tileRows; }
+
+    void segments(size_t tile, const Levels& levels, std::vector<Segment>& segments) const
+    {
+        uint32_t firstRow = (uint32_t)(tile / _tileColumns) * tileCells;
+        uint32_t firstColumn = (uint32_t)(tile % _tileColumns) * tileCells;
+        uint32_t lastRow = std::min(firstRow + tileCells, _grid.rows - 1);
+        uint32_t lastColumn = std::min(firstColumn + tileCells, _grid.columns - 1);
+        for (uint32_t row = firstRow; row < lastRow; ++row) {
+            for (uint32_t column = firstColumn; column < lastColumn; ++column) {
+                // counterclockwise from the first sample, rows go up along y
+                double z[4] = {_grid.at(row, column), _grid.at(row, column + 1), _grid.at(row + 1, column + 1),
+                               _grid.at(row + 1, column)};
+                if (std::isnan(z[0]) || std::isnan(z[1]) || std::isnan(z[2]) || std::isnan(z[3])) {
+                    continue;
+                }
+                auto [begin, end] = levels.crossing(std::min({z[0], z[1], z[2], z[3]}),
+                                                    std::max({z[0], z[1], z[2], z[3]}));
+                if (begin == end) {
+                    continue;
+                }
+                uint64_t sample = (uint64_t)row * _grid.columns + column;
+                uint64_t edges[4] = {2 * sample, 2 * (sample + 1) + 1, 2 * (sample + _grid.columns),
+                                     2 * sample + 1};
+                double middle = (z[0] + z[1] + z[2] + z[3]) / 4.0;
+                for (uint32_t level = begin; level < end; ++level) {
+                    double height = levels.at(level);
+                    cut(z, edges, level, height, middle >= height, segments);
+                }
+            }
+        }
+    }
+
+    void point(uint64_t edge, double height, double position[2]) const
+    {
+        uint64_t sample = edge >> 1;
+        uint32_t row = (uint32_t)(sample / _grid.columns);
+        uint32_t column = (uint32_t)(sample % _grid.columns);
+        bool alongRow = (edge & 1) == 0;
+        double from = _grid.at(row, column);
+        double to = alongRow ? _grid.at(row, column + 1) : _grid.at(row + 1, column);
+        double t = (height - from) / (to - from);
+        position[0] = _grid.origin[0] + (column + (alongRow ? t : 0.0)) * _grid.spacing;
+        position[1] = _grid.origin[1] + (row + (alongRow ? 0.0 : t)) * _grid.spacing;
+    }
+
+private:
+    const ElevationGrid& _grid;
+    uint32_t _tileColumns;
+    uint32_t _tileRows;
+};
+
+// a chain of segments; where it is open, its ends wait for the pieces of the tiles next to it
+struct Piece
+{
+    uint32_t level;
+    uint64_t start;
+    uint64_t end;
+    QVector<Vertex> vertices;
+    bool closed;
+};
+
+// a point on a level through a vertex may come twice in a row, it is kept once
+void appendVertex(QVector<Vertex>& vertices, const Vertex& vertex)
+{
+    if (vertices.isEmpty() || vertices.back().pos[0] != vertex.pos[0] || vertices.back().pos[1] != vertex.pos[1]) {
+        vertices.append(vertex);
+    }
+}
+
+// Follows every segment to the one starting where it ends. Each crossing starts at most one
+// segment and ends at most one, so what isn't reached from a chain's first segment is a loop.
+template<typename Item, typename Visit>
+void follow(const std::vector<Item>& items, const std::vector<uint32_t>& next, Visit visit)
+{
+    std::vector<bool> hasPrevious(items.size(), false);
+    for (uint32_t successor : next) {
+        if (successor != none) {
+            hasPrevious[successor] = true;
+        }
+    }
+    std::vector<bool> visited(items.size(), false);
+    std::vector<uint32_t> chain;
+    auto walk = [&](uint32_t first, bool loop) {
+        chain.clear();
+        for (uint32_t i = first; i != none && !visited[i]; i = next[i]) {
+            visited[i] = true;
+            chain.push_back(i);
+        }
+        visit(chain, loop);
+    };
+    for (uint32_t i = 0; i < items.size(); ++i) {
+        if (!hasPrevious[i]) {
+            walk(i, false);
+        }
+    }
+    for (uint32_t i = 0; i < items.size(); ++i) {
+        if (!visited[i]) {
+            walk(i, true);
+        }
+    }
+}
+
+template<typename Surface>
+class Tracer
+{
+public:
+    Tracer(const Surface& surface, const Levels& levels, const ContourGenerator::Options& options) :
+        _surface(surface),
+        _levels(levels),
+        _options(options)
+    {}
+
+    // the segments of the tile chained as far as they go inside it
+    std::vector<Piece> trace(size_t tile) const
+    {
+        std::vector<Segment> segments;
+        _surface.segments(tile, _levels, segments);
+        std::sort(segments.begin(), segments.end(),
+                  [](const Segment& a, const Segment& b) { return a.start < b.start; });
+        std::vector<uint32_t> next(segments.size(), none);
+        for (size_t i = 0; i < segments.size(); ++i) {
+            auto found = std::lower_bound(segments.begin(), segments.end(), segments[i].end,
+                                          [](const Segment& segment, uint64_t key) { return segment.start < key; });
+            if (found != segments.end() && found->start == segments[i].end) {
+                next[i] = (uint32_t)(found - segments.begin());
+            }
+        }
+
+        std::vector<Piece> pieces;
+        follow(segments, next, [&](const std::vector<uint32_t>& chain, bool loop) {
+            Piece piece{level(segments[chain.front()].start), segments[chain.front()].start,
+                        segments[chain.back()].end, {}, loop};
+            piece.vertices.reserve(chain.size() + 1);
+            for (uint32_t i : chain) {
+                appendVertex(piece.vertices, vertex(segments[i].start));
+            }
+            if (!loop) {
+                appendVertex(piece.vertices, vertex(segments[chain.back()].end));
+            }
+            pieces.push_back(std::move(piece));
+        });
+        return pieces;
+    }
+
+    Vertex vertex(uint64_t key) const
+    {
+        double position[2];
+        _surface.point(key & edgeMask, _levels.at(level(key)), position);
+        return Vertex{{(float)position[0], (float)position[1]},
+                      {_options.color[0], _options.color[1], _options.color[2]}};
+    }
+
+    static uint32_t level(uint64_t key) { return (uint32_t)(key >> edgeBits); }
+
+private:
+    const Surface& _surface;
+    const Levels& _levels;
+    const ContourGenerator::Options& _options;
+};
+
+// the pieces of all tiles, those still open joined across the tiles
+template<typename Surface>
+QVector<ContourLine> generate(const Surface& surface, const Levels& levels, const ContourGenerator::Options& options,
+                              Concurrency::ThreadPool& pool)
+{
+    Tracer<Surface> tracer(surface, levels, options);
+    std::vector<std::vector<Piece>> tiles(surface.tileCount());
+    pool.parallelFor(tiles.size(), [&](size_t tile) { tiles[tile] = tracer.trace(tile); });
+
+    QVector<ContourLine> lines;
+    auto add = [&](uint32_t level, QVector<Vertex>&& vertices, bool closed) {
+        if (closed && vertices.size() > 2 && vertices.back().pos[0] == vertices.front().pos[0] &&
+            vertices.back().pos[1] == vertices.front().pos[1]) {
+            vertices.removeLast();
+        }
+        if (vertices.size() >= 2) {
+            lines.append(ContourLine{levels.at(level), std::move(vertices), closed});
+        }
+    };
+    std::vector<Piece> open;
+    for (std::vector<Piece>& pieces : tiles) {
+        for (Piece& piece : pieces) {
+            if (piece.closed) {
+                add(piece.level, std::move(piece.vertices), true);
+            } else {
+                open.push_back(std::move(piece));
+            }
+        }
+        pieces = {};
+    }
+
+    std::unordered_map<uint64_t, uint32_t> byStart;
+    byStart.reserve(open.size());
+    for (uint32_t i = 0; i < open.size(); ++i) {
+        byStart.emplace(open[i].start, i);
+    }
+    std::vector<uint32_t> next(open.size(), none);
+    for (uint32_t i = 0; i < open.size(); ++i) {
+        auto found = byStart.find(open[i].end);
+        if (found != byStart.end()) {
+            next[i] = found->second;
+        }
+    }
+    follow(open, next, [&](const std::vector<uint32_t>& chain, bool loop) {
+        QVector<Vertex> vertices = std::move(open[chain.front()].vertices);
+        for (size_t i = 1; i < chain.size(); ++i) {
+            for (const Vertex& vertex : open[chain[i]].vertices) {
+                appendVertex(vertices, vertex);
+            }
+        }
+        add(open[chain.front()].level, std::move(vertices), loop);
+    });
+    return lines;
+}
+
+}
+
+ContourGenerator::ContourGenerator(const Tin& tin, const Options& options, Concurrency::ThreadPool& pool)
+{
+    Levels levels(tin.minElevation(), tin.maxElevation(), options);
+    _levelCount = levels.count();
+    if (_levelCount > 0) {
+        _lines = generate(TinSurface(tin), levels, options, pool);
+    }
+    for (const ContourLine& line : _lines) {
+        _vertexCount += line.vertices.size();
+    }
+}
+
+ContourGenerator::ContourGenerator(const ElevationGrid& grid, const Options& options, Concurrency::ThreadPool& pool)
+{
+    if ((size_t)grid.columns * grid.rows != grid.values.size()) {
+        throw std::runtime_error("the grid's values don't match its size");
+    }
+    if ((uint64_t)grid.columns * grid.rows * 2 > edgeMask) {
+        throw std::runtime_error("the grid is too large for contours");
+    }
+    float lowest = std::numeric_limits<float>::infinity();
+    float highest = -std::numeric_limits<float>::infinity();
+    for (float value : grid.values) {
+        if (!std::isnan(value)) {
+            lowest = std::min(lowest, value);
+            highest = std::max(highest, value);
+        }
+    }
+    Levels levels(lowest, highest, options);
+    _levelCount = levels.count();
+    if (_levelCount > 0) {
+        _lines = generate(GridSurface(grid), levels, options, pool);
+    }
+    for (const ContourLine& line : _lines) {
+        _vertexCount += line.vertices.size();
+    }
+}
+
+}
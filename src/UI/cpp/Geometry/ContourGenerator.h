@@ -0,0 +1,56 @@
+#pragma once
+
+#include <QVector>
+#include <cstddef>
+
+#include "ElevationGrid.h"
+#include "Tin.h"
+#include "Vertex.h"
+
+namespace Concurrency {
+class ThreadPool;
+}
+
+namespace Geometry {
+
+// a contour line for PolylineList::append(), the higher ground on its left in document
+// coordinates; open where it leaves the surface or the grid's data
+struct ContourLine
+{
+    double elevation;
+    QVector<Vertex> vertices;
+    bool closed;
+};
+
+// Cuts a surface at every multiple of the interval into contour lines. The surface is cut tile
+// by tile on the pool, a Tin by its chunks and a grid in squares of cells (marching squares,
+// saddles decided by the cell's mean), and every tile chains its own segments. A segment
+// starts and ends on an edge of the surface at a level, which is what the pieces of different
+// tiles are joined by afterwards, so the lines are continuous whatever the tiles are.
+// A height on a level counts as above it, a level through a vertex gives no gaps.
+// Throws when the interval isn't positive or gives more than 2^24 levels.
+class ContourGenerator {
+public:
+    struct Options {
+        double interval = 1.0;
+        // elevation of one of the levels, the others are whole intervals from it
+        double base = 0.0;
+        // brown like the contours of a map
+        float color[3] = {0.6f, 0.4f, 0.2f};
+    };
+
+    ContourGenerator(const Tin& tin, const Options& options, Concurrency::ThreadPool& pool);
+    ContourGenerator(const ElevationGrid& grid, const Options& options, Concurrency::ThreadPool& pool);
+
+    const QVector<ContourLine>& lines() const { return _lines; }
+    // levels between the lowest and the highest elevation, with or without a line
+    size_t levelCount() const { return _levelCount; }
+    size_t vertexCount() const { return _vertexCount; }
+
+private:
+    QVector<ContourLine> _lines;
+    size_t _levelCount = 0;
+    size_t _vertexCount = 0;
+};
+
+}
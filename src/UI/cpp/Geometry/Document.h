@@ -0,0 +1,342 @@
+#pragma once
+
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <numbers>
+#include <string>
+#include <vector>
+
+#include "Library/Flux/Computed.h"
+#include "Library/Flux/Signal.h"
+#include "Library/Geodesy/Crs.h"
+#include "BoundingBox.h"
+#include "Layer.h"
+
+namespace Geometry {
+
+// The whole document as one immutable value, see Document::snapshot(). Cheap to copy, the
+// lists are shared.
+struct DocumentSnapshot
+{
+    std::vector<LayerSnapshot> layers;
+    // one per layer
+    std::vector<LayerStyle> styles;
+    std::vector<std::string> names;
+    // grows with every change of the layers or their styles, the lists carry their own versions
+    uint64_t layersVersion = 0;
+
+    BoundingBox bounds() const
+    {
+        BoundingBox box;
+        for (const LayerSnapshot& layer : layers) {
+            box.expand(layer.bounds());
+        }
+        return box;
+    }
+};
+
+// The layers of a drawing and their styles, owned by the GUI thread. Layers are only added,
+// so their indices stay valid; there is always at least the layer "0" of DXF.
+class Document
+{
+public:
+    Document() :
+        _id(nextId()),
+        _extents([this]() {
+            BoundingBox box;
+            for (const LayerMeasures& measures : _measures) {
+                box.expand(measures.bounds.value());
+            }
+            for (const Layer& layer : _layers) {
+                for (const std::shared_ptr<const PointCloud>& cloud : layer.pointClouds) {
+                    box.expand(cloud->bounds());
+                }
+                for (const std::shared_ptr<const Raster>& raster : layer.rasters) {
+                    box.expand(raster->bounds());
+                }
+                for (const std::shared_ptr<const Tin>& tin : layer.tins) {
+                    box.expand(tin->bounds());
+                }
+            }
+            return box;
+        }),
+        _totalLength([this]() {
+            double length = 0.0;
+            for (const LayerMeasures& measures : _measures) {
+                length += measures.length.value();
+            }
+            return length;
+        })
+    {
+        addLayer("0");
+    }
+
+    Document(const Document&) = delete;
+    Document& operator=(const Document&) = delete;
+
+    // never reused by another document, views of one document share its GPU copy
+    uint64_t id() const
+    {
+        return _id;
+    }
+
+    size_t addLayer(const std::string& name, const LayerStyle& style = LayerStyle{})
+    {
+        _layers.push_back(Layer{name});
+        _styles.push_back(style);
+        Layer& layer = _layers.back();
+        // the layer lists live as long as the document, their slots only forward to its signal
+        Flux::Signal<> documentChanged = _changed;
+        layer.lines.subscribe([documentChanged](size_t, size_t) { documentChanged.notify(); }).release();
+        layer.circles.subscribe([documentChanged](size_t, size_t) { documentChanged.notify(); }).release();
+        layer.arcs.subscribe([documentChanged](size_t, size_t) { documentChanged.notify(); }).release();
+        layer.polylines.subscribe([documentChanged]() { documentChanged.notify(); }).release();
+
+        _measures.push_back(LayerMeasures{measureBounds(layer), measureLength(layer)});
+        _extents.dependsOn(_measures.back().bounds).invalidate();
+        _totalLength.dependsOn(_measures.back().length).invalidate();
+        changed();
+        return _layers.size() - 1;
+    }
+
+    // index of the layer with the name, a new layer when there's none
+    size_t layerIndex(const std::string& name)
+    {
+        for (size_t i = 0; i < _layers.size(); ++i) {
+            if (_layers[i].name == name) {
+                return i;
+            }
+        }
+        return addLayer(name);
+    }
+
+    size_t layerCount() const
+    {
+        return _layers.size();
+    }
+
+    Layer& layer(size_t index)
+    {
+        return _layers[index];
+    }
+
+    const Layer& layer(size_t index) const
+    {
+        return _layers[index];
+    }
+
+    // new entities go there
+    Layer& currentLayer()
+    {
+        return _layers[_currentLayer];
+    }
+
+    void setCurrentLayer(size_t index)
+    {
+        if (index < _layers.size()) {
+            _currentLayer = index;
+        }
+    }
+
+    const LayerStyle& style(size_t index) const
+    {
+        return _styles[index];
+    }
+
+    // the geometry isn't touched, a view only uploads the new style table
+    void setStyle(size_t index, const LayerStyle& style)
+    {
+        if (index < _styles.size()) {
+            _styles[index] = style;
+            changed();
+        }
+    }
+
+    void setVisible(size_t index, bool visible)
+    {
+        if (index < _styles.size()) {
+            LayerStyle style = _styles[index];
+            style.flags = visible ? style.flags | LayerStyle::Visible : style.flags & ~LayerStyle::Visible;
+            setStyle(index, style);
+        }
+    }
+
+    // the cloud is drawn with the layer and counts into extents(); the exports skip it
+    void addPointCloud(size_t index, std::shared_ptr<const PointCloud> cloud)
+    {
+        if (index < _layers.size() && cloud) {
+            _layers[index].pointClouds.push_back(std::move(cloud));
+            _extents.invalidate();
+            changed();
+        }
+    }
+
+    // like addPointCloud(), the image is drawn under every entity
+    void addRaster(size_t index, std::shared_ptr<const Raster> raster)
+    {
+        if (index < _layers.size() && raster) {
+            _layers[index].rasters.push_back(std::move(raster));
+            _extents.invalidate();
+            changed();
+        }
+    }
+
+    // like addPointCloud(), drawn shaded or as a wireframe after the layer's style
+    void addTin(size_t index, std::shared_ptr<const Tin> tin)
+    {
+        if (index < _layers.size() && tin) {
+            _layers[index].tins.push_back(std::move(tin));
+            _extents.invalidate();
+            changed();
+        }
+    }
+
+    // the system the coordinates of every layer are in, WGS 84 longitude and latitude until set;
+    // setting it doesn't touch the coordinates, see Geometry::reproject(). They are stored as
+    // floats without an origin, so a float's 24 bits of mantissa bound them: northings of UTM
+    // zones, around 5.7e6 m, keep steps of 0.5 m, latitudes around 52 degrees steps of 4e-6
+    // degrees, also about 0.4 m
+    const Geodesy::Crs& crs() const
+    {
+        return _crs;
+    }
+
+    void setCrs(const Geodesy::Crs& crs)
+    {
+        _crs = crs;
+    }
+
+    // box of every entity, point cloud, image and surface of every layer, hidden ones included; reading it is
+    // free until the document changes, after appends only the new entities are looked at
+    const BoundingBox& extents() const
+    {
+        return _extents.value();
+    }
+
+    // summed length of every line, circle, arc and polyline, kept up to date like extents()
+    double totalLength() const
+    {
+        return _totalLength.value();
+    }
+
+    DocumentSnapshot snapshot() const
+    {
+        DocumentSnapshot snapshot;
+        snapshot.layers.reserve(_layers.size());
+        snapshot.names.reserve(_layers.size());
+        for (const Layer& layer : _layers) {
+            snapshot.layers.push_back(layer.snapshot());
+            snapshot.names.push_back(layer.name);
+        }
+        snapshot.styles = _styles;
+        snapshot.layersVersion = _layersVersion;
+        return snapshot;
+    }
+
+    // called after every change of an entity, a layer or a style, until the subscription is dropped
+    [[nodiscard]] Flux::Subscription subscribe(std::function<void()> observer)
+    {
+        return _changed.subscribe(std::move(observer));
+    }
+
+    // called once in the dispatcher's next flush for all the changes made until then
+    [[nodiscard]] Flux::Subscription subscribe(Flux::DeferredDispatcher& dispatcher, std::function<void()> observer)
+    {
+        return _changed.subscribe(dispatcher, std::move(observer));
+    }
+
+private:
+    static uint64_t nextId()
+    {
+        static std::atomic<uint64_t> id{0};
+        return ++id;
+    }
+
+    // what extents() and totalLength() are made of, per layer
+    struct LayerMeasures
+    {
+        Flux::Computed<BoundingBox> bounds;
+        Flux::Computed<double> length;
+    };
+
+    static Flux::Computed<BoundingBox> measureBounds(const Layer& layer)
+    {
+        // from scratch from the chunk boxes, appends expand the box by the new entities
+        Flux::Computed<BoundingBox> bounds([&layer]() { return layer.snapshot().bounds(); });
+        auto expandBy = [](const auto& list) {
+            return [list](BoundingBox& box, size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                    box.expand(list.at(i));
+                }
+            };
+        };
+        bounds.extendsWith(layer.lines, expandBy(layer.lines))
+            .extendsWith(layer.circles, expandBy(layer.circles))
+            .extendsWith(layer.arcs, expandBy(layer.arcs))
+            .extendsWith(layer.polylines.vertices(), expandBy(layer.polylines.vertices()));
+        return bounds;
+    }
+
+    static Flux::Computed<double> measureLength(const Layer& layer)
+    {
+        const PolylineList& polylines = layer.polylines;
+        auto polylineLength = [&polylines](double& length, const Polyline& polyline) {
+            for (uint32_t i = 1; i < polyline.vertexCount; ++i) {
+                length += distance(polylines.vertex(polyline.firstVertex + i - 1),
+                                   polylines.vertex(polyline.firstVertex + i));
+            }
+            if (polyline.closed && polyline.vertexCount > 2) {
+                length += distance(polylines.vertex(polyline.firstVertex + polyline.vertexCount - 1),
+                                   polylines.vertex(polyline.firstVertex));
+            }
+        };
+        Flux::Computed<double> lines = Flux::Computed<double>::fold(layer.lines, 0.0, [](double& length, const Line& line) {
+            length += distance(line.vertices[0], line.vertices[1]);
+        });
+        Flux::Computed<double> circles = Flux::Computed<double>::fold(layer.circles, 0.0, [](double& length, const Circle& circle) {
+            length += 2.0 * std::numbers::pi * circle.radius;
+        });
+        Flux::Computed<double> arcs = Flux::Computed<double>::fold(layer.arcs, 0.0, [](double& length, const Arc& arc) {
+            length += (double)arc.radius * arc.sweepAngle;
+        });
+        // moving a vertex recomputes, appending one doesn't change anything until its polyline is added
+        Flux::Computed<double> polylineTotal = Flux::Computed<double>::fold(polylines.records(), 0.0, polylineLength);
+        polylineTotal.extendsWith(polylines.vertices());
+
+        Flux::Computed<double> length([lines, circles, arcs, polylineTotal]() {
+            return lines.value() + circles.value() + arcs.value() + polylineTotal.value();
+        });
+        length.dependsOn(lines).dependsOn(circles).dependsOn(arcs).dependsOn(polylineTotal);
+        return length;
+    }
+
+    static double distance(const Vertex& a, const Vertex& b)
+    {
+        return std::hypot((double)b.pos[0] - a.pos[0], (double)b.pos[1] - a.pos[1]);
+    }
+
+    void changed()
+    {
+        ++_layersVersion;
+        _changed.notify();
+    }
+
+    uint64_t _id;
+    // a deque keeps references to the layers valid while layers are added
+    std::deque<Layer> _layers;
+    std::deque<LayerMeasures> _measures;
+    std::vector<LayerStyle> _styles;
+    size_t _currentLayer = 0;
+    Geodesy::Crs _crs;
+    uint64_t _layersVersion = 0;
+    Flux::Signal<> _changed;
+    Flux::Computed<BoundingBox> _extents;
+    Flux::Computed<double> _totalLength;
+};
+
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Geometry {
+
+// Heights sampled on a regular grid in document coordinates, sample (row, column) at
+// x = origin[0] + column * spacing, y = origin[1] + row * spacing; NaN where there is no data.
+struct ElevationGrid
+{
+    double origin[2] = {0.0, 0.0};
+    double spacing = 1.0;
+    uint32_t columns = 0;
+    uint32_t rows = 0;
+    // row by row
+    std::vector<float> values;
+
+    float at(uint32_t row, uint32_t column) const
+    {
+        return values[(size_t)row * columns + column];
+    }
+};
+
+}
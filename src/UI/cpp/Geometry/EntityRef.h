@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Geometry {
+
+// One entity of a Document: the list it is in, its layer and its index in the list. Stays valid
+// while entities are only added.
+struct EntityRef
+{
+    enum class Kind : uint32_t {
+        None,
+        Line,
+        Circle,
+        Arc,
+        Polyline,
+    };
+
+    Kind kind = Kind::None;
+    uint32_t layer = 0;
+    size_t index = 0;
+
+    explicit operator bool() const { return kind != Kind::None; }
+    bool operator==(const EntityRef&) const = default;
+};
+
+}
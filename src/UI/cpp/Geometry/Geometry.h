@@ -1,4 +1,11 @@
 #pragma once
 
+#include "Arc.h"
+#include "BoundingBox.h"
+#include "Circle.h"
+#include "Color.h"
+#include "EntityRef.h"
+#include "Layer.h"
 #include "Line.h"
-#include "Vertex.h"
\ No newline at end of file
+#include "Polyline.h"
+#include "Vertex.h"
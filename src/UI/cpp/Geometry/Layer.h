@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ArcList.h"
+#include "BoundingBox.h"
+#include "CircleList.h"
+#include "Color.h"
+#include "LineList.h"
+#include "PointCloud.h"
+#include "PolylineList.h"
+#include "Raster.h"
+#include "Tin.h"
+
+namespace Geometry {
+
+// How a layer is drawn, one entry of the style table the shaders index by layer. Changing it
+// never touches the layer's geometry.
+struct LayerStyle
+{
+    enum Flags : uint32_t {
+        Visible = 1,
+        // the layer color replaces the colors of its entities
+        OverrideColor = 2,
+        // surfaces are drawn as their edges instead of shaded
+        Wireframe = 4,
+    };
+
+    // see packColor()
+    uint32_t color = packColor(0.0f, 0.0f, 0.0f);
+    // in pixels
+    float width = 3.0f;
+    // length of a dash and of the gap after it in pixels, 0 draws solid
+    float dash = 0.0f;
+    uint32_t flags = Visible;
+
+    bool visible() const { return flags & Visible; }
+
+    std::array<float, 3> resolve(const float color[3]) const
+    {
+        if (flags & OverrideColor) {
+            return unpackColor(this->color);
+        }
+        return {color[0], color[1], color[2]};
+    }
+
+    uint32_t resolve(uint32_t color) const
+    {
+        return flags & OverrideColor ? this->color : color;
+    }
+};
+
+static_assert(sizeof(LayerStyle) == 16);
+
+struct LayerSnapshot
+{
+    LineSnapshot lines;
+    CircleSnapshot circles;
+    ArcSnapshot arcs;
+    PolylineSnapshot polylines;
+    // immutable, shared with the layer
+    std::vector<std::shared_ptr<const PointCloud>> pointClouds;
+    std::vector<std::shared_ptr<const Raster>> rasters;
+    std::vector<std::shared_ptr<const Tin>> tins;
+
+    // union of the chunk boxes of all lists, polylines by the chunks of their vertex pool
+    BoundingBox bounds() const
+    {
+        BoundingBox box;
+        auto expandBy = [&box](const auto& list) {
+            for (size_t i = 0; list && i < list->chunkCount(); ++i) {
+                box.expand(list->chunk(i).summary);
+            }
+        };
+        expandBy(lines);
+        expandBy(circles);
+        expandBy(arcs);
+        expandBy(polylines.vertices);
+        return box;
+    }
+};
+
+// the entities of one layer, every layer has its own lists and so its own chunks on the GPU
+struct Layer
+{
+    std::string name;
+    LineList lines;
+    CircleList circles;
+    ArcList arcs;
+    PolylineList polylines;
+    // scans drawn with the layer, added through Document::addPointCloud()
+    std::vector<std::shared_ptr<const PointCloud>> pointClouds;
+    // images drawn under the layer's entities, added through Document::addRaster()
+    std::vector<std::shared_ptr<const Raster>> rasters;
+    // terrain surfaces drawn with the layer, added through Document::addTin()
+    std::vector<std::shared_ptr<const Tin>> tins;
+
+    LayerSnapshot snapshot() const
+    {
+        return LayerSnapshot{lines.snapshot(), circles.snapshot(), arcs.snapshot(), polylines.snapshot(), pointClouds,
+                             rasters, tins};
+    }
+};
+
+}
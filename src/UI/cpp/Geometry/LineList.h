@@ -0,0 +1,14 @@
+#pragma once
+
+#include "Library/Flux/MutableList.h"
+#include "BoundingBox.h"
+#include "Line.h"
+
+namespace Geometry {
+
+// document lines, every storage chunk carries the bounding box of its lines
+using LineList = Flux::MutableList<Line, BoundingBox>;
+// immutable view of the document for other threads, see LineList::snapshot()
+using LineSnapshot = LineList::Snapshot;
+
+}
@@ -0,0 +1,91 @@
+#include "PointCloud.h"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <unistd.h>
+
+namespace Geometry {
+
+namespace {
+
+// pread until everything is there, it may return less than asked
+void readFully(int file, void* data, size_t size, uint64_t offset, const std::string& fileName)
+{
+    char* bytes = static_cast<char*>(data);
+    while (size > 0) {
+        ssize_t count = pread(file, bytes, size, (off_t)offset);
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count <= 0) {
+            throw std::runtime_error("can't read file " + fileName + (count < 0 ? strerror(errno) : " (truncated)"));
+        }
+        bytes += count;
+        size -= (size_t)count;
+        offset += (uint64_t)count;
+    }
+}
+
+}
+
+std::shared_ptr<const PointCloud> PointCloud::open(const std::string& fileName, const std::string& name)
+{
+    return std::shared_ptr<const PointCloud>(new PointCloud(fileName, name));
+}
+
+PointCloud::PointCloud(const std::string& fileName, const std::string& name) :
+    _fileName(fileName),
+    _name(name)
+{
+    _file = ::open(fileName.c_str(), O_RDONLY | O_CLOEXEC);
+    if (_file < 0) {
+        throw std::runtime_error("can't open file " + fileName + strerror(errno));
+    }
+    try {
+        readFully(_file, &_header, sizeof(_header), 0, fileName);
+        if (std::memcmp(_header.magic, FileHeader::magicValue, sizeof(_header.magic)) != 0 ||
+            _header.version != FileHeader::currentVersion || _header.nodeCount == 0 || _header.nodeCapacity == 0) {
+            throw std::runtime_error(fileName + " isn't a point cloud cache of this version");
+        }
+        _nodes.resize(_header.nodeCount);
+        _pages.resize(_header.pageCount);
+        readFully(_file, _nodes.data(), _nodes.size() * sizeof(Node), sizeof(FileHeader), fileName);
+        uint64_t pagesOffset = sizeof(FileHeader) + _nodes.size() * sizeof(Node);
+        readFully(_file, _pages.data(), _pages.size() * sizeof(Page), pagesOffset, fileName);
+        _pointsOffset = pagesOffset + _pages.size() * sizeof(Page);
+    } catch (...) {
+        ::close(_file);
+        throw;
+    }
+
+    for (const Node& node : _nodes) {
+        for (uint32_t child : node.children) {
+            if (child >= _nodes.size()) {
+                ::close(_file);
+                throw std::runtime_error(fileName + " has a broken node table");
+            }
+        }
+        if ((uint64_t)node.firstPage + node.pageCount > _pages.size()) {
+            ::close(_file);
+            throw std::runtime_error(fileName + " has a broken node table");
+        }
+    }
+}
+
+PointCloud::~PointCloud()
+{
+    if (_file >= 0) {
+        ::close(_file);
+    }
+}
+
+void PointCloud::readPage(size_t page, std::vector<CloudPoint>& points) const
+{
+    const Page& entry = _pages[page];
+    points.resize(entry.count);
+    readFully(_file, points.data(), points.size() * sizeof(CloudPoint),
+              _pointsOffset + entry.first * sizeof(CloudPoint), _fileName);
+}
+
+}
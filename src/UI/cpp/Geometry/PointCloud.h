@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "BoundingBox.h"
+
+namespace Geometry {
+
+// one point of a point cloud, in document coordinates like the vertices of the other entities
+struct CloudPoint
+{
+    float pos[2];
+    // see packColor()
+    uint32_t color;
+};
+
+static_assert(sizeof(CloudPoint) == 12);
+
+// A scan too large for memory, as an out of core level of detail hierarchy in a cache file
+// written by Import::PointCloudBuilder. The hierarchy is a quadtree over the document plane:
+// leaves hold the points of their cell, inner nodes an evenly spread sample of what their
+// children hold, so drawing a node instead of its children shows the same area thinner. Every
+// node holds at most nodeCapacity() points per page; only a leaf in a cell denser than that has
+// more than one page. Only the node and page tables are in memory, the points are read page by
+// page with readPage(), from any thread. Immutable once opened, shared by the document and the
+// views drawing it.
+class PointCloud
+{
+public:
+    struct Node
+    {
+        // square, the children split it at its center
+        BoundingBox cell;
+        // per quadrant (bit 0 set for the half of larger x, bit 1 for the half of larger y), 0
+        // where it is empty; the root is node 0 and never a child
+        uint32_t children[4];
+        uint32_t firstPage;
+        uint32_t pageCount;
+        uint32_t level;
+
+        bool isLeaf() const { return !(children[0] | children[1] | children[2] | children[3]); }
+    };
+
+    struct Page
+    {
+        // index of the first point in the point section of the file
+        uint64_t first;
+        uint32_t count;
+        uint32_t node;
+    };
+
+    // what starts the cache file, followed by the node table, the page table and the points
+    struct FileHeader
+    {
+        static constexpr char magicValue[8] = {'G', 'C', 'P', 'C', 'L', 'O', 'U', 'D'};
+        static constexpr uint32_t currentVersion = 1;
+
+        char magic[8];
+        uint32_t version;
+        uint32_t nodeCapacity;
+        // of the scan, and in the file counting the samples of inner nodes
+        uint64_t pointCount;
+        uint64_t storedCount;
+        uint32_t nodeCount;
+        uint32_t pageCount;
+        // of every point
+        BoundingBox bounds;
+        // what the cache was built from, a cache not matching its source is built again
+        uint64_t sourceSize;
+        int64_t sourceModified;
+        int32_t sourceEpsg;
+        int32_t documentEpsg;
+    };
+
+    // throws when the file isn't a cache of the current version
+    static std::shared_ptr<const PointCloud> open(const std::string& fileName, const std::string& name);
+
+    ~PointCloud();
+
+    PointCloud(const PointCloud&) = delete;
+    PointCloud& operator=(const PointCloud&) = delete;
+
+    // of the scan, the layer it is added to has the same
+    const std::string& name() const { return _name; }
+    const FileHeader& header() const { return _header; }
+    const BoundingBox& bounds() const { return _header.bounds; }
+    uint64_t pointCount() const { return _header.pointCount; }
+    size_t nodeCapacity() const { return _header.nodeCapacity; }
+
+    const std::vector<Node>& nodes() const { return _nodes; }
+    const std::vector<Page>& pages() const { return _pages; }
+
+    // the page's points replace the vector's, safe to call from several threads at once
+    void readPage(size_t page, std::vector<CloudPoint>& points) const;
+
+private:
+    PointCloud(const std::string& fileName, const std::string& name);
+
+    std::string _fileName;
+    std::string _name;
+    int _file = -1;
+    FileHeader _header = {};
+    std::vector<Node> _nodes;
+    std::vector<Page> _pages;
+    // byte offset of the first point in the file
+    uint64_t _pointsOffset = 0;
+};
+
+}
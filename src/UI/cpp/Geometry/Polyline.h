@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Geometry {
+
+// A chain of vertices in the vertex pool of a PolylineList, segments run between consecutive
+// vertices and, when closed, from the last one back to the first. Vertices are shared by the
+// segments meeting in them, so moving a point changes one vertex. All vertices of a polyline
+// lie in one chunk of the pool.
+struct Polyline
+{
+    uint32_t firstVertex;
+    uint32_t vertexCount;
+    // 0 or 1, a full word keeps the record free of padding
+    uint32_t closed;
+};
+
+static_assert(sizeof(Polyline) == 12);
+
+}
@@ -0,0 +1,190 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <stdexcept>
+#include <QVector>
+
+#include "Library/Flux/MutableList.h"
+#include "BoundingBox.h"
+#include "Polyline.h"
+#include "Vertex.h"
+
+namespace Geometry {
+
+using PolylineRecords = Flux::MutableList<Polyline>;
+// every storage chunk carries the bounding box of its vertices, which is the box of the
+// polylines in it
+using PolylineVertices = Flux::MutableList<Vertex, BoundingBox>;
+
+struct PolylineSnapshot
+{
+    PolylineRecords::Snapshot polylines;
+    PolylineVertices::Snapshot vertices;
+};
+
+// Document polylines: the records and the vertex pool they point into. A polyline is placed so
+// it doesn't cross a pool chunk (the rest of a chunk it doesn't fit into is padded with copies
+// of the last vertex), which lets the GPU index every chunk on its own. Polylines are added or
+// replaced all at once by set(), their points are moved through updateVertex().
+class PolylineList
+{
+public:
+    static constexpr size_t chunkSize = PolylineVertices::Storage::chunkSize;
+
+    PolylineList()
+    {
+        // the lists and the signal are shared by every copy and die together, the slots stay
+        Flux::Signal<> changed = _changed;
+        _polylines.subscribe([changed](size_t, size_t) { changed.notify(); }).release();
+        _vertices.subscribe([changed](size_t, size_t) { changed.notify(); }).release();
+    }
+
+    // polylines need two vertices, shorter ones are ignored; ones longer than a pool chunk are
+    // stored as several open pieces sharing their end vertices
+    void add(const QVector<Vertex>& points, bool closed = false)
+    {
+        Batch batch;
+        batch.base = _vertices.size();
+        pack(batch, points, closed);
+        commit(batch);
+    }
+
+    // adds every polyline like add() with one append to the pool and one to the records, so the
+    // lists are published twice however many there are; anything with vertices and closed, like
+    // Import::ImportedPolyline
+    template<typename Polylines>
+    void append(const Polylines& polylines)
+    {
+        Batch batch;
+        batch.base = _vertices.size();
+        for (const auto& polyline : polylines) {
+            pack(batch, polyline.vertices, polyline.closed);
+        }
+        commit(batch);
+    }
+
+    // replaces every polyline by the ones given like append(), with one set() of the pool and
+    // one of the records
+    template<typename Polylines>
+    void set(const Polylines& polylines)
+    {
+        Batch batch;
+        for (const auto& polyline : polylines) {
+            pack(batch, polyline.vertices, polyline.closed);
+        }
+        _vertices.set(batch.vertices);
+        _polylines.set(batch.records);
+    }
+
+    // index into the vertex pool, see Polyline::firstVertex
+    void updateVertex(size_t index, const Vertex& vertex)
+    {
+        _vertices.update(index, vertex);
+    }
+
+    const Polyline& at(size_t index) const
+    {
+        return _polylines.at(index);
+    }
+
+    const Vertex& vertex(size_t index) const
+    {
+        return _vertices.at(index);
+    }
+
+    size_t size() const
+    {
+        return _polylines.size();
+    }
+
+    // moves every vertex of the pool at once, for transformations of the whole list; the
+    // vertices replace the pool one for one
+    void setVertices(const QVector<Vertex>& vertices)
+    {
+        if ((size_t)vertices.size() != _vertices.size()) {
+            throw std::runtime_error("the vertices don't match the vertex pool");
+        }
+        _vertices.set(vertices);
+    }
+
+    const PolylineRecords& records() const
+    {
+        return _polylines;
+    }
+
+    const PolylineVertices& vertices() const
+    {
+        return _vertices;
+    }
+
+    PolylineSnapshot snapshot() const
+    {
+        return PolylineSnapshot{_polylines.snapshot(), _vertices.snapshot()};
+    }
+
+    // called after every change, added polylines report once their vertices are in place
+    [[nodiscard]] Flux::Subscription subscribe(std::function<void()> observer)
+    {
+        return _changed.subscribe(std::move(observer));
+    }
+
+private:
+    // what add() and append() place behind the pool and the records, set() into empty ones
+    struct Batch
+    {
+        // vertices of the pool before the batch
+        size_t base = 0;
+        QVector<Vertex> vertices;
+        QVector<Polyline> records;
+    };
+
+    void pack(Batch& batch, const QVector<Vertex>& points, bool closed)
+    {
+        if (points.size() < 2) {
+            return;
+        }
+        if ((size_t)points.size() + closed > chunkSize) {
+            QVector<Vertex> chain = points;
+            if (closed) {
+                chain.append(points.front());
+            }
+            for (size_t first = 0; first + 1 < (size_t)chain.size(); first += chunkSize - 1) {
+                size_t last = std::min(first + chunkSize, (size_t)chain.size());
+                packPiece(batch, chain.constData() + first, last - first, false);
+            }
+            return;
+        }
+        packPiece(batch, points.constData(), points.size(), closed);
+    }
+
+    void packPiece(Batch& batch, const Vertex* points, size_t count, bool closed)
+    {
+        size_t size = batch.base + batch.vertices.size();
+        size_t used = size % chunkSize;
+        if (used != 0 && used + count > chunkSize) {
+            Vertex last = batch.vertices.isEmpty() ? _vertices.at(batch.base - 1) : batch.vertices.back();
+            batch.vertices.insert(batch.vertices.size(), chunkSize - used, last);
+            size += chunkSize - used;
+        }
+        batch.records.append(Polyline{(uint32_t)size, (uint32_t)count, closed ? 1u : 0u});
+        batch.vertices.append(QVector<Vertex>(points, points + count));
+    }
+
+    // the vertices first, a polyline reports once they are in place
+    void commit(const Batch& batch)
+    {
+        if (batch.records.isEmpty()) {
+            return;
+        }
+        _vertices.append(batch.vertices);
+        _polylines.append(batch.records);
+    }
+
+    PolylineRecords _polylines;
+    PolylineVertices _vertices;
+    Flux::Signal<> _changed;
+};
+
+}
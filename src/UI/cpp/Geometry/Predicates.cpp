@@ -0,0 +1,243 @@
+#include "Predicates.h"
+#include <algorithm>
+#include <cmath>
+
+namespace Geometry {
+
+namespace {
+
+// half an ulp of 1, the relative error of one rounding
+constexpr double epsilon = 0x1p-53;
+// Shewchuk's bounds on the error of the floating point determinants, relative to their permanents
+constexpr double orientationBound = (3.0 + 16.0 * epsilon) * epsilon;
+constexpr double inCircleBound = (10.0 + 96.0 * epsilon) * epsilon;
+
+// An expansion is a sum of doubles ordered by increasing magnitude that don't overlap, so its
+// sign is the sign of its last component. Zero components are left out, but there is always one.
+
+void twoSum(double a, double b, double& sum, double& error)
+{
+    sum = a + b;
+    double bVirtual = sum - a;
+    double aVirtual = sum - bVirtual;
+    error = (a - aVirtual) + (b - bVirtual);
+}
+
+void twoProduct(double a, double b, double& product, double& error)
+{
+    product = a * b;
+    error = std::fma(a, b, -product);
+}
+
+void fastTwoSum(double a, double b, double& sum, double& error)
+{
+    sum = a + b;
+    error = b - (sum - a);
+}
+
+// a - b exactly
+int difference(double a, double b, double* h)
+{
+    double x = a - b;
+    double bVirtual = a - x;
+    double aVirtual = x + bVirtual;
+    double low = (a - aVirtual) + (bVirtual - b);
+    if (low == 0.0) {
+        h[0] = x;
+        return 1;
+    }
+    h[0] = low;
+    h[1] = x;
+    return 2;
+}
+
+// h = e + f, h has room for elen + flen components
+int sum(const double* e, int elen, const double* f, int flen, double* h)
+{
+    int ei = 0;
+    int fi = 0;
+    // the smaller remaining component of either
+    auto next = [&]() {
+        if (fi == flen || (ei < elen && (f[fi] > e[ei]) == (f[fi] > -e[ei]))) {
+            return e[ei++];
+        }
+        return f[fi++];
+    };
+    int hlen = 0;
+    double q = next();
+    for (int i = 1; i < elen + flen; ++i) {
+        double error;
+        twoSum(q, next(), q, error);
+        if (error != 0.0) {
+            h[hlen++] = error;
+        }
+    }
+    if (q != 0.0 || hlen == 0) {
+        h[hlen++] = q;
+    }
+    return hlen;
+}
+
+// h = e * b, h has room for 2 * elen components
+int scale(const double* e, int elen, double b, double* h)
+{
+    int hlen = 0;
+    double q;
+    double error;
+    twoProduct(e[0], b, q, error);
+    if (error != 0.0) {
+        h[hlen++] = error;
+    }
+    for (int i = 1; i < elen; ++i) {
+        double high;
+        double low;
+        twoProduct(e[i], b, high, low);
+        double partial;
+        twoSum(q, low, partial, error);
+        if (error != 0.0) {
+            h[hlen++] = error;
+        }
+        fastTwoSum(high, partial, q, error);
+        if (error != 0.0) {
+            h[hlen++] = error;
+        }
+    }
+    if (q != 0.0 || hlen == 0) {
+        h[hlen++] = q;
+    }
+    return hlen;
+}
+
+// of the factors of product()
+constexpr int maxFactor = 16;
+
+// h = e * f with e of at most maxFactor components; h and scratch have room for 2 * elen * flen
+int product(const double* e, int elen, const double* f, int flen, double* h, double* scratch)
+{
+    double part[2 * maxFactor];
+    int hlen = scale(e, elen, f[0], h);
+    for (int i = 1; i < flen; ++i) {
+        int partLength = scale(e, elen, f[i], part);
+        hlen = sum(h, hlen, part, partLength, scratch);
+        std::copy(scratch, scratch + hlen, h);
+    }
+    return hlen;
+}
+
+int negate(double* e, int elen)
+{
+    for (int i = 0; i < elen; ++i) {
+        e[i] = -e[i];
+    }
+    return elen;
+}
+
+int sign(const double* e, int elen)
+{
+    double last = e[elen - 1];
+    return last > 0.0 ? 1 : last < 0.0 ? -1 : 0;
+}
+
+// ux * vy - uy * vx, h has room for 16 components
+int cross(const double* ux, int uxn, const double* uy, int uyn, const double* vx, int vxn, const double* vy, int vyn,
+          double* h)
+{
+    double left[8];
+    double right[8];
+    double scratch[8];
+    int leftLength = product(ux, uxn, vy, vyn, left, scratch);
+    int rightLength = negate(right, product(uy, uyn, vx, vxn, right, scratch));
+    return sum(left, leftLength, right, rightLength, h);
+}
+
+int orientationExact(const double* a, const double* b, const double* c)
+{
+    double acx[2], acy[2], bcx[2], bcy[2];
+    int acxn = difference(a[0], c[0], acx);
+    int acyn = difference(a[1], c[1], acy);
+    int bcxn = difference(b[0], c[0], bcx);
+    int bcyn = difference(b[1], c[1], bcy);
+    double determinant[16];
+    return sign(determinant, cross(acx, acxn, acy, acyn, bcx, bcxn, bcy, bcyn, determinant));
+}
+
+int inCircleExact(const double* a, const double* b, const double* c, const double* d)
+{
+    double dx[3][2], dy[3][2];
+    int dxn[3], dyn[3];
+    const double* points[3] = {a, b, c};
+    for (int i = 0; i < 3; ++i) {
+        dxn[i] = difference(points[i][0], d[0], dx[i]);
+        dyn[i] = difference(points[i][1], d[1], dy[i]);
+    }
+
+    // lift(i) * cross(j, k) for the three rotations of a, b, c
+    double terms[3][512];
+    int termLength[3];
+    for (int i = 0; i < 3; ++i) {
+        int j = (i + 1) % 3;
+        int k = (i + 2) % 3;
+        double squares[2][8];
+        double scratch[512];
+        int xx = product(dx[i], dxn[i], dx[i], dxn[i], squares[0], scratch);
+        int yy = product(dy[i], dyn[i], dy[i], dyn[i], squares[1], scratch);
+        double lift[16];
+        int liftLength = sum(squares[0], xx, squares[1], yy, lift);
+        double determinant[16];
+        int determinantLength = cross(dx[j], dxn[j], dy[j], dyn[j], dx[k], dxn[k], dy[k], dyn[k], determinant);
+        termLength[i] = product(lift, liftLength, determinant, determinantLength, terms[i], scratch);
+    }
+    double partial[1024];
+    int partialLength = sum(terms[0], termLength[0], terms[1], termLength[1], partial);
+    double total[1536];
+    return sign(total, sum(partial, partialLength, terms[2], termLength[2], total));
+}
+
+}
+
+int orientation(const double* a, const double* b, const double* c)
+{
+    double left = (a[0] - c[0]) * (b[1] - c[1]);
+    double right = (a[1] - c[1]) * (b[0] - c[0]);
+    double determinant = left - right;
+    // with opposite signs nothing cancels, the rounded difference has the right sign
+    if ((left > 0.0) != (right > 0.0) || left == 0.0 || right == 0.0) {
+        return determinant > 0.0 ? 1 : determinant < 0.0 ? -1 : 0;
+    }
+    double bound = orientationBound * std::abs(left + right);
+    if (determinant > bound || -determinant > bound) {
+        return determinant > 0.0 ? 1 : -1;
+    }
+    return orientationExact(a, b, c);
+}
+
+int inCircle(const double* a, const double* b, const double* c, const double* d)
+{
+    double adx = a[0] - d[0];
+    double ady = a[1] - d[1];
+    double bdx = b[0] - d[0];
+    double bdy = b[1] - d[1];
+    double cdx = c[0] - d[0];
+    double cdy = c[1] - d[1];
+
+    double bdxcdy = bdx * cdy;
+    double cdxbdy = cdx * bdy;
+    double cdxady = cdx * ady;
+    double adxcdy = adx * cdy;
+    double adxbdy = adx * bdy;
+    double bdxady = bdx * ady;
+    double alift = adx * adx + ady * ady;
+    double blift = bdx * bdx + bdy * bdy;
+    double clift = cdx * cdx + cdy * cdy;
+
+    double determinant = alift * (bdxcdy - cdxbdy) + blift * (cdxady - adxcdy) + clift * (adxbdy - bdxady);
+    double permanent = (std::abs(bdxcdy) + std::abs(cdxbdy)) * alift + (std::abs(cdxady) + std::abs(adxcdy)) * blift +
+                       (std::abs(adxbdy) + std::abs(bdxady)) * clift;
+    double bound = inCircleBound * permanent;
+    if (determinant > bound || -determinant > bound) {
+        return determinant > 0.0 ? 1 : -1;
+    }
+    return inCircleExact(a, b, c, d);
+}
+
+}
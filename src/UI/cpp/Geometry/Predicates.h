@@ -0,0 +1,17 @@
+#pragma once
+
+namespace Geometry {
+
+// The two tests a Delaunay triangulation is made of, with the exact sign for any double input.
+// The floating point result is taken when it is farther from 0 than its rounding error can be,
+// the rest is evaluated exactly on Shewchuk's expansions; only nearly degenerate input, like
+// the cocircular points of a grid, pays for that. Points are x, y pairs.
+
+// > 0 when c is left of the line from a to b, < 0 when it is right of it, 0 when on it
+int orientation(const double* a, const double* b, const double* c);
+
+// > 0 when d is inside the circle through a, b and c, which are counterclockwise; < 0 when
+// outside, 0 when on it
+int inCircle(const double* a, const double* b, const double* c, const double* d);
+
+}
@@ -0,0 +1,100 @@
+#include "Raster.h"
+#include <QByteArray>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <unistd.h>
+
+namespace Geometry {
+
+namespace {
+
+// pread until everything is there, it may return less than asked
+void readFully(int file, void* data, size_t size, uint64_t offset, const std::string& fileName)
+{
+    char* bytes = static_cast<char*>(data);
+    while (size > 0) {
+        ssize_t count = pread(file, bytes, size, (off_t)offset);
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count <= 0) {
+            throw std::runtime_error("can't read file " + fileName + (count < 0 ? strerror(errno) : " (truncated)"));
+        }
+        bytes += count;
+        size -= (size_t)count;
+        offset += (uint64_t)count;
+    }
+}
+
+}
+
+std::shared_ptr<const Raster> Raster::open(const std::string& fileName, const std::string& name)
+{
+    return std::shared_ptr<const Raster>(new Raster(fileName, name));
+}
+
+Raster::Raster(const std::string& fileName, const std::string& name) :
+    _fileName(fileName),
+    _name(name)
+{
+    _file = ::open(fileName.c_str(), O_RDONLY | O_CLOEXEC);
+    if (_file < 0) {
+        throw std::runtime_error("can't open file " + fileName + strerror(errno));
+    }
+    try {
+        readFully(_file, &_header, sizeof(_header), 0, fileName);
+        if (std::memcmp(_header.magic, FileHeader::magicValue, sizeof(_header.magic)) != 0 ||
+            _header.version != FileHeader::currentVersion || _header.levelCount == 0 || _header.tileSize == 0) {
+            throw std::runtime_error(fileName + " isn't a raster cache of this version");
+        }
+        _levels.resize(_header.levelCount);
+        _tiles.resize(_header.tileCount);
+        readFully(_file, _levels.data(), _levels.size() * sizeof(Level), _header.tablesOffset, fileName);
+        readFully(_file, _tiles.data(), _tiles.size() * sizeof(Tile),
+                  _header.tablesOffset + _levels.size() * sizeof(Level), fileName);
+        for (const Level& level : _levels) {
+            if (level.firstTile + (uint64_t)level.tilesX * level.tilesY > _tiles.size()) {
+                throw std::runtime_error(fileName + " has a broken tile table");
+            }
+        }
+    } catch (...) {
+        ::close(_file);
+        throw;
+    }
+
+    const double* a = _header.georeference;
+    for (double column : {0.0, (double)_header.width}) {
+        for (double row : {0.0, (double)_header.height}) {
+            _bounds.expand((float)(a[0] + a[1] * column + a[2] * row), (float)(a[3] + a[4] * column + a[5] * row));
+        }
+    }
+}
+
+Raster::~Raster()
+{
+    if (_file >= 0) {
+        ::close(_file);
+    }
+}
+
+void Raster::readTile(size_t tile, std::vector<uint8_t>& rgba) const
+{
+    size_t size = (size_t)_header.tileSize * _header.tileSize * 4;
+    const Tile& entry = _tiles[tile];
+    if (entry.size == 0) {
+        rgba.assign(size, 0);
+        return;
+    }
+    // qCompress'ed, the expected size in front
+    QByteArray packed(entry.size, Qt::Uninitialized);
+    readFully(_file, packed.data(), entry.size, entry.offset, _fileName);
+    QByteArray unpacked = qUncompress(packed);
+    if ((size_t)unpacked.size() != size) {
+        throw std::runtime_error(_fileName + " has a broken tile");
+    }
+    rgba.assign(unpacked.constData(), unpacked.constData() + size);
+}
+
+}
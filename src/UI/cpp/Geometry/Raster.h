@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "BoundingBox.h"
+
+namespace Geometry {
+
+// An image too large for memory, as a mip pyramid of square RGBA tiles in a cache file written
+// by Import::RasterPyramidBuilder. Level 0 has the image's full resolution, every level above
+// half the one below, up to the level fitting into one tile. Tiles are stored compressed; the
+// ones entirely transparent aren't stored at all. Only the tile table is in memory, tiles are
+// read and decompressed by readTile() from any thread. Immutable once opened, shared by the
+// document and the views drawing it.
+class Raster
+{
+public:
+    struct Level
+    {
+        uint32_t width;
+        uint32_t height;
+        uint32_t tilesX;
+        uint32_t tilesY;
+        // index of the level's first tile in the tile table, row by row
+        uint64_t firstTile;
+    };
+
+    struct Tile
+    {
+        uint64_t offset;
+        // 0 for a tile that is transparent throughout
+        uint32_t size;
+        uint32_t reserved;
+    };
+
+    // what starts the cache file; the tiles follow, the level and tile tables come last
+    struct FileHeader
+    {
+        static constexpr char magicValue[8] = {'G', 'C', 'R', 'A', 'S', 'T', 'E', 'R'};
+        static constexpr uint32_t currentVersion = 1;
+
+        char magic[8];
+        uint32_t version;
+        uint32_t tileSize;
+        uint32_t width;
+        uint32_t height;
+        uint32_t levelCount;
+        uint32_t reserved;
+        uint64_t tileCount;
+        uint64_t tablesOffset;
+        // from level 0 pixels, (0, 0) at the outer corner of the first one, to document
+        // coordinates: x = a[0] + a[1] * column + a[2] * row, y = a[3] + a[4] * column + a[5] * row
+        double georeference[6];
+        // what the cache was built from, a cache not matching its source is built again
+        uint64_t sourceSize;
+        int64_t sourceModified;
+        int32_t sourceEpsg;
+        int32_t documentEpsg;
+    };
+
+    // throws when the file isn't a cache of the current version
+    static std::shared_ptr<const Raster> open(const std::string& fileName, const std::string& name);
+
+    ~Raster();
+
+    Raster(const Raster&) = delete;
+    Raster& operator=(const Raster&) = delete;
+
+    // of the image, the layer it is added to has the same
+    const std::string& name() const { return _name; }
+    const FileHeader& header() const { return _header; }
+    uint32_t tileSize() const { return _header.tileSize; }
+    // of the image's four corners in the document
+    const BoundingBox& bounds() const { return _bounds; }
+
+    const std::vector<Level>& levels() const { return _levels; }
+    const std::vector<Tile>& tiles() const { return _tiles; }
+    size_t tileIndex(size_t level, uint32_t x, uint32_t y) const
+    {
+        return _levels[level].firstTile + (size_t)y * _levels[level].tilesX + x;
+    }
+
+    // tileSize() * tileSize() RGBA texels, rows going down the image; throws on a broken tile.
+    // Safe to call from several threads at once.
+    void readTile(size_t tile, std::vector<uint8_t>& rgba) const;
+
+private:
+    Raster(const std::string& fileName, const std::string& name);
+
+    std::string _fileName;
+    std::string _name;
+    int _file = -1;
+    FileHeader _header = {};
+    BoundingBox _bounds;
+    std::vector<Level> _levels;
+    std::vector<Tile> _tiles;
+};
+
+}
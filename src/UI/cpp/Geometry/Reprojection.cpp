@@ -0,0 +1,141 @@
+#include "Reprojection.h"
+
+#include <cmath>
+#include <numbers>
+#include <utility>
+#include <vector>
+
+#include "Library/Concurrency/ThreadPool.h"
+
+namespace Geometry {
+
+namespace {
+
+// the points of all entities of one list side by side, converted in one call; y of the
+// document points down, the systems' latitudes and northings up, so it's negated both ways
+struct Points
+{
+    explicit Points(size_t count) : x(count), y(count) {}
+
+    void set(size_t index, float px, float py)
+    {
+        x[index] = px;
+        y[index] = -(double)py;
+    }
+
+    // converted back into document coordinates
+    double documentX(size_t index) const
+    {
+        return x[index];
+    }
+
+    double documentY(size_t index) const
+    {
+        return -y[index];
+    }
+
+    std::vector<double> x;
+    std::vector<double> y;
+};
+
+constexpr float fullTurn = 2.0f * std::numbers::pi_v<float>;
+
+}
+
+ReprojectedEntities reprojected(const Layer& layer, const Geodesy::Transform& transform,
+                                Concurrency::ThreadPool& pool)
+{
+    QVector<Line> lines = layer.lines.get();
+    Points linePoints(lines.size() * 2);
+    for (qsizetype i = 0; i < lines.size(); ++i) {
+        linePoints.set(2 * i, lines[i].vertices[0].pos[0], lines[i].vertices[0].pos[1]);
+        linePoints.set(2 * i + 1, lines[i].vertices[1].pos[0], lines[i].vertices[1].pos[1]);
+    }
+    transform.apply(linePoints.x.data(), linePoints.y.data(), linePoints.x.size(), pool);
+    for (qsizetype i = 0; i < lines.size(); ++i) {
+        for (int end = 0; end < 2; ++end) {
+            lines[i].vertices[end].pos[0] = (float)linePoints.documentX(2 * i + end);
+            lines[i].vertices[end].pos[1] = (float)linePoints.documentY(2 * i + end);
+        }
+    }
+
+    // the center and the point east of it
+    QVector<Circle> circles = layer.circles.get();
+    Points circlePoints(circles.size() * 2);
+    for (qsizetype i = 0; i < circles.size(); ++i) {
+        const Circle& circle = circles[i];
+        circlePoints.set(2 * i, circle.center[0], circle.center[1]);
+        circlePoints.set(2 * i + 1, circle.center[0] + circle.radius, circle.center[1]);
+    }
+    transform.apply(circlePoints.x.data(), circlePoints.y.data(), circlePoints.x.size(), pool);
+    for (qsizetype i = 0; i < circles.size(); ++i) {
+        Circle& circle = circles[i];
+        circle.center[0] = (float)circlePoints.documentX(2 * i);
+        circle.center[1] = (float)circlePoints.documentY(2 * i);
+        circle.radius = (float)std::hypot(circlePoints.x[2 * i + 1] - circlePoints.x[2 * i],
+                                          circlePoints.y[2 * i + 1] - circlePoints.y[2 * i]);
+    }
+
+    // the center and both end points, the angles follow the ends
+    QVector<Arc> arcs = layer.arcs.get();
+    Points arcPoints(arcs.size() * 3);
+    for (qsizetype i = 0; i < arcs.size(); ++i) {
+        const Arc& arc = arcs[i];
+        float point[2];
+        arcPoints.set(3 * i, arc.center[0], arc.center[1]);
+        arc.pointAt(arc.startAngle, point);
+        arcPoints.set(3 * i + 1, point[0], point[1]);
+        arc.pointAt(arc.endAngle(), point);
+        arcPoints.set(3 * i + 2, point[0], point[1]);
+    }
+    transform.apply(arcPoints.x.data(), arcPoints.y.data(), arcPoints.x.size(), pool);
+    for (qsizetype i = 0; i < arcs.size(); ++i) {
+        Arc& arc = arcs[i];
+        // the angles turn towards +y of the document, they're taken after flipping back
+        double centerX = arcPoints.documentX(3 * i);
+        double centerY = arcPoints.documentY(3 * i);
+        double startX = arcPoints.documentX(3 * i + 1) - centerX;
+        double startY = arcPoints.documentY(3 * i + 1) - centerY;
+        float start = (float)std::atan2(startY, startX);
+        float end = (float)std::atan2(arcPoints.documentY(3 * i + 2) - centerY,
+                                      arcPoints.documentX(3 * i + 2) - centerX);
+        arc.center[0] = (float)centerX;
+        arc.center[1] = (float)centerY;
+        arc.radius = (float)std::hypot(startX, startY);
+        // a full circle has both ends in one point, keep it full
+        if (arc.sweepAngle < fullTurn - 1e-4f) {
+            float sweep = std::fmod(end - start, fullTurn);
+            arc.sweepAngle = sweep <= 0.0f ? sweep + fullTurn : sweep;
+        }
+        arc.startAngle = start;
+    }
+
+    QVector<Vertex> vertices = layer.polylines.vertices().get();
+    Points vertexPoints(vertices.size());
+    for (qsizetype i = 0; i < vertices.size(); ++i) {
+        vertexPoints.set(i, vertices[i].pos[0], vertices[i].pos[1]);
+    }
+    transform.apply(vertexPoints.x.data(), vertexPoints.y.data(), vertexPoints.x.size(), pool);
+    for (qsizetype i = 0; i < vertices.size(); ++i) {
+        vertices[i].pos[0] = (float)vertexPoints.documentX(i);
+        vertices[i].pos[1] = (float)vertexPoints.documentY(i);
+    }
+    return ReprojectedEntities{std::move(lines), std::move(circles), std::move(arcs), std::move(vertices)};
+}
+
+void replaceEntities(Layer& layer, const ReprojectedEntities& entities)
+{
+    layer.lines.set(entities.lines);
+    layer.circles.set(entities.circles);
+    layer.arcs.set(entities.arcs);
+    layer.polylines.setVertices(entities.vertices);
+}
+
+void reproject(Layer& layer, const Geodesy::Transform& transform, Concurrency::ThreadPool& pool)
+{
+    if (!transform.isIdentity()) {
+        replaceEntities(layer, reprojected(layer, transform, pool));
+    }
+}
+
+}
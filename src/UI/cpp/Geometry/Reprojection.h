@@ -0,0 +1,35 @@
+#pragma once
+
+#include "Library/Geodesy/Transform.h"
+#include "Layer.h"
+
+namespace Concurrency {
+class ThreadPool;
+}
+
+namespace Geometry {
+
+// The entities of a layer converted into another system, see reprojected().
+struct ReprojectedEntities
+{
+    QVector<Line> lines;
+    QVector<Circle> circles;
+    QVector<Arc> arcs;
+    // of the polyline pool, the polylines keep their records
+    QVector<Vertex> vertices;
+};
+
+// Converts every entity of the layer with the transform without touching the layer, so the
+// layers of a document can all be converted before any of them is replaced. Circles and arcs
+// stay circular: their centers are converted and their radii measured to the converted points
+// on them, which is exact to the scale change across the circle.
+ReprojectedEntities reprojected(const Layer& layer, const Geodesy::Transform& transform,
+                                Concurrency::ThreadPool& pool);
+
+// replaces the layer's entities, each list in one bulk set()
+void replaceEntities(Layer& layer, const ReprojectedEntities& entities);
+
+// both at once, for a single layer
+void reproject(Layer& layer, const Geodesy::Transform& transform, Concurrency::ThreadPool& pool);
+
+}
@@ -0,0 +1,29 @@
+#include "Tin.h"
+#include <algorithm>
+#include <utility>
+
+namespace Geometry {
+
+Tin::Tin(std::string name, std::vector<TinPoint> points, std::vector<uint32_t> triangles,
+         std::vector<uint32_t> opposites, std::vector<Chunk> chunks, std::vector<Overview> overviews) :
+    _name(std::move(name)),
+    _points(std::move(points)),
+    _triangles(std::move(triangles)),
+    _opposites(std::move(opposites)),
+    _chunks(std::move(chunks)),
+    _overviews(std::move(overviews))
+{
+    size_t hull = std::count(_opposites.begin(), _opposites.end(), none);
+    _edgeCount = (_opposites.size() + hull) / 2;
+    for (const Chunk& chunk : _chunks) {
+        _bounds.expand(chunk.bounds);
+    }
+    if (!_points.empty()) {
+        auto [lowest, highest] = std::minmax_element(_points.begin(), _points.end(),
+                                                     [](const TinPoint& a, const TinPoint& b) { return a.pos[2] < b.pos[2]; });
+        _minElevation = lowest->pos[2];
+        _maxElevation = highest->pos[2];
+    }
+}
+
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "BoundingBox.h"
+
+namespace Geometry {
+
+// a vertex of a Tin: x and y in document coordinates, the elevation in the document's units
+struct TinPoint
+{
+    double pos[3];
+};
+
+// A triangulated irregular network, the terrain surface built by TinBuilder from survey points,
+// in a compact half-edge form. Triangle t is made of the half-edges 3t, 3t + 1 and 3t + 2,
+// counterclockwise; half-edge e runs from vertex triangles()[e] to the start of next(e), and
+// opposites()[e] is the half-edge running the other way along the same edge in the neighbouring
+// triangle, none on the hull; 8 bytes per half-edge, about 48 per point. The triangles are
+// grouped into compact patches, the chunks, which views cull and upload one at a time. For
+// drawing from afar there are overviews, coarser surfaces of the same points.
+// Immutable once built, shared by the document and the views drawing it.
+class Tin
+{
+public:
+    static constexpr uint32_t none = std::numeric_limits<uint32_t>::max();
+    // triangles of a chunk at most
+    static constexpr uint32_t chunkTriangles = 16384;
+
+    // consecutive triangles, close to each other
+    struct Chunk
+    {
+        uint32_t firstTriangle;
+        uint32_t triangleCount;
+        BoundingBox bounds;
+    };
+
+    // The Delaunay triangulation of every 4^k-th point, k from 1 on, triangles into points()
+    // like those of the surface; the breaklines aren't in it. Only for drawing.
+    struct Overview
+    {
+        std::vector<uint32_t> triangles;
+        std::vector<Chunk> chunks;
+    };
+
+    Tin(std::string name, std::vector<TinPoint> points, std::vector<uint32_t> triangles,
+        std::vector<uint32_t> opposites, std::vector<Chunk> chunks, std::vector<Overview> overviews);
+
+    Tin(const Tin&) = delete;
+    Tin& operator=(const Tin&) = delete;
+
+    static uint32_t next(uint32_t halfEdge) { return halfEdge % 3 == 2 ? halfEdge - 2 : halfEdge + 1; }
+    static uint32_t previous(uint32_t halfEdge) { return halfEdge % 3 == 0 ? halfEdge + 2 : halfEdge - 1; }
+
+    // of the surface, the layer it is added to has the same
+    const std::string& name() const { return _name; }
+    const std::vector<TinPoint>& points() const { return _points; }
+    const std::vector<uint32_t>& triangles() const { return _triangles; }
+    const std::vector<uint32_t>& opposites() const { return _opposites; }
+    const std::vector<Chunk>& chunks() const { return _chunks; }
+    // coarser and coarser, down to one chunk
+    const std::vector<Overview>& overviews() const { return _overviews; }
+
+    size_t triangleCount() const { return _triangles.size() / 3; }
+    // every edge once, the hull's included
+    size_t edgeCount() const { return _edgeCount; }
+    const BoundingBox& bounds() const { return _bounds; }
+    double minElevation() const { return _minElevation; }
+    double maxElevation() const { return _maxElevation; }
+
+private:
+    std::string _name;
+    std::vector<TinPoint> _points;
+    std::vector<uint32_t> _triangles;
+    std::vector<uint32_t> _opposites;
+    std::vector<Chunk> _chunks;
+    std::vector<Overview> _overviews;
+    size_t _edgeCount = 0;
+    BoundingBox _bounds;
+    double _minElevation = 0.0;
+    double _maxElevation = 0.0;
+};
+
+}
@@ -0,0 +1,869 @@
+#include "TinBuilder.h"
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <stdexcept>
+#include <utility>
+
+#include "Library/Concurrency/ThreadPool.h"
+#include "Predicates.h"
+
+namespace Geometry {
+
+namespace {
+
+constexpr uint32_t none = Tin::none;
+// ranges of more points triangulate their halves on the pool at the same time
+constexpr size_t parallelPoints = 1 << 15;
+// ranges of at most so many points are cut along one axis only, sorting them is cheaper
+constexpr size_t straightCuts = 16;
+// half-edges or triangles per task of the passes over all of them
+constexpr size_t blockSize = 1 << 16;
+// points of the patches the triangles are grouped by, about half the triangles of a chunk
+constexpr size_t blockPoints = Tin::chunkTriangles / 2;
+
+struct SortPoint
+{
+    double pos[3];
+    // index into the points, then into the vertices of the breaklines
+    uint32_t source;
+};
+
+bool lessAlongX(const SortPoint& a, const SortPoint& b)
+{
+    if (a.pos[0] != b.pos[0]) {
+        return a.pos[0] < b.pos[0];
+    }
+    if (a.pos[1] != b.pos[1]) {
+        return a.pos[1] < b.pos[1];
+    }
+    return a.source < b.source;
+}
+
+// sorted in parts on the pool, the parts merged pairwise
+void parallelSort(std::vector<SortPoint>& points, Concurrency::ThreadPool& pool)
+{
+    size_t parts = 1;
+    while (parts < pool.threadCount() * 4 && points.size() / parts > blockSize) {
+        parts *= 2;
+    }
+    auto bound = [&](size_t part) { return points.begin() + points.size() * part / parts; };
+    pool.parallelFor(parts, [&](size_t part) { std::sort(bound(part), bound(part + 1), lessAlongX); });
+    for (size_t width = 1; width < parts; width *= 2) {
+        pool.parallelFor(parts / (2 * width), [&](size_t i) {
+            std::inplace_merge(bound(2 * i * width), bound((2 * i + 1) * width), bound((2 * i + 2) * width),
+                               lessAlongX);
+        });
+    }
+}
+
+// Ranges are halved across x and across y in turn, Dwyer's alternating cuts: the halves a merge
+// zips together stay about square instead of becoming ever thinner strips, whose merges delete
+// most of what was built in them. Along axis 1 the order is that along x turned a quarter
+// counterclockwise, from top to bottom.
+bool lessAlong(int axis, const double* a, const double* b)
+{
+    if (axis == 0) {
+        return a[0] < b[0] || (a[0] == b[0] && a[1] < b[1]);
+    }
+    return a[1] > b[1] || (a[1] == b[1] && a[0] < b[0]);
+}
+
+// the points of [lo, hi) in the order Subdivision halves them; sorted tells they are along the axis
+void arrange(std::vector<SortPoint>& points, size_t lo, size_t hi, int axis, bool sorted,
+             Concurrency::ThreadPool& pool)
+{
+    auto less = [axis](const SortPoint& a, const SortPoint& b) { return lessAlong(axis, a.pos, b.pos); };
+    size_t count = hi - lo;
+    if (count <= straightCuts) {
+        std::sort(points.begin() + lo, points.begin() + hi, less);
+        return;
+    }
+    size_t middle = lo + count / 2;
+    if (!sorted) {
+        std::nth_element(points.begin() + lo, points.begin() + middle, points.begin() + hi, less);
+    }
+    if (count > parallelPoints) {
+        pool.parallelFor(2, [&](size_t half) {
+            arrange(points, half == 0 ? lo : middle, half == 0 ? middle : hi, 1 - axis, false, pool);
+        });
+    } else {
+        arrange(points, lo, middle, 1 - axis, false, pool);
+        arrange(points, middle, hi, 1 - axis, false, pool);
+    }
+}
+
+// The edges a range of points may take: its own slice of the arrays, and what its merges
+// deleted. A planar subdivision of m points has at most 3m edges, so the slice never runs out.
+struct EdgePool
+{
+    // first half-edges of the pairs not taken yet
+    uint32_t next;
+    uint32_t end;
+    std::vector<uint32_t> free;
+
+    uint32_t take()
+    {
+        if (!free.empty()) {
+            uint32_t edge = free.back();
+            free.pop_back();
+            return edge;
+        }
+        if (next == end) {
+            throw std::logic_error("a triangulation ran out of edges");
+        }
+        uint32_t edge = next;
+        next += 2;
+        return edge;
+    }
+
+    // the slice from at on, for the other half of the range; only before anything was taken
+    EdgePool split(uint32_t at)
+    {
+        EdgePool rest{at, end, {}};
+        end = at;
+        return rest;
+    }
+
+    void absorb(EdgePool& other)
+    {
+        free.insert(free.end(), other.free.begin(), other.free.end());
+        for (uint32_t edge = other.next; edge < other.end; edge += 2) {
+            free.push_back(edge);
+        }
+    }
+};
+
+// Guibas and Stolfi's edge algebra cut down to what the divide and conquer needs: half-edges
+// in pairs, e ^ 1 the other half of e, and the ring of half-edges leaving each vertex,
+// counterclockwise through onext and back through oprev. Points i of [lo, hi) take the
+// half-edges [6 lo, 6 hi). The points are in the order of arrange().
+class Subdivision {
+public:
+    Subdivision(const std::vector<TinPoint>& points, Concurrency::ThreadPool& pool) :
+        _points(points),
+        _pool(pool),
+        _origin(6 * points.size(), none),
+        _onext(6 * points.size()),
+        _oprev(6 * points.size())
+    {
+        EdgePool edges{0, (uint32_t)_origin.size(), {}};
+        triangulate(0, (uint32_t)points.size(), 0, edges);
+    }
+
+    // the faces that are counterclockwise triangles, opposites as in Tin
+    void extract(std::vector<uint32_t>& triangles, std::vector<uint32_t>& opposites)
+    {
+        // a triangle belongs to its smallest half-edge; first counted per block, then written
+        // from the block's offset, so the order doesn't depend on the pool
+        size_t blocks = (_origin.size() + blockSize - 1) / blockSize;
+        std::vector<size_t> offsets(blocks + 1, 0);
+        _pool.parallelFor(blocks, [&](size_t block) {
+            size_t count = 0;
+            for (uint32_t e = block * blockSize; e < std::min((block + 1) * blockSize, _origin.size()); ++e) {
+                count += owns(e);
+            }
+            offsets[block + 1] = count;
+        });
+        for (size_t block = 0; block < blocks; ++block) {
+            offsets[block + 1] += offsets[block];
+        }
+
+        // onext isn't needed anymore, it becomes the slot of each half-edge in the triangles
+        std::vector<uint32_t>& slots = _onext;
+        _pool.parallelFor(blocks, [&](size_t block) {
+            std::fill(slots.begin() + block * blockSize, slots.begin() + std::min((block + 1) * blockSize, slots.size()),
+                      none);
+        });
+        triangles.resize(offsets[blocks] * 3);
+        _pool.parallelFor(blocks, [&](size_t block) {
+            uint32_t slot = (uint32_t)offsets[block] * 3;
+            for (uint32_t e = block * blockSize; e < std::min((block + 1) * blockSize, _origin.size()); ++e) {
+                if (!owns(e)) {
+                    continue;
+                }
+                uint32_t edges[3] = {e, lnext(e), lnext(lnext(e))};
+                for (uint32_t edge : edges) {
+                    triangles[slot] = _origin[edge];
+                    slots[edge] = slot++;
+                }
+            }
+        });
+        opposites.assign(triangles.size(), none);
+        _pool.parallelFor(blocks, [&](size_t block) {
+            for (uint32_t e = block * blockSize; e < std::min((block + 1) * blockSize, slots.size()); ++e) {
+                if (slots[e] != none) {
+                    opposites[slots[e]] = slots[e ^ 1];
+                }
+            }
+        });
+    }
+
+private:
+    const double* pos(uint32_t vertex) const { return _points[vertex].pos; }
+    uint32_t destination(uint32_t e) const { return _origin[e ^ 1]; }
+    // next half-edge counterclockwise around the face left of e
+    uint32_t lnext(uint32_t e) const { return _oprev[e ^ 1]; }
+    // next half-edge clockwise around the face right of e
+    uint32_t rprev(uint32_t e) const { return _onext[e ^ 1]; }
+
+    bool rightOf(uint32_t vertex, uint32_t e) const
+    {
+        return orientation(pos(vertex), pos(destination(e)), pos(_origin[e])) > 0;
+    }
+
+    bool leftOf(uint32_t vertex, uint32_t e) const
+    {
+        return orientation(pos(vertex), pos(_origin[e]), pos(destination(e))) > 0;
+    }
+
+    bool owns(uint32_t e) const
+    {
+        if (_origin[e] == none) {
+            return false;
+        }
+        uint32_t b = lnext(e);
+        uint32_t c = lnext(b);
+        // the outer face of three points is clockwise
+        return lnext(c) == e && e < b && e < c &&
+               orientation(pos(_origin[e]), pos(_origin[b]), pos(_origin[c])) > 0;
+    }
+
+    uint32_t makeEdge(EdgePool& edges, uint32_t from, uint32_t to)
+    {
+        uint32_t e = edges.take();
+        _origin[e] = from;
+        _origin[e ^ 1] = to;
+        _onext[e] = _oprev[e] = e;
+        _onext[e ^ 1] = _oprev[e ^ 1] = e ^ 1;
+        return e;
+    }
+
+    // joins the rings of a and b when they are apart, splits them when they are one
+    void splice(uint32_t a, uint32_t b)
+    {
+        uint32_t aNext = _onext[a];
+        uint32_t bNext = _onext[b];
+        _onext[a] = bNext;
+        _onext[b] = aNext;
+        _oprev[bNext] = a;
+        _oprev[aNext] = b;
+    }
+
+    // a new edge from the destination of a to the origin of b, the face left of both
+    uint32_t connect(EdgePool& edges, uint32_t a, uint32_t b)
+    {
+        uint32_t e = makeEdge(edges, destination(a), _origin[b]);
+        splice(e, lnext(a));
+        splice(e ^ 1, b);
+        return e;
+    }
+
+    void deleteEdge(EdgePool& edges, uint32_t e)
+    {
+        splice(e, _oprev[e]);
+        splice(e ^ 1, _oprev[e ^ 1]);
+        _origin[e] = _origin[e ^ 1] = none;
+        edges.free.push_back(e & ~1u);
+    }
+
+    // The hull edges of a triangulation leaving its first and last point along the axis: the
+    // counterclockwise one, the outer face right of it, and the clockwise one. Found walking
+    // the hull from any counterclockwise edge of it.
+    std::pair<uint32_t, uint32_t> extremes(uint32_t hullEdge, int axis) const
+    {
+        uint32_t first = hullEdge;
+        uint32_t last = hullEdge;
+        uint32_t e = hullEdge;
+        do {
+            if (lessAlong(axis, pos(_origin[e]), pos(_origin[first]))) {
+                first = e;
+            }
+            if (lessAlong(axis, pos(_origin[last]), pos(_origin[e]))) {
+                last = e;
+            }
+            e = rprev(e);
+        } while (e != hullEdge);
+        return {first, _oprev[last]};
+    }
+
+    // the points [lo, hi), in the order along the axis from their first to their last; returns
+    // the counterclockwise hull edge leaving the first point and the clockwise one leaving the last
+    std::pair<uint32_t, uint32_t> triangulate(uint32_t lo, uint32_t hi, int axis, EdgePool& edges)
+    {
+        uint32_t count = hi - lo;
+        if (count == 2) {
+            uint32_t a = makeEdge(edges, lo, lo + 1);
+            return {a, a ^ 1};
+        }
+        if (count == 3) {
+            uint32_t a = makeEdge(edges, lo, lo + 1);
+            uint32_t b = makeEdge(edges, lo + 1, lo + 2);
+            splice(a ^ 1, b);
+            int side = orientation(pos(lo), pos(lo + 1), pos(lo + 2));
+            if (side > 0) {
+                connect(edges, b, a);
+                return {a, b ^ 1};
+            }
+            if (side < 0) {
+                uint32_t c = connect(edges, b, a);
+                return {c ^ 1, c};
+            }
+            return {a, b ^ 1};
+        }
+
+        uint32_t middle = lo + count / 2;
+        std::pair<uint32_t, uint32_t> left;
+        std::pair<uint32_t, uint32_t> right;
+        int halfAxis = count > straightCuts ? 1 - axis : axis;
+        if (count > parallelPoints) {
+            EdgePool rightEdges = edges.split(6 * middle);
+            _pool.parallelFor(2, [&](size_t half) {
+                if (half == 0) {
+                    left = triangulate(lo, middle, halfAxis, edges);
+                } else {
+                    right = triangulate(middle, hi, halfAxis, rightEdges);
+                }
+            });
+            edges.absorb(rightEdges);
+        } else {
+            left = triangulate(lo, middle, halfAxis, edges);
+            right = triangulate(middle, hi, halfAxis, edges);
+        }
+        if (halfAxis == axis) {
+            return merge(left, right, edges);
+        }
+        // the halves were split the other way, they are merged as two sides of this one
+        return merge(extremes(left.first, axis), extremes(right.first, axis), edges);
+    }
+
+    std::pair<uint32_t, uint32_t> merge(std::pair<uint32_t, uint32_t> left, std::pair<uint32_t, uint32_t> right,
+                                        EdgePool& edges)
+    {
+        auto [ldo, ldi] = left;
+        auto [rdi, rdo] = right;
+        // the lower common tangent of the two hulls
+        while (true) {
+            if (leftOf(_origin[rdi], ldi)) {
+                ldi = lnext(ldi);
+            } else if (rightOf(_origin[ldi], rdi)) {
+                rdi = rprev(rdi);
+            } else {
+                break;
+            }
+        }
+        uint32_t base = connect(edges, rdi ^ 1, ldi);
+        if (_origin[ldi] == _origin[ldo]) {
+            ldo = base ^ 1;
+        }
+        if (_origin[rdi] == _origin[rdo]) {
+            rdo = base;
+        }
+
+        // zip upwards, the edges of either side whose circles the other side enters go
+        auto valid = [&](uint32_t e) { return rightOf(destination(e), base); };
+        while (true) {
+            uint32_t leftCandidate = _onext[base ^ 1];
+            if (valid(leftCandidate)) {
+                while (inCircle(pos(destination(base)), pos(_origin[base]), pos(destination(leftCandidate)),
+                                pos(destination(_onext[leftCandidate]))) > 0) {
+                    uint32_t next = _onext[leftCandidate];
+                    deleteEdge(edges, leftCandidate);
+                    leftCandidate = next;
+                }
+            }
+            uint32_t rightCandidate = _oprev[base];
+            if (valid(rightCandidate)) {
+                while (inCircle(pos(destination(base)), pos(_origin[base]), pos(destination(rightCandidate)),
+                                pos(destination(_oprev[rightCandidate]))) > 0) {
+                    uint32_t next = _oprev[rightCandidate];
+                    deleteEdge(edges, rightCandidate);
+                    rightCandidate = next;
+                }
+            }
+            bool leftValid = valid(leftCandidate);
+            bool rightValid = valid(rightCandidate);
+            if (!leftValid && !rightValid) {
+                break;
+            }
+            if (!leftValid || (rightValid && inCircle(pos(destination(leftCandidate)), pos(_origin[leftCandidate]),
+                                                      pos(_origin[rightCandidate]), pos(destination(rightCandidate))) > 0)) {
+                base = connect(edges, rightCandidate, base ^ 1);
+            } else {
+                base = connect(edges, base ^ 1, leftCandidate ^ 1);
+            }
+        }
+        return {ldo, rdo};
+    }
+
+    const std::vector<TinPoint>& _points;
+    Concurrency::ThreadPool& _pool;
+    std::vector<uint32_t> _origin;
+    std::vector<uint32_t> _onext;
+    std::vector<uint32_t> _oprev;
+};
+
+// Forces segments between vertices into a triangulation in the form of Tin, Sloan's way: the
+// edges the segment crosses are flipped until none is left, then the new edges are flipped
+// back where they aren't Delaunay, the segment and earlier ones excepted.
+class BreaklineInserter {
+public:
+    BreaklineInserter(const std::vector<TinPoint>& points, std::vector<uint32_t>& triangles,
+                      std::vector<uint32_t>& opposites) :
+        _points(points),
+        _triangles(triangles),
+        _opposites(opposites),
+        _constrained(triangles.size(), false),
+        _vertexEdges(points.size(), none)
+    {
+        for (uint32_t e = 0; e < triangles.size(); ++e) {
+            _vertexEdges[triangles[e]] = e;
+        }
+    }
+
+    // false when the segment crosses a breakline inserted before, the part up to a vertex on
+    // it may be in already
+    bool insert(uint32_t a, uint32_t b)
+    {
+        while (a != b) {
+            uint32_t existing = find(a, b);
+            if (existing != none) {
+                constrain(existing);
+                return true;
+            }
+
+            // the triangle at a the segment leaves through, or a vertex it runs into on the way
+            uint32_t via = none;
+            uint32_t crossed = none;
+            forEachLeaving(a, [&](uint32_t e) {
+                uint32_t right = _triangles[Tin::next(e)];
+                uint32_t left = _triangles[Tin::previous(e)];
+                int rightSide = orientation(pos(a), pos(b), pos(right));
+                int leftSide = orientation(pos(a), pos(b), pos(left));
+                if (rightSide == 0 && ahead(a, b, right)) {
+                    via = right;
+                } else if (leftSide == 0 && ahead(a, b, left)) {
+                    via = left;
+                } else if (rightSide < 0 && leftSide > 0) {
+                    crossed = Tin::next(e);
+                }
+                return via != none || crossed != none;
+            });
+            if (via != none) {
+                constrain(find(a, via));
+                a = via;
+                continue;
+            }
+            if (crossed == none) {
+                return false;
+            }
+
+            // the edges crossed on the way to b, or to a vertex on the segment before it
+            uint32_t end = b;
+            std::deque<std::pair<uint32_t, uint32_t>> crossing;
+            while (true) {
+                if (_constrained[crossed] || _opposites[crossed] == none) {
+                    return false;
+                }
+                crossing.emplace_back(_triangles[crossed], _triangles[Tin::next(crossed)]);
+                uint32_t back = _opposites[crossed];
+                uint32_t beyond = _triangles[Tin::previous(back)];
+                if (beyond == b) {
+                    break;
+                }
+                int side = orientation(pos(a), pos(b), pos(beyond));
+                if (side == 0) {
+                    end = beyond;
+                    break;
+                }
+                crossed = side > 0 ? Tin::next(back) : Tin::previous(back);
+            }
+
+            std::vector<std::pair<uint32_t, uint32_t>> created;
+            while (!crossing.empty()) {
+                auto [u, v] = crossing.front();
+                crossing.pop_front();
+                uint32_t e = find(u, v);
+                uint32_t r = _triangles[Tin::previous(e)];
+                uint32_t s = _triangles[Tin::previous(_opposites[e])];
+                // only the diagonal of a convex quadrilateral can be flipped, the others come
+                // round again once their neighbours moved
+                if (orientation(pos(r), pos(s), pos(u)) * orientation(pos(r), pos(s), pos(v)) >= 0) {
+                    crossing.emplace_back(u, v);
+                    continue;
+                }
+                flip(e);
+                if (crosses(r, s, a, end)) {
+                    crossing.emplace_back(r, s);
+                } else {
+                    created.emplace_back(r, s);
+                }
+            }
+            constrain(find(a, end));
+            restoreDelaunay(created, a, end);
+            a = end;
+        }
+        return true;
+    }
+
+private:
+    const double* pos(uint32_t vertex) const { return _points[vertex].pos; }
+
+    bool ahead(uint32_t a, uint32_t b, uint32_t vertex) const
+    {
+        return (pos(b)[0] - pos(a)[0]) * (pos(vertex)[0] - pos(a)[0]) +
+                   (pos(b)[1] - pos(a)[1]) * (pos(vertex)[1] - pos(a)[1]) >
+               0.0;
+    }
+
+    // whether the open segments cross
+    bool crosses(uint32_t a, uint32_t b, uint32_t c, uint32_t d) const
+    {
+        return orientation(pos(c), pos(d), pos(a)) * orientation(pos(c), pos(d), pos(b)) < 0 &&
+               orientation(pos(a), pos(b), pos(c)) * orientation(pos(a), pos(b), pos(d)) < 0;
+    }
+
+    // calls visit with the half-edges leaving the vertex until it returns true: counterclockwise,
+    // then clockwise from the first one when the vertex is on the hull
+    template<typename Visit>
+    void forEachLeaving(uint32_t vertex, Visit&& visit) const
+    {
+        uint32_t start = _vertexEdges[vertex];
+        uint32_t e = start;
+        do {
+            if (visit(e)) {
+                return;
+            }
+            e = _opposites[Tin::previous(e)];
+        } while (e != none && e != start);
+        if (e == none) {
+            for (e = _opposites[start]; e != none; e = _opposites[e]) {
+                e = Tin::next(e);
+                if (visit(e)) {
+                    return;
+                }
+            }
+        }
+    }
+
+    // a half-edge between the vertices, either way; none when they aren't neighbours
+    uint32_t find(uint32_t u, uint32_t v) const
+    {
+        uint32_t found = none;
+        forEachLeaving(u, [&](uint32_t e) {
+            found = _triangles[Tin::next(e)] == v ? e : none;
+            return found != none;
+        });
+        if (found == none) {
+            forEachLeaving(v, [&](uint32_t e) {
+                found = _triangles[Tin::next(e)] == u ? e : none;
+                return found != none;
+            });
+        }
+        return found;
+    }
+
+    void constrain(uint32_t e)
+    {
+        _constrained[e] = true;
+        if (_opposites[e] != none) {
+            _constrained[_opposites[e]] = true;
+        }
+    }
+
+    void link(uint32_t a, uint32_t b, bool constrained)
+    {
+        _opposites[a] = b;
+        _constrained[a] = constrained;
+        if (b != none) {
+            _opposites[b] = a;
+        }
+    }
+
+    // the edge between the triangles p q r and q p s becomes s r, the triangles s r p and r s q
+    void flip(uint32_t e)
+    {
+        uint32_t o = _opposites[e];
+        uint32_t an = Tin::next(e);
+        uint32_t ap = Tin::previous(e);
+        uint32_t bn = Tin::next(o);
+        uint32_t bp = Tin::previous(o);
+        uint32_t p = _triangles[e];
+        uint32_t q = _triangles[an];
+        uint32_t r = _triangles[ap];
+        uint32_t s = _triangles[bp];
+        uint32_t anOpposite = _opposites[an];
+        uint32_t apOpposite = _opposites[ap];
+        uint32_t bnOpposite = _opposites[bn];
+        uint32_t bpOpposite = _opposites[bp];
+        bool anConstrained = _constrained[an];
+        bool apConstrained = _constrained[ap];
+        bool bnConstrained = _constrained[bn];
+        bool bpConstrained = _constrained[bp];
+
+        _triangles[e] = s;
+        _triangles[an] = r;
+        _triangles[ap] = p;
+        _triangles[o] = r;
+        _triangles[bn] = s;
+        _triangles[bp] = q;
+        link(an, apOpposite, apConstrained);
+        link(ap, bnOpposite, bnConstrained);
+        link(bn, bpOpposite, bpConstrained);
+        link(bp, anOpposite, anConstrained);
+        _vertexEdges[p] = ap;
+        _vertexEdges[q] = bp;
+        _vertexEdges[r] = an;
+        _vertexEdges[s] = bn;
+    }
+
+    void restoreDelaunay(std::vector<std::pair<uint32_t, uint32_t>>& created, uint32_t a, uint32_t b)
+    {
+        bool flipped = true;
+        while (flipped) {
+            flipped = false;
+            for (auto& [u, v] : created) {
+                if ((u == a && v == b) || (u == b && v == a)) {
+                    continue;
+                }
+                uint32_t e = find(u, v);
+                if (e == none || _opposites[e] == none || _constrained[e]) {
+                    continue;
+                }
+                // the triangle of e is counterclockwise, whichever way round u and v are
+                uint32_t r = _triangles[Tin::previous(e)];
+                uint32_t s = _triangles[Tin::previous(_opposites[e])];
+                if (inCircle(pos(_triangles[e]), pos(_triangles[Tin::next(e)]), pos(r), pos(s)) > 0) {
+                    flip(e);
+                    u = r;
+                    v = s;
+                    flipped = true;
+                }
+            }
+        }
+    }
+
+    const std::vector<TinPoint>& _points;
+    std::vector<uint32_t>& _triangles;
+    std::vector<uint32_t>& _opposites;
+    std::vector<bool> _constrained;
+    // a half-edge leaving each vertex
+    std::vector<uint32_t> _vertexEdges;
+};
+
+// the first points of the ranges arrange() halves the points [lo, hi) into until they are
+// at most so many, each a compact patch of the surface
+void collectBlocks(size_t lo, size_t hi, size_t maxPoints, std::vector<uint32_t>& firsts)
+{
+    if (hi - lo <= maxPoints) {
+        firsts.push_back((uint32_t)lo);
+        return;
+    }
+    size_t middle = lo + (hi - lo) / 2;
+    collectBlocks(lo, middle, maxPoints, firsts);
+    collectBlocks(middle, hi, maxPoints, firsts);
+}
+
+// The triangles reordered by the block of collectBlocks() their lowest vertex is in, the
+// blocks of at most blockPoints * step points. A chunk per block, cut where it gets longer than
+// Tin::chunkTriangles. The opposites, when there are, follow the half-edges.
+std::vector<Tin::Chunk> groupIntoChunks(const std::vector<TinPoint>& points, size_t step, std::vector<uint32_t>& triangles,
+                                        std::vector<uint32_t>* opposites, Concurrency::ThreadPool& pool)
+{
+    size_t triangleCount = triangles.size() / 3;
+    std::vector<uint32_t> firsts;
+    collectBlocks(0, points.size(), blockPoints * step, firsts);
+    size_t cells = firsts.size();
+    auto cellOf = [&](size_t triangle) {
+        uint32_t lowest = std::min({triangles[3 * triangle], triangles[3 * triangle + 1], triangles[3 * triangle + 2]});
+        return (size_t)(std::upper_bound(firsts.begin(), firsts.end(), lowest) - firsts.begin()) - 1;
+    };
+
+    // a counting sort, counted per block of triangles so the blocks can be placed on the pool
+    size_t blocks = (triangleCount + blockSize - 1) / blockSize;
+    std::vector<uint32_t> counts(blocks * cells, 0);
+    pool.parallelFor(blocks, [&](size_t block) {
+        for (size_t t = block * blockSize; t < std::min((block + 1) * blockSize, triangleCount); ++t) {
+            ++counts[block * cells + cellOf(t)];
+        }
+    });
+    std::vector<Tin::Chunk> chunks;
+    uint32_t placed = 0;
+    for (size_t cell = 0; cell < cells; ++cell) {
+        uint32_t first = placed;
+        for (size_t block = 0; block < blocks; ++block) {
+            uint32_t count = counts[block * cells + cell];
+            counts[block * cells + cell] = placed;
+            placed += count;
+        }
+        for (uint32_t begin = first; begin < placed; begin += Tin::chunkTriangles) {
+            chunks.push_back({begin, std::min(placed - begin, Tin::chunkTriangles), BoundingBox{}});
+        }
+    }
+    std::vector<uint32_t> newIndex(triangleCount);
+    pool.parallelFor(blocks, [&](size_t block) {
+        for (size_t t = block * blockSize; t < std::min((block + 1) * blockSize, triangleCount); ++t) {
+            newIndex[t] = counts[block * cells + cellOf(t)]++;
+        }
+    });
+    counts = {};
+
+    std::vector<uint32_t> movedTriangles(triangles.size());
+    std::vector<uint32_t> movedOpposites(opposites ? opposites->size() : 0);
+    pool.parallelFor(blocks, [&](size_t block) {
+        for (size_t t = block * blockSize; t < std::min((block + 1) * blockSize, triangleCount); ++t) {
+            for (size_t k = 0; k < 3; ++k) {
+                movedTriangles[3 * newIndex[t] + k] = triangles[3 * t + k];
+                if (opposites) {
+                    uint32_t opposite = (*opposites)[3 * t + k];
+                    movedOpposites[3 * newIndex[t] + k] =
+                        opposite == none ? none : 3 * newIndex[opposite / 3] + opposite % 3;
+                }
+            }
+        }
+    });
+    triangles = std::move(movedTriangles);
+    if (opposites) {
+        *opposites = std::move(movedOpposites);
+    }
+
+    pool.parallelFor(chunks.size(), [&](size_t i) {
+        Tin::Chunk& chunk = chunks[i];
+        for (size_t e = 3 * (size_t)chunk.firstTriangle; e < 3 * ((size_t)chunk.firstTriangle + chunk.triangleCount); ++e) {
+            chunk.bounds.expand((float)points[triangles[e]].pos[0], (float)points[triangles[e]].pos[1]);
+        }
+    });
+    return chunks;
+}
+
+// Overviews of the arranged points, each of every fourth point of the one before. Every 4^k-th
+// point of the order of arrange() is spread over the surface like the points themselves.
+std::vector<Tin::Overview> buildOverviews(const std::vector<TinPoint>& points, Concurrency::ThreadPool& pool)
+{
+    std::vector<Tin::Overview> overviews;
+    for (size_t step = 4; points.size() / step >= 3; step *= 4) {
+        if (!overviews.empty() && overviews.back().chunks.size() <= 1) {
+            break;
+        }
+        size_t count = (points.size() + step - 1) / step;
+        std::vector<SortPoint> subset(count);
+        pool.parallelFor((count + blockSize - 1) / blockSize, [&](size_t block) {
+            for (size_t i = block * blockSize; i < std::min((block + 1) * blockSize, count); ++i) {
+                const double* pos = points[i * step].pos;
+                subset[i] = {{pos[0], pos[1], pos[2]}, (uint32_t)(i * step)};
+            }
+        });
+        parallelSort(subset, pool);
+        arrange(subset, 0, count, 0, true, pool);
+        std::vector<TinPoint> vertices(count);
+        for (size_t i = 0; i < count; ++i) {
+            vertices[i] = {{subset[i].pos[0], subset[i].pos[1], subset[i].pos[2]}};
+        }
+
+        Tin::Overview overview;
+        std::vector<uint32_t> opposites;
+        Subdivision(vertices, pool).extract(overview.triangles, opposites);
+        if (overview.triangles.empty()) {
+            break;
+        }
+        for (uint32_t& vertex : overview.triangles) {
+            vertex = subset[vertex].source;
+        }
+        overview.chunks = groupIntoChunks(points, step, overview.triangles, nullptr, pool);
+        overviews.push_back(std::move(overview));
+    }
+    return overviews;
+}
+
+}
+
+TinBuilder::TinBuilder(std::string name, std::vector<TinPoint> points,
+                       const std::vector<std::vector<TinPoint>>& breaklines, Concurrency::ThreadPool& pool)
+{
+    // the breaklines' vertices are points like the others, they may add some
+    std::vector<SortPoint> sorted;
+    size_t breaklineVertexCount = 0;
+    for (const std::vector<TinPoint>& breakline : breaklines) {
+        breaklineVertexCount += breakline.size();
+    }
+    if (points.size() + breaklineVertexCount >= none / 6) {
+        throw std::runtime_error("too many points for one surface");
+    }
+    sorted.reserve(points.size() + breaklineVertexCount);
+    for (const TinPoint& point : points) {
+        sorted.push_back({{point.pos[0], point.pos[1], point.pos[2]}, (uint32_t)sorted.size()});
+    }
+    for (const std::vector<TinPoint>& breakline : breaklines) {
+        for (const TinPoint& point : breakline) {
+            sorted.push_back({{point.pos[0], point.pos[1], point.pos[2]}, (uint32_t)sorted.size()});
+        }
+    }
+    size_t pointCount = points.size();
+    points = {};
+    parallelSort(sorted, pool);
+
+    // one vertex per x and y, its index in the order along x kept in source for a while
+    std::vector<uint32_t> breaklineVertices(breaklineVertexCount);
+    size_t vertexCount = 0;
+    for (size_t i = 0; i < sorted.size(); ++i) {
+        SortPoint point = sorted[i];
+        if (i == 0 || point.pos[0] != sorted[vertexCount - 1].pos[0] || point.pos[1] != sorted[vertexCount - 1].pos[1]) {
+            sorted[vertexCount] = {{point.pos[0], point.pos[1], point.pos[2]}, (uint32_t)vertexCount};
+            ++vertexCount;
+        }
+        if (point.source >= pointCount) {
+            breaklineVertices[point.source - pointCount] = (uint32_t)vertexCount - 1;
+        }
+    }
+    _duplicateCount = sorted.size() - vertexCount;
+    sorted.resize(vertexCount);
+    if (vertexCount < 3) {
+        throw std::runtime_error("a surface needs three points at least");
+    }
+
+    arrange(sorted, 0, vertexCount, 0, true, pool);
+    std::vector<TinPoint> vertices(vertexCount);
+    std::vector<uint32_t> arranged(breaklineVertexCount > 0 ? vertexCount : 0);
+    pool.parallelFor((vertexCount + blockSize - 1) / blockSize, [&](size_t block) {
+        for (size_t i = block * blockSize; i < std::min((block + 1) * blockSize, vertexCount); ++i) {
+            vertices[i] = {{sorted[i].pos[0], sorted[i].pos[1], sorted[i].pos[2]}};
+            if (!arranged.empty()) {
+                arranged[sorted[i].source] = (uint32_t)i;
+            }
+        }
+    });
+    sorted = {};
+    for (uint32_t& vertex : breaklineVertices) {
+        vertex = arranged[vertex];
+    }
+    arranged = {};
+
+    std::vector<uint32_t> triangles;
+    std::vector<uint32_t> opposites;
+    Subdivision(vertices, pool).extract(triangles, opposites);
+    if (triangles.empty()) {
+        throw std::runtime_error("the points are all on one line");
+    }
+
+    if (breaklineVertexCount > 0) {
+        BreaklineInserter inserter(vertices, triangles, opposites);
+        size_t first = 0;
+        for (const std::vector<TinPoint>& breakline : breaklines) {
+            for (size_t i = 1; i < breakline.size(); ++i) {
+                uint32_t a = breaklineVertices[first + i - 1];
+                uint32_t b = breaklineVertices[first + i];
+                if (a != b && !inserter.insert(a, b)) {
+                    ++_skippedSegmentCount;
+                }
+            }
+            first += breakline.size();
+        }
+    }
+
+    std::vector<Tin::Chunk> chunks = groupIntoChunks(vertices, 1, triangles, &opposites, pool);
+    std::vector<Tin::Overview> overviews = buildOverviews(vertices, pool);
+    _tin = std::make_shared<const Tin>(std::move(name), std::move(vertices), std::move(triangles), std::move(opposites),
+                                       std::move(chunks), std::move(overviews));
+}
+
+}
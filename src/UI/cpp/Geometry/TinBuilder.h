@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Tin.h"
+
+namespace Concurrency {
+class ThreadPool;
+}
+
+namespace Geometry {
+
+// Builds the Delaunay triangulation of survey points, constrained by breaklines, into a Tin.
+// The points are sorted along x on the pool and triangulated by Guibas and Stolfi's divide
+// and conquer, the halves of large ranges at the same time, each in its own slice of the edge
+// arrays. Every decision is taken by the exact predicates, so collinear and cocircular points
+// (a grid) need no special care. Points with the same x and y are one vertex, the first one's
+// elevation kept, a breakline's vertex included. Breaklines are then forced in as edges by
+// flipping away the edges they cross (Sloan's method) and the triangulation is made Delaunay
+// again around them; a segment crossing a breakline inserted before it is left out. The
+// overviews are triangulated the same way from fewer and fewer of the points.
+// Throws when the points span no area.
+class TinBuilder {
+public:
+    TinBuilder(std::string name, std::vector<TinPoint> points, const std::vector<std::vector<TinPoint>>& breaklines,
+               Concurrency::ThreadPool& pool);
+
+    const std::shared_ptr<const Tin>& tin() const { return _tin; }
+    // points dropped for having the x and y of another
+    size_t duplicateCount() const { return _duplicateCount; }
+    // breakline segments left out for crossing another breakline
+    size_t skippedSegmentCount() const { return _skippedSegmentCount; }
+
+private:
+    std::shared_ptr<const Tin> _tin;
+    size_t _duplicateCount = 0;
+    size_t _skippedSegmentCount = 0;
+};
+
+}
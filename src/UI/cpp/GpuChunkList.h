@@ -0,0 +1,144 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+#include "Library/Flux/ChunkedList.h"
+#include "Library/Vulkan/Buffer.h"
+#include "Library/Vulkan/StagingRing.h"
+#include "Library/Vulkan/VulkanComponent.h"
+#include "Library/Vulkan/VulkanManager.h"
+
+// GPU copy of a Flux::ChunkedList, one device local buffer per storage chunk. Only chunks whose
+// version changed are uploaded: the ranges from their edit log plus the appended tail, or the
+// whole chunk when the log doesn't reach back far enough. A buffer holds a power of two of
+// elements, at least minCapacity, and is replaced by one big enough when its chunk outgrows it,
+// which uploads the chunk again.
+template<typename T, typename Summary>
+class GpuChunkList : protected Vulkan::VulkanComponent {
+public:
+    using Storage = Flux::ChunkedList<T, Summary>;
+    using Snapshot = std::shared_ptr<const Storage>;
+
+    struct Chunk {
+        std::unique_ptr<Vulkan::Buffer> buffer;
+        // elements the buffer has room for
+        size_t capacity = 0;
+        uint64_t uploadedVersion = 0;
+        // elements valid on the GPU, the prefix of the chunk that was uploaded
+        size_t uploadedCount = 0;
+    };
+
+    static constexpr size_t chunkSize = Storage::chunkSize;
+    static constexpr VkDeviceSize chunkBytes = chunkSize * sizeof(T);
+    static constexpr size_t minCapacity = std::min<size_t>(256, chunkSize);
+
+    GpuChunkList(std::shared_ptr<Vulkan::VulkanManager>& vkManager, VkBufferUsageFlags usage) :
+        VulkanComponent(vkManager),
+        _usage(usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT)
+    {}
+
+    // ignored when a newer snapshot was set before
+    void setSnapshot(Snapshot snapshot)
+    {
+        if (snapshot && (!_snapshot || _snapshot->version() < snapshot->version())) {
+            _snapshot = std::move(snapshot);
+        }
+    }
+
+    // false when the ring ran out of room, the rest is continued by the next call
+    bool upload(Vulkan::StagingRing& ring)
+    {
+        if (!_snapshot) {
+            return true;
+        }
+        const Storage& storage = *_snapshot;
+
+        // chunks left behind by a shorter list draw nothing
+        for (size_t i = storage.chunkCount(); i < _chunks.size(); ++i) {
+            _chunks[i].uploadedCount = 0;
+        }
+
+        for (size_t i = 0; i < storage.chunkCount(); ++i) {
+            if (i == _chunks.size()) {
+                _chunks.emplace_back();
+            }
+            const auto& source = storage.chunk(i);
+            Chunk& chunk = _chunks[i];
+            if (source.version == chunk.uploadedVersion) {
+                continue;
+            }
+            if (source.size() > chunk.capacity) {
+                reserve(chunk, source.size());
+            }
+
+            _ranges.clear();
+            bool logged = chunk.uploadedCount <= source.size() &&
+                source.changesSince(chunk.uploadedVersion, [&](size_t begin, size_t end) {
+                    // edits behind the uploaded prefix go up with the tail anyway
+                    if (begin < chunk.uploadedCount) {
+                        _ranges.emplace_back(begin, std::min(end, chunk.uploadedCount));
+                    }
+                });
+
+            if (!logged) {
+                if (!uploadRange(chunk, source, 0, source.size(), ring)) {
+                    return false;
+                }
+                chunk.uploadedCount = source.size();
+                chunk.uploadedVersion = source.version;
+                continue;
+            }
+
+            for (const auto& [begin, end] : _ranges) {
+                if (!uploadRange(chunk, source, begin, end, ring)) {
+                    return false;
+                }
+            }
+
+            // the tail may be split over several frames, the logged edits are simply sent again
+            size_t end = std::min(source.size(), chunk.uploadedCount + ring.available() / sizeof(T));
+            if (!uploadRange(chunk, source, chunk.uploadedCount, end, ring)) {
+                return false;
+            }
+            chunk.uploadedCount = end;
+            if (end != source.size()) {
+                return false;
+            }
+            chunk.uploadedVersion = source.version;
+        }
+        return true;
+    }
+
+    const Snapshot& snapshot() const { return _snapshot; }
+    size_t chunkCount() const { return _chunks.size(); }
+    const Chunk& chunk(size_t index) const { return _chunks[index]; }
+
+private:
+    // a new, empty buffer, the old one is released once the frames drawing it are done
+    void reserve(Chunk& chunk, size_t size)
+    {
+        chunk.capacity = std::max(minCapacity, std::bit_ceil(size));
+        chunk.buffer = std::make_unique<Vulkan::Buffer>(_vkManager);
+        chunk.buffer->allocateMemory(chunk.capacity * sizeof(T), _usage, Vulkan::Buffer::Location::DeviceLocal);
+        chunk.uploadedCount = 0;
+        chunk.uploadedVersion = 0;
+    }
+
+    bool uploadRange(Chunk& chunk, const typename Storage::Chunk& source, size_t begin, size_t end,
+                     Vulkan::StagingRing& ring)
+    {
+        return end <= begin || chunk.buffer->upload(ring, begin * sizeof(T), source.data() + begin,
+                                                    (end - begin) * sizeof(T));
+    }
+
+    VkBufferUsageFlags _usage;
+    Snapshot _snapshot;
+    std::vector<Chunk> _chunks;
+    std::vector<std::pair<size_t, size_t>> _ranges;
+};
@@ -0,0 +1,83 @@
+#include "GpuPolylineList.h"
+#include <algorithm>
+#include <bit>
+
+GpuPolylineList::GpuPolylineList(std::shared_ptr<Vulkan::VulkanManager>& vkManager) :
+    VulkanComponent(vkManager),
+    _vertices(vkManager, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT)
+{}
+
+void GpuPolylineList::setSnapshot(const Geometry::PolylineSnapshot& snapshot)
+{
+    _vertices.setSnapshot(snapshot.vertices);
+    if (snapshot.polylines && (!_polylines || _polylines->version() < snapshot.polylines->version())) {
+        _polylines = snapshot.polylines;
+    }
+}
+
+void GpuPolylineList::index(const Geometry::Polyline& polyline)
+{
+    size_t chunkIndex = polyline.firstVertex / Geometry::PolylineList::chunkSize;
+    if (_indexChunks.size() <= chunkIndex) {
+        _indexChunks.resize(chunkIndex + 1);
+    }
+
+    std::vector<uint32_t>& indices = _indexChunks[chunkIndex].indices;
+    if (!indices.empty()) {
+        indices.push_back(restartIndex);
+    }
+    uint32_t first = polyline.firstVertex % Geometry::PolylineList::chunkSize;
+    for (uint32_t i = 0; i < polyline.vertexCount; ++i) {
+        indices.push_back(first + i);
+    }
+    if (polyline.closed) {
+        indices.push_back(first);
+    }
+}
+
+bool GpuPolylineList::upload(Vulkan::StagingRing& ring)
+{
+    // indices may only reach vertices that are on the GPU already
+    if (!_vertices.upload(ring)) {
+        return false;
+    }
+    if (!_polylines) {
+        return true;
+    }
+
+    // the records were replaced by set(), or the document with a shorter one
+    if (_polylines->clearedVersion() != _indexedClear || _polylines->size() < _indexedPolylines) {
+        for (IndexChunk& chunk : _indexChunks) {
+            chunk.indices.clear();
+            chunk.uploadedCount = 0;
+        }
+        _indexedPolylines = 0;
+        _indexedClear = _polylines->clearedVersion();
+    }
+    for (; _indexedPolylines < _polylines->size(); ++_indexedPolylines) {
+        index(_polylines->at(_indexedPolylines));
+    }
+
+    // drawing a prefix of the indices is fine, it ends on a whole polyline or a partial strip
+    for (IndexChunk& chunk : _indexChunks) {
+        if (chunk.indices.size() > chunk.capacity) {
+            // the old buffer is released once the frames drawing it are done
+            chunk.capacity = std::min(indexCapacity, std::max(minIndexCapacity, std::bit_ceil(chunk.indices.size())));
+            chunk.buffer = std::make_unique<Vulkan::Buffer>(_vkManager);
+            chunk.buffer->allocateMemory(chunk.capacity * sizeof(uint32_t),
+                                         VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                         Vulkan::Buffer::Location::DeviceLocal);
+            chunk.uploadedCount = 0;
+        }
+        size_t count = std::min(chunk.indices.size() - chunk.uploadedCount, ring.available() / sizeof(uint32_t));
+        if (count > 0 && !chunk.buffer->upload(ring, chunk.uploadedCount * sizeof(uint32_t),
+                                               chunk.indices.data() + chunk.uploadedCount, count * sizeof(uint32_t))) {
+            return false;
+        }
+        chunk.uploadedCount += count;
+        if (chunk.uploadedCount != chunk.indices.size()) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+#include "Library/Vulkan/Buffer.h"
+#include "Library/Vulkan/StagingRing.h"
+#include "Library/Vulkan/VulkanComponent.h"
+#include "Library/Vulkan/VulkanManager.h"
+#include "UI/cpp/Geometry/PolylineList.h"
+#include "UI/cpp/GpuChunkList.h"
+
+// GPU copy of a Geometry::PolylineList: the vertex pool as a GpuChunkList and per pool chunk an
+// index buffer drawing all its polylines as one indexed line strip, separated by the primitive
+// restart index. Polylines are added or replaced all at once, so the indices are only appended
+// or built again; moving a point re-uploads that vertex and leaves the indices alone. Index buffers grow by powers of two
+// like the vertex buffers.
+class GpuPolylineList : protected Vulkan::VulkanComponent {
+public:
+    using Vertices = GpuChunkList<Geometry::Vertex, Geometry::BoundingBox>;
+
+    struct IndexChunk {
+        std::unique_ptr<Vulkan::Buffer> buffer;
+        // indices the buffer has room for
+        size_t capacity = 0;
+        // built on the CPU, the prefix [0, uploadedCount) is on the GPU
+        std::vector<uint32_t> indices;
+        size_t uploadedCount = 0;
+    };
+
+    static constexpr uint32_t restartIndex = 0xFFFFFFFF;
+
+    GpuPolylineList(std::shared_ptr<Vulkan::VulkanManager>& vkManager);
+
+    // ignored when a newer snapshot was set before
+    void setSnapshot(const Geometry::PolylineSnapshot& snapshot);
+    // false when the ring ran out of room, the rest is continued by the next call
+    bool upload(Vulkan::StagingRing& ring);
+
+    // pool chunk i is drawn with index chunk i
+    const Vertices& vertices() const { return _vertices; }
+    // records of the newest snapshot, ordered by their first vertex
+    const Geometry::PolylineRecords::Snapshot& polylines() const { return _polylines; }
+    size_t indexChunkCount() const { return _indexChunks.size(); }
+    const IndexChunk& indexChunk(size_t index) const { return _indexChunks[index]; }
+
+private:
+    void index(const Geometry::Polyline& polyline);
+
+    // a strip per polyline with at least two vertices: every vertex, the closing index and a
+    // restart index, which never exceeds twice the chunk size
+    static constexpr size_t indexCapacity = 2 * Geometry::PolylineList::chunkSize;
+    static constexpr size_t minIndexCapacity = 256;
+
+    Vertices _vertices;
+    Geometry::PolylineRecords::Snapshot _polylines;
+    std::vector<IndexChunk> _indexChunks;
+    // records of _polylines already in _indexChunks
+    size_t _indexedPolylines = 0;
+    // clearedVersion() of the records indexed
+    uint64_t _indexedClear = 0;
+};
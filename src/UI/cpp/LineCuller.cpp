@@ -0,0 +1,194 @@
+#include "LineCuller.h"
+#include <stdexcept>
+#include <string>
+
+#include "SpirvShaders.h"
+
+namespace {
+
+constexpr uint32_t workgroupSize = 64;
+constexpr uint32_t setsPerPool = 64;
+
+struct PushConstants {
+    float view[4];
+    uint32_t lineCount;
+};
+
+}
+
+LineCuller::LineCuller(std::shared_ptr<Vulkan::VulkanManager>& vkManager) :
+    VulkanComponent(vkManager),
+    _shader(vkManager, Vulkan::SpirvByteCode(Shaders::cull_lines))
+{
+    createPipeline();
+}
+
+LineCuller::~LineCuller()
+{
+    if (_pipeline != VK_NULL_HANDLE) {
+        _vkManager->vkDestroyPipeline(_pipeline, nullptr);
+    }
+    if (_pipelineLayout != VK_NULL_HANDLE) {
+        _vkManager->vkDestroyPipelineLayout(_pipelineLayout, nullptr);
+    }
+    for (VkDescriptorPool pool : _descriptorPools) {
+        _vkManager->vkDestroyDescriptorPool(pool, nullptr);
+    }
+    if (_descriptorSetLayout != VK_NULL_HANDLE) {
+        _vkManager->vkDestroyDescriptorSetLayout(_descriptorSetLayout, nullptr);
+    }
+}
+
+void LineCuller::createPipeline()
+{
+    VkDescriptorSetLayoutBinding bindings[3] = {};
+    for (uint32_t i = 0; i < 3; ++i) {
+        bindings[i].binding = i;
+        bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[i].descriptorCount = 1;
+        bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    }
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo = {};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = 3;
+    layoutInfo.pBindings = bindings;
+
+    VkResult result = _vkManager->vkCreateDescriptorSetLayout(&layoutInfo, nullptr, &_descriptorSetLayout);
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("can't create culling descriptor set layout, return: " + std::to_string(result));
+    }
+
+    VkPushConstantRange pushConstantRange = {};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(PushConstants);
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &_descriptorSetLayout;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+    result = _vkManager->vkCreatePipelineLayout(&pipelineLayoutInfo, nullptr, &_pipelineLayout);
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("can't create culling pipeline layout, return: " + std::to_string(result));
+    }
+
+    VkComputePipelineCreateInfo pipelineInfo = {};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    pipelineInfo.stage.module = _shader;
+    pipelineInfo.stage.pName = "main";
+    pipelineInfo.layout = _pipelineLayout;
+    pipelineInfo.basePipelineIndex = -1;
+
+    result = _vkManager->vkCreateComputePipelines(VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &_pipeline);
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("can't create culling pipeline, return: " + std::to_string(result));
+    }
+}
+
+void LineCuller::createDescriptorPool()
+{
+    VkDescriptorPoolSize poolSize = {};
+    poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    poolSize.descriptorCount = setsPerPool * 3;
+
+    VkDescriptorPoolCreateInfo poolInfo = {};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.maxSets = setsPerPool;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+
+    VkDescriptorPool pool;
+    VkResult result = _vkManager->vkCreateDescriptorPool(&poolInfo, nullptr, &pool);
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("can't create culling descriptor pool, return: " + std::to_string(result));
+    }
+    _descriptorPools.push_back(pool);
+}
+
+VkDescriptorSet LineCuller::createDescriptorSet(const VkDescriptorBufferInfo (&ranges)[3])
+{
+    VkDescriptorSetAllocateInfo allocInfo = {};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &_descriptorSetLayout;
+
+    // counted instead of waiting for VK_ERROR_OUT_OF_POOL_MEMORY, which Vulkan 1.0 drivers needn't report
+    if (_setsInLastPool == setsPerPool || _descriptorPools.empty()) {
+        createDescriptorPool();
+        _setsInLastPool = 0;
+    }
+    allocInfo.descriptorPool = _descriptorPools.back();
+
+    VkDescriptorSet descriptorSet;
+    VkResult result = _vkManager->vkAllocateDescriptorSets(&allocInfo, &descriptorSet);
+    ++_setsInLastPool;
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("can't allocate culling descriptor set, return: " + std::to_string(result));
+    }
+
+    VkWriteDescriptorSet writes[3] = {};
+    for (uint32_t i = 0; i < 3; ++i) {
+        writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[i].dstSet = descriptorSet;
+        writes[i].dstBinding = i;
+        writes[i].descriptorCount = 1;
+        writes[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        writes[i].pBufferInfo = &ranges[i];
+    }
+    _vkManager->vkUpdateDescriptorSets(3, writes, 0, nullptr);
+    return descriptorSet;
+}
+
+void LineCuller::record(VkCommandBuffer commandBuffer, const QRectF& view, const std::vector<Job>& jobs)
+{
+    if (jobs.empty()) {
+        return;
+    }
+
+    // the previous frame's draws read the outputs, wait for them before overwriting
+    VkMemoryBarrier barrier = {};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = 0;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    _vkManager->vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+                                     VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                     0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+    VkDrawIndirectCommand reset = {0, 1, 0, 0};
+    for (const Job& job : jobs) {
+        _vkManager->vkCmdUpdateBuffer(commandBuffer, job.drawBuffer, job.drawOffset, sizeof(reset), &reset);
+    }
+
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    _vkManager->vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                     0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+    QRectF normalized = view.normalized();
+    PushConstants constants = {
+        {(float)normalized.left(), (float)normalized.top(), (float)normalized.right(), (float)normalized.bottom()},
+        0
+    };
+
+    _vkManager->vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, _pipeline);
+    for (const Job& job : jobs) {
+        constants.lineCount = job.lineCount;
+        _vkManager->vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, _pipelineLayout,
+                                            0, 1, &job.descriptorSet, 0, nullptr);
+        _vkManager->vkCmdPushConstants(commandBuffer, _pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT,
+                                       0, sizeof(constants), &constants);
+        _vkManager->vkCmdDispatch(commandBuffer, (job.lineCount + workgroupSize - 1) / workgroupSize, 1, 1);
+    }
+
+    barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT;
+    _vkManager->vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                     VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+                                     0, 1, &barrier, 0, nullptr, 0, nullptr);
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <QRectF>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+#include "Library/Vulkan/ShaderModule.h"
+#include "Library/Vulkan/VulkanComponent.h"
+#include "Library/Vulkan/VulkanManager.h"
+
+// Culls Geometry::Line segments against the view on the GPU. record() dispatches cull_lines.comp
+// once per job; each job copies its visible lines into a compacted range and writes their vertex
+// count into a VkDrawIndirectCommand, so drawing them needs no CPU work per line.
+class LineCuller : protected Vulkan::VulkanComponent {
+public:
+    struct Job {
+        VkDescriptorSet descriptorSet;
+        VkBuffer drawBuffer;
+        VkDeviceSize drawOffset;
+        uint32_t lineCount;
+    };
+
+    LineCuller(std::shared_ptr<Vulkan::VulkanManager>& vkManager);
+    ~LineCuller();
+
+    // bindings: source lines, visible lines, VkDrawIndirectCommand; written once, sets live as long as the culler
+    VkDescriptorSet createDescriptorSet(const VkDescriptorBufferInfo (&ranges)[3]);
+    // outside of the render pass, after the uploads into the sources were recorded
+    void record(VkCommandBuffer commandBuffer, const QRectF& view, const std::vector<Job>& jobs);
+
+private:
+    void createPipeline();
+    void createDescriptorPool();
+
+    Vulkan::ShaderModule _shader;
+
+    VkDescriptorSetLayout _descriptorSetLayout = VK_NULL_HANDLE;
+    std::vector<VkDescriptorPool> _descriptorPools;
+    uint32_t _setsInLastPool = 0;
+    VkPipelineLayout _pipelineLayout = VK_NULL_HANDLE;
+    VkPipeline _pipeline = VK_NULL_HANDLE;
+};
@@ -1,33 +1,69 @@
 #include "MainWindow.h"
 #include <QCursor>
+#include <QFileInfo>
 #include <QGuiApplication>
+#include <QPointer>
+#include <algorithm>
+#include <chrono>
 #include <memory>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include "Export/DxfExporter.h"
+#include "Export/PdfExporter.h"
+#include "Export/SvgExporter.h"
+#include "Import/AsciiGridReader.h"
+#include "Import/DxfImporter.h"
+#include "Import/GeoJsonImporter.h"
+#include "Import/PointCloudBuilder.h"
+#include "Import/RasterPyramidBuilder.h"
+#include "Import/ShapefileImporter.h"
+#include "Import/SurveyPointReader.h"
+#include "Import/TiffReader.h"
+#include "Library/Concurrency/ThreadPool.h"
+#include "Library/Geodesy/Transform.h"
+#include "Library/Profiling/ResourceUsage.h"
+#include "UI/cpp/Geometry/ContourGenerator.h"
+#include "UI/cpp/Geometry/PointCloud.h"
+#include "UI/cpp/Geometry/Raster.h"
+#include "UI/cpp/Geometry/Reprojection.h"
+#include "UI/cpp/Geometry/TinBuilder.h"
 #include "UI/cpp/Geometry/Vertex.h"
 #include "UI/cpp/ModeHandlers/ModeHandlers.h"
 #include "UI/cpp/ModeHandlers/MoveHandler.h"
-#include "UI/cpp/VulkanRenderNode.h"
 
 
 MainWindow::MainWindow(QObject* parent) :
     QObject(parent),
-    lines(Flux::MutableList<Geometry::Line>()),
     _modeController(nullptr),
     _moveHandler(std::make_shared<ModeHandlers::MoveHandler>(this))
 {}
 
 void MainWindow::addLine(const Geometry::Line& line)
 {
-    lines.add(line);
+    document.currentLayer().lines.add(line);
 }
 
 void MainWindow::updateLine(const Geometry::Line& line)
 {
-    lines.update(lines.get().size() -1, line);
+    Geometry::LineList& lines = document.currentLayer().lines;
+    lines.update(lines.size() - 1, line);
 }
 
-void MainWindow::updatePosition(const QPointF& position)
+void MainWindow::addCircle(const Geometry::Circle& circle)
 {
-    VulkanRenderNode::pos = position;
+    document.currentLayer().circles.add(circle);
+}
+
+void MainWindow::updateCircle(const Geometry::Circle& circle)
+{
+    Geometry::CircleList& circles = document.currentLayer().circles;
+    circles.update(circles.size() - 1, circle);
+}
+
+Geometry::DocumentSnapshot MainWindow::snapshot() const
+{
+    return document.snapshot();
 }
 
 void MainWindow::mouseMove(QMouseEvent* event, ViewportContext cntx)
@@ -116,6 +152,12 @@ void MainWindow::changeMode(Mode newMode)
             }
             _modeController = std::make_shared<ModeHandlers::AddingLineWithAngleMode>(this);
             break;
+        case Mode::AddCircle:
+            if (!QGuiApplication::overrideCursor() || QGuiApplication::overrideCursor()->shape() != Qt::CrossCursor) {
+                QGuiApplication::setOverrideCursor(QCursor(Qt::CrossCursor));
+            }
+            _modeController = std::make_shared<ModeHandlers::AddingCircleMode>(this);
+            break;
     }
 }
 
@@ -135,3 +177,428 @@ void MainWindow::addLineWithAngleMode()
     changeMode(Mode::AddLineWithAngle);
 }
 
+void MainWindow::addCircleMode()
+{
+    changeMode(Mode::AddCircle);
+}
+
+void MainWindow::exportSvg(const QString& fileName)
+{
+    try {
+        Export::SvgExporter(snapshot()).exportTo(fileName.toStdString());
+    } catch (const std::exception& e) {
+        qWarning("SVG export failed: %s", e.what());
+    }
+}
+
+void MainWindow::exportPdf(const QString& fileName)
+{
+    try {
+        Export::PdfExporter(snapshot()).exportTo(fileName.toStdString());
+    } catch (const std::exception& e) {
+        qWarning("PDF export failed: %s", e.what());
+    }
+}
+
+void MainWindow::exportDxf(const QString& fileName)
+{
+    try {
+        Export::DxfExporter(snapshot()).exportTo(fileName.toStdString());
+    } catch (const std::exception& e) {
+        qWarning("DXF export failed: %s", e.what());
+    }
+}
+
+namespace {
+
+// throughput of the whole import, reading through adding to the document
+void reportImport(const QString& fileName, size_t bytes, std::chrono::steady_clock::time_point start)
+{
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double megabytes = bytes / (1024.0 * 1024.0);
+    qDebug("imported %s: %.1f MB in %.2f s, %.1f MB/s, peak resident %.0f MB", qPrintable(fileName), megabytes,
+           seconds, seconds > 0 ? megabytes / seconds : 0.0, Profiling::peakResidentBytes() / (1024.0 * 1024.0));
+}
+
+// point clouds, rasters and surfaces are built once in the system of their import, their caches
+// and triangulations can't be converted in place
+void requireEntitiesOnly(const Geometry::Layer& layer)
+{
+    if (!layer.pointClouds.empty() || !layer.rasters.empty() || !layer.tins.empty()) {
+        throw std::runtime_error("layer " + layer.name +
+                                 " has point clouds, images or surfaces, they can't be converted into another system");
+    }
+}
+
+}
+
+void MainWindow::addImported(const Import::ImportedLayer& imported)
+{
+    Geometry::Layer& layer = document.layer(document.layerIndex(imported.name));
+    layer.lines.append(imported.lines);
+    layer.circles.append(imported.circles);
+    layer.arcs.append(imported.arcs);
+    layer.polylines.append(imported.polylines);
+}
+
+void MainWindow::importDxf(const QString& fileName)
+{
+    try {
+        Import::DxfImporter importer(fileName.toStdString());
+        for (const Import::DxfImporter::Layer& imported : importer.layers()) {
+            addImported(imported);
+        }
+    } catch (const std::exception& e) {
+        qWarning("DXF import failed: %s", e.what());
+    }
+}
+
+void MainWindow::importShapefile(const QString& fileName, int epsg)
+{
+    try {
+        auto start = std::chrono::steady_clock::now();
+        std::optional<Geodesy::Transform> transform;
+        if (epsg != 0) {
+            transform.emplace(Geodesy::Crs::fromEpsg(epsg), document.crs());
+        }
+        Import::ShapefileImporter importer(fileName.toStdString(), transform ? &*transform : nullptr);
+        addImported(importer.layer());
+        qDebug("%zu shapefile records, %zu skipped, %zu attribute columns of %zu rows", importer.recordCount(),
+               importer.skippedCount(), importer.attributes().size(), importer.attributeRowCount());
+        reportImport(fileName, importer.byteCount(), start);
+    } catch (const std::exception& e) {
+        qWarning("Shapefile import failed: %s", e.what());
+    }
+}
+
+void MainWindow::importGeoJson(const QString& fileName)
+{
+    try {
+        auto start = std::chrono::steady_clock::now();
+        Geodesy::Transform transform(Geodesy::Crs::fromEpsg(4326), document.crs());
+        Import::GeoJsonImporter importer(fileName.toStdString(), &transform);
+        addImported(importer.layer());
+        reportImport(fileName, importer.byteCount(), start);
+    } catch (const std::exception& e) {
+        qWarning("GeoJSON import failed: %s", e.what());
+    }
+}
+
+void MainWindow::importLas(const QString& fileName, int epsg)
+{
+    try {
+        std::optional<Geodesy::Transform> transform;
+        if (epsg != 0) {
+            transform.emplace(Geodesy::Crs::fromEpsg(epsg), document.crs());
+        }
+        int documentEpsg = document.crs().epsg();
+        std::string name = QFileInfo(fileName).completeBaseName().toStdString();
+        // the document is only touched back on this thread, the window may be gone by then
+        QPointer<MainWindow> self(this);
+        Concurrency::ThreadPool::global().submit([self, fileName, epsg, documentEpsg, name, transform]() {
+            try {
+                auto start = std::chrono::steady_clock::now();
+                Import::PointCloudBuilder::Options options;
+                options.transform = transform ? &*transform : nullptr;
+                options.sourceEpsg = epsg;
+                options.documentEpsg = documentEpsg;
+                std::string cacheFileName = fileName.toStdString() + ".gcpc";
+                Import::PointCloudBuilder builder(fileName.toStdString(), cacheFileName, options);
+                std::shared_ptr<const Geometry::PointCloud> cloud = Geometry::PointCloud::open(cacheFileName, name);
+                qDebug("%llu scan points in %zu nodes%s", (unsigned long long)cloud->pointCount(),
+                       cloud->nodes().size(), builder.reused() ? ", cache reused" : "");
+                reportImport(fileName, builder.byteCount(), start);
+                QMetaObject::invokeMethod(self.data(), [self, cloud]() {
+                    if (self) {
+                        self->document.addPointCloud(self->document.layerIndex(cloud->name()), cloud);
+                    }
+                }, Qt::QueuedConnection);
+            } catch (const std::exception& e) {
+                qWarning("LAS import failed: %s", e.what());
+            }
+        });
+    } catch (const std::exception& e) {
+        qWarning("LAS import failed: %s", e.what());
+    }
+}
+
+void MainWindow::importRaster(const QString& fileName, int epsg)
+{
+    Geodesy::Crs documentCrs = document.crs();
+    std::string name = QFileInfo(fileName).completeBaseName().toStdString();
+    QPointer<MainWindow> self(this);
+    Concurrency::ThreadPool::global().submit([self, fileName, epsg, documentCrs, name]() {
+        try {
+            auto start = std::chrono::steady_clock::now();
+            int sourceEpsg = epsg != 0 ? epsg : Import::TiffReader(fileName.toStdString()).epsg();
+            std::optional<Geodesy::Transform> transform;
+            if (sourceEpsg != 0 && sourceEpsg != documentCrs.epsg()) {
+                try {
+                    transform.emplace(Geodesy::Crs::fromEpsg(sourceEpsg), documentCrs);
+                } catch (const std::exception& e) {
+                    // a code given by the caller has to be right, one from the file may just be unknown here
+                    if (epsg != 0) {
+                        throw;
+                    }
+                    qWarning("Image %s is placed as it is: %s", name.c_str(), e.what());
+                    sourceEpsg = 0;
+                }
+            }
+            Import::RasterPyramidBuilder::Options options;
+            options.transform = transform ? &*transform : nullptr;
+            options.sourceEpsg = sourceEpsg;
+            options.documentEpsg = documentCrs.epsg();
+            std::string cacheFileName = fileName.toStdString() + ".gcraster";
+            Import::RasterPyramidBuilder builder(fileName.toStdString(), cacheFileName, options);
+            std::shared_ptr<const Geometry::Raster> raster = Geometry::Raster::open(cacheFileName, name);
+            qDebug("%ux%u image in %zu tiles of %zu levels%s", raster->header().width, raster->header().height,
+                   raster->tiles().size(), raster->levels().size(), builder.reused() ? ", cache reused" : "");
+            reportImport(fileName, builder.byteCount(), start);
+            QMetaObject::invokeMethod(self.data(), [self, raster]() {
+                if (self) {
+                    self->document.addRaster(self->document.layerIndex(raster->name()), raster);
+                }
+            }, Qt::QueuedConnection);
+        } catch (const std::exception& e) {
+            qWarning("Raster import failed: %s", e.what());
+        }
+    });
+}
+
+void MainWindow::importTin(const QString& points, const QString& breaklines, int epsg)
+{
+    try {
+        std::optional<Geodesy::Transform> transform;
+        if (epsg != 0) {
+            transform.emplace(Geodesy::Crs::fromEpsg(epsg), document.crs());
+        }
+        std::string name = QFileInfo(points).completeBaseName().toStdString();
+        QPointer<MainWindow> self(this);
+        Concurrency::ThreadPool::global().submit([self, points, breaklines, name, transform]() {
+            try {
+                auto start = std::chrono::steady_clock::now();
+                Import::SurveyPointReader reader(points.toStdString(), transform ? &*transform : nullptr);
+                size_t bytes = reader.byteCount();
+                std::vector<std::vector<Geometry::TinPoint>> lines;
+                if (!breaklines.isEmpty()) {
+                    Import::SurveyPointReader lineReader(breaklines.toStdString(), transform ? &*transform : nullptr);
+                    lines = lineReader.polylines();
+                    bytes += lineReader.byteCount();
+                }
+                size_t skipped = reader.skippedLineCount();
+                Geometry::TinBuilder builder(name, reader.takePoints(), lines, Concurrency::ThreadPool::global());
+                std::shared_ptr<const Geometry::Tin> tin = builder.tin();
+                qDebug("%zu triangles of %zu points, %zu duplicates, %zu lines skipped, %zu breakline segments "
+                       "left out", tin->triangleCount(), tin->points().size(), builder.duplicateCount(), skipped,
+                       builder.skippedSegmentCount());
+                reportImport(points, bytes, start);
+                QMetaObject::invokeMethod(self.data(), [self, tin]() {
+                    if (self) {
+                        self->document.addTin(self->document.layerIndex(tin->name()), tin);
+                    }
+                }, Qt::QueuedConnection);
+            } catch (const std::exception& e) {
+                qWarning("TIN import failed: %s", e.what());
+            }
+        });
+    } catch (const std::exception& e) {
+        qWarning("TIN import failed: %s", e.what());
+    }
+}
+
+void MainWindow::benchmarkTin(const QString& points)
+{
+    QPointer<MainWindow> self(this);
+    Concurrency::ThreadPool::global().submit([self, points]() {
+        try {
+            Import::SurveyPointReader reader(points.toStdString());
+            // each run gets a pool of its own so the thread count is the only variable
+            auto results = std::make_shared<std::vector<std::pair<size_t, double>>>();
+            size_t maxThreads = std::max(1u, std::thread::hardware_concurrency());
+            for (size_t threads = 1;; threads = std::min(threads * 2, maxThreads)) {
+                Concurrency::ThreadPool pool(threads);
+                std::vector<Geometry::TinPoint> copy = reader.points();
+                auto start = std::chrono::steady_clock::now();
+                Geometry::TinBuilder builder("benchmark", std::move(copy), {}, pool);
+                results->emplace_back(threads,
+                                      std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+                if (threads == maxThreads) {
+                    break;
+                }
+            }
+            size_t count = reader.points().size();
+            QMetaObject::invokeMethod(self.data(), [self, results, count]() {
+                if (self) {
+                    for (const auto& [threads, seconds] : *results) {
+                        qDebug("TIN of %zu points with %zu threads: %.2f s, %.1f M points/s", count, threads, seconds,
+                               seconds > 0 ? count / seconds / 1e6 : 0.0);
+                    }
+                }
+            }, Qt::QueuedConnection);
+        } catch (const std::exception& e) {
+            qWarning("TIN benchmark failed: %s", e.what());
+        }
+    });
+}
+
+size_t MainWindow::contourLayer(const std::string& source)
+{
+    size_t index = document.layerIndex(source + " contours");
+    document.setVisible(index, true);
+    return index;
+}
+
+bool MainWindow::isLatestContours(size_t layerIndex, const std::string& layerName, uint64_t generation) const
+{
+    auto latest = _contourGenerations.find(layerIndex);
+    return latest != _contourGenerations.end() && latest->second == generation &&
+           layerIndex < document.layerCount() && document.layer(layerIndex).name == layerName;
+}
+
+void MainWindow::generateContours(int index, double interval)
+{
+    if (index < 0 || static_cast<size_t>(index) >= document.layerCount())
+        return;
+
+    std::vector<std::shared_ptr<const Geometry::Tin>> tins = document.layer(static_cast<size_t>(index)).tins;
+    if (tins.empty()) {
+        qWarning("Layer %s has no surface to cut contours from", document.layer(static_cast<size_t>(index)).name.c_str());
+        return;
+    }
+    if (!(interval > 0)) {
+        qWarning("Contour generation failed: the interval must be positive");
+        return;
+    }
+    size_t layerIndex = contourLayer(document.layer(static_cast<size_t>(index)).name);
+    std::string layerName = document.layer(layerIndex).name;
+    uint64_t generation = ++_contourGenerations[layerIndex];
+    QPointer<MainWindow> self(this);
+    Concurrency::ThreadPool::global().submit([self, tins, interval, layerIndex, layerName, generation]() {
+        try {
+            auto start = std::chrono::steady_clock::now();
+            Geometry::ContourGenerator::Options options;
+            options.interval = interval;
+            auto lines = std::make_shared<QVector<Geometry::ContourLine>>();
+            size_t vertices = 0;
+            for (const std::shared_ptr<const Geometry::Tin>& tin : tins) {
+                Geometry::ContourGenerator generator(*tin, options, Concurrency::ThreadPool::global());
+                lines->append(generator.lines());
+                vertices += generator.vertexCount();
+            }
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            qDebug("%lld contour lines every %g of %zu vertices in %.2f s", (long long)lines->size(), interval,
+                   vertices, seconds);
+            QMetaObject::invokeMethod(self.data(), [self, lines, layerIndex, layerName, generation]() {
+                if (self && self->isLatestContours(layerIndex, layerName, generation)) {
+                    self->document.layer(layerIndex).polylines.set(*lines);
+                }
+            }, Qt::QueuedConnection);
+        } catch (const std::exception& e) {
+            qWarning("Contour generation failed: %s", e.what());
+        }
+    });
+}
+
+void MainWindow::importGridContours(const QString& fileName, double interval)
+{
+    if (!(interval > 0)) {
+        qWarning("Grid contour import failed: the interval must be positive");
+        return;
+    }
+    size_t layerIndex = contourLayer(QFileInfo(fileName).completeBaseName().toStdString());
+    std::string layerName = document.layer(layerIndex).name;
+    uint64_t generation = ++_contourGenerations[layerIndex];
+    QPointer<MainWindow> self(this);
+    Concurrency::ThreadPool::global().submit([self, fileName, interval, layerIndex, layerName, generation]() {
+        try {
+            auto start = std::chrono::steady_clock::now();
+            Import::AsciiGridReader reader(fileName.toStdString());
+            Geometry::ContourGenerator::Options options;
+            options.interval = interval;
+            Geometry::ContourGenerator generator(reader.grid(), options, Concurrency::ThreadPool::global());
+            auto lines = std::make_shared<QVector<Geometry::ContourLine>>(generator.lines());
+            qDebug("%ux%u grid, %lld contour lines every %g of %zu vertices", reader.grid().columns,
+                   reader.grid().rows, (long long)lines->size(), interval, generator.vertexCount());
+            reportImport(fileName, reader.byteCount(), start);
+            QMetaObject::invokeMethod(self.data(), [self, lines, layerIndex, layerName, generation]() {
+                if (self && self->isLatestContours(layerIndex, layerName, generation)) {
+                    self->document.layer(layerIndex).polylines.set(*lines);
+                }
+            }, Qt::QueuedConnection);
+        } catch (const std::exception& e) {
+            qWarning("Grid contour import failed: %s", e.what());
+        }
+    });
+}
+
+void MainWindow::setCrs(int epsg)
+{
+    try {
+        Geodesy::Crs crs = Geodesy::Crs::fromEpsg(epsg);
+        Geodesy::Transform transform(document.crs(), crs);
+        if (transform.isIdentity()) {
+            document.setCrs(crs);
+            return;
+        }
+        for (size_t i = 0; i < document.layerCount(); ++i) {
+            requireEntitiesOnly(document.layer(i));
+        }
+        // every layer is converted before the first one is replaced, a failure leaves the document as it was
+        std::vector<Geometry::ReprojectedEntities> converted;
+        converted.reserve(document.layerCount());
+        for (size_t i = 0; i < document.layerCount(); ++i) {
+            converted.push_back(Geometry::reprojected(document.layer(i), transform, Concurrency::ThreadPool::global()));
+        }
+        for (size_t i = 0; i < converted.size(); ++i) {
+            Geometry::replaceEntities(document.layer(i), converted[i]);
+        }
+        document.setCrs(crs);
+        // contours still being cut are in the system before
+        for (auto& [layer, generation] : _contourGenerations) {
+            ++generation;
+        }
+    } catch (const std::exception& e) {
+        qWarning("Changing the coordinate system failed: %s", e.what());
+    }
+}
+
+void MainWindow::reprojectLayer(int index, int fromEpsg)
+{
+    if (index < 0 || static_cast<size_t>(index) >= document.layerCount())
+        return;
+
+    try {
+        Geodesy::Transform transform(Geodesy::Crs::fromEpsg(fromEpsg), document.crs());
+        requireEntitiesOnly(document.layer(static_cast<size_t>(index)));
+        Geometry::reproject(document.layer(static_cast<size_t>(index)), transform,
+                            Concurrency::ThreadPool::global());
+    } catch (const std::exception& e) {
+        qWarning("Reprojecting the layer failed: %s", e.what());
+    }
+}
+
+int MainWindow::addLayer(const QString& name)
+{
+    return static_cast<int>(document.layerIndex(name.toStdString()));
+}
+
+void MainWindow::setCurrentLayer(int index)
+{
+    document.setCurrentLayer(static_cast<size_t>(index));
+}
+
+void MainWindow::setLayerVisible(int index, bool visible)
+{
+    document.setVisible(static_cast<size_t>(index), visible);
+}
+
+void MainWindow::setLayerWireframe(int index, bool wireframe)
+{
+    if (index < 0 || static_cast<size_t>(index) >= document.layerCount())
+        return;
+
+    Geometry::LayerStyle style = document.style(static_cast<size_t>(index));
+    style.flags = wireframe ? style.flags | Geometry::LayerStyle::Wireframe
+                            : style.flags & ~Geometry::LayerStyle::Wireframe;
+    document.setStyle(static_cast<size_t>(index), style);
+}
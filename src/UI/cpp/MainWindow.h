@@ -7,10 +7,11 @@
 #include <QHoverEvent>
 #include <QWheelEvent>
 #include <QKeyEvent>
-#include "Library/Flux/MutableList.h"
+#include "Geometry/Document.h"
 #include "ModeHandlers/ViewportContext.h"
 #include <linux/limits.h>
 #include <memory>
+#include <unordered_map>
 
 #include "Library/Meta/Meta.h"
 #include "Geometry/Line.h"
@@ -19,6 +20,10 @@ namespace ModeHandlers {
     class IModeHandler;
 }
 
+namespace Import {
+    struct ImportedLayer;
+}
+
 class MainWindow : public QObject
 {
     Q_OBJECT
@@ -42,6 +47,7 @@ public:
         None,
         AddLine,
         AddLineWithAngle,
+        AddCircle,
     };
 
     Mode currentMode = Mode::None;
@@ -51,9 +57,13 @@ public:
 
     void addLine(const Geometry::Line& line);
     void updateLine(const Geometry::Line& line);
-    void updatePosition(const QPointF& position);
+    void addCircle(const Geometry::Circle& circle);
+    void updateCircle(const Geometry::Circle& circle);
+
+    // snapshots of all layers, safe to hand to other threads
+    Geometry::DocumentSnapshot snapshot() const;
 
-    Flux::MutableList<Geometry::Line> lines;
+    Geometry::Document document;
 
 public slots:
     void mousePress(QMouseEvent* event, ViewportContext cntx);
@@ -67,10 +77,66 @@ public slots:
 
     void addLineMode();
     void addLineWithAngleMode();
+    void addCircleMode();
     void addingLineWithCoordinates(float x1, float y1, float x2, float y2);
 
+    void exportSvg(const QString& fileName);
+    void exportPdf(const QString& fileName);
+    void exportDxf(const QString& fileName);
+    void importDxf(const QString& fileName);
+    // the shapefile's coordinates are in the system with the EPSG code, 0 when they are in the
+    // document's already; its attributes aren't kept by the document yet
+    void importShapefile(const QString& fileName, int epsg = 0);
+    // GeoJSON is in WGS 84 longitude and latitude, converted into the document's system
+    void importGeoJson(const QString& fileName);
+    // a LAS scan of any size, sorted into a cache next to it on the thread pool (or the cache of
+    // an earlier import reused) and added to the layer named after the file once that is done;
+    // the EPSG code is the scan's system like for shapefiles
+    void importLas(const QString& fileName, int epsg = 0);
+    // a GeoTIFF or a TIFF with a world file, cut into a pyramid of tiles cached next to it like a
+    // LAS scan and drawn under the layer named after the file; without an EPSG code the one in
+    // the file is used, the image is placed by its corners when it's in another system
+    void importRaster(const QString& fileName, int epsg = 0);
+    // survey points as "x y z" lines triangulated into a surface on the thread pool, breaklines
+    // from a file of the same form forced in as edges, each run of points up to a blank line one
+    // breakline; added to the layer named after the points file
+    void importTin(const QString& points, const QString& breaklines = QString(), int epsg = 0);
+    // builds the surface of the points once for every thread count from 1 up, doubling, and logs
+    // the times; the document isn't touched
+    void benchmarkTin(const QString& points);
+    // contour lines of the layer's surfaces at every multiple of the interval, cut on the thread
+    // pool into the layer "<layer> contours"; they replace the lines of the interval before with
+    // one bulk set()
+    void generateContours(int index, double interval);
+    // the same for an Esri ASCII grid of elevations, its coordinates taken as the document's
+    void importGridContours(const QString& fileName, double interval);
+
+    // the EPSG code of the system the document is in; entities already drawn are converted, all
+    // layers or none. Refused while a layer has point clouds, rasters or surfaces, they were
+    // built in the system before
+    void setCrs(int epsg);
+    // the layer's entities were given in the system with the EPSG code, converts them into the
+    // document's, e.g. after importing data of another UTM zone; refused like setCrs()
+    void reprojectLayer(int index, int fromEpsg);
+
+    int addLayer(const QString& name);
+    void setCurrentLayer(int index);
+    void setLayerVisible(int index, bool visible);
+    // surfaces of the layer drawn as their edges instead of shaded
+    void setLayerWireframe(int index, bool wireframe);
+
 private:
+    // appends into the document layer of the same name
+    void addImported(const Import::ImportedLayer& imported);
+    // the layer the contours of the source go into, shown
+    size_t contourLayer(const std::string& source);
+    // whether the contours of a job are the last ones asked for of the layer, the ones of an
+    // earlier job finishing late are dropped
+    bool isLatestContours(size_t layerIndex, const std::string& layerName, uint64_t generation) const;
+
     std::shared_ptr<ModeHandlers::IModeHandler> _modeController;
     std::shared_ptr<ModeHandlers::IModeHandler> _moveHandler;
+    // per contour layer, grows with every contour job started for it
+    std::unordered_map<size_t, uint64_t> _contourGenerations;
 
 };
\ No newline at end of file
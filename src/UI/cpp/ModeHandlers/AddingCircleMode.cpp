@@ -0,0 +1,79 @@
+#include "AddingCircleMode.h"
+#include "UI/cpp/MainWindow.h"
+#include "UI/cpp/Geometry/Geometry.h"
+#include "UI/cpp/VulkanItem.h"
+#include <QGuiApplication>
+#include <cmath>
+
+namespace ModeHandlers {
+
+AddingCircleMode::AddingCircleMode(MainWindow* controller)
+    : IModeHandler(controller)
+{}
+
+QPointF AddingCircleMode::toDocument(const QPointF& position, const ViewportContext& cntx) const
+{
+    auto itemSize = cntx.viewportSize;
+    auto pos = cntx.offset;
+    auto z = cntx.zoomLevel;
+
+    return QPointF(
+        ((position.x() - pos.x() / 2) * 2 / itemSize.width() - 1) / z,
+        ((position.y() - pos.y() / 2) * 2 / itemSize.height() - 1) / z
+    );
+}
+
+Geometry::Circle AddingCircleMode::circleTo(const QPointF& position, const ViewportContext& cntx) const
+{
+    QPointF edge = toDocument(position, cntx);
+    return Geometry::Circle{
+        {(float)m_center.x(), (float)m_center.y()},
+        (float)std::hypot(edge.x() - m_center.x(), edge.y() - m_center.y()),
+        Geometry::packColor(0.f, 0.f, 0.f)
+    };
+}
+
+void AddingCircleMode::mousePressEvent(QMouseEvent *event, ViewportContext cntx)
+{
+    if (event->buttons() & Qt::RightButton) {
+        m_mousePressed = false;
+        m_dragged = false;
+        if (cntx.view) {
+            cntx.view->setPreview({});
+        }
+        _controller->changeMode(MainWindow::Mode::None);
+        return;
+    }
+    if (event->buttons() & Qt::LeftButton) {
+        m_mousePressed = true;
+        m_center = toDocument(event->position(), cntx);
+    }
+}
+
+void AddingCircleMode::mouseMoveEvent(QMouseEvent *event, ViewportContext cntx)
+{
+    // the circle stays in the preview while the radius is dragged
+    if (m_mousePressed && cntx.view) {
+        m_dragged = true;
+        cntx.view->setPreview({}, {circleTo(event->position(), cntx)});
+    }
+}
+
+void AddingCircleMode::mouseReleaseEvent(QMouseEvent *event, ViewportContext cntx)
+{
+    if (!m_mousePressed) {
+        return;
+    }
+    m_mousePressed = false;
+    // a click without dragging leaves no circle behind
+    if (m_dragged) {
+        if (cntx.view) {
+            cntx.view->setPreview({});
+        }
+        _controller->addCircle(circleTo(event->position(), cntx));
+        m_dragged = false;
+        _controller->changeMode(MainWindow::Mode::None);
+    }
+}
+
+} // namespace ModeHandlers
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "IModeHandler.h"
+#include "UI/cpp/Geometry/Circle.h"
+
+namespace ModeHandlers {
+
+// press sets the center, dragging sets the radius, release adds the circle to the document
+class AddingCircleMode : public IModeHandler
+{
+public:
+    AddingCircleMode(MainWindow* controller);
+    void mousePressEvent(QMouseEvent *event, ViewportContext cntx) override;
+    void mouseMoveEvent(QMouseEvent *event, ViewportContext cntx) override;
+    void mouseReleaseEvent(QMouseEvent *event, ViewportContext cntx) override;
+private:
+    QPointF toDocument(const QPointF& position, const ViewportContext& cntx) const;
+    // centered on the press, through position
+    Geometry::Circle circleTo(const QPointF& position, const ViewportContext& cntx) const;
+
+    bool m_mousePressed = false;
+    // the circle is in the preview, release adds it to the document
+    bool m_dragged = false;
+    QPointF m_center;
+
+};
+
+} // namespace ModeHandlers
@@ -1,6 +1,7 @@
 #include "AddingLineMode.h"
 #include "UI/cpp/MainWindow.h"
 #include "UI/cpp/Geometry/Geometry.h"
+#include "UI/cpp/VulkanItem.h"
 #include <QObject>
 #include "../VulkanRenderNode.h"
 
@@ -17,6 +18,9 @@ void AddingLineMode::mousePressEvent(QMouseEvent *event, ViewportContext cntx)
     if (event->buttons() & Qt::RightButton) {
         _controller->changeMode(MainWindow::Mode::None);
         isSecondPoint = false;
+        if (cntx.view) {
+            cntx.view->setPreview({});
+        }
         QGuiApplication::restoreOverrideCursor();
         return;
     } else if (event->buttons() & Qt::LeftButton) {
@@ -50,13 +54,10 @@ void AddingLineMode::mouseMoveEvent(QMouseEvent *event, ViewportContext cntx)
         Geometry::Vertex{(float)addLineStart.x(), (float)addLineStart.y(), 0., 0., 0.}, 
         Geometry::Vertex{endXpos, endYpos, 0., 0., 0.}
     };
-    if (m_mouseLinePressed) {
-        if (isSecondPoint) {
-            _controller->updateLine(line);
-        } else {
-            isSecondPoint = true;
-            _controller->addLine(line);
-        }
+    // the document gets the line once on release, until then it only lives in the preview
+    if (m_mouseLinePressed && cntx.view) {
+        isSecondPoint = true;
+        cntx.view->setPreview({line});
     }
 }
 
@@ -77,6 +78,9 @@ void AddingLineMode::mouseReleaseEvent(QMouseEvent *event, ViewportContext cntx)
             Geometry::Vertex{(float)addLineStart.x(), (float)(addLineStart.y()),0.0, 0.0, 0.0},
             Geometry::Vertex{endXpos, endYpos, 0.0, 0.0, 0.0}
         };
+        if (cntx.view) {
+            cntx.view->setPreview({});
+        }
         _controller->addLine(line);
         isSecondPoint = false;
         _controller->changeMode(MainWindow::Mode::None);
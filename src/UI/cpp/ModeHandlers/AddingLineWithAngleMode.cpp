@@ -1,6 +1,7 @@
 #include "AddingLineWithAngleMode.h"
 #include "UI/cpp/Geometry/Line.h"
 #include "UI/cpp/ModeHandlers/IModeHandler.h"
+#include "UI/cpp/VulkanItem.h"
 #include <QPoint>
 #include <cmath>
 
@@ -11,63 +12,66 @@ AddingLineWithAngleMode::AddingLineWithAngleMode(MainWindow* controller)
 {
 }
 
-void AddingLineWithAngleMode::mousePressEvent(QMouseEvent *event, ViewportContext cntx)
+Geometry::Line AddingLineWithAngleMode::lineAt(const QPointF& position, const ViewportContext& cntx) const
 {
-    QPointF localPos = event->position();
-
-    if (event->buttons() & Qt::RightButton) {
-        _controller->changeMode(MainWindow::Mode::None);
-        QGuiApplication::restoreOverrideCursor();
-        return;
-    } else if (event->buttons() & Qt::LeftButton) {
-        _pressed = true;
-    }
-
     auto itemSize = cntx.viewportSize;
     auto pos = cntx.offset;
     auto z = cntx.zoomLevel;
 
     QPointF addLineStart = QPointF(
-        (((event->position().x() - pos.x() / 2) * 2 / (itemSize.width()) - 1) / z),
-        (((event->position().y() - pos.y() / 2) * 2 / (itemSize.height()) - 1) / z)
+        (((position.x() - pos.x() / 2) * 2 / (itemSize.width()) - 1) / z),
+        (((position.y() - pos.y() / 2) * 2 / (itemSize.height()) - 1) / z)
     );
 
     QPointF addLineEnd = QPointF(addLineStart.rx() + 10 * std::sin((_controller->angle + 90) / 180 * M_PI), addLineStart.ry() + 10 * std::cos((_controller->angle + 90) / 180 * M_PI));
 
-    Geometry::Line line = {
+    return Geometry::Line{
         Geometry::Vertex{(float)addLineStart.x(), (float)addLineStart.y(), 0., 0., 0.}, 
         Geometry::Vertex{(float)addLineEnd.x(), (float)addLineEnd.y(), 0., 0., 0.}
     };
+}
+
+void AddingLineWithAngleMode::mousePressEvent(QMouseEvent *event, ViewportContext cntx)
+{
+    if (event->buttons() & Qt::RightButton) {
+        _pressed = false;
+        if (cntx.view) {
+            cntx.view->setPreview({});
+        }
+        _controller->changeMode(MainWindow::Mode::None);
+        QGuiApplication::restoreOverrideCursor();
+        return;
+    } else if (event->buttons() & Qt::LeftButton) {
+        _pressed = true;
+    }
 
-    _controller->addLine(line);
+    // dragging moves the line in the preview, the document gets it on release
+    _line = lineAt(event->position(), cntx);
+    if (cntx.view) {
+        cntx.view->setPreview({_line});
+    }
 }
 
 void AddingLineWithAngleMode::mouseMoveEvent(QMouseEvent *event, ViewportContext cntx)
 {
     if (_pressed) {
-        auto itemSize = cntx.viewportSize;
-        auto pos = cntx.offset;
-        auto z = cntx.zoomLevel;
-
-        QPointF addLineStart = QPointF(
-            (((event->position().x() - pos.x() / 2) * 2 / (itemSize.width()) - 1) / z),
-            (((event->position().y() - pos.y() / 2) * 2 / (itemSize.height()) - 1) / z)
-        );
-
-        QPointF addLineEnd = QPointF(addLineStart.rx() + 10 * std::sin((_controller->angle + 90) / 180 * M_PI), addLineStart.ry() + 10 * std::cos((_controller->angle + 90) / 180 * M_PI));
-
-        Geometry::Line line = {
-            Geometry::Vertex{(float)addLineStart.x(), (float)addLineStart.y(), 0., 0., 0.}, 
-            Geometry::Vertex{(float)addLineEnd.x(), (float)addLineEnd.y(), 0., 0., 0.}
-        };
-
-        _controller->updateLine(line);
+        _line = lineAt(event->position(), cntx);
+        if (cntx.view) {
+            cntx.view->setPreview({_line});
+        }
     }
 }
 
 void AddingLineWithAngleMode::mouseReleaseEvent(QMouseEvent *event, ViewportContext cntx)
 {
+    if (!_pressed) {
+        return;
+    }
     _pressed = false;
+    if (cntx.view) {
+        cntx.view->setPreview({});
+    }
+    _controller->addLine(_line);
 }
 
-}
\ No newline at end of file
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "UI/cpp/Geometry/Line.h"
 #include "UI/cpp/ModeHandlers/IModeHandler.h"
 
 namespace ModeHandlers {
@@ -13,7 +14,11 @@ public:
     void mouseReleaseEvent(QMouseEvent *event, ViewportContext cntx) override;
 
 private:
+    // the line under the cursor, added to the document on release
+    Geometry::Line lineAt(const QPointF& position, const ViewportContext& cntx) const;
+
     bool _pressed = false;
+    Geometry::Line _line;
 };
 
 }
\ No newline at end of file
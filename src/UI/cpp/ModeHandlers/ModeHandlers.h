@@ -2,4 +2,5 @@
 
 #include "IModeHandler.h"
 #include "AddingLineMode.h"
-#include "AddingLineWithAngleMode.h"
\ No newline at end of file
+#include "AddingLineWithAngleMode.h"
+#include "AddingCircleMode.h"
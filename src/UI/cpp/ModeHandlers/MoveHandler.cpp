@@ -1,5 +1,8 @@
 #include "MoveHandler.h"
 #include "../MainWindow.h"
+#include "../VulkanItem.h"
+#include <algorithm>
+#include <cmath>
 
 namespace ModeHandlers {
 
@@ -12,7 +15,7 @@ void MoveHandler::mousePressEvent(QMouseEvent *event, ViewportContext cntx)
     if ((event->buttons() & Qt::MiddleButton || (event->buttons() & Qt::RightButton && modifiers & Qt::ControlModifier))) {
         m_mousePressed = true;
         beginPos = event->position();
-        deltaPos = VulkanRenderNode::pos;
+        deltaPos = cntx.offset;
     }
 };
 
@@ -20,7 +23,9 @@ void MoveHandler::mouseMoveEvent(QMouseEvent *event, ViewportContext cntx)
 {
     if (m_mousePressed && (event->buttons() & Qt::MiddleButton || event->buttons() & Qt::RightButton)) {
         auto delta = event->position() - beginPos;
-        _controller->updatePosition(deltaPos + delta);
+        Camera camera = cntx.view->camera();
+        camera.offset = deltaPos + delta;
+        cntx.view->setCamera(camera);
     }
 };
 
@@ -34,12 +39,37 @@ void MoveHandler::mouseReleaseEvent(QMouseEvent *event, ViewportContext cntx)
 
 void MoveHandler::wheelEvent(QWheelEvent* event, ViewportContext cntx)
 {
-    float delta = event->angleDelta().ry();
-    if (delta > 0) {
-        VulkanRenderNode::z /= 0.9;
-    } else if (delta < 0 && VulkanRenderNode::z > 0.04) {
-        VulkanRenderNode::z *= 0.9;
+    // in wheel notches, turns coalesced into one event carry several
+    float steps = event->angleDelta().ry() / 120.0f;
+    Camera camera = cntx.view->camera();
+    if (steps > 0) {
+        camera.zoom /= std::pow(0.9f, steps);
+    } else if (steps < 0 && camera.zoom > 0.04) {
+        camera.zoom *= std::pow(0.9f, -steps);
     }
+    cntx.view->setCamera(camera);
 }
 
-}
\ No newline at end of file
+
+void MoveHandler::keyPressEvent(QKeyEvent* event, ViewportContext cntx)
+{
+    if (event->key() != Qt::Key_Home)
+        return;
+
+    // memoized by the document, fitting a large drawing doesn't scan it
+    const Geometry::BoundingBox& extents = _controller->document.extents();
+    if (extents.isEmpty())
+        return;
+
+    // clip = zoom * document + offset / size, the box is centered with a margin of 5% around it
+    float size = std::max(std::max(extents.width(), extents.height()), 1e-6f);
+    float centerX = (extents.min[0] + extents.max[0]) / 2;
+    float centerY = (extents.min[1] + extents.max[1]) / 2;
+    Camera camera = cntx.view->camera();
+    camera.zoom = 1.9f / size;
+    camera.offset = QPointF(-camera.zoom * centerX * cntx.viewportSize.width(),
+                            -camera.zoom * centerY * cntx.viewportSize.height());
+    cntx.view->setCamera(camera);
+}
+
+}
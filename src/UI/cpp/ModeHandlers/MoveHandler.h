@@ -12,6 +12,8 @@ public:
     void mouseMoveEvent(QMouseEvent *event, ViewportContext cntx) override;
     void mouseReleaseEvent(QMouseEvent *event, ViewportContext cntx) override;
     void wheelEvent(QWheelEvent* event, ViewportContext cntx) override;
+    // Home fits the whole document into the view
+    void keyPressEvent(QKeyEvent* event, ViewportContext cntx) override;
 
 private:
     bool m_mousePressed = false;
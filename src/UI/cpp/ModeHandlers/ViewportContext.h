@@ -2,10 +2,22 @@
 
 #include <QPointF>
 #include <QSizeF>
+#include <vector>
+
+#include "UI/cpp/Geometry/EntityRef.h"
+
+class VulkanItem;
 
 struct ViewportContext
 {
     float zoomLevel;
     QPointF offset;
     QSizeF viewportSize;
-};
\ No newline at end of file
+    // the item the event came from, handlers change its camera through it
+    VulkanItem* view = nullptr;
+    // the entity the view last picked under the cursor, none when there is nothing
+    Geometry::EntityRef hovered;
+    // pointer moves are delivered once per frame: the positions of every move folded into this
+    // one, oldest first and ending with the event's own, for tools that need each sample
+    std::vector<QPointF> history;
+};
@@ -0,0 +1,521 @@
+#include "Picker.h"
+#include <QRectF>
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+#include "SpirvShaders.h"
+#include "UI/cpp/Geometry/Arc.h"
+#include "UI/cpp/Geometry/Circle.h"
+#include "UI/cpp/Geometry/Vertex.h"
+
+namespace {
+
+// the part of the document drawn into the window, grown by margin pixels on every side
+Geometry::BoundingBox pickBox(const QMatrix4x4& clipToDocument, const QSizeF& pixelSize, const QPointF& cursor,
+                              float margin)
+{
+    float reach = Picker::radius + 1 + margin;
+    QRectF window(cursor.x() - reach, cursor.y() - reach, 2 * reach, 2 * reach);
+    QRectF clip(window.x() / pixelSize.width() * 2 - 1, window.y() / pixelSize.height() * 2 - 1,
+                window.width() / pixelSize.width() * 2, window.height() / pixelSize.height() * 2);
+    QRectF document = clipToDocument.mapRect(clip).normalized();
+
+    Geometry::BoundingBox box;
+    box.expand((float)document.left(), (float)document.top());
+    box.expand((float)document.right(), (float)document.bottom());
+    return box;
+}
+
+}
+
+Picker::Picker(std::shared_ptr<Vulkan::VulkanManager>& vkManager) :
+    VulkanComponent(vkManager),
+    _lineShader(vkManager, Vulkan::SpirvByteCode(Shaders::pick_line)),
+    _idShader(vkManager, Vulkan::SpirvByteCode(Shaders::pick)),
+    _circleShader(vkManager, Vulkan::SpirvByteCode(Shaders::vertex_circle)),
+    _circleIdShader(vkManager, Vulkan::SpirvByteCode(Shaders::pick_circle))
+{
+    createTarget();
+    createPipelines();
+}
+
+Picker::~Picker()
+{
+    for (VkPipeline pipeline : {_linePipeline, _stripPipeline, _circlePipeline, _arcPipeline}) {
+        if (pipeline != VK_NULL_HANDLE) {
+            _vkManager->vkDestroyPipeline(pipeline, nullptr);
+        }
+    }
+    if (_pipelineLayout != VK_NULL_HANDLE) {
+        _vkManager->vkDestroyPipelineLayout(_pipelineLayout, nullptr);
+    }
+    if (_styleSetLayout != VK_NULL_HANDLE) {
+        _vkManager->vkDestroyDescriptorSetLayout(_styleSetLayout, nullptr);
+    }
+    if (_framebuffer != VK_NULL_HANDLE) {
+        _vkManager->vkDestroyFramebuffer(_framebuffer, nullptr);
+    }
+    if (_renderPass != VK_NULL_HANDLE) {
+        _vkManager->vkDestroyRenderPass(_renderPass, nullptr);
+    }
+    if (_imageView != VK_NULL_HANDLE) {
+        _vkManager->vkDestroyImageView(_imageView, nullptr);
+    }
+    if (_image != VK_NULL_HANDLE) {
+        _vkManager->vkDestroyImage(_image, nullptr);
+    }
+    _vkManager->memoryAllocator().free(_imageMemory);
+}
+
+void Picker::createTarget()
+{
+    VkImageCreateInfo imageInfo = {};
+    imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageInfo.imageType = VK_IMAGE_TYPE_2D;
+    imageInfo.format = VK_FORMAT_R32_UINT;
+    imageInfo.extent = {windowSize, windowSize, 1};
+    imageInfo.mipLevels = 1;
+    imageInfo.arrayLayers = 1;
+    imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    imageInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+    imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+    VkResult result = _vkManager->vkCreateImage(&imageInfo, nullptr, &_image);
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("can't create pick image, return: " + std::to_string(result));
+    }
+
+    VkMemoryRequirements memReq;
+    vkGetImageMemoryRequirements(_vkManager->device(), _image, &memReq);
+    _imageMemory = _vkManager->memoryAllocator().allocate(memReq, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                                          Vulkan::MemoryAllocator::Kind::OptimalImage);
+    vkBindImageMemory(_vkManager->device(), _image, _imageMemory.memory, _imageMemory.offset);
+
+    VkImageViewCreateInfo viewInfo = {};
+    viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    viewInfo.image = _image;
+    viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    viewInfo.format = VK_FORMAT_R32_UINT;
+    viewInfo.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+
+    result = _vkManager->vkCreateImageView(&viewInfo, nullptr, &_imageView);
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("can't create pick image view, return: " + std::to_string(result));
+    }
+
+    // cleared every pick, afterwards the image is only copied out
+    VkAttachmentDescription attachment = {};
+    attachment.format = VK_FORMAT_R32_UINT;
+    attachment.samples = VK_SAMPLE_COUNT_1_BIT;
+    attachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    attachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    attachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    attachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    attachment.finalLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+
+    VkAttachmentReference colorReference = {0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL};
+
+    VkSubpassDescription subpass = {};
+    subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    subpass.colorAttachmentCount = 1;
+    subpass.pColorAttachments = &colorReference;
+
+    // the previous pick's copy reads the image before this one clears it, this pick's copy
+    // waits for the ids
+    VkSubpassDependency dependencies[2] = {};
+    dependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
+    dependencies[0].dstSubpass = 0;
+    dependencies[0].srcStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+    dependencies[0].dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    dependencies[0].srcAccessMask = 0;
+    dependencies[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+
+    dependencies[1].srcSubpass = 0;
+    dependencies[1].dstSubpass = VK_SUBPASS_EXTERNAL;
+    dependencies[1].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    dependencies[1].dstStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+    dependencies[1].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    dependencies[1].dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+    VkRenderPassCreateInfo renderPassInfo = {};
+    renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+    renderPassInfo.attachmentCount = 1;
+    renderPassInfo.pAttachments = &attachment;
+    renderPassInfo.subpassCount = 1;
+    renderPassInfo.pSubpasses = &subpass;
+    renderPassInfo.dependencyCount = 2;
+    renderPassInfo.pDependencies = dependencies;
+
+    result = _vkManager->vkCreateRenderPass(&renderPassInfo, nullptr, &_renderPass);
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("can't create pick render pass, return: " + std::to_string(result));
+    }
+
+    VkFramebufferCreateInfo framebufferInfo = {};
+    framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+    framebufferInfo.renderPass = _renderPass;
+    framebufferInfo.attachmentCount = 1;
+    framebufferInfo.pAttachments = &_imageView;
+    framebufferInfo.width = windowSize;
+    framebufferInfo.height = windowSize;
+    framebufferInfo.layers = 1;
+
+    result = _vkManager->vkCreateFramebuffer(&framebufferInfo, nullptr, &_framebuffer);
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("can't create pick framebuffer, return: " + std::to_string(result));
+    }
+}
+
+void Picker::createPipelines()
+{
+    // the circle shader reads the style table like in the document pipelines
+    _styleSetLayout = StyleTable::createDescriptorSetLayout(*_vkManager);
+
+    VkPushConstantRange pushConstantRange = {};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(PushConstants);
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &_styleSetLayout;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+    VkResult result = _vkManager->vkCreatePipelineLayout(&pipelineLayoutInfo, nullptr, &_pipelineLayout);
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("can't create pick pipeline layout, return: " + std::to_string(result));
+    }
+
+    VkVertexInputBindingDescription vertexBinding = {0, sizeof(Geometry::Vertex), VK_VERTEX_INPUT_RATE_VERTEX};
+    VkVertexInputAttributeDescription vertexAttribute = {0, 0, VK_FORMAT_R32G32_SFLOAT, offsetof(Geometry::Vertex, pos)};
+    _linePipeline = createPipeline(_lineShader, _idShader, VK_FALSE, VK_PRIMITIVE_TOPOLOGY_LINE_LIST,
+                                   vertexBinding, &vertexAttribute, 1);
+    _stripPipeline = createPipeline(_lineShader, _idShader, VK_TRUE, VK_PRIMITIVE_TOPOLOGY_LINE_STRIP,
+                                    vertexBinding, &vertexAttribute, 1);
+
+    // the attributes of the node's circle pipelines, colors are read but not written
+    for (VkBool32 isArc : {VK_FALSE, VK_TRUE}) {
+        VkVertexInputBindingDescription binding = {
+            0, isArc ? (uint32_t)sizeof(Geometry::Arc) : (uint32_t)sizeof(Geometry::Circle), VK_VERTEX_INPUT_RATE_INSTANCE
+        };
+        VkVertexInputAttributeDescription attributes[4] = {
+            {0, 0, VK_FORMAT_R32G32_SFLOAT, offsetof(Geometry::Circle, center)},
+            {1, 0, VK_FORMAT_R32_SFLOAT, offsetof(Geometry::Circle, radius)},
+            {2, 0, VK_FORMAT_R8G8B8A8_UNORM, offsetof(Geometry::Circle, color)},
+            {3, 0, VK_FORMAT_R32G32_SFLOAT, isArc ? (uint32_t)offsetof(Geometry::Arc, startAngle) : 0},
+        };
+        VkPipeline pipeline = createPipeline(_circleShader, _circleIdShader, isArc, VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP,
+                                             binding, attributes, 4);
+        (isArc ? _arcPipeline : _circlePipeline) = pipeline;
+    }
+}
+
+VkPipeline Picker::createPipeline(VkShaderModule vertexShader, VkShaderModule fragmentShader, VkBool32 specialization,
+                                  VkPrimitiveTopology topology, const VkVertexInputBindingDescription& binding,
+                                  const VkVertexInputAttributeDescription* attributes, uint32_t attributeCount)
+{
+    // isStrip of the line shader, isArc of the circle shaders
+    VkSpecializationMapEntry specializationEntry = {0, 0, sizeof(VkBool32)};
+    VkSpecializationInfo specializationInfo = {};
+    specializationInfo.mapEntryCount = 1;
+    specializationInfo.pMapEntries = &specializationEntry;
+    specializationInfo.dataSize = sizeof(specialization);
+    specializationInfo.pData = &specialization;
+
+    VkPipelineShaderStageCreateInfo shaderStages[2] = {};
+    shaderStages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    shaderStages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
+    shaderStages[0].module = vertexShader;
+    shaderStages[0].pName = "main";
+    shaderStages[0].pSpecializationInfo = &specializationInfo;
+
+    shaderStages[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    shaderStages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+    shaderStages[1].module = fragmentShader;
+    shaderStages[1].pName = "main";
+    shaderStages[1].pSpecializationInfo = &specializationInfo;
+
+    VkPipelineVertexInputStateCreateInfo vertexInputInfo = {};
+    vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+    vertexInputInfo.vertexBindingDescriptionCount = 1;
+    vertexInputInfo.pVertexBindingDescriptions = &binding;
+    vertexInputInfo.vertexAttributeDescriptionCount = attributeCount;
+    vertexInputInfo.pVertexAttributeDescriptions = attributes;
+
+    VkPipelineInputAssemblyStateCreateInfo inputAssembly = {};
+    inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+    inputAssembly.topology = topology;
+    inputAssembly.primitiveRestartEnable = topology == VK_PRIMITIVE_TOPOLOGY_LINE_STRIP ? VK_TRUE : VK_FALSE;
+
+    VkPipelineViewportStateCreateInfo viewportState = {};
+    viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+    viewportState.viewportCount = 1;
+    viewportState.scissorCount = 1;
+
+    VkPipelineRasterizationStateCreateInfo rasterizer = {};
+    rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+    rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
+    rasterizer.lineWidth = 1.0f;
+    rasterizer.cullMode = VK_CULL_MODE_NONE;
+    rasterizer.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+
+    VkPipelineMultisampleStateCreateInfo multisampling = {};
+    multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+    multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+    multisampling.minSampleShading = 1.0f;
+
+    // ids can't be blended, the last entity drawn into a pixel owns it
+    VkPipelineColorBlendAttachmentState colorBlendAttachment = {};
+    colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT;
+    colorBlendAttachment.blendEnable = VK_FALSE;
+
+    VkPipelineColorBlendStateCreateInfo colorBlending = {};
+    colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+    colorBlending.attachmentCount = 1;
+    colorBlending.pAttachments = &colorBlendAttachment;
+
+    VkDynamicState dynamicStates[] = {
+        VK_DYNAMIC_STATE_VIEWPORT,
+        VK_DYNAMIC_STATE_SCISSOR,
+        VK_DYNAMIC_STATE_LINE_WIDTH
+    };
+
+    VkPipelineDynamicStateCreateInfo dynamicState = {};
+    dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+    dynamicState.dynamicStateCount = 3;
+    dynamicState.pDynamicStates = dynamicStates;
+
+    VkGraphicsPipelineCreateInfo pipelineInfo = {};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    pipelineInfo.stageCount = 2;
+    pipelineInfo.pStages = shaderStages;
+    pipelineInfo.pVertexInputState = &vertexInputInfo;
+    pipelineInfo.pInputAssemblyState = &inputAssembly;
+    pipelineInfo.pViewportState = &viewportState;
+    pipelineInfo.pRasterizationState = &rasterizer;
+    pipelineInfo.pMultisampleState = &multisampling;
+    pipelineInfo.pColorBlendState = &colorBlending;
+    pipelineInfo.pDynamicState = &dynamicState;
+    pipelineInfo.layout = _pipelineLayout;
+    pipelineInfo.renderPass = _renderPass;
+    pipelineInfo.subpass = 0;
+    pipelineInfo.basePipelineIndex = -1;
+
+    VkPipeline pipeline;
+    VkResult result = _vkManager->vkCreateGraphicsPipelines(VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline);
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("can't create pick pipeline, return: " + std::to_string(result));
+    }
+    return pipeline;
+}
+
+uint32_t Picker::addRange(Slot& slot, Geometry::EntityRef::Kind kind, uint32_t layer, size_t firstIndex, size_t count)
+{
+    uint32_t firstId = _nextId;
+    slot.ranges.push_back({firstId, (uint32_t)count, kind, layer, firstIndex});
+    _nextId += (uint32_t)count;
+    return firstId;
+}
+
+void Picker::record(VkCommandBuffer commandBuffer, int frameSlot, int framesInFlight, const DocumentGpuStore& store,
+                    const QMatrix4x4& documentToClip, const QSizeF& pixelSize, const QPointF& cursor)
+{
+    if (pixelSize.isEmpty()) {
+        return;
+    }
+    if (_slots.size() != (size_t)framesInFlight) {
+        _slots.resize(framesInFlight);
+    }
+    Slot& slot = _slots[frameSlot];
+    if (!slot.readback) {
+        slot.readback = std::make_unique<Vulkan::Buffer>(_vkManager);
+        slot.readback->allocateMemory(windowSize * windowSize * sizeof(uint32_t), VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                      Vulkan::Buffer::Location::HostVisible);
+    }
+    slot.ranges.clear();
+    _nextId = 1;
+
+    VkClearValue clear = {};
+    VkRenderPassBeginInfo beginInfo = {};
+    beginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+    beginInfo.renderPass = _renderPass;
+    beginInfo.framebuffer = _framebuffer;
+    beginInfo.renderArea = {{0, 0}, {windowSize, windowSize}};
+    beginInfo.clearValueCount = 1;
+    beginInfo.pClearValues = &clear;
+    _vkManager->vkCmdBeginRenderPass(commandBuffer, &beginInfo, VK_SUBPASS_CONTENTS_INLINE);
+
+    // the whole item shifted so the cursor lands in the middle of the window
+    VkViewport viewport = {};
+    viewport.x = (float)(radius - cursor.x());
+    viewport.y = (float)(radius - cursor.y());
+    viewport.width = (float)pixelSize.width();
+    viewport.height = (float)pixelSize.height();
+    viewport.minDepth = 0.0f;
+    viewport.maxDepth = 1.0f;
+    _vkManager->vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+
+    VkRect2D scissor = {{0, 0}, {windowSize, windowSize}};
+    _vkManager->vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+
+    VkDescriptorSet styles = store.styleTable().descriptorSet();
+    _vkManager->vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, _pipelineLayout,
+                                        0, 1, &styles, 0, nullptr);
+
+    PushConstants constants = {};
+    std::copy(documentToClip.constData(), documentToClip.constData() + 16, constants.transform);
+    constants.viewportSize[0] = (float)pixelSize.width();
+    constants.viewportSize[1] = (float)pixelSize.height();
+
+    QMatrix4x4 clipToDocument = documentToClip.inverted();
+    const std::vector<Geometry::LayerStyle>& layerStyles = store.styles();
+    size_t layerCount = std::min({store.layerCount(), layerStyles.size(), StyleTable::capacity});
+
+    // every chunk touching the window is drawn whole, its entities get consecutive ids
+    auto drawChunks = [&](const auto& list, Geometry::EntityRef::Kind kind, const Geometry::BoundingBox& box,
+                          auto&& draw) {
+        if (!list.snapshot()) {
+            return;
+        }
+        for (size_t i = 0; i < list.chunkCount() && i < list.snapshot()->chunkCount(); ++i) {
+            size_t count = list.chunk(i).uploadedCount;
+            if (count == 0 || !box.intersects(list.snapshot()->chunk(i).summary) ||
+                count >= std::numeric_limits<uint32_t>::max() - _nextId) {
+                continue;
+            }
+            constants.firstId = addRange(slot, kind, constants.layer, i * list.chunkSize, count);
+            _vkManager->vkCmdPushConstants(commandBuffer, _pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT,
+                                           0, sizeof(constants), &constants);
+            VkBuffer buffer = *list.chunk(i).buffer;
+            VkDeviceSize offset = 0;
+            _vkManager->vkCmdBindVertexBuffers(commandBuffer, 0, 1, &buffer, &offset);
+            draw(i, count);
+        }
+    };
+
+    for (size_t layer = 0; layer < layerCount; ++layer) {
+        if (!layerStyles[layer].visible()) {
+            continue;
+        }
+        const DocumentGpuStore::Layer& source = store.layer(layer);
+        constants.layer = (uint32_t)layer;
+        // lines reach half their width past their chunk's box, circles and arcs a pixel more
+        Geometry::BoundingBox box = pickBox(clipToDocument, pixelSize, cursor, layerStyles[layer].width * 0.5f + 1.0f);
+
+        _vkManager->vkCmdSetLineWidth(commandBuffer, layerStyles[layer].width);
+        _vkManager->vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, _linePipeline);
+        drawChunks(source.lines, Geometry::EntityRef::Kind::Line, box, [&](size_t, size_t count) {
+            _vkManager->vkCmdDraw(commandBuffer, count * 2, 1, 0, 0);
+        });
+
+        _vkManager->vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, _stripPipeline);
+        const GpuPolylineList& polylines = source.polylines;
+        drawChunks(polylines.vertices(), Geometry::EntityRef::Kind::Polyline, box, [&](size_t i, size_t) {
+            if (i < polylines.indexChunkCount() && polylines.indexChunk(i).uploadedCount > 0) {
+                const GpuPolylineList::IndexChunk& indices = polylines.indexChunk(i);
+                _vkManager->vkCmdBindIndexBuffer(commandBuffer, *indices.buffer, 0, VK_INDEX_TYPE_UINT32);
+                _vkManager->vkCmdDrawIndexed(commandBuffer, indices.uploadedCount, 1, 0, 0, 0);
+            }
+        });
+
+        _vkManager->vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, _circlePipeline);
+        drawChunks(source.circles, Geometry::EntityRef::Kind::Circle, box, [&](size_t, size_t count) {
+            _vkManager->vkCmdDraw(commandBuffer, 4, count, 0, 0);
+        });
+
+        _vkManager->vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, _arcPipeline);
+        drawChunks(source.arcs, Geometry::EntityRef::Kind::Arc, box, [&](size_t, size_t count) {
+            _vkManager->vkCmdDraw(commandBuffer, 4, count, 0, 0);
+        });
+    }
+
+    _vkManager->vkCmdEndRenderPass(commandBuffer);
+
+    VkBufferImageCopy region = {};
+    region.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+    region.imageExtent = {windowSize, windowSize, 1};
+    _vkManager->vkCmdCopyImageToBuffer(commandBuffer, _image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                                       *slot.readback, 1, &region);
+
+    // read by collect() once Qt waited for the slot's fence
+    VkMemoryBarrier barrier = {};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+    _vkManager->vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT,
+                                     0, 1, &barrier, 0, nullptr, 0, nullptr);
+    slot.pending = true;
+}
+
+std::optional<Geometry::EntityRef> Picker::collect(int frameSlot, const DocumentGpuStore& store)
+{
+    if ((size_t)frameSlot >= _slots.size() || !_slots[frameSlot].pending) {
+        return std::nullopt;
+    }
+    Slot& slot = _slots[frameSlot];
+    slot.pending = false;
+
+    const uint32_t* ids = static_cast<const uint32_t*>(slot.readback->map());
+    uint32_t nearest = 0;
+    uint32_t nearestDistance = std::numeric_limits<uint32_t>::max();
+    for (uint32_t y = 0; y < windowSize; ++y) {
+        for (uint32_t x = 0; x < windowSize; ++x) {
+            uint32_t id = ids[y * windowSize + x];
+            int dx = (int)x - (int)radius;
+            int dy = (int)y - (int)radius;
+            uint32_t distance = dx * dx + dy * dy;
+            if (id != 0 && distance < nearestDistance) {
+                nearest = id;
+                nearestDistance = distance;
+            }
+        }
+    }
+    return nearest == 0 ? Geometry::EntityRef{} : resolve(slot, nearest, store);
+}
+
+Geometry::EntityRef Picker::resolve(const Slot& slot, uint32_t id, const DocumentGpuStore& store) const
+{
+    // ranges were added with growing ids
+    auto range = std::upper_bound(slot.ranges.begin(), slot.ranges.end(), id,
+                                  [](uint32_t id, const Range& range) { return id < range.firstId; });
+    if (range == slot.ranges.begin()) {
+        return {};
+    }
+    --range;
+    if (id - range->firstId >= range->count) {
+        return {};
+    }
+    size_t index = range->firstIndex + (id - range->firstId);
+    if (range->kind != Geometry::EntityRef::Kind::Polyline) {
+        return {range->kind, range->layer, index};
+    }
+
+    // the id of a polyline segment is the pool vertex it starts at, the polyline is the last one
+    // starting at or before it
+    if (range->layer >= store.layerCount() || !store.layer(range->layer).polylines.polylines()) {
+        return {};
+    }
+    const auto& records = *store.layer(range->layer).polylines.polylines();
+    size_t first = 0;
+    size_t last = records.size();
+    while (first < last) {
+        size_t middle = first + (last - first) / 2;
+        if (records.at(middle).firstVertex <= index) {
+            first = middle + 1;
+        } else {
+            last = middle;
+        }
+    }
+    if (first == 0) {
+        return {};
+    }
+    return {Geometry::EntityRef::Kind::Polyline, range->layer, first - 1};
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <QMatrix4x4>
+#include <QPointF>
+#include <QSizeF>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+#include "Library/Vulkan/Buffer.h"
+#include "Library/Vulkan/MemoryAllocator.h"
+#include "Library/Vulkan/ShaderModule.h"
+#include "Library/Vulkan/VulkanComponent.h"
+#include "Library/Vulkan/VulkanManager.h"
+#include "UI/cpp/DocumentGpuStore.h"
+#include "UI/cpp/Geometry/EntityRef.h"
+
+// Finds the entity under the cursor on the GPU. record() draws entity ids into a small R32_UINT
+// image covering a window around the cursor and copies it into a host visible buffer of the
+// frame slot; collect() reads that buffer once the slot comes round again, when Qt has waited
+// for the slot's fence. Picking never stalls the queue and answers one or two frames late, at a
+// cost that depends on the chunks touching the window, not on the size of the document.
+class Picker : protected Vulkan::VulkanComponent {
+public:
+    // pixels on each side of the cursor, the entity drawn nearest to the cursor in the window wins
+    static constexpr uint32_t radius = 6;
+    static constexpr uint32_t windowSize = 2 * radius + 1;
+
+    Picker(std::shared_ptr<Vulkan::VulkanManager>& vkManager);
+    ~Picker();
+
+    // at the start of the frame, what the pick recorded the last time the slot was used found;
+    // nullopt when nothing was recorded in the slot
+    std::optional<Geometry::EntityRef> collect(int frameSlot, const DocumentGpuStore& store);
+    // outside of the render pass, after the store's uploads were flushed; cursor and pixelSize
+    // in framebuffer pixels of the item
+    void record(VkCommandBuffer commandBuffer, int frameSlot, int framesInFlight, const DocumentGpuStore& store,
+                const QMatrix4x4& documentToClip, const QSizeF& pixelSize, const QPointF& cursor);
+
+private:
+    // layout of the push constants in pick_line.vert and vertex_circle.vert
+    struct PushConstants {
+        float transform[16];
+        float viewportSize[2];
+        uint32_t layer;
+        uint32_t firstId;
+    };
+
+    // ids [firstId, firstId + count) are the entities [firstIndex, firstIndex + count) of a list,
+    // for polylines the vertices of the pool
+    struct Range {
+        uint32_t firstId;
+        uint32_t count;
+        Geometry::EntityRef::Kind kind;
+        uint32_t layer;
+        size_t firstIndex;
+    };
+
+    struct Slot {
+        std::unique_ptr<Vulkan::Buffer> readback;
+        std::vector<Range> ranges;
+        bool pending = false;
+    };
+
+    void createTarget();
+    void createPipelines();
+    VkPipeline createPipeline(VkShaderModule vertexShader, VkShaderModule fragmentShader, VkBool32 specialization,
+                              VkPrimitiveTopology topology, const VkVertexInputBindingDescription& binding,
+                              const VkVertexInputAttributeDescription* attributes, uint32_t attributeCount);
+    // the first id of the range
+    uint32_t addRange(Slot& slot, Geometry::EntityRef::Kind kind, uint32_t layer, size_t firstIndex, size_t count);
+    Geometry::EntityRef resolve(const Slot& slot, uint32_t id, const DocumentGpuStore& store) const;
+
+    Vulkan::ShaderModule _lineShader;
+    Vulkan::ShaderModule _idShader;
+    Vulkan::ShaderModule _circleShader;
+    Vulkan::ShaderModule _circleIdShader;
+
+    VkImage _image = VK_NULL_HANDLE;
+    Vulkan::Allocation _imageMemory;
+    VkImageView _imageView = VK_NULL_HANDLE;
+    VkRenderPass _renderPass = VK_NULL_HANDLE;
+    VkFramebuffer _framebuffer = VK_NULL_HANDLE;
+
+    VkDescriptorSetLayout _styleSetLayout = VK_NULL_HANDLE;
+    VkPipelineLayout _pipelineLayout = VK_NULL_HANDLE;
+    VkPipeline _linePipeline = VK_NULL_HANDLE;
+    VkPipeline _stripPipeline = VK_NULL_HANDLE;
+    VkPipeline _circlePipeline = VK_NULL_HANDLE;
+    VkPipeline _arcPipeline = VK_NULL_HANDLE;
+
+    std::vector<Slot> _slots;
+    uint32_t _nextId = 1;
+};
@@ -0,0 +1,294 @@
+#include "PointCloudView.h"
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+#include <exception>
+#include <queue>
+#include <utility>
+
+#include "Library/Concurrency/ThreadPool.h"
+
+namespace {
+
+// of the slots, the rest takes the pages still uploading and the ones being replaced
+constexpr size_t pageBudget = PointCloudView::slotCount * 3 / 4;
+// pixels between the points of a node from where its children aren't needed
+constexpr double targetSpacing = 1.0;
+
+}
+
+PointCloudView::PointCloudView(std::shared_ptr<Vulkan::VulkanManager>& vkManager) :
+    VulkanComponent(vkManager),
+    _slots(slotCount),
+    _inbox(std::make_shared<Inbox>())
+{}
+
+// reads still running only touch the inbox, which they hold themselves
+PointCloudView::~PointCloudView() = default;
+
+void PointCloudView::setSnapshot(const Geometry::DocumentSnapshot& snapshot)
+{
+    std::unordered_map<const Geometry::PointCloud*, Cloud> clouds;
+    for (size_t layer = 0; layer < snapshot.layers.size(); ++layer) {
+        bool visible = layer < snapshot.styles.size() && snapshot.styles[layer].visible();
+        for (const std::shared_ptr<const Geometry::PointCloud>& source : snapshot.layers[layer].pointClouds) {
+            auto found = _clouds.find(source.get());
+            Cloud cloud;
+            if (found != _clouds.end()) {
+                cloud = std::move(found->second);
+            } else {
+                cloud.cloud = source;
+                cloud.slots.assign(source->pages().size(), -1);
+                cloud.loading.assign(source->pages().size(), false);
+                cloud.picked.assign(source->nodes().size(), false);
+            }
+            cloud.visible = visible;
+            clouds.emplace(source.get(), std::move(cloud));
+        }
+    }
+    // the slots of clouds no longer in the document are free again
+    for (Slot& slot : _slots) {
+        if (slot.cloud && !clouds.count(slot.cloud)) {
+            slot = Slot{};
+        }
+    }
+    _clouds = std::move(clouds);
+}
+
+void PointCloudView::prepare(Vulkan::StagingRing& ring, const QRectF& view, double pixelsPerUnit)
+{
+    ++_frame;
+    _draws.clear();
+    {
+        std::lock_guard<std::mutex> lock(_inbox->mutex);
+        for (Load& load : _inbox->loads) {
+            _ready.push_back(std::move(load));
+        }
+        _inbox->loads.clear();
+    }
+    if (_clouds.empty()) {
+        _loadsRunning -= _ready.size();
+        _ready.clear();
+        return;
+    }
+    if (!_buffer) {
+        _buffer = std::make_unique<Vulkan::Buffer>(_vkManager);
+        _buffer->allocateMemory(slotCount * slotPoints * sizeof(Geometry::CloudPoint), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                                Vulkan::Buffer::Location::DeviceLocal);
+    }
+
+    QRectF normalized = view.normalized();
+    _view = Geometry::BoundingBox{};
+    _view.expand((float)normalized.left(), (float)normalized.top());
+    _view.expand((float)normalized.right(), (float)normalized.bottom());
+
+    pick(pixelsPerUnit);
+    upload(ring);
+    for (auto& [key, cloud] : _clouds) {
+        if (cloud.visible && cloud.picked[0]) {
+            collectDraws(cloud, 0);
+        }
+    }
+}
+
+void PointCloudView::pick(double pixelsPerUnit)
+{
+    struct Candidate {
+        // of the node's cell on screen, in pixels
+        double size;
+        Cloud* cloud;
+        uint32_t node;
+
+        bool operator<(const Candidate& other) const { return size < other.size; }
+    };
+
+    std::priority_queue<Candidate> queue;
+    for (auto& [key, cloud] : _clouds) {
+        std::fill(cloud.picked.begin(), cloud.picked.end(), false);
+        const Geometry::PointCloud::Node& root = cloud.cloud->nodes()[0];
+        if (cloud.visible && _view.intersects(root.cell)) {
+            queue.push({root.cell.width() * pixelsPerUnit, &cloud, 0});
+        }
+    }
+
+    size_t points = 0;
+    size_t pages = 0;
+    while (!queue.empty()) {
+        Candidate candidate = queue.top();
+        queue.pop();
+        Cloud& cloud = *candidate.cloud;
+        const Geometry::PointCloud::Node& node = cloud.cloud->nodes()[candidate.node];
+        size_t nodePoints = 0;
+        for (uint32_t page = node.firstPage; page < node.firstPage + node.pageCount; ++page) {
+            nodePoints += std::min<size_t>(cloud.cloud->pages()[page].count, slotPoints);
+        }
+        // the largest nodes come first, what is left out is detail
+        if (points + nodePoints > pointBudget || pages + node.pageCount > pageBudget) {
+            break;
+        }
+        points += nodePoints;
+        pages += node.pageCount;
+        cloud.picked[candidate.node] = true;
+        for (uint32_t page = node.firstPage; page < node.firstPage + node.pageCount; ++page) {
+            if (cloud.slots[page] >= 0) {
+                _slots[cloud.slots[page]].used = _frame;
+            }
+        }
+        request(cloud, candidate.node);
+
+        if (candidate.size / std::sqrt((double)std::max<size_t>(nodePoints, 1)) <= targetSpacing) {
+            continue;
+        }
+        for (uint32_t child : node.children) {
+            if (child && _view.intersects(cloud.cloud->nodes()[child].cell)) {
+                queue.push({cloud.cloud->nodes()[child].cell.width() * pixelsPerUnit, &cloud, child});
+            }
+        }
+    }
+}
+
+void PointCloudView::request(Cloud& cloud, uint32_t node)
+{
+    const Geometry::PointCloud::Node& entry = cloud.cloud->nodes()[node];
+    for (uint32_t page = entry.firstPage; page < entry.firstPage + entry.pageCount; ++page) {
+        if (_loadsRunning >= maxLoads) {
+            return;
+        }
+        if (cloud.slots[page] >= 0 || cloud.loading[page]) {
+            continue;
+        }
+        cloud.loading[page] = true;
+        ++_loadsRunning;
+        std::shared_ptr<Inbox> inbox = _inbox;
+        std::shared_ptr<const Geometry::PointCloud> source = cloud.cloud;
+        Concurrency::ThreadPool::global().submit([inbox, source, page]() {
+            Load load;
+            load.cloud = source;
+            load.page = page;
+            try {
+                source->readPage(page, load.points);
+            } catch (const std::exception& e) {
+                qWarning("Reading point cloud %s failed: %s", source->name().c_str(), e.what());
+                load.failed = true;
+            }
+            std::lock_guard<std::mutex> lock(inbox->mutex);
+            inbox->loads.push_back(std::move(load));
+        });
+    }
+}
+
+void PointCloudView::upload(Vulkan::StagingRing& ring)
+{
+    size_t kept = 0;
+    for (Load& load : _ready) {
+        auto found = _clouds.find(load.cloud.get());
+        if (found == _clouds.end() || found->second.cloud != load.cloud) {
+            // removed from the document while it was read
+            --_loadsRunning;
+            continue;
+        }
+        Cloud& cloud = found->second;
+        if (load.failed) {
+            // the page stays marked as loading, a broken file isn't read every frame
+            --_loadsRunning;
+            continue;
+        }
+        int32_t slot = takeSlot();
+        size_t count = std::min(load.points.size(), slotPoints);
+        if (slot < 0 || !_buffer->upload(ring, slot * slotPoints * sizeof(Geometry::CloudPoint), load.points.data(),
+                                         count * sizeof(Geometry::CloudPoint))) {
+            // no room in this frame, tried again in the next
+            _ready[kept++] = std::move(load);
+            continue;
+        }
+        Slot& entry = _slots[slot];
+        if (entry.cloud) {
+            auto owner = _clouds.find(entry.cloud);
+            if (owner != _clouds.end()) {
+                owner->second.slots[entry.page] = -1;
+            }
+        }
+        entry = Slot{cloud.cloud.get(), load.page, (uint32_t)count, _frame};
+        cloud.slots[load.page] = slot;
+        cloud.loading[load.page] = false;
+        --_loadsRunning;
+    }
+    _ready.resize(kept);
+}
+
+int32_t PointCloudView::takeSlot()
+{
+    int32_t oldest = -1;
+    for (size_t i = 0; i < _slots.size(); ++i) {
+        if (!_slots[i].cloud) {
+            return (int32_t)i;
+        }
+        if (_slots[i].used < _frame && (oldest < 0 || _slots[i].used < _slots[oldest].used)) {
+            oldest = (int32_t)i;
+        }
+    }
+    return oldest;
+}
+
+bool PointCloudView::resident(const Cloud& cloud, uint32_t node) const
+{
+    const Geometry::PointCloud::Node& entry = cloud.cloud->nodes()[node];
+    for (uint32_t page = entry.firstPage; page < entry.firstPage + entry.pageCount; ++page) {
+        if (cloud.slots[page] < 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool PointCloudView::refined(const Cloud& cloud, uint32_t node) const
+{
+    bool any = false;
+    for (uint32_t child : cloud.cloud->nodes()[node].children) {
+        if (!child || !_view.intersects(cloud.cloud->nodes()[child].cell)) {
+            continue;
+        }
+        if (!cloud.picked[child] || !drawable(cloud, child)) {
+            return false;
+        }
+        any = true;
+    }
+    return any;
+}
+
+bool PointCloudView::drawable(const Cloud& cloud, uint32_t node) const
+{
+    return resident(cloud, node) || refined(cloud, node);
+}
+
+void PointCloudView::collectDraws(Cloud& cloud, uint32_t node)
+{
+    const Geometry::PointCloud::Node& entry = cloud.cloud->nodes()[node];
+    if (!refined(cloud, node) && resident(cloud, node)) {
+        for (uint32_t page = entry.firstPage; page < entry.firstPage + entry.pageCount; ++page) {
+            const Slot& slot = _slots[cloud.slots[page]];
+            _draws.emplace_back((uint32_t)cloud.slots[page], slot.count);
+        }
+        return;
+    }
+    // the children replace the node, or whatever of them is there stands in for it
+    for (uint32_t child : entry.children) {
+        if (child && cloud.picked[child]) {
+            collectDraws(cloud, child);
+        }
+    }
+}
+
+void PointCloudView::draw(VkCommandBuffer commandBuffer)
+{
+    if (_draws.empty()) {
+        return;
+    }
+    VkBuffer buffer = *_buffer;
+    VkDeviceSize offset = 0;
+    _vkManager->vkCmdBindVertexBuffers(commandBuffer, 0, 1, &buffer, &offset);
+    for (const auto& [slot, count] : _draws) {
+        // a quad as triangle strip per instance, the instances of a slot start at its first point
+        _vkManager->vkCmdDraw(commandBuffer, 4, count, 0, slot * (uint32_t)slotPoints);
+    }
+}
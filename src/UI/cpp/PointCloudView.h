@@ -0,0 +1,111 @@
+#pragma once
+
+#include <QRectF>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+#include "Library/Vulkan/Buffer.h"
+#include "Library/Vulkan/StagingRing.h"
+#include "Library/Vulkan/VulkanComponent.h"
+#include "Library/Vulkan/VulkanManager.h"
+#include "UI/cpp/Geometry/Document.h"
+#include "UI/cpp/Geometry/PointCloud.h"
+
+// What one view draws of the point clouds of a document, in a fixed amount of memory however
+// large the scans are. Every frame the nodes worth drawing are picked from the hierarchies,
+// largest on screen first, until their points are as dense as a pixel or the point budget is
+// spent. Pages of picked nodes that aren't resident are read on the thread pool and uploaded
+// into the slots of one device local buffer, a slot per page, the least recently drawn slot
+// giving way when none is free. A node is drawn in place of its children until they are all
+// resident, so the view refines as the pages arrive instead of showing holes.
+class PointCloudView : protected Vulkan::VulkanComponent {
+public:
+    // points of a slot, pages of caches built with a larger capacity are cut there
+    static constexpr size_t slotPoints = 16384;
+    // slots, so the device memory is slotCount * slotPoints * 12 bytes
+    static constexpr size_t slotCount = 256;
+    // points drawn in a frame at most
+    static constexpr size_t pointBudget = 3'000'000;
+    // pages read at the same time at most
+    static constexpr size_t maxLoads = 16;
+
+    PointCloudView(std::shared_ptr<Vulkan::VulkanManager>& vkManager);
+    ~PointCloudView();
+
+    // the clouds of the visible layers are drawn, resident pages of the others are kept until
+    // their slots are needed
+    void setSnapshot(const Geometry::DocumentSnapshot& snapshot);
+
+    bool empty() const { return _clouds.empty(); }
+
+    // picks the nodes for the view, given in document coordinates, and queues the uploads of the
+    // pages read since the last frame; before the ring is flushed
+    void prepare(Vulkan::StagingRing& ring, const QRectF& view, double pixelsPerUnit);
+
+    // inside the render pass with the point pipeline bound, one instance per point
+    void draw(VkCommandBuffer commandBuffer);
+
+private:
+    struct Cloud {
+        std::shared_ptr<const Geometry::PointCloud> cloud;
+        bool visible = false;
+        // per page, -1 while it isn't resident
+        std::vector<int32_t> slots;
+        std::vector<bool> loading;
+        // per node, whether the last prepare() picked it
+        std::vector<bool> picked;
+    };
+
+    struct Slot {
+        const Geometry::PointCloud* cloud = nullptr;
+        uint32_t page = 0;
+        uint32_t count = 0;
+        // frame the slot was last drawn or uploaded in
+        uint64_t used = 0;
+    };
+
+    // a page read by the pool, handed over to the render thread
+    struct Load {
+        std::shared_ptr<const Geometry::PointCloud> cloud;
+        uint32_t page = 0;
+        std::vector<Geometry::CloudPoint> points;
+        bool failed = false;
+    };
+
+    // outlives the view while reads are running
+    struct Inbox {
+        std::mutex mutex;
+        std::vector<Load> loads;
+    };
+
+    void pick(double pixelsPerUnit);
+    // starts reading the node's pages that aren't resident, as far as maxLoads allows
+    void request(Cloud& cloud, uint32_t node);
+    void upload(Vulkan::StagingRing& ring);
+    // a free slot or the least recently used one not needed in this frame, -1 when there is none
+    int32_t takeSlot();
+    bool resident(const Cloud& cloud, uint32_t node) const;
+    // every child in the view was picked and can be drawn, so they replace the node
+    bool refined(const Cloud& cloud, uint32_t node) const;
+    bool drawable(const Cloud& cloud, uint32_t node) const;
+    void collectDraws(Cloud& cloud, uint32_t node);
+
+    std::unordered_map<const Geometry::PointCloud*, Cloud> _clouds;
+    std::unique_ptr<Vulkan::Buffer> _buffer;
+    std::vector<Slot> _slots;
+    uint64_t _frame = 0;
+    // of the last prepare(), in document coordinates
+    Geometry::BoundingBox _view;
+    // requested and neither uploaded nor dropped yet, so at most maxLoads pages are in memory
+    size_t _loadsRunning = 0;
+    std::shared_ptr<Inbox> _inbox;
+    // read and waiting for room in the ring
+    std::vector<Load> _ready;
+    // per draw the slot and its point count
+    std::vector<std::pair<uint32_t, uint32_t>> _draws;
+};
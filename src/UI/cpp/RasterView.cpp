@@ -0,0 +1,355 @@
+#include "RasterView.h"
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+#include <exception>
+#include <limits>
+#include <unordered_set>
+#include <utility>
+
+#include "Library/Concurrency/ThreadPool.h"
+
+namespace {
+
+// of the atlas slots the tiles in the view may take, the rest holds the coarser fallbacks and
+// the tiles being replaced
+constexpr double viewShare = 0.75;
+
+}
+
+RasterView::RasterView(std::shared_ptr<Vulkan::VulkanManager>& vkManager) :
+    VulkanComponent(vkManager),
+    _inbox(std::make_shared<Inbox>())
+{}
+
+// reads still running only touch the inbox, which they hold themselves
+RasterView::~RasterView() = default;
+
+void RasterView::setSnapshot(const Geometry::DocumentSnapshot& snapshot)
+{
+    std::unordered_map<const Geometry::Raster*, Image> images;
+    std::vector<const Geometry::Raster*> order;
+    for (size_t layer = 0; layer < snapshot.layers.size(); ++layer) {
+        bool visible = layer < snapshot.styles.size() && snapshot.styles[layer].visible();
+        for (const std::shared_ptr<const Geometry::Raster>& source : snapshot.layers[layer].rasters) {
+            if (source->tileSize() != tileSize) {
+                if (!_images.count(source.get())) {
+                    qWarning("Image %s has %u texel tiles, %u are drawn", source->name().c_str(), source->tileSize(),
+                             tileSize);
+                }
+                continue;
+            }
+            auto found = _images.find(source.get());
+            Image image;
+            if (found != _images.end()) {
+                image = std::move(found->second);
+            } else {
+                image.raster = source;
+                image.slots.assign(source->tiles().size(), -1);
+                image.loading.assign(source->tiles().size(), false);
+            }
+            image.visible = visible;
+            if (images.emplace(source.get(), std::move(image)).second) {
+                order.push_back(source.get());
+            }
+        }
+    }
+    // the slots of images no longer in the document are free again
+    for (Slot& slot : _slots) {
+        if (slot.raster && !images.count(slot.raster)) {
+            slot = Slot{};
+        }
+    }
+    _images = std::move(images);
+    _order = std::move(order);
+}
+
+void RasterView::prepare(Vulkan::StagingRing& ring, const QRectF& view, double pixelsPerUnit)
+{
+    ++_frame;
+    _draws.clear();
+    {
+        std::lock_guard<std::mutex> lock(_inbox->mutex);
+        for (Load& load : _inbox->loads) {
+            _ready.push_back(std::move(load));
+        }
+        _inbox->loads.clear();
+    }
+    if (_images.empty()) {
+        _loadsRunning -= _ready.size();
+        _ready.clear();
+        return;
+    }
+    if (!_atlas) {
+        _atlas = std::make_unique<TileAtlas>(_vkManager, tileSize);
+        _slots.assign(_atlas->slotCount(), Slot{});
+    }
+
+    for (const Geometry::Raster* raster : _order) {
+        Image& image = _images[raster];
+        image.inView = false;
+        if (image.visible) {
+            pick(image, view.normalized(), pixelsPerUnit);
+        }
+    }
+    upload(ring);
+    for (const Geometry::Raster* raster : _order) {
+        if (_images[raster].inView) {
+            collectDraws(_images[raster]);
+        }
+    }
+}
+
+void RasterView::pick(Image& image, const QRectF& view, double pixelsPerUnit)
+{
+    const Geometry::Raster& raster = *image.raster;
+    const double* a = raster.header().georeference;
+    double determinant = a[1] * a[5] - a[2] * a[4];
+    if (determinant == 0.0 || !(pixelsPerUnit > 0.0)) {
+        return;
+    }
+
+    // the view's corners in level 0 pixels
+    double minX = std::numeric_limits<double>::max();
+    double minY = std::numeric_limits<double>::max();
+    double maxX = std::numeric_limits<double>::lowest();
+    double maxY = std::numeric_limits<double>::lowest();
+    for (QPointF corner : {view.topLeft(), view.topRight(), view.bottomLeft(), view.bottomRight()}) {
+        double dx = corner.x() - a[0];
+        double dy = corner.y() - a[3];
+        double column = (a[5] * dx - a[2] * dy) / determinant;
+        double row = (a[1] * dy - a[4] * dx) / determinant;
+        minX = std::min(minX, column);
+        maxX = std::max(maxX, column);
+        minY = std::min(minY, row);
+        maxY = std::max(maxY, row);
+    }
+    const Geometry::Raster::FileHeader& header = raster.header();
+    if (maxX <= 0.0 || maxY <= 0.0 || minX >= header.width || minY >= header.height) {
+        return;
+    }
+
+    // a texel of the level about as large as a pixel; with more tiles than the atlas can
+    // spare, coarser ones
+    const std::vector<Geometry::Raster::Level>& levels = raster.levels();
+    uint32_t lastLevel = (uint32_t)levels.size() - 1;
+    double texelPixels = std::sqrt(std::abs(determinant)) * pixelsPerUnit;
+    long ideal = std::lround(std::log2(1.0 / texelPixels));
+    uint32_t level = (uint32_t)std::clamp<long>(ideal, 0, lastLevel);
+    size_t budget = (size_t)(_slots.size() * viewShare);
+    while (true) {
+        double size = (double)tileSize * (1u << level);
+        const Geometry::Raster::Level& info = levels[level];
+        image.left = (uint32_t)std::clamp(std::floor(minX / size), 0.0, info.tilesX - 1.0);
+        image.right = (uint32_t)std::clamp(std::floor(maxX / size), 0.0, info.tilesX - 1.0);
+        image.top = (uint32_t)std::clamp(std::floor(minY / size), 0.0, info.tilesY - 1.0);
+        image.bottom = (uint32_t)std::clamp(std::floor(maxY / size), 0.0, info.tilesY - 1.0);
+        size_t count = size_t(image.right - image.left + 1) * (image.bottom - image.top + 1);
+        if (count <= budget || level == lastLevel) {
+            break;
+        }
+        ++level;
+    }
+    image.level = level;
+    image.inView = true;
+
+    // the coarsest tile stays resident, the last resort of every missing one
+    uint32_t coarsest = (uint32_t)raster.tileIndex(lastLevel, 0, 0);
+    if (raster.tiles()[coarsest].size != 0) {
+        if (image.slots[coarsest] >= 0) {
+            _slots[image.slots[coarsest]].used = _frame;
+        } else {
+            request(image, coarsest);
+        }
+    }
+
+    std::vector<std::pair<double, uint32_t>> missing;
+    double centerX = (minX + maxX) / 2.0 / ((double)tileSize * (1u << level)) - 0.5;
+    double centerY = (minY + maxY) / 2.0 / ((double)tileSize * (1u << level)) - 0.5;
+    for (uint32_t y = image.top; y <= image.bottom; ++y) {
+        for (uint32_t x = image.left; x <= image.right; ++x) {
+            uint32_t tile = (uint32_t)raster.tileIndex(level, x, y);
+            if (raster.tiles()[tile].size == 0) {
+                continue;
+            }
+            if (image.slots[tile] >= 0) {
+                _slots[image.slots[tile]].used = _frame;
+                continue;
+            }
+            uint32_t ancestorLevel;
+            int32_t ancestor = residentAncestor(image, level, x, y, ancestorLevel);
+            if (ancestor >= 0) {
+                _slots[image.slots[ancestor]].used = _frame;
+            }
+            missing.emplace_back(std::hypot(x - centerX, y - centerY), tile);
+        }
+    }
+    // the middle of the view first
+    std::sort(missing.begin(), missing.end());
+    for (const auto& [distance, tile] : missing) {
+        if (_loadsRunning >= maxLoads) {
+            break;
+        }
+        request(image, tile);
+    }
+}
+
+void RasterView::request(Image& image, uint32_t tile)
+{
+    if (_loadsRunning >= maxLoads || image.slots[tile] >= 0 || image.loading[tile]) {
+        return;
+    }
+    image.loading[tile] = true;
+    ++_loadsRunning;
+    std::shared_ptr<Inbox> inbox = _inbox;
+    std::shared_ptr<const Geometry::Raster> source = image.raster;
+    Concurrency::ThreadPool::global().submit([inbox, source, tile]() {
+        Load load;
+        load.raster = source;
+        load.tile = tile;
+        try {
+            source->readTile(tile, load.rgba);
+        } catch (const std::exception& e) {
+            qWarning("Reading image %s failed: %s", source->name().c_str(), e.what());
+            load.failed = true;
+        }
+        std::lock_guard<std::mutex> lock(inbox->mutex);
+        inbox->loads.push_back(std::move(load));
+    });
+}
+
+void RasterView::upload(Vulkan::StagingRing& ring)
+{
+    size_t kept = 0;
+    for (Load& load : _ready) {
+        auto found = _images.find(load.raster.get());
+        if (found == _images.end() || found->second.raster != load.raster) {
+            // removed from the document while it was read
+            --_loadsRunning;
+            continue;
+        }
+        Image& image = found->second;
+        if (load.failed) {
+            // the tile stays marked as loading, a broken file isn't read every frame
+            --_loadsRunning;
+            continue;
+        }
+        int32_t slot = takeSlot();
+        if (slot < 0 || !_atlas->upload(ring, (uint32_t)slot, load.rgba.data())) {
+            // no room in this frame, tried again in the next
+            _ready[kept++] = std::move(load);
+            continue;
+        }
+        Slot& entry = _slots[slot];
+        if (entry.raster) {
+            auto owner = _images.find(entry.raster);
+            if (owner != _images.end()) {
+                owner->second.slots[entry.tile] = -1;
+            }
+        }
+        entry = Slot{image.raster.get(), load.tile, _frame};
+        image.slots[load.tile] = slot;
+        image.loading[load.tile] = false;
+        --_loadsRunning;
+    }
+    _ready.resize(kept);
+}
+
+int32_t RasterView::takeSlot()
+{
+    int32_t oldest = -1;
+    for (size_t i = 0; i < _slots.size(); ++i) {
+        if (!_slots[i].raster) {
+            return (int32_t)i;
+        }
+        if (_slots[i].used < _frame && (oldest < 0 || _slots[i].used < _slots[oldest].used)) {
+            oldest = (int32_t)i;
+        }
+    }
+    return oldest;
+}
+
+int32_t RasterView::residentAncestor(const Image& image, uint32_t level, uint32_t x, uint32_t y,
+                                     uint32_t& ancestorLevel) const
+{
+    for (uint32_t above = level + 1; above < image.raster->levels().size(); ++above) {
+        uint32_t shift = above - level;
+        uint32_t tile = (uint32_t)image.raster->tileIndex(above, x >> shift, y >> shift);
+        if (image.slots[tile] >= 0) {
+            ancestorLevel = above;
+            return (int32_t)tile;
+        }
+    }
+    return -1;
+}
+
+void RasterView::collectDraws(const Image& image)
+{
+    const Geometry::Raster& raster = *image.raster;
+    std::vector<Draw> fallbacks;
+    std::vector<Draw> exact;
+    std::unordered_set<int32_t> covered;
+    for (uint32_t y = image.top; y <= image.bottom; ++y) {
+        for (uint32_t x = image.left; x <= image.right; ++x) {
+            uint32_t tile = (uint32_t)raster.tileIndex(image.level, x, y);
+            if (raster.tiles()[tile].size == 0) {
+                continue;
+            }
+            if (image.slots[tile] >= 0) {
+                exact.push_back({&raster, image.level, x, y, (uint32_t)image.slots[tile]});
+                continue;
+            }
+            uint32_t level;
+            int32_t ancestor = residentAncestor(image, image.level, x, y, level);
+            if (ancestor >= 0 && covered.insert(ancestor).second) {
+                uint32_t shift = level - image.level;
+                fallbacks.push_back({&raster, level, x >> shift, y >> shift, (uint32_t)image.slots[ancestor]});
+            }
+        }
+    }
+    // the coarsest first, finer ones cover them
+    std::sort(fallbacks.begin(), fallbacks.end(), [](const Draw& a, const Draw& b) { return a.level > b.level; });
+    _draws.insert(_draws.end(), fallbacks.begin(), fallbacks.end());
+    _draws.insert(_draws.end(), exact.begin(), exact.end());
+}
+
+void RasterView::draw(VkCommandBuffer commandBuffer, VkPipelineLayout layout, const QMatrix4x4& documentToClip)
+{
+    if (_draws.empty()) {
+        return;
+    }
+    VkDescriptorSet atlas = _atlas->descriptorSet();
+    _vkManager->vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, layout, 0, 1, &atlas, 0,
+                                        nullptr);
+
+    PushConstants constants = {};
+    constants.slotSize = (float)tileSize / TileAtlas::atlasSize;
+    const Geometry::Raster* current = nullptr;
+    for (const Draw& draw : _draws) {
+        if (draw.raster != current) {
+            // the camera times the image's georeference, in double so the large offsets of
+            // projected coordinates cancel before they are narrowed
+            const double* a = draw.raster->header().georeference;
+            for (int row = 0; row < 4; ++row) {
+                double m0 = documentToClip(row, 0);
+                double m1 = documentToClip(row, 1);
+                constants.transform[0 * 4 + row] = (float)(m0 * a[1] + m1 * a[4]);
+                constants.transform[1 * 4 + row] = (float)(m0 * a[2] + m1 * a[5]);
+                constants.transform[2 * 4 + row] = documentToClip(row, 2);
+                constants.transform[3 * 4 + row] = (float)(m0 * a[0] + m1 * a[3] + documentToClip(row, 3));
+            }
+            current = draw.raster;
+        }
+        float size = (float)(tileSize << draw.level);
+        constants.rect[0] = draw.x * size;
+        constants.rect[1] = draw.y * size;
+        constants.rect[2] = (draw.x + 1) * size;
+        constants.rect[3] = (draw.y + 1) * size;
+        uint32_t slotsPerRow = _atlas->slotsPerRow();
+        constants.slotOrigin[0] = (float)(draw.slot % slotsPerRow) * constants.slotSize;
+        constants.slotOrigin[1] = (float)(draw.slot / slotsPerRow) * constants.slotSize;
+        _vkManager->vkCmdPushConstants(commandBuffer, layout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(PushConstants),
+                                       &constants);
+        _vkManager->vkCmdDraw(commandBuffer, 4, 1, 0, 0);
+    }
+}
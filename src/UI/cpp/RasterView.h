@@ -0,0 +1,127 @@
+#pragma once
+
+#include <QMatrix4x4>
+#include <QRectF>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+#include "Library/Vulkan/StagingRing.h"
+#include "Library/Vulkan/VulkanComponent.h"
+#include "Library/Vulkan/VulkanManager.h"
+#include "UI/cpp/Geometry/Document.h"
+#include "UI/cpp/Geometry/Raster.h"
+#include "UI/cpp/TileAtlas.h"
+
+// What one view draws of the images of a document. Every frame the pyramid level matching the
+// zoom is picked per image, coarser when the view would need more tiles than the atlas can
+// spare, and its tiles in the view are drawn from a TileAtlas. Tiles that aren't resident are
+// read and decompressed on the thread pool and uploaded in a later frame, the least recently
+// drawn slot giving way when none is free; meanwhile the nearest coarser tile that is resident
+// is drawn in their place, so panning and zooming never wait for a tile.
+class RasterView : protected Vulkan::VulkanComponent {
+public:
+    // of the atlas slots, images built with another tile size aren't drawn
+    static constexpr uint32_t tileSize = 256;
+    // tiles read at the same time at most
+    static constexpr size_t maxLoads = 8;
+
+    // layout of the push constants in vertex_raster.vert
+    struct PushConstants {
+        // from level 0 pixels of the image to clip space
+        float transform[16];
+        // of the tile, in level 0 pixels
+        float rect[4];
+        // of the slot in the atlas, in texture coordinates
+        float slotOrigin[2];
+        float slotSize;
+    };
+
+    RasterView(std::shared_ptr<Vulkan::VulkanManager>& vkManager);
+    ~RasterView();
+
+    // the images of the visible layers are drawn in layer order, resident tiles of the others
+    // are kept until their slots are needed
+    void setSnapshot(const Geometry::DocumentSnapshot& snapshot);
+
+    bool empty() const { return _order.empty(); }
+
+    // picks the tiles for the view, given in document coordinates, and queues the uploads of the
+    // tiles read since the last frame; before the ring is flushed
+    void prepare(Vulkan::StagingRing& ring, const QRectF& view, double pixelsPerUnit);
+
+    // inside the render pass with the raster pipeline bound; the atlas set is bound here
+    void draw(VkCommandBuffer commandBuffer, VkPipelineLayout layout, const QMatrix4x4& documentToClip);
+
+private:
+    struct Image {
+        std::shared_ptr<const Geometry::Raster> raster;
+        bool visible = false;
+        // per tile, -1 while it isn't resident
+        std::vector<int32_t> slots;
+        std::vector<bool> loading;
+        // of the last prepare(): the level and the range of its tiles in the view
+        uint32_t level = 0;
+        uint32_t left = 0;
+        uint32_t top = 0;
+        uint32_t right = 0;
+        uint32_t bottom = 0;
+        bool inView = false;
+    };
+
+    struct Slot {
+        const Geometry::Raster* raster = nullptr;
+        uint32_t tile = 0;
+        // frame the slot was last drawn or uploaded in
+        uint64_t used = 0;
+    };
+
+    // a tile read by the pool, handed over to the render thread
+    struct Load {
+        std::shared_ptr<const Geometry::Raster> raster;
+        uint32_t tile = 0;
+        std::vector<uint8_t> rgba;
+        bool failed = false;
+    };
+
+    // outlives the view while reads are running
+    struct Inbox {
+        std::mutex mutex;
+        std::vector<Load> loads;
+    };
+
+    struct Draw {
+        const Geometry::Raster* raster;
+        uint32_t level;
+        uint32_t x;
+        uint32_t y;
+        uint32_t slot;
+    };
+
+    // the level and tiles of the image in the view; marks what is drawn as used and requests
+    // what is missing
+    void pick(Image& image, const QRectF& view, double pixelsPerUnit);
+    void request(Image& image, uint32_t tile);
+    void upload(Vulkan::StagingRing& ring);
+    // a free slot or the least recently used one not needed in this frame, -1 when there is none
+    int32_t takeSlot();
+    // the tile of the nearest coarser level covering the tile that is resident, -1 when there is none
+    int32_t residentAncestor(const Image& image, uint32_t level, uint32_t x, uint32_t y, uint32_t& ancestorLevel) const;
+    void collectDraws(const Image& image);
+
+    std::unordered_map<const Geometry::Raster*, Image> _images;
+    // drawing order, layer by layer
+    std::vector<const Geometry::Raster*> _order;
+    std::unique_ptr<TileAtlas> _atlas;
+    std::vector<Slot> _slots;
+    uint64_t _frame = 0;
+    size_t _loadsRunning = 0;
+    std::shared_ptr<Inbox> _inbox;
+    std::vector<Load> _ready;
+    // coarse fallbacks first, so the exact tiles cover them
+    std::vector<Draw> _draws;
+};
@@ -0,0 +1,38 @@
+#include "RenderCommandQueue.h"
+#include <algorithm>
+
+void RenderCommandQueue::push(RenderCommand command, Clock::time_point eventTime)
+{
+    retryPending();
+
+    auto& pending = _pending[command.index()];
+    if (pending) {
+        // keep the older event time, the state it stood for isn't on screen yet either
+        pending->command = std::move(command);
+        pending->eventTime = std::min(pending->eventTime, eventTime);
+        return;
+    }
+
+    Entry entry{std::move(command), eventTime};
+    if (!_queue.tryPush(std::move(entry))) {
+        pending = std::move(entry);
+    }
+}
+
+void RenderCommandQueue::retryPending()
+{
+    for (auto& pending : _pending) {
+        if (pending && _queue.tryPush(std::move(*pending))) {
+            pending.reset();
+        }
+    }
+}
+
+void RenderCommandQueue::framePresented()
+{
+    Clock::time_point now = Clock::now();
+    for (Clock::time_point eventTime : _unpresented) {
+        _latency.record(now - eventTime);
+    }
+    _unpresented.clear();
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <QPointF>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <variant>
+#include <vector>
+
+#include "Library/Concurrency/SpscQueue.h"
+#include "Library/Profiling/LatencyHistogram.h"
+#include "UI/cpp/Camera.h"
+#include "UI/cpp/Geometry/Circle.h"
+#include "UI/cpp/Geometry/Document.h"
+#include "UI/cpp/Geometry/Line.h"
+
+namespace RenderCommands {
+
+struct SetCamera {
+    Camera camera;
+};
+
+// upserts and removes of document entities, the snapshot's chunk versions and edit logs
+// tell the render thread which ranges changed since the one it had before
+struct SetDocument {
+    Geometry::DocumentSnapshot snapshot;
+    // Document::id(), views of the same document share its GPU copy
+    uint64_t document = 0;
+};
+
+// geometry drawn on top of the document while an edit is in progress, empty to clear it;
+// tools rubber-band here and add to the document once the edit is done
+struct SetPreview {
+    std::vector<Geometry::Line> lines;
+    std::vector<Geometry::Circle> circles;
+};
+
+// where the entity under the cursor is looked for, in framebuffer pixels of the item;
+// nullopt stops picking and clears the highlight
+struct SetPickPoint {
+    std::optional<QPointF> position;
+};
+
+} // namespace RenderCommands
+
+using RenderCommand = std::variant<RenderCommands::SetCamera, RenderCommands::SetDocument, RenderCommands::SetPreview,
+                                   RenderCommands::SetPickPoint>;
+
+// Everything the GUI thread tells the render thread goes through here, the GUI thread pushes
+// and the render thread drains once per frame before recording anything. Every command
+// replaces a piece of render state as a whole, so when the ring is full (the window isn't
+// rendering) only the newest command of each kind is kept and pushed once there is room.
+// Each command carries the time of the input event that caused it, the delay until the
+// frame that applied it was presented goes into latency().
+class RenderCommandQueue {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // GUI thread
+    void push(RenderCommand command, Clock::time_point eventTime = Clock::now());
+    // GUI thread, pushes what didn't fit before
+    void retryPending();
+
+    // render thread, calls apply(const RenderCommand&) for every queued command
+    template<typename F>
+    size_t drain(F&& apply)
+    {
+        return _queue.drain([&](Entry&& entry) {
+            apply(entry.command);
+            _unpresented.push_back(entry.eventTime);
+        });
+    }
+    // render thread, once the frame recorded after the last drain() was swapped
+    void framePresented();
+
+    const Profiling::LatencyHistogram& latency() const { return _latency; }
+
+private:
+    struct Entry {
+        RenderCommand command;
+        Clock::time_point eventTime;
+    };
+
+    Concurrency::SpscQueue<Entry, 1024> _queue;
+    // GUI thread, newest command of each kind that didn't fit
+    std::array<std::optional<Entry>, std::variant_size_v<RenderCommand>> _pending;
+    // render thread, event times of the commands drained since the last presented frame
+    std::vector<Clock::time_point> _unpresented;
+    Profiling::LatencyHistogram _latency;
+};
@@ -0,0 +1,104 @@
+#include "StyleTable.h"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+StyleTable::StyleTable(std::shared_ptr<Vulkan::VulkanManager>& vkManager) :
+    VulkanComponent(vkManager),
+    _buffer(vkManager)
+{
+    _buffer.allocateMemory(capacity * sizeof(Geometry::LayerStyle),
+                           VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                           Vulkan::Buffer::Location::DeviceLocal);
+
+    _descriptorSetLayout = createDescriptorSetLayout(*_vkManager);
+
+    VkDescriptorPoolSize poolSize = {};
+    poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    poolSize.descriptorCount = 1;
+
+    VkDescriptorPoolCreateInfo poolInfo = {};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.maxSets = 1;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+
+    VkResult result = _vkManager->vkCreateDescriptorPool(&poolInfo, nullptr, &_descriptorPool);
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("can't create style table descriptor pool, return: " + std::to_string(result));
+    }
+
+    VkDescriptorSetAllocateInfo allocInfo = {};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = _descriptorPool;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &_descriptorSetLayout;
+
+    result = _vkManager->vkAllocateDescriptorSets(&allocInfo, &_descriptorSet);
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("can't allocate style table descriptor set, return: " + std::to_string(result));
+    }
+
+    VkDescriptorBufferInfo range = {_buffer, 0, _buffer.size()};
+    VkWriteDescriptorSet write = {};
+    write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    write.dstSet = _descriptorSet;
+    write.dstBinding = 0;
+    write.descriptorCount = 1;
+    write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    write.pBufferInfo = &range;
+    _vkManager->vkUpdateDescriptorSets(1, &write, 0, nullptr);
+}
+
+StyleTable::~StyleTable()
+{
+    if (_descriptorPool != VK_NULL_HANDLE) {
+        _vkManager->vkDestroyDescriptorPool(_descriptorPool, nullptr);
+    }
+    if (_descriptorSetLayout != VK_NULL_HANDLE) {
+        _vkManager->vkDestroyDescriptorSetLayout(_descriptorSetLayout, nullptr);
+    }
+}
+
+VkDescriptorSetLayout StyleTable::createDescriptorSetLayout(const Vulkan::VulkanManager& vkManager)
+{
+    VkDescriptorSetLayoutBinding binding = {};
+    binding.binding = 0;
+    binding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    binding.descriptorCount = 1;
+    // the fragment shaders get what they need of a style from the vertex shader
+    binding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo = {};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = 1;
+    layoutInfo.pBindings = &binding;
+
+    VkDescriptorSetLayout layout;
+    VkResult result = vkManager.vkCreateDescriptorSetLayout(&layoutInfo, nullptr, &layout);
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("can't create style table descriptor set layout, return: " + std::to_string(result));
+    }
+    return layout;
+}
+
+void StyleTable::setStyles(const std::vector<Geometry::LayerStyle>& styles, uint64_t version)
+{
+    if (version <= _version) {
+        return;
+    }
+    _styles.assign(styles.begin(), styles.begin() + std::min(styles.size(), capacity));
+    _version = version;
+}
+
+bool StyleTable::upload(Vulkan::StagingRing& ring)
+{
+    if (_uploadedVersion == _version || _styles.empty()) {
+        return true;
+    }
+    if (!_buffer.upload(ring, 0, _styles.data(), _styles.size() * sizeof(Geometry::LayerStyle))) {
+        return false;
+    }
+    _uploadedVersion = _version;
+    return true;
+}
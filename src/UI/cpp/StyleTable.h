@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+#include "Library/Vulkan/Buffer.h"
+#include "Library/Vulkan/StagingRing.h"
+#include "Library/Vulkan/VulkanComponent.h"
+#include "Library/Vulkan/VulkanManager.h"
+#include "UI/cpp/Geometry/Layer.h"
+
+// The Geometry::LayerStyle of every layer of a document in a storage buffer. The document
+// shaders index it by the layer in their push constants, so recoloring, restyling or hiding a
+// layer rewrites a few bytes here and never touches the layer's geometry.
+class StyleTable : protected Vulkan::VulkanComponent {
+public:
+    // layers past it are not drawn; the descriptor set can't be rewritten while frames use it,
+    // so the buffer doesn't grow
+    static constexpr size_t capacity = 4096;
+
+    StyleTable(std::shared_ptr<Vulkan::VulkanManager>& vkManager);
+    ~StyleTable();
+
+    // binding 0: the table, read by the vertex stage. Pipelines create their layouts from their
+    // own identically defined set layout, which makes them compatible with the table's set.
+    static VkDescriptorSetLayout createDescriptorSetLayout(const Vulkan::VulkanManager& vkManager);
+
+    VkDescriptorSet descriptorSet() const { return _descriptorSet; }
+
+    // older versions than the one the table has are ignored
+    void setStyles(const std::vector<Geometry::LayerStyle>& styles, uint64_t version);
+    // false when the ring was full, the next call tries again
+    bool upload(Vulkan::StagingRing& ring);
+
+private:
+    Vulkan::Buffer _buffer;
+    VkDescriptorSetLayout _descriptorSetLayout = VK_NULL_HANDLE;
+    VkDescriptorPool _descriptorPool = VK_NULL_HANDLE;
+    VkDescriptorSet _descriptorSet = VK_NULL_HANDLE;
+
+    std::vector<Geometry::LayerStyle> _styles;
+    uint64_t _version = 0;
+    uint64_t _uploadedVersion = 0;
+};
@@ -0,0 +1,154 @@
+#include "TileAtlas.h"
+#include <stdexcept>
+#include <string>
+
+TileAtlas::TileAtlas(std::shared_ptr<Vulkan::VulkanManager>& vkManager, uint32_t tileSize) :
+    VulkanComponent(vkManager),
+    _tileSize(tileSize)
+{
+    if (tileSize == 0 || atlasSize % tileSize != 0) {
+        throw std::runtime_error("tile size " + std::to_string(tileSize) + " doesn't divide the atlas");
+    }
+
+    VkImageCreateInfo imageInfo = {};
+    imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageInfo.imageType = VK_IMAGE_TYPE_2D;
+    imageInfo.format = VK_FORMAT_R8G8B8A8_UNORM;
+    imageInfo.extent = {atlasSize, atlasSize, 1};
+    imageInfo.mipLevels = 1;
+    imageInfo.arrayLayers = 1;
+    imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    imageInfo.usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+    imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+    VkResult result = _vkManager->vkCreateImage(&imageInfo, nullptr, &_image);
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("can't create tile atlas image, return: " + std::to_string(result));
+    }
+
+    VkMemoryRequirements memReq;
+    vkGetImageMemoryRequirements(_vkManager->device(), _image, &memReq);
+    _imageMemory = _vkManager->memoryAllocator().allocate(memReq, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                                          Vulkan::MemoryAllocator::Kind::OptimalImage);
+    vkBindImageMemory(_vkManager->device(), _image, _imageMemory.memory, _imageMemory.offset);
+
+    VkImageViewCreateInfo viewInfo = {};
+    viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    viewInfo.image = _image;
+    viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    viewInfo.format = VK_FORMAT_R8G8B8A8_UNORM;
+    viewInfo.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+
+    result = _vkManager->vkCreateImageView(&viewInfo, nullptr, &_imageView);
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("can't create tile atlas image view, return: " + std::to_string(result));
+    }
+
+    // the shaders keep half a texel away from the slot edges, so the neighbours never bleed in
+    VkSamplerCreateInfo samplerInfo = {};
+    samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    samplerInfo.magFilter = VK_FILTER_LINEAR;
+    samplerInfo.minFilter = VK_FILTER_LINEAR;
+    samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+    samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.maxLod = 0.0f;
+
+    result = _vkManager->vkCreateSampler(&samplerInfo, nullptr, &_sampler);
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("can't create tile atlas sampler, return: " + std::to_string(result));
+    }
+
+    _descriptorSetLayout = createDescriptorSetLayout(*_vkManager);
+
+    VkDescriptorPoolSize poolSize = {};
+    poolSize.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    poolSize.descriptorCount = 1;
+
+    VkDescriptorPoolCreateInfo poolInfo = {};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.maxSets = 1;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+
+    result = _vkManager->vkCreateDescriptorPool(&poolInfo, nullptr, &_descriptorPool);
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("can't create tile atlas descriptor pool, return: " + std::to_string(result));
+    }
+
+    VkDescriptorSetAllocateInfo allocInfo = {};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = _descriptorPool;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &_descriptorSetLayout;
+
+    result = _vkManager->vkAllocateDescriptorSets(&allocInfo, &_descriptorSet);
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("can't allocate tile atlas descriptor set, return: " + std::to_string(result));
+    }
+
+    // the layout the image is in whenever a draw samples it
+    VkDescriptorImageInfo image = {_sampler, _imageView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL};
+    VkWriteDescriptorSet write = {};
+    write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    write.dstSet = _descriptorSet;
+    write.dstBinding = 0;
+    write.descriptorCount = 1;
+    write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    write.pImageInfo = &image;
+    _vkManager->vkUpdateDescriptorSets(1, &write, 0, nullptr);
+}
+
+TileAtlas::~TileAtlas()
+{
+    if (_descriptorPool != VK_NULL_HANDLE) {
+        _vkManager->vkDestroyDescriptorPool(_descriptorPool, nullptr);
+    }
+    if (_descriptorSetLayout != VK_NULL_HANDLE) {
+        _vkManager->vkDestroyDescriptorSetLayout(_descriptorSetLayout, nullptr);
+    }
+    if (_sampler != VK_NULL_HANDLE) {
+        _vkManager->vkDestroySampler(_sampler, nullptr);
+    }
+    if (_imageView != VK_NULL_HANDLE) {
+        _vkManager->vkDestroyImageView(_imageView, nullptr);
+    }
+    if (_image != VK_NULL_HANDLE) {
+        _vkManager->vkDestroyImage(_image, nullptr);
+    }
+    _vkManager->memoryAllocator().free(_imageMemory);
+}
+
+VkDescriptorSetLayout TileAtlas::createDescriptorSetLayout(const Vulkan::VulkanManager& vkManager)
+{
+    VkDescriptorSetLayoutBinding binding = {};
+    binding.binding = 0;
+    binding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    binding.descriptorCount = 1;
+    binding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo = {};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = 1;
+    layoutInfo.pBindings = &binding;
+
+    VkDescriptorSetLayout layout;
+    VkResult result = vkManager.vkCreateDescriptorSetLayout(&layoutInfo, nullptr, &layout);
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("can't create tile atlas descriptor set layout, return: " + std::to_string(result));
+    }
+    return layout;
+}
+
+bool TileAtlas::upload(Vulkan::StagingRing& ring, uint32_t slot, const uint8_t* rgba)
+{
+    VkOffset2D offset = {(int32_t)(slot % slotsPerRow() * _tileSize), (int32_t)(slot / slotsPerRow() * _tileSize)};
+    if (!ring.upload(_image, _layout, offset, {_tileSize, _tileSize}, rgba, (VkDeviceSize)_tileSize * _tileSize * 4)) {
+        return false;
+    }
+    _layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    return true;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vulkan/vulkan.h>
+
+#include "Library/Vulkan/MemoryAllocator.h"
+#include "Library/Vulkan/StagingRing.h"
+#include "Library/Vulkan/VulkanComponent.h"
+#include "Library/Vulkan/VulkanManager.h"
+
+// Square RGBA tiles in the slots of one sampled image, so any mix of tiles is drawn with a
+// single descriptor set. A slot is rewritten through the staging ring while the others keep
+// being sampled; which tile a slot holds is up to the owner.
+class TileAtlas : protected Vulkan::VulkanComponent {
+public:
+    // texels per side of the image, which every device supports
+    static constexpr uint32_t atlasSize = 4096;
+
+    TileAtlas(std::shared_ptr<Vulkan::VulkanManager>& vkManager, uint32_t tileSize);
+    ~TileAtlas();
+
+    // binding 0: the atlas with a linear sampler clamped to its edge, read by the fragment stage.
+    // Pipelines create their layouts from their own, like with StyleTable.
+    static VkDescriptorSetLayout createDescriptorSetLayout(const Vulkan::VulkanManager& vkManager);
+
+    VkDescriptorSet descriptorSet() const { return _descriptorSet; }
+
+    uint32_t tileSize() const { return _tileSize; }
+    uint32_t slotsPerRow() const { return atlasSize / _tileSize; }
+    uint32_t slotCount() const { return slotsPerRow() * slotsPerRow(); }
+
+    // tileSize() * tileSize() texels into the slot; false when the ring has no room left in
+    // this frame
+    bool upload(Vulkan::StagingRing& ring, uint32_t slot, const uint8_t* rgba);
+
+private:
+    uint32_t _tileSize;
+    VkImage _image = VK_NULL_HANDLE;
+    Vulkan::Allocation _imageMemory;
+    VkImageView _imageView = VK_NULL_HANDLE;
+    VkSampler _sampler = VK_NULL_HANDLE;
+    VkDescriptorSetLayout _descriptorSetLayout = VK_NULL_HANDLE;
+    VkDescriptorPool _descriptorPool = VK_NULL_HANDLE;
+    VkDescriptorSet _descriptorSet = VK_NULL_HANDLE;
+    // UNDEFINED until the first upload, the ring leaves the image ready for sampling
+    VkImageLayout _layout = VK_IMAGE_LAYOUT_UNDEFINED;
+};
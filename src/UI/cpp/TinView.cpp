@@ -0,0 +1,309 @@
+#include "TinView.h"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace {
+
+// floats of a slot, three coordinates for each corner of every triangle
+constexpr size_t slotFloats = (size_t)Geometry::Tin::chunkTriangles * 9;
+// of the slots the chunks in the view may take, the rest holds the coarser fallbacks and the
+// chunks being replaced
+constexpr double viewShare = 0.75;
+// square pixels of a triangle on average from where a finer level isn't needed
+constexpr double targetTrianglePixels = 8.0;
+
+}
+
+TinView::TinView(std::shared_ptr<Vulkan::VulkanManager>& vkManager) :
+    VulkanComponent(vkManager),
+    _slots(slotCount)
+{}
+
+void TinView::setSnapshot(const Geometry::DocumentSnapshot& snapshot)
+{
+    std::unordered_map<const Geometry::Tin*, Surface> surfaces;
+    std::vector<const Geometry::Tin*> order;
+    for (size_t layer = 0; layer < snapshot.layers.size(); ++layer) {
+        Geometry::LayerStyle style = layer < snapshot.styles.size() ? snapshot.styles[layer] : Geometry::LayerStyle{};
+        for (const std::shared_ptr<const Geometry::Tin>& source : snapshot.layers[layer].tins) {
+            auto found = _surfaces.find(source.get());
+            Surface surface;
+            if (found != _surfaces.end()) {
+                surface = std::move(found->second);
+            } else {
+                surface.tin = source;
+                const Geometry::BoundingBox& bounds = source->bounds();
+                surface.origin[0] = ((double)bounds.min[0] + bounds.max[0]) / 2.0;
+                surface.origin[1] = ((double)bounds.min[1] + bounds.max[1]) / 2.0;
+                for (uint32_t level = 0; level < levelCount(*source); ++level) {
+                    surface.slots.emplace_back(chunks(*source, level).size(), -1);
+                }
+            }
+            surface.visible = style.visible();
+            surface.style = style;
+            if (surfaces.emplace(source.get(), std::move(surface)).second) {
+                order.push_back(source.get());
+            }
+        }
+    }
+    // the slots of surfaces no longer in the document are free again
+    for (Slot& slot : _slots) {
+        if (slot.tin && !surfaces.count(slot.tin)) {
+            slot = Slot{};
+        }
+    }
+    _surfaces = std::move(surfaces);
+    _order = std::move(order);
+}
+
+const std::vector<uint32_t>& TinView::triangles(const Geometry::Tin& tin, uint32_t level)
+{
+    return level == 0 ? tin.triangles() : tin.overviews()[level - 1].triangles;
+}
+
+const std::vector<Geometry::Tin::Chunk>& TinView::chunks(const Geometry::Tin& tin, uint32_t level)
+{
+    return level == 0 ? tin.chunks() : tin.overviews()[level - 1].chunks;
+}
+
+void TinView::prepare(Vulkan::StagingRing& ring, const QRectF& view, double pixelsPerUnit)
+{
+    ++_frame;
+    _draws.clear();
+    if (_order.empty()) {
+        return;
+    }
+    if (!_buffer) {
+        _buffer = std::make_unique<Vulkan::Buffer>(_vkManager);
+        _buffer->allocateMemory(slotCount * slotFloats * sizeof(float), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                                Vulkan::Buffer::Location::DeviceLocal);
+    }
+
+    QRectF normalized = view.normalized();
+    _view = Geometry::BoundingBox{};
+    _view.expand((float)normalized.left(), (float)normalized.top());
+    _view.expand((float)normalized.right(), (float)normalized.bottom());
+
+    std::vector<Surface*> inView;
+    for (const Geometry::Tin* tin : _order) {
+        Surface& surface = _surfaces[tin];
+        surface.inView.clear();
+        if (surface.visible && _view.intersects(tin->bounds())) {
+            inView.push_back(&surface);
+        }
+    }
+    if (inView.empty()) {
+        return;
+    }
+    size_t chunkBudget = std::max<size_t>(1, (size_t)(slotCount * viewShare) / inView.size());
+    std::vector<Missing> missing;
+    for (Surface* surface : inView) {
+        pick(*surface, pixelsPerUnit, chunkBudget, missing);
+    }
+
+    // the coarsest level first, it stands in for everything else
+    std::sort(missing.begin(), missing.end(), [](const Missing& a, const Missing& b) {
+        bool aCoarsest = a.level + 1 == levelCount(*a.surface->tin);
+        bool bCoarsest = b.level + 1 == levelCount(*b.surface->tin);
+        if (aCoarsest != bCoarsest) {
+            return aCoarsest;
+        }
+        return a.distance < b.distance;
+    });
+    for (const Missing& chunk : missing) {
+        if (!upload(ring, chunk)) {
+            break;
+        }
+    }
+    for (Surface* surface : inView) {
+        collectDraws(*surface);
+    }
+}
+
+void TinView::pick(Surface& surface, double pixelsPerUnit, size_t chunkBudget, std::vector<Missing>& missing)
+{
+    const Geometry::Tin& tin = *surface.tin;
+    uint32_t coarsest = levelCount(tin) - 1;
+    auto countInView = [&](uint32_t level) {
+        size_t count = 0;
+        for (const Geometry::Tin::Chunk& chunk : chunks(tin, level)) {
+            count += _view.intersects(chunk.bounds);
+        }
+        return count;
+    };
+
+    // finer while the triangles of the level are larger than needed and the finer chunks fit
+    double area = (double)tin.bounds().width() * tin.bounds().height() * pixelsPerUnit * pixelsPerUnit;
+    uint32_t level = coarsest;
+    while (level > 0 && area / (triangles(tin, level).size() / 3) > targetTrianglePixels &&
+           countInView(level - 1) <= chunkBudget) {
+        --level;
+    }
+    surface.level = level;
+
+    double centerX = ((double)_view.min[0] + _view.max[0]) / 2.0;
+    double centerY = ((double)_view.min[1] + _view.max[1]) / 2.0;
+    auto visit = [&](uint32_t visited, bool collect) {
+        const std::vector<Geometry::Tin::Chunk>& list = chunks(tin, visited);
+        for (uint32_t i = 0; i < list.size(); ++i) {
+            const Geometry::BoundingBox& bounds = list[i].bounds;
+            if (!_view.intersects(bounds)) {
+                continue;
+            }
+            if (collect) {
+                surface.inView.push_back(i);
+            }
+            int32_t slot = surface.slots[visited][i];
+            if (slot >= 0) {
+                _slots[slot].used = _frame;
+            } else {
+                double dx = ((double)bounds.min[0] + bounds.max[0]) / 2.0 - centerX;
+                double dy = ((double)bounds.min[1] + bounds.max[1]) / 2.0 - centerY;
+                missing.push_back({&surface, visited, i, dx * dx + dy * dy});
+            }
+        }
+    };
+    visit(level, true);
+    if (level != coarsest) {
+        visit(coarsest, false);
+    }
+}
+
+bool TinView::upload(Vulkan::StagingRing& ring, const Missing& missing)
+{
+    Surface& surface = *missing.surface;
+    const Geometry::Tin& tin = *surface.tin;
+    const Geometry::Tin::Chunk& chunk = chunks(tin, missing.level)[missing.chunk];
+    const std::vector<uint32_t>& list = triangles(tin, missing.level);
+
+    int32_t slot = takeSlot();
+    if (slot < 0) {
+        return false;
+    }
+    _scratch.resize((size_t)chunk.triangleCount * 9);
+    size_t first = (size_t)chunk.firstTriangle * 3;
+    for (size_t i = 0; i < (size_t)chunk.triangleCount * 3; ++i) {
+        const Geometry::TinPoint& point = tin.points()[list[first + i]];
+        _scratch[3 * i] = (float)(point.pos[0] - surface.origin[0]);
+        _scratch[3 * i + 1] = (float)(point.pos[1] - surface.origin[1]);
+        _scratch[3 * i + 2] = (float)point.pos[2];
+    }
+    if (!_buffer->upload(ring, slot * slotFloats * sizeof(float), _scratch.data(), _scratch.size() * sizeof(float))) {
+        return false;
+    }
+
+    Slot& entry = _slots[slot];
+    if (entry.tin) {
+        auto owner = _surfaces.find(entry.tin);
+        if (owner != _surfaces.end()) {
+            owner->second.slots[entry.level][entry.chunk] = -1;
+        }
+    }
+    entry = Slot{&tin, missing.level, missing.chunk, _frame};
+    surface.slots[missing.level][missing.chunk] = slot;
+    return true;
+}
+
+int32_t TinView::takeSlot()
+{
+    int32_t oldest = -1;
+    for (size_t i = 0; i < _slots.size(); ++i) {
+        if (!_slots[i].tin) {
+            return (int32_t)i;
+        }
+        if (_slots[i].used < _frame && (oldest < 0 || _slots[i].used < _slots[oldest].used)) {
+            oldest = (int32_t)i;
+        }
+    }
+    return oldest;
+}
+
+void TinView::collectDraws(Surface& surface)
+{
+    const Geometry::Tin& tin = *surface.tin;
+    std::vector<Draw> exact;
+    std::vector<Geometry::BoundingBox> holes;
+    for (uint32_t chunk : surface.inView) {
+        int32_t slot = surface.slots[surface.level][chunk];
+        if (slot >= 0) {
+            exact.push_back({&surface, (uint32_t)slot, chunks(tin, surface.level)[chunk].triangleCount});
+        } else {
+            holes.push_back(chunks(tin, surface.level)[chunk].bounds);
+        }
+    }
+
+    // per coarser level what covers the holes, the holes left are where that is missing too
+    std::vector<std::vector<Draw>> fallbacks;
+    for (uint32_t level = surface.level + 1; level < levelCount(tin) && !holes.empty(); ++level) {
+        std::vector<Draw> draws;
+        std::vector<Geometry::BoundingBox> left;
+        const std::vector<Geometry::Tin::Chunk>& list = chunks(tin, level);
+        for (uint32_t i = 0; i < list.size(); ++i) {
+            const Geometry::BoundingBox& bounds = list[i].bounds;
+            bool covers = _view.intersects(bounds) &&
+                          std::any_of(holes.begin(), holes.end(),
+                                      [&](const Geometry::BoundingBox& hole) { return hole.intersects(bounds); });
+            if (!covers) {
+                continue;
+            }
+            int32_t slot = surface.slots[level][i];
+            if (slot >= 0) {
+                _slots[slot].used = _frame;
+                draws.push_back({&surface, (uint32_t)slot, list[i].triangleCount});
+            } else {
+                left.push_back(bounds);
+            }
+        }
+        fallbacks.push_back(std::move(draws));
+        holes = std::move(left);
+    }
+    // coarse first, so the finer triangles cover them
+    for (auto level = fallbacks.rbegin(); level != fallbacks.rend(); ++level) {
+        _draws.insert(_draws.end(), level->begin(), level->end());
+    }
+    _draws.insert(_draws.end(), exact.begin(), exact.end());
+}
+
+void TinView::draw(VkCommandBuffer commandBuffer, VkPipelineLayout layout, const QMatrix4x4& documentToClip)
+{
+    if (_draws.empty()) {
+        return;
+    }
+    VkBuffer buffer = *_buffer;
+    VkDeviceSize offset = 0;
+    _vkManager->vkCmdBindVertexBuffers(commandBuffer, 0, 1, &buffer, &offset);
+
+    PushConstants constants = {};
+    const Surface* current = nullptr;
+    for (const Draw& draw : _draws) {
+        if (draw.surface != current) {
+            current = draw.surface;
+            // the camera times the move to the surface's origin, in double so the large offsets
+            // of projected coordinates cancel before they are narrowed
+            for (int row = 0; row < 4; ++row) {
+                for (int column = 0; column < 3; ++column) {
+                    constants.transform[column * 4 + row] = documentToClip(row, column);
+                }
+                constants.transform[3 * 4 + row] = (float)(documentToClip(row, 0) * current->origin[0] +
+                                                           documentToClip(row, 1) * current->origin[1] +
+                                                           documentToClip(row, 3));
+            }
+            std::array<float, 3> color = Geometry::unpackColor(current->style.color);
+            std::copy(color.begin(), color.end(), constants.color);
+            constants.color[3] = 1.0f;
+            constants.elevationRange[0] = (float)current->tin->minElevation();
+            constants.elevationRange[1] = (float)current->tin->maxElevation();
+            constants.flags = 0;
+            if (current->style.flags & Geometry::LayerStyle::Wireframe) {
+                constants.flags |= 1;
+            }
+            if (current->style.flags & Geometry::LayerStyle::OverrideColor) {
+                constants.flags |= 2;
+            }
+            _vkManager->vkCmdPushConstants(commandBuffer, layout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+                                           0, sizeof(PushConstants), &constants);
+        }
+        _vkManager->vkCmdDraw(commandBuffer, draw.triangleCount * 3, 1, draw.slot * (uint32_t)slotFloats / 3, 0);
+    }
+}
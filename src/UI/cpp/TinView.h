@@ -0,0 +1,117 @@
+#pragma once
+
+#include <QMatrix4x4>
+#include <QRectF>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+#include "Library/Vulkan/Buffer.h"
+#include "Library/Vulkan/StagingRing.h"
+#include "Library/Vulkan/VulkanComponent.h"
+#include "Library/Vulkan/VulkanManager.h"
+#include "UI/cpp/Geometry/Document.h"
+#include "UI/cpp/Geometry/Tin.h"
+
+// What one view draws of the surfaces of a document, in a fixed amount of memory however many
+// triangles they have. Every frame the finest of a surface and its overviews is picked whose
+// triangles aren't much smaller than a pixel and whose chunks in the view fit the slots, like
+// the level of a RasterView. Chunks that aren't resident are uploaded into the slots of one
+// device local buffer as far as the staging ring allows, the least recently drawn slot giving
+// way when none is free; meanwhile the resident chunks of coarser overviews stand in for them.
+// The triangles are drawn shaded, or as a wireframe after the layer's style.
+class TinView : protected Vulkan::VulkanComponent {
+public:
+    // slots of Tin::chunkTriangles triangles, 576 KB each
+    static constexpr size_t slotCount = 192;
+
+    // layout of the push constants in vertex_tin.vert and frag_tin.frag
+    struct PushConstants {
+        // from the surface's origin to clip space
+        float transform[16];
+        float color[4];
+        float elevationRange[2];
+        uint32_t flags;
+    };
+
+    TinView(std::shared_ptr<Vulkan::VulkanManager>& vkManager);
+
+    // the surfaces of the visible layers are drawn in layer order, resident chunks of the others
+    // are kept until their slots are needed
+    void setSnapshot(const Geometry::DocumentSnapshot& snapshot);
+
+    bool empty() const { return _order.empty(); }
+
+    // picks the chunks for the view, given in document coordinates, and uploads what is missing
+    // as far as the ring has room; before the ring is flushed
+    void prepare(Vulkan::StagingRing& ring, const QRectF& view, double pixelsPerUnit);
+
+    // inside the render pass with the surface pipeline bound
+    void draw(VkCommandBuffer commandBuffer, VkPipelineLayout layout, const QMatrix4x4& documentToClip);
+
+private:
+    struct Surface {
+        std::shared_ptr<const Geometry::Tin> tin;
+        bool visible = false;
+        Geometry::LayerStyle style;
+        // what the coordinates in the slots are relative to, so floats keep their precision
+        double origin[2] = {0.0, 0.0};
+        // per level, the surface and then its overviews, per chunk; -1 while it isn't resident
+        std::vector<std::vector<int32_t>> slots;
+        // of the last prepare(): the level and its chunks in the view
+        uint32_t level = 0;
+        std::vector<uint32_t> inView;
+    };
+
+    struct Slot {
+        const Geometry::Tin* tin = nullptr;
+        uint32_t level = 0;
+        uint32_t chunk = 0;
+        // frame the slot was last drawn or uploaded in
+        uint64_t used = 0;
+    };
+
+    struct Draw {
+        const Surface* surface;
+        uint32_t slot;
+        uint32_t triangleCount;
+    };
+
+    // a chunk to upload, nearer the center of the view first
+    struct Missing {
+        Surface* surface;
+        uint32_t level;
+        uint32_t chunk;
+        double distance;
+    };
+
+    static const std::vector<uint32_t>& triangles(const Geometry::Tin& tin, uint32_t level);
+    static const std::vector<Geometry::Tin::Chunk>& chunks(const Geometry::Tin& tin, uint32_t level);
+
+    static uint32_t levelCount(const Geometry::Tin& tin) { return 1 + (uint32_t)tin.overviews().size(); }
+
+    // the level and chunks of the surface in the view, those of the coarsest level too; marks
+    // what is resident as used and collects what is missing
+    void pick(Surface& surface, double pixelsPerUnit, size_t chunkBudget, std::vector<Missing>& missing);
+    // the resident chunks of the level, where some are missing those of coarser levels under them
+    void collectDraws(Surface& surface);
+    // false when the ring is full
+    bool upload(Vulkan::StagingRing& ring, const Missing& missing);
+    // a free slot or the least recently used one not needed in this frame, -1 when there is none
+    int32_t takeSlot();
+
+    std::unordered_map<const Geometry::Tin*, Surface> _surfaces;
+    // drawing order, layer by layer
+    std::vector<const Geometry::Tin*> _order;
+    std::unique_ptr<Vulkan::Buffer> _buffer;
+    std::vector<Slot> _slots;
+    uint64_t _frame = 0;
+    // of the last prepare(), in document coordinates
+    Geometry::BoundingBox _view;
+    std::vector<Draw> _draws;
+    // the vertices of a chunk on their way into the ring
+    std::vector<float> _scratch;
+};
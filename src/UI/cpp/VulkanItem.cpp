@@ -9,32 +9,227 @@
 #include <vector>
 #include <iostream>
 #include <QTimer>
+#include <QPointer>
 
 #include "Geometry/Vertex.h"
 #include "UI/cpp/MainWindow.h"
 #include "VulkanRenderNode.h"
 
+ViewportContext VulkanItem::viewportContext()
+{
+    return ViewportContext{_camera.zoom, _camera.offset, size(), this, _hovered};
+}
+
+void VulkanItem::beginEvent()
+{
+    _eventTime = RenderCommandQueue::Clock::now();
+}
+
+void VulkanItem::endEvent()
+{
+    _eventTime.reset();
+}
+
+RenderCommandQueue::Clock::time_point VulkanItem::commandTime() const
+{
+    return _eventTime.value_or(RenderCommandQueue::Clock::now());
+}
+
+void VulkanItem::setCamera(const Camera& camera)
+{
+    if (_camera == camera)
+        return;
+
+    _camera = camera;
+    _commands->push(RenderCommands::SetCamera{_camera}, commandTime());
+    update();
+}
+
+void VulkanItem::setPreview(std::vector<Geometry::Line> lines, std::vector<Geometry::Circle> circles)
+{
+    _commands->push(RenderCommands::SetPreview{std::move(lines), std::move(circles)}, commandTime());
+    update();
+}
+
+void VulkanItem::setPicking(bool picking)
+{
+    if (_picking == picking)
+        return;
+
+    _picking = picking;
+    if (!_picking) {
+        setPickPoint(std::nullopt);
+    }
+    emit pickingChanged();
+}
+
+void VulkanItem::setPickPoint(std::optional<QPointF> position)
+{
+    if (position && !_picking)
+        return;
+
+    // the render thread works in framebuffer pixels
+    if (position && window()) {
+        *position *= window()->devicePixelRatio();
+    }
+    _commands->push(RenderCommands::SetPickPoint{position}, commandTime());
+    update();
+}
+
+void VulkanItem::setHovered(const Geometry::EntityRef& hovered)
+{
+    if (_hovered == hovered)
+        return;
+
+    _hovered = hovered;
+    emit hoveredChanged();
+}
+
+void VulkanItem::setCoalesceInput(bool coalesce)
+{
+    if (_coalesceInput == coalesce)
+        return;
+
+    dispatchCoalesced();
+    _coalesceInput = coalesce;
+    emit coalesceInputChanged();
+}
+
+void VulkanItem::scheduleDispatch()
+{
+    if (!_pendingMouseMove && !_pendingHoverMove && !_pendingWheel) {
+        _pendingTime = RenderCommandQueue::Clock::now();
+    }
+    watchFrames();
+    update();
+}
+
+void VulkanItem::watchFrames()
+{
+    // afterAnimating comes on the GUI thread right before the frame is synchronized
+    if (window() != _dispatchWindow) {
+        QObject::disconnect(_afterAnimatingConnection);
+        _dispatchWindow = window();
+        if (_dispatchWindow) {
+            _afterAnimatingConnection = QObject::connect(_dispatchWindow, &QQuickWindow::afterAnimating,
+                                                         this, &VulkanItem::beforeFrame);
+        }
+    }
+}
+
+void VulkanItem::beforeFrame()
+{
+    // input first, the document edits it makes go out with the same frame
+    dispatchCoalesced();
+    _frameUpdates.flush();
+}
+
+void VulkanItem::coalesce(QMouseEvent* event)
+{
+    scheduleDispatch();
+    _moveHistory.push_back(event->position());
+    _pendingMouseMove.reset(event->clone());
+}
+
+void VulkanItem::coalesce(QHoverEvent* event)
+{
+    scheduleDispatch();
+    _moveHistory.push_back(event->position());
+    _pendingHoverMove.reset(event->clone());
+}
+
+void VulkanItem::coalesce(QWheelEvent* event)
+{
+    scheduleDispatch();
+    if (!_pendingWheel) {
+        _pendingWheel.reset(event->clone());
+        return;
+    }
+    // the newest position and state with the deltas of every turn since the last frame
+    _pendingWheel = std::make_unique<QWheelEvent>(
+        event->position(), event->globalPosition(),
+        _pendingWheel->pixelDelta() + event->pixelDelta(), _pendingWheel->angleDelta() + event->angleDelta(),
+        event->buttons(), event->modifiers(), event->phase(), event->inverted(), Qt::MouseEventNotSynthesized,
+        event->pointingDevice());
+}
+
+void VulkanItem::dispatchCoalesced()
+{
+    if (!_pendingMouseMove && !_pendingHoverMove && !_pendingWheel)
+        return;
+
+    // handlers may send more events, take the kept ones out first
+    std::unique_ptr<QMouseEvent> pendingMouse = std::move(_pendingMouseMove);
+    std::unique_ptr<QHoverEvent> pendingHover = std::move(_pendingHoverMove);
+    std::unique_ptr<QWheelEvent> pendingWheel = std::move(_pendingWheel);
+    std::vector<QPointF> history = std::move(_moveHistory);
+    _moveHistory.clear();
+
+    // latency is measured from the oldest event the dispatch stands for
+    _eventTime = _pendingTime;
+    ViewportContext context = viewportContext();
+    context.history = std::move(history);
+    if (pendingHover) {
+        setPickPoint(pendingHover->position());
+        emit hoverMove(pendingHover.get(), context);
+    }
+    if (pendingMouse) {
+        setPickPoint(pendingMouse->position());
+        emit mouseMove(pendingMouse.get(), context);
+    }
+    if (pendingWheel) {
+        context.history.clear();
+        emit wheel(pendingWheel.get(), context);
+    }
+    endEvent();
+}
+
+void VulkanItem::pushDocument()
+{
+    if (_controller) {
+        _commands->push(RenderCommands::SetDocument{_controller->snapshot(), _controller->document.id()},
+                        _documentChangeTime);
+        update();
+    }
+}
+
 void VulkanItem::mousePressEvent(QMouseEvent *event)
 {
-    emit mousePress(event, ViewportContext{VulkanRenderNode::z, VulkanRenderNode::pos, size()});
+    dispatchCoalesced();
+    beginEvent();
+    emit mousePress(event, viewportContext());
+    endEvent();
     event->accept();
 }
 
 void VulkanItem::mouseMoveEvent(QMouseEvent *event)
 {
-    emit mouseMove(event, ViewportContext{VulkanRenderNode::z, VulkanRenderNode::pos, size()});
     event->accept();
+    if (_coalesceInput) {
+        coalesce(event);
+        return;
+    }
+    beginEvent();
+    setPickPoint(event->position());
+    emit mouseMove(event, viewportContext());
+    endEvent();
 }
 
 void VulkanItem::mouseReleaseEvent(QMouseEvent *event)
 {
-    emit mouseRelease(event, ViewportContext{VulkanRenderNode::z, VulkanRenderNode::pos, size()});
+    dispatchCoalesced();
+    beginEvent();
+    emit mouseRelease(event, viewportContext());
+    endEvent();
     event->accept();
 }
 
 void VulkanItem::hoverEnterEvent(QHoverEvent *event)
 {
-    emit hoverEnter(event, ViewportContext{VulkanRenderNode::z, VulkanRenderNode::pos, size()});
+    dispatchCoalesced();
+    beginEvent();
+    emit hoverEnter(event, viewportContext());
+    endEvent();
     event->accept();
 }
 
@@ -44,6 +239,7 @@ void VulkanItem::setController(QObject* controller)
         return;
 
     _controller = static_cast<MainWindow*>(controller);
+    _documentSubscription.reset();
     emit controllerChanged();
 
     if (_controller) {
@@ -58,30 +254,51 @@ void VulkanItem::keyPressEvent(QKeyEvent* event)
         isLineAdding = false;
         QGuiApplication::restoreOverrideCursor();
     }
-    emit keyPress(event, ViewportContext{VulkanRenderNode::z, VulkanRenderNode::pos, size()});
+    dispatchCoalesced();
+    beginEvent();
+    emit keyPress(event, viewportContext());
+    endEvent();
     event->accept();
 }
 
 void VulkanItem::hoverMoveEvent(QHoverEvent *event)
 {
-    emit hoverMove(event, ViewportContext{VulkanRenderNode::z, VulkanRenderNode::pos, size()});
     event->accept();
+    if (_coalesceInput) {
+        coalesce(event);
+        return;
+    }
+    beginEvent();
+    setPickPoint(event->position());
+    emit hoverMove(event, viewportContext());
+    endEvent();
 }
 
 void VulkanItem::hoverLeaveEvent(QHoverEvent *event)
 {
-    emit hoverLeave(event, ViewportContext{VulkanRenderNode::z, VulkanRenderNode::pos, size()});
+    dispatchCoalesced();
+    beginEvent();
+    setPickPoint(std::nullopt);
+    emit hoverLeave(event, viewportContext());
+    endEvent();
     event->accept();
 }
 
 void VulkanItem::wheelEvent(QWheelEvent* event)
 {
-    emit wheel(event, ViewportContext{VulkanRenderNode::z, VulkanRenderNode::pos, size()});
     event->accept();
+    if (_coalesceInput) {
+        coalesce(event);
+        return;
+    }
+    beginEvent();
+    emit wheel(event, viewportContext());
+    endEvent();
 }
 
 VulkanItem::VulkanItem(QQuickItem *parent)
-    : QQuickItem(parent)
+    : QQuickItem(parent),
+      _commands(std::make_shared<RenderCommandQueue>())
 {
     setFlag(ItemHasContents, true);
     setAcceptedMouseButtons(Qt::AllButtons);
@@ -89,19 +306,69 @@ VulkanItem::VulkanItem(QQuickItem *parent)
     QTimer *timer = new QTimer(this);
     connect(timer, &QTimer::timeout, this, &VulkanItem::update);
     timer->start(10); 
+
+    // the first change of a batch stamps it and asks for the frame that sends it
+    _frameUpdates.setWakeUp([this]() {
+        _documentChangeTime = commandTime();
+        watchFrames();
+        update();
+    });
+}
+
+VulkanItem::~VulkanItem()
+{
+    if (_commands->latency().count() > 0) {
+        // compare runs with coalesceInput on and off
+        _commands->latency().print(_coalesceInput ? "event to frame latency, coalesced input"
+                                                  : "event to frame latency, every input event");
+    }
 }
 
 QSGNode* VulkanItem::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *)
 {
+    // the GUI thread is blocked while this runs on the render thread, so pushing from here
+    // doesn't break the single producer rule of the queue
     VulkanRenderNode *node = static_cast<VulkanRenderNode *>(oldNode);
-    if (!node)
-        node = new VulkanRenderNode(this, _controller);
+    if (!node) {
+        // picks arrive on the render thread, the item may be gone before they are delivered
+        QPointer<VulkanItem> self(this);
+        node = new VulkanRenderNode(this, _commands, [self](const Geometry::EntityRef& hovered) {
+            QMetaObject::invokeMethod(self.data(), [self, hovered]() {
+                if (self) {
+                    self->setHovered(hovered);
+                }
+            }, Qt::QueuedConnection);
+        });
+        // a new node starts from nothing, give it the whole state
+        _commands->push(RenderCommands::SetCamera{_camera});
+        if (_controller) {
+            _commands->push(RenderCommands::SetDocument{_controller->snapshot(), _controller->document.id()});
+        }
+
+        // frameSwapped comes on the render thread once the frame is presented
+        QObject::disconnect(_frameSwappedConnection);
+        std::shared_ptr<RenderCommandQueue> commands = _commands;
+        _frameSwappedConnection = QObject::connect(window(), &QQuickWindow::frameSwapped, this,
+                                                   [commands]() { commands->framePresented(); },
+                                                   Qt::DirectConnection);
+    }
+    _commands->retryPending();
     m_renderNode = node;
     node->markDirty(QSGNode::DirtyMaterial);
 
     return node;
 }
 
+void VulkanItem::itemChange(ItemChange change, const ItemChangeData& value)
+{
+    // updates collected while the item had no window wait for its first frame
+    if (change == ItemSceneChange && value.window && !_frameUpdates.empty()) {
+        watchFrames();
+        update();
+    }
+    QQuickItem::itemChange(change, value);
+}
+
 // void VulkanItem::addingLine()
 // {
 //     isLineAdding = true;
@@ -134,4 +401,10 @@ void VulkanItem::connectController(MainWindow* controller)
     QObject::connect(this, &VulkanItem::hoverLeave, controller, &MainWindow::hoverLeave);
     QObject::connect(this, &VulkanItem::wheel, controller, &MainWindow::wheel);
     QObject::connect(this, &VulkanItem::keyPress, controller, &MainWindow::keyPress);
+
+    // edits come in batches (an import adds every entity separately), the snapshot is sent once
+    // per frame whatever the number of edits
+    _documentSubscription = controller->document.subscribe(_frameUpdates, [this]() { pushDocument(); });
+    _documentChangeTime = RenderCommandQueue::Clock::now();
+    pushDocument();
 }
\ No newline at end of file
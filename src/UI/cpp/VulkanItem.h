@@ -7,9 +7,17 @@
 #include <QVulkanDeviceFunctions>
 #include <qevent.h>
 #include <qpoint.h>
+#include <QPointer>
+#include <QQuickWindow>
+#include <memory>
+#include <optional>
+#include <vector>
 
+#include "Library/Flux/Signal.h"
+#include "UI/cpp/Camera.h"
 #include "UI/cpp/MainWindow.h"
 #include "UI/cpp/ModeHandlers/ViewportContext.h"
+#include "UI/cpp/RenderCommandQueue.h"
 #include "VulkanRenderNode.h"
 
 
@@ -21,22 +29,42 @@ class VulkanItem : public QQuickItem
     // Q_PROPERTY(bool interactive READ interactive WRITE setInteractive NOTIFY interactiveChanged)
     // Q_PROPERTY(QColor triangleColor READ triangleColor WRITE setTriangleColor NOTIFY triangleColorChanged)
     Q_PROPERTY(QObject* controller READ controller WRITE setController NOTIFY controllerChanged)
+    // looks up the entity under the cursor and highlights it
+    Q_PROPERTY(bool picking READ picking WRITE setPicking NOTIFY pickingChanged)
+    // mouse, hover moves and wheel turns are delivered once per frame with the latest state
+    Q_PROPERTY(bool coalesceInput READ coalesceInput WRITE setCoalesceInput NOTIFY coalesceInputChanged)
 
 public:
     VulkanItem(QQuickItem *parent = nullptr);
+    ~VulkanItem();
 
     // bool interactive() const { return m_interactive; }
     // void setInteractive(bool interactive);
 
     // QColor triangleColor() const { return m_triangleColor; }
     // void setTriangleColor(const QColor& color);
-    static float z;
+
+    // GUI thread, the render node gets a copy through the command queue
+    const Camera& camera() const { return _camera; }
+    void setCamera(const Camera& camera);
+    // entities drawn over the document until the next call, empty to clear; they never enter
+    // the document, so rubber-banding costs the same however large the drawing is
+    void setPreview(std::vector<Geometry::Line> lines, std::vector<Geometry::Circle> circles = {});
 
     QObject* controller() const { return _controller; }
     void setController(QObject* controller);
 
+    bool picking() const { return _picking; }
+    void setPicking(bool picking);
+    // what the render thread last found under the cursor, one or two frames behind the cursor
+    const Geometry::EntityRef& hovered() const { return _hovered; }
+
+    bool coalesceInput() const { return _coalesceInput; }
+    void setCoalesceInput(bool coalesce);
+
 protected:
     QSGNode *updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *) override;
+    void itemChange(ItemChange change, const ItemChangeData& value) override;
 
     // Mouse event handlers
     void mousePressEvent(QMouseEvent *event) override;
@@ -59,6 +87,9 @@ signals:
     void wheel(QWheelEvent* event, ViewportContext cntx);
     void keyPress(QKeyEvent* event, ViewportContext cntx);
     void controllerChanged();
+    void pickingChanged();
+    void hoveredChanged();
+    void coalesceInputChanged();
 
 private:
     VulkanRenderNode *m_renderNode = nullptr;
@@ -79,4 +110,47 @@ public slots:
     // void addingLineWithCoordinates(float x1, float y1, float x2, float y2);
 private:
     void connectController(MainWindow* controller);
+    ViewportContext viewportContext();
+    // keeps the event until the next frame, replacing the one kept before
+    void coalesce(QMouseEvent* event);
+    void coalesce(QHoverEvent* event);
+    void coalesce(QWheelEvent* event);
+    // delivers what was kept since the last frame; called before every frame and before any
+    // other event, so handlers see events in the order they came
+    void dispatchCoalesced();
+    void scheduleDispatch();
+    // runs beforeFrame() before every frame of the item's window
+    void watchFrames();
+    void beforeFrame();
+    // commands pushed between the two are stamped with the time the event arrived
+    void beginEvent();
+    void endEvent();
+    RenderCommandQueue::Clock::time_point commandTime() const;
+    void pushDocument();
+    // item coordinates, nullopt when the cursor left
+    void setPickPoint(std::optional<QPointF> position);
+    void setHovered(const Geometry::EntityRef& hovered);
+
+    Camera _camera;
+    std::shared_ptr<RenderCommandQueue> _commands;
+    std::optional<RenderCommandQueue::Clock::time_point> _eventTime;
+    // collects the document changes until the next frame, the snapshot is sent once for them
+    Flux::DeferredDispatcher _frameUpdates;
+    Flux::Subscription _documentSubscription;
+    // the first change since the last snapshot was sent
+    RenderCommandQueue::Clock::time_point _documentChangeTime;
+    QMetaObject::Connection _frameSwappedConnection;
+    bool _picking = true;
+    bool _coalesceInput = true;
+    std::unique_ptr<QMouseEvent> _pendingMouseMove;
+    std::unique_ptr<QHoverEvent> _pendingHoverMove;
+    // angle and pixel deltas of the kept turns summed up
+    std::unique_ptr<QWheelEvent> _pendingWheel;
+    // positions of the kept moves, see ViewportContext::history
+    std::vector<QPointF> _moveHistory;
+    // arrival of the oldest kept event, commands caused by the dispatch carry it
+    RenderCommandQueue::Clock::time_point _pendingTime;
+    QPointer<QQuickWindow> _dispatchWindow;
+    QMetaObject::Connection _afterAnimatingConnection;
+    Geometry::EntityRef _hovered;
 };
@@ -1,6 +1,10 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
 #include <cstddef>
 #include <exception>
 #include <memory>
+#include <numbers>
 #include <qquickitem.h>
 #include <stdexcept>
 #include <vulkan/vulkan.h>
@@ -8,12 +12,17 @@
 #include <QSGRendererInterface>
 #include <iostream>
 #include <QQuickWindow>
+#include <QTime>
 
+#include "SpirvShaders.h"
 #include "VulkanRenderNode.h"
-#include "Library/Files/FileStream.h"
 #include "Library/Vulkan/VulkanManager.h"
+#include "UI/cpp/Geometry/Arc.h"
+#include "UI/cpp/Geometry/Circle.h"
+#include "UI/cpp/Geometry/Color.h"
 #include "UI/cpp/Geometry/Line.h"
-#include "UI/cpp/MainWindow.h"
+#include "UI/cpp/Geometry/PointCloud.h"
+#include "UI/cpp/StyleTable.h"
 
 namespace {
 
@@ -35,38 +44,119 @@ std::string queueFamiliesFlagsToString(VkQueueFlags flags)
     return res;
 }
 
+constexpr std::array<float, 3> highlightColor = {1.0f, 0.55f, 0.1f};
+// segments of a circle drawn as lines, arcs get as many
+constexpr int curveSegments = 64;
+
+void appendSegment(std::vector<Geometry::Line>& lines, const float (&from)[2], const float (&to)[2],
+                   const std::array<float, 3>& color)
+{
+    Geometry::Line line;
+    line.vertices[0] = {{from[0], from[1]}, {color[0], color[1], color[2]}};
+    line.vertices[1] = {{to[0], to[1]}, {color[0], color[1], color[2]}};
+    lines.push_back(line);
+}
+
+void appendArc(std::vector<Geometry::Line>& lines, const Geometry::Arc& arc, const std::array<float, 3>& color)
+{
+    float from[2];
+    arc.pointAt(arc.startAngle, from);
+    for (int i = 1; i <= curveSegments; ++i) {
+        float to[2];
+        arc.pointAt(arc.startAngle + arc.sweepAngle * i / curveSegments, to);
+        appendSegment(lines, from, to, color);
+        from[0] = to[0];
+        from[1] = to[1];
+    }
+}
+
+void appendCircle(std::vector<Geometry::Line>& lines, const Geometry::Circle& circle, const std::array<float, 3>& color)
+{
+    Geometry::Arc full = {{circle.center[0], circle.center[1]}, circle.radius, circle.color,
+                          0.0f, 2.0f * std::numbers::pi_v<float>};
+    appendArc(lines, full, color);
+}
+
+// the outline of an entity of the store as lines, at most capacity of them
+std::vector<Geometry::Line> highlightLines(const DocumentGpuStore& store, const Geometry::EntityRef& entity, size_t capacity)
+{
+    std::vector<Geometry::Line> lines;
+    if (!entity || entity.layer >= store.layerCount()) {
+        return lines;
+    }
+    const DocumentGpuStore::Layer& layer = store.layer(entity.layer);
+    switch (entity.kind) {
+    case Geometry::EntityRef::Kind::Line:
+        if (layer.lines.snapshot() && entity.index < layer.lines.snapshot()->size()) {
+            const Geometry::Line& line = layer.lines.snapshot()->at(entity.index);
+            appendSegment(lines, line.vertices[0].pos, line.vertices[1].pos, highlightColor);
+        }
+        break;
+    case Geometry::EntityRef::Kind::Circle:
+        if (layer.circles.snapshot() && entity.index < layer.circles.snapshot()->size()) {
+            appendCircle(lines, layer.circles.snapshot()->at(entity.index), highlightColor);
+        }
+        break;
+    case Geometry::EntityRef::Kind::Arc:
+        if (layer.arcs.snapshot() && entity.index < layer.arcs.snapshot()->size()) {
+            appendArc(lines, layer.arcs.snapshot()->at(entity.index), highlightColor);
+        }
+        break;
+    case Geometry::EntityRef::Kind::Polyline: {
+        const auto& records = layer.polylines.polylines();
+        const auto& vertices = layer.polylines.vertices().snapshot();
+        if (!records || !vertices || entity.index >= records->size()) {
+            break;
+        }
+        const Geometry::Polyline& polyline = records->at(entity.index);
+        uint32_t segments = polyline.closed ? polyline.vertexCount : polyline.vertexCount - 1;
+        for (uint32_t i = 0; i < segments && lines.size() < capacity; ++i) {
+            size_t from = polyline.firstVertex + i;
+            size_t to = polyline.firstVertex + (i + 1) % polyline.vertexCount;
+            if (to < vertices->size()) {
+                appendSegment(lines, vertices->at(from).pos, vertices->at(to).pos, highlightColor);
+            }
+        }
+        break;
+    }
+    case Geometry::EntityRef::Kind::None:
+        break;
+    }
+    lines.resize(std::min(lines.size(), capacity));
+    return lines;
 }
 
-float VulkanRenderNode::z = 1.0f;
-QPointF VulkanRenderNode::pos = {0, 0};
+}
 
-VulkanRenderNode::VulkanRenderNode(QQuickItem *item, MainWindow* controller) :
+VulkanRenderNode::VulkanRenderNode(QQuickItem *item, std::shared_ptr<RenderCommandQueue> commands, HoveredCallback hovered) :
     _vkManager(std::make_shared<Vulkan::VulkanManager>(item)),
+    m_commands(std::move(commands)),
     bufferTriangle(_vkManager),
     bufferLine(_vkManager),
     bufferNet(_vkManager),
-    bufferAddedLines(_vkManager),
+    bufferPreview(_vkManager),
+    bufferHighlight(_vkManager),
+    m_stagingRing(_vkManager, 4 << 20),
+    m_documentView(_vkManager),
+    m_pointCloudView(_vkManager),
+    m_rasterView(_vkManager),
+    m_tinView(_vkManager),
     m_vertShaderModule(_vkManager),
     m_fragShaderModule(_vkManager),
     m_fragDashShaderModule(_vkManager),
     m_vertCircleModule(_vkManager),
     m_fragCircleModule(_vkManager),
-    m_verticesAddedLines()
+    m_vertDocumentModule(_vkManager),
+    m_fragDocumentModule(_vkManager),
+    m_vertPointModule(_vkManager),
+    m_fragPointModule(_vkManager),
+    m_vertRasterModule(_vkManager),
+    m_fragRasterModule(_vkManager),
+    m_vertTinModule(_vkManager),
+    m_fragTinModule(_vkManager),
+    m_onHovered(std::move(hovered))
 {
-    Files::FileStream vertFS("shaders/vertex.spv");
-    Files::FileStream fragFS("shaders/frag.spv");
-    Files::FileStream fragDashFS("shaders/frag_dash_line.spv");
-    Files::FileStream vertCircleFS("shaders/vertex_circle.spv");
-    Files::FileStream fragCircleFS("shaders/frag_circle.spv");
-
-    vertShaderCode = vertFS.getSpirvByteCode();
-    fragShaderCode = fragFS.getSpirvByteCode();
-    fragDashShaderCode = fragDashFS.getSpirvByteCode();
-    vertCircleShaderCode = vertCircleFS.getSpirvByteCode();
-    fragCircleShaderCode = fragCircleFS.getSpirvByteCode();
-
     initVulkan(item);
-    connectController(controller);
 }
 
 VulkanRenderNode::~VulkanRenderNode()
@@ -74,19 +164,6 @@ VulkanRenderNode::~VulkanRenderNode()
     releaseResources();
 }
 
-uint32_t findMemoryType(VkPhysicalDevice physicalDevice, uint32_t typeFilter, VkMemoryPropertyFlags properties)
-{
-    VkPhysicalDeviceMemoryProperties memProperties;
-    vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memProperties);
-
-    for (uint32_t i = 0; i < memProperties.memoryTypeCount; i++) {
-        if ((typeFilter & (1 << i)) && (memProperties.memoryTypes[i].propertyFlags & properties) == properties) {
-            return i;
-        }
-    }
-    return 0;
-}
-
 uint32_t findGraphicsQueueFamily(VkPhysicalDevice physicalDevice)
 {
     uint32_t queueFamilyCount = 0;
@@ -147,11 +224,22 @@ void VulkanRenderNode::initVulkan(QQuickItem* item)
     if (m_vertShaderModule == VK_NULL_HANDLE ||
         m_fragShaderModule == VK_NULL_HANDLE ||
         m_fragCircleModule == VK_NULL_HANDLE ||
-        m_fragCircleModule == VK_NULL_HANDLE) {
+        m_fragCircleModule == VK_NULL_HANDLE ||
+        m_vertDocumentModule == VK_NULL_HANDLE ||
+        m_fragDocumentModule == VK_NULL_HANDLE ||
+        m_vertPointModule == VK_NULL_HANDLE ||
+        m_fragPointModule == VK_NULL_HANDLE ||
+        m_vertRasterModule == VK_NULL_HANDLE ||
+        m_fragRasterModule == VK_NULL_HANDLE ||
+        m_vertTinModule == VK_NULL_HANDLE ||
+        m_fragTinModule == VK_NULL_HANDLE) {
         qWarning("Failed to create shader modules!");
         return;
     }
 
+    m_styleSetLayout = StyleTable::createDescriptorSetLayout(*_vkManager);
+    m_rasterSetLayout = TileAtlas::createDescriptorSetLayout(*_vkManager);
+
     qDebug("Vulkan initialization successful!");
     m_initialized = true;
 }
@@ -208,9 +296,8 @@ void VulkanRenderNode::createBuffer()
         {{100.0f, 0.0f}, {0.2f, 0.2f, 0.7f}}
     };
 
-    bufferLine.allocateMemory(m_verticesLine.size() * sizeof(decltype(m_verticesLine)::value_type));
-    bufferLine.updateMemory(0, m_verticesLine.data(),
-                        m_verticesLine.size() * sizeof(decltype(m_verticesLine)::value_type));
+    bufferLine.allocateMemory(m_verticesLine.size() * sizeof(decltype(m_verticesLine)::value_type),
+                              VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, Vulkan::Buffer::Location::DeviceLocal);
 
     for (float i = -100; i <= 100; i+=0.1) {
         m_verticesNet.push_back({{i, 100.0f}, {0.2f, 0.2f, 0.6f}});
@@ -220,20 +307,31 @@ void VulkanRenderNode::createBuffer()
         m_verticesNet.push_back({{-100.0f, i}, {0.2f, 0.2f, 0.6f}});
     }
 
-    bufferNet.allocateMemory(m_verticesNet.size() * sizeof(decltype(m_verticesNet)::value_type));
-    bufferNet.updateMemory(0, m_verticesNet.data(),
-                        m_verticesNet.size() * sizeof(decltype(m_verticesNet)::value_type));
+    bufferNet.allocateMemory(m_verticesNet.size() * sizeof(decltype(m_verticesNet)::value_type),
+                             VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, Vulkan::Buffer::Location::DeviceLocal);
 
-    bufferAddedLines.allocateMemory(1000 * sizeof(decltype(m_verticesAddedLines)::value_type));
+    bufferPreview.allocateMemory(previewCapacity * sizeof(Geometry::Line),
+                                 VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, Vulkan::Buffer::Location::DeviceLocal);
+
+    bufferHighlight.allocateMemory(highlightCapacity * sizeof(Geometry::Line),
+                                   VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, Vulkan::Buffer::Location::DeviceLocal);
 }
 
 void VulkanRenderNode::createShaderModules()
 {
-    m_vertShaderModule.setShader(vertShaderCode);
-    m_fragShaderModule.setShader(fragShaderCode);
-    m_fragDashShaderModule.setShader(fragDashShaderCode);
-    m_vertCircleModule.setShader(vertCircleShaderCode);
-    m_fragCircleModule.setShader(fragCircleShaderCode);
+    m_vertShaderModule.setShader(Vulkan::SpirvByteCode(Shaders::vertex));
+    m_fragShaderModule.setShader(Vulkan::SpirvByteCode(Shaders::frag));
+    m_fragDashShaderModule.setShader(Vulkan::SpirvByteCode(Shaders::frag_dash_line));
+    m_vertCircleModule.setShader(Vulkan::SpirvByteCode(Shaders::vertex_circle));
+    m_fragCircleModule.setShader(Vulkan::SpirvByteCode(Shaders::frag_circle));
+    m_vertDocumentModule.setShader(Vulkan::SpirvByteCode(Shaders::vertex_document));
+    m_fragDocumentModule.setShader(Vulkan::SpirvByteCode(Shaders::frag_document_line));
+    m_vertPointModule.setShader(Vulkan::SpirvByteCode(Shaders::vertex_point));
+    m_fragPointModule.setShader(Vulkan::SpirvByteCode(Shaders::frag_point));
+    m_vertRasterModule.setShader(Vulkan::SpirvByteCode(Shaders::vertex_raster));
+    m_fragRasterModule.setShader(Vulkan::SpirvByteCode(Shaders::frag_raster));
+    m_vertTinModule.setShader(Vulkan::SpirvByteCode(Shaders::vertex_tin));
+    m_fragTinModule.setShader(Vulkan::SpirvByteCode(Shaders::frag_tin));
 }
 
 void VulkanRenderNode::createTrianglePipeline(VkRenderPass renderPass)
@@ -677,6 +775,45 @@ void VulkanRenderNode::createLinePipeline(VkRenderPass renderPass)
         return;
     }
 
+    // Document lines: the same state with the style table as set 0 and the document shaders
+    if (m_pipelineDocumentLayout == VK_NULL_HANDLE) {
+        VkPushConstantRange pushConstantRange = {};
+        pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+        pushConstantRange.offset = 0;
+        pushConstantRange.size = sizeof(DocumentPushConstants);
+
+        VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
+        pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        pipelineLayoutInfo.pushConstantRangeCount = 1;
+        pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+        pipelineLayoutInfo.setLayoutCount = 1;
+        pipelineLayoutInfo.pSetLayouts = &m_styleSetLayout;
+
+        result = _vkManager->vkCreatePipelineLayout(&pipelineLayoutInfo, nullptr, &m_pipelineDocumentLayout);
+        if (result != VK_SUCCESS) {
+            qWarning("Failed to create document pipeline layout: %d", result);
+            return;
+        }
+    }
+
+    shaderStages[0].module = m_vertDocumentModule;
+    shaderStages[1].module = m_fragDocumentModule;
+    pipelineInfo.layout = m_pipelineDocumentLayout;
+    result = _vkManager->vkCreateGraphicsPipelines(VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_graphicsDocumentLinePipeline);
+    if (result != VK_SUCCESS) {
+        qWarning("Failed to create document line pipeline: %d", result);
+        m_graphicsDocumentLinePipeline = VK_NULL_HANDLE;
+    }
+
+    // Polylines: drawing indexed strips, the restart index ends each polyline
+    inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_LINE_STRIP;
+    inputAssembly.primitiveRestartEnable = VK_TRUE;
+    result = _vkManager->vkCreateGraphicsPipelines(VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_graphicsDocumentStripPipeline);
+    if (result != VK_SUCCESS) {
+        qWarning("Failed to create line strip pipeline: %d", result);
+        m_graphicsDocumentStripPipeline = VK_NULL_HANDLE;
+    }
+
     m_linePipelineCreated = true;
     qDebug("Graphics line pipeline created successfully!");
 }
@@ -690,74 +827,299 @@ void VulkanRenderNode::createCirclePipeline(VkRenderPass renderPass)
     }
 
     // Don't recreate if already created
-    // if (m_linePipelineCreated && m_graphicsLinePipeline != VK_NULL_HANDLE) {
-    //     return;
-    // }
+    if (m_circlePipelineCreated && m_graphicsCirclePipeline != VK_NULL_HANDLE && m_graphicsArcPipeline != VK_NULL_HANDLE) {
+        return;
+    }
 
-    qDebug("Creating graphics pipeline with render pass %p", renderPass);
+    if (m_vertCircleModule == VK_NULL_HANDLE || m_fragCircleModule == VK_NULL_HANDLE) {
+        qWarning("Shader modules not created!");
+        return;
+    }
 
+    VkResult result;
 
-    // if (m_vertShaderModule == VK_NULL_HANDLE || m_fragShaderModule == VK_NULL_HANDLE) {
-    //     qWarning("Shader modules not created!");
-    //     return;
-    // }
+    // Pipeline layout (create if not exists)
+    if (m_pipelineCircleLayout == VK_NULL_HANDLE) {
+        VkPushConstantRange pushConstantRange = {};
+        pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+        pushConstantRange.offset = 0;
+        pushConstantRange.size = sizeof(CirclePushConstants);
+
+        // the style table is set 0 like in the document line pipelines
+        VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
+        pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        pipelineLayoutInfo.pushConstantRangeCount = 1;
+        pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+        pipelineLayoutInfo.setLayoutCount = 1;
+        pipelineLayoutInfo.pSetLayouts = &m_styleSetLayout;
+
+        result = _vkManager->vkCreatePipelineLayout( &pipelineLayoutInfo, nullptr, &m_pipelineCircleLayout);
+        if (result != VK_SUCCESS) {
+            qWarning("Failed to create pipeline layout: %d", result);
+            return;
+        }
+    }
+
+    // Circles and arcs share the shaders, the specialization constant switches the arc code on
+    VkSpecializationMapEntry specializationEntry = {};
+    specializationEntry.constantID = 0;
+    specializationEntry.offset = 0;
+    specializationEntry.size = sizeof(VkBool32);
+
+    // Input assembly, a quad per instance
+    VkPipelineInputAssemblyStateCreateInfo inputAssembly = {};
+    inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+    inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP;
+    inputAssembly.primitiveRestartEnable = VK_FALSE;
+
+    // Viewport and scissor (dynamic)
+    VkPipelineViewportStateCreateInfo viewportState = {};
+    viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+    viewportState.viewportCount = 1;
+    viewportState.pViewports = nullptr; // Dynamic
+    viewportState.scissorCount = 1;
+    viewportState.pScissors = nullptr; // Dynamic
+
+    // Rasterizer
+    VkPipelineRasterizationStateCreateInfo rasterizer = {};
+    rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+    rasterizer.depthClampEnable = VK_FALSE;
+    rasterizer.rasterizerDiscardEnable = VK_FALSE;
+    rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
+    rasterizer.lineWidth = 1.0f;
+    rasterizer.cullMode = VK_CULL_MODE_NONE;
+    rasterizer.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+    rasterizer.depthBiasEnable = VK_FALSE;
+
+    // Multisampling
+    VkPipelineMultisampleStateCreateInfo multisampling = {};
+    multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+    multisampling.sampleShadingEnable = VK_FALSE;
+    multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+    multisampling.minSampleShading = 1.0f;
+
+    // Depth stencil
+    VkPipelineDepthStencilStateCreateInfo depthStencil = {};
+    depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+    depthStencil.depthTestEnable = VK_FALSE;
+    depthStencil.depthWriteEnable = VK_FALSE;
+    depthStencil.depthCompareOp = VK_COMPARE_OP_ALWAYS;
+    depthStencil.minDepthBounds = 0.0f;
+    depthStencil.maxDepthBounds = 1.0f;
+
+    // Color blending, the edges are antialiased through alpha
+    VkPipelineColorBlendAttachmentState colorBlendAttachment = {};
+    colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |
+                                          VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+    colorBlendAttachment.blendEnable = VK_TRUE;
+    colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+    colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+    colorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
+    colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+    colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+    colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
+
+    VkPipelineColorBlendStateCreateInfo colorBlending = {};
+    colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+    colorBlending.logicOpEnable = VK_FALSE;
+    colorBlending.logicOp = VK_LOGIC_OP_COPY;
+    colorBlending.attachmentCount = 1;
+    colorBlending.pAttachments = &colorBlendAttachment;
+
+    // Dynamic state
+    VkDynamicState dynamicStates[] = {
+        VK_DYNAMIC_STATE_VIEWPORT,
+        VK_DYNAMIC_STATE_SCISSOR
+    };
+
+    VkPipelineDynamicStateCreateInfo dynamicState = {};
+    dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+    dynamicState.dynamicStateCount = 2;
+    dynamicState.pDynamicStates = dynamicStates;
+
+    for (VkBool32 isArc : {VK_FALSE, VK_TRUE}) {
+        VkPipeline& pipeline = isArc ? m_graphicsArcPipeline : m_graphicsCirclePipeline;
+        if (pipeline != VK_NULL_HANDLE) {
+            continue;
+        }
+
+        VkSpecializationInfo specializationInfo = {};
+        specializationInfo.mapEntryCount = 1;
+        specializationInfo.pMapEntries = &specializationEntry;
+        specializationInfo.dataSize = sizeof(isArc);
+        specializationInfo.pData = &isArc;
+
+        // Shader stages
+        VkPipelineShaderStageCreateInfo shaderStages[2] = {};
+
+        shaderStages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        shaderStages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
+        shaderStages[0].module = m_vertCircleModule;
+        shaderStages[0].pName = "main";
+        shaderStages[0].pSpecializationInfo = &specializationInfo;
+
+        shaderStages[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        shaderStages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+        shaderStages[1].module = m_fragCircleModule;
+        shaderStages[1].pName = "main";
+        shaderStages[1].pSpecializationInfo = &specializationInfo;
+
+        // Vertex input, the entities themselves advance per instance
+        VkVertexInputBindingDescription bindingDescription = {};
+        bindingDescription.binding = 0;
+        bindingDescription.stride = isArc ? sizeof(Geometry::Arc) : sizeof(Geometry::Circle);
+        bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+
+        static_assert(offsetof(Geometry::Arc, center) == offsetof(Geometry::Circle, center) &&
+                      offsetof(Geometry::Arc, radius) == offsetof(Geometry::Circle, radius) &&
+                      offsetof(Geometry::Arc, color) == offsetof(Geometry::Circle, color),
+                      "circles and arcs share the first attributes");
+
+        VkVertexInputAttributeDescription attributeDescriptions[4] = {};
+        attributeDescriptions[0].binding = 0;
+        attributeDescriptions[0].location = 0;
+        attributeDescriptions[0].format = VK_FORMAT_R32G32_SFLOAT;
+        attributeDescriptions[0].offset = offsetof(Geometry::Circle, center);
+
+        attributeDescriptions[1].binding = 0;
+        attributeDescriptions[1].location = 1;
+        attributeDescriptions[1].format = VK_FORMAT_R32_SFLOAT;
+        attributeDescriptions[1].offset = offsetof(Geometry::Circle, radius);
+
+        attributeDescriptions[2].binding = 0;
+        attributeDescriptions[2].location = 2;
+        attributeDescriptions[2].format = VK_FORMAT_R8G8B8A8_UNORM;
+        attributeDescriptions[2].offset = offsetof(Geometry::Circle, color);
+
+        // circles have no angles, the shader doesn't read them so any 8 bytes of the circle do
+        attributeDescriptions[3].binding = 0;
+        attributeDescriptions[3].location = 3;
+        attributeDescriptions[3].format = VK_FORMAT_R32G32_SFLOAT;
+        attributeDescriptions[3].offset = isArc ? offsetof(Geometry::Arc, startAngle) : 0;
+
+        VkPipelineVertexInputStateCreateInfo vertexInputInfo = {};
+        vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+        vertexInputInfo.vertexBindingDescriptionCount = 1;
+        vertexInputInfo.pVertexBindingDescriptions = &bindingDescription;
+        vertexInputInfo.vertexAttributeDescriptionCount = 4;
+        vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions;
+
+        // Create pipeline
+        VkGraphicsPipelineCreateInfo pipelineInfo = {};
+        pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+        pipelineInfo.stageCount = 2;
+        pipelineInfo.pStages = shaderStages;
+        pipelineInfo.pVertexInputState = &vertexInputInfo;
+        pipelineInfo.pInputAssemblyState = &inputAssembly;
+        pipelineInfo.pTessellationState = nullptr;
+        pipelineInfo.pViewportState = &viewportState;
+        pipelineInfo.pRasterizationState = &rasterizer;
+        pipelineInfo.pMultisampleState = &multisampling;
+        pipelineInfo.pDepthStencilState = &depthStencil;
+        pipelineInfo.pColorBlendState = &colorBlending;
+        pipelineInfo.pDynamicState = &dynamicState;
+        pipelineInfo.layout = m_pipelineCircleLayout;
+        pipelineInfo.renderPass = renderPass;
+        pipelineInfo.subpass = 0;
+        pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+        pipelineInfo.basePipelineIndex = -1;
+
+        result = _vkManager->vkCreateGraphicsPipelines(VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline);
+        if (result != VK_SUCCESS) {
+            qWarning("Failed to create %s pipeline: %d", isArc ? "arc" : "circle", result);
+            pipeline = VK_NULL_HANDLE;
+            return;
+        }
+    }
+
+    m_circlePipelineCreated = true;
+    qDebug("Graphics circle and arc pipelines created successfully!");
+}
+
+void VulkanRenderNode::createPointPipeline(VkRenderPass renderPass)
+{
+    if (renderPass == VK_NULL_HANDLE) {
+        qWarning("Cannot create pipeline: invalid render pass");
+        return;
+    }
+
+    if (m_pointPipelineCreated && m_graphicsPointPipeline != VK_NULL_HANDLE) {
+        return;
+    }
+
+    if (m_vertPointModule == VK_NULL_HANDLE || m_fragPointModule == VK_NULL_HANDLE) {
+        qWarning("Shader modules not created!");
+        return;
+    }
 
     VkResult result;
 
+    // Pipeline layout, the points carry their colors so there is no style table
+    if (m_pipelinePointLayout == VK_NULL_HANDLE) {
+        VkPushConstantRange pushConstantRange = {};
+        pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+        pushConstantRange.offset = 0;
+        pushConstantRange.size = sizeof(PointPushConstants);
+
+        VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
+        pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        pipelineLayoutInfo.pushConstantRangeCount = 1;
+        pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+        result = _vkManager->vkCreatePipelineLayout(&pipelineLayoutInfo, nullptr, &m_pipelinePointLayout);
+        if (result != VK_SUCCESS) {
+            qWarning("Failed to create pipeline layout: %d", result);
+            return;
+        }
+    }
+
     // Shader stages
     VkPipelineShaderStageCreateInfo shaderStages[2] = {};
 
     shaderStages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
     shaderStages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
-    shaderStages[0].module = m_vertCircleModule;
+    shaderStages[0].module = m_vertPointModule;
     shaderStages[0].pName = "main";
-    shaderStages[0].pSpecializationInfo = nullptr;
 
     shaderStages[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
     shaderStages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-    shaderStages[1].module = m_fragCircleModule;
+    shaderStages[1].module = m_fragPointModule;
     shaderStages[1].pName = "main";
-    shaderStages[1].pSpecializationInfo = nullptr;
 
-    // Vertex input
+    // Vertex input, a point per instance
     VkVertexInputBindingDescription bindingDescription = {};
     bindingDescription.binding = 0;
-    bindingDescription.stride = sizeof(Geometry::Vertex);
-    bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+    bindingDescription.stride = sizeof(Geometry::CloudPoint);
+    bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
 
     VkVertexInputAttributeDescription attributeDescriptions[2] = {};
     attributeDescriptions[0].binding = 0;
     attributeDescriptions[0].location = 0;
     attributeDescriptions[0].format = VK_FORMAT_R32G32_SFLOAT;
-    attributeDescriptions[0].offset = offsetof(Geometry::Vertex, pos);
+    attributeDescriptions[0].offset = offsetof(Geometry::CloudPoint, pos);
 
     attributeDescriptions[1].binding = 0;
     attributeDescriptions[1].location = 1;
-    attributeDescriptions[1].format = VK_FORMAT_R32G32B32_SFLOAT;
-    attributeDescriptions[1].offset = offsetof(Geometry::Vertex, color);
+    attributeDescriptions[1].format = VK_FORMAT_R8G8B8A8_UNORM;
+    attributeDescriptions[1].offset = offsetof(Geometry::CloudPoint, color);
 
     VkPipelineVertexInputStateCreateInfo vertexInputInfo = {};
     vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-    vertexInputInfo.pNext = nullptr;
-    vertexInputInfo.flags = 0;
     vertexInputInfo.vertexBindingDescriptionCount = 1;
     vertexInputInfo.pVertexBindingDescriptions = &bindingDescription;
     vertexInputInfo.vertexAttributeDescriptionCount = 2;
     vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions;
 
-    // Input assembly
+    // Input assembly, a quad per instance; POINT_LIST would need the largePoints feature for
+    // anything but one pixel
     VkPipelineInputAssemblyStateCreateInfo inputAssembly = {};
     inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-    inputAssembly.pNext = nullptr;
-    inputAssembly.flags = 0;
-    inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_LINE_LIST;
+    inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP;
     inputAssembly.primitiveRestartEnable = VK_FALSE;
 
     // Viewport and scissor (dynamic)
     VkPipelineViewportStateCreateInfo viewportState = {};
     viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
-    viewportState.pNext = nullptr;
-    viewportState.flags = 0;
     viewportState.viewportCount = 1;
     viewportState.pViewports = nullptr; // Dynamic
     viewportState.scissorCount = 1;
@@ -766,8 +1128,6 @@ void VulkanRenderNode::createCirclePipeline(VkRenderPass renderPass)
     // Rasterizer
     VkPipelineRasterizationStateCreateInfo rasterizer = {};
     rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
-    rasterizer.pNext = nullptr;
-    rasterizer.flags = 0;
     rasterizer.depthClampEnable = VK_FALSE;
     rasterizer.rasterizerDiscardEnable = VK_FALSE;
     rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
@@ -775,109 +1135,53 @@ void VulkanRenderNode::createCirclePipeline(VkRenderPass renderPass)
     rasterizer.cullMode = VK_CULL_MODE_NONE;
     rasterizer.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
     rasterizer.depthBiasEnable = VK_FALSE;
-    rasterizer.depthBiasConstantFactor = 0.0f;
-    rasterizer.depthBiasClamp = 0.0f;
-    rasterizer.depthBiasSlopeFactor = 0.0f;
 
     // Multisampling
     VkPipelineMultisampleStateCreateInfo multisampling = {};
     multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
-    multisampling.pNext = nullptr;
-    multisampling.flags = 0;
     multisampling.sampleShadingEnable = VK_FALSE;
     multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
     multisampling.minSampleShading = 1.0f;
-    multisampling.pSampleMask = nullptr;
-    multisampling.alphaToCoverageEnable = VK_FALSE;
-    multisampling.alphaToOneEnable = VK_FALSE;
 
     // Depth stencil
     VkPipelineDepthStencilStateCreateInfo depthStencil = {};
     depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
-    depthStencil.pNext = nullptr;
-    depthStencil.flags = 0;
     depthStencil.depthTestEnable = VK_FALSE;
     depthStencil.depthWriteEnable = VK_FALSE;
     depthStencil.depthCompareOp = VK_COMPARE_OP_ALWAYS;
-    depthStencil.depthBoundsTestEnable = VK_FALSE;
-    depthStencil.stencilTestEnable = VK_FALSE;
     depthStencil.minDepthBounds = 0.0f;
     depthStencil.maxDepthBounds = 1.0f;
 
-    // Color blending
+    // Color blending, off: the points are opaque and millions of them overlap
     VkPipelineColorBlendAttachmentState colorBlendAttachment = {};
-    colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | 
+    colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |
                                           VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
-    colorBlendAttachment.blendEnable = VK_TRUE;
-    colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
-    colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
-    colorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
-    colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
-    colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
-    colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
+    colorBlendAttachment.blendEnable = VK_FALSE;
 
     VkPipelineColorBlendStateCreateInfo colorBlending = {};
     colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
-    colorBlending.pNext = nullptr;
-    colorBlending.flags = 0;
     colorBlending.logicOpEnable = VK_FALSE;
     colorBlending.logicOp = VK_LOGIC_OP_COPY;
     colorBlending.attachmentCount = 1;
     colorBlending.pAttachments = &colorBlendAttachment;
-    colorBlending.blendConstants[0] = 0.0f;
-    colorBlending.blendConstants[1] = 0.0f;
-    colorBlending.blendConstants[2] = 0.0f;
-    colorBlending.blendConstants[3] = 0.0f;
 
     // Dynamic state
     VkDynamicState dynamicStates[] = {
-        VK_DYNAMIC_STATE_VIEWPORT, 
-        VK_DYNAMIC_STATE_SCISSOR,
-        VK_DYNAMIC_STATE_LINE_WIDTH
+        VK_DYNAMIC_STATE_VIEWPORT,
+        VK_DYNAMIC_STATE_SCISSOR
     };
 
     VkPipelineDynamicStateCreateInfo dynamicState = {};
     dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
-    dynamicState.pNext = nullptr;
-    dynamicState.flags = 0;
-    dynamicState.dynamicStateCount = 3;
+    dynamicState.dynamicStateCount = 2;
     dynamicState.pDynamicStates = dynamicStates;
 
-    // Pipeline layout (create if not exists)
-    if (m_pipelineLineLayout == VK_NULL_HANDLE) {
-        VkPushConstantRange pushConstantRanges[2];
-        pushConstantRanges[0].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
-        pushConstantRanges[0].offset = 0;
-        pushConstantRanges[0].size = sizeof(float) * 2;
-
-        pushConstantRanges[1].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
-        pushConstantRanges[1].offset = sizeof(float) * 2;
-        pushConstantRanges[1].size = sizeof(float);
-
-
-        VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
-        pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-        pipelineLayoutInfo.pushConstantRangeCount = 2;
-        pipelineLayoutInfo.pPushConstantRanges = pushConstantRanges;
-        pipelineLayoutInfo.setLayoutCount = 0;
-        pipelineLayoutInfo.pSetLayouts = nullptr;
-
-        result = _vkManager->vkCreatePipelineLayout( &pipelineLayoutInfo, nullptr, &m_pipelineCircleLayout);
-        if (result != VK_SUCCESS) {
-            qWarning("Failed to create pipeline layout: %d", result);
-            return;
-        }
-        qDebug("Pipeline layout created: %p", m_pipelineTriangleLayout);
-    }
-
     // Create pipeline
     VkGraphicsPipelineCreateInfo pipelineInfo = {};
     pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-    pipelineInfo.pNext = nullptr;
-    pipelineInfo.flags = 0;
     pipelineInfo.stageCount = 2;
     pipelineInfo.pStages = shaderStages;
-    pipelineInfo.pVertexInputState = nullptr;
+    pipelineInfo.pVertexInputState = &vertexInputInfo;
     pipelineInfo.pInputAssemblyState = &inputAssembly;
     pipelineInfo.pTessellationState = nullptr;
     pipelineInfo.pViewportState = &viewportState;
@@ -886,41 +1190,357 @@ void VulkanRenderNode::createCirclePipeline(VkRenderPass renderPass)
     pipelineInfo.pDepthStencilState = &depthStencil;
     pipelineInfo.pColorBlendState = &colorBlending;
     pipelineInfo.pDynamicState = &dynamicState;
-    pipelineInfo.layout = m_pipelineLineLayout;
+    pipelineInfo.layout = m_pipelinePointLayout;
     pipelineInfo.renderPass = renderPass;
     pipelineInfo.subpass = 0;
     pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
     pipelineInfo.basePipelineIndex = -1;
 
-    // qDebug("Calling vkCreateGraphicsPipelines...");
-    // qDebug("  Device: %p", _vkManager->device());
-    // qDebug("  Pipeline layout: %p", m_pipelineCircleLayout);
-    // qDebug("  Render pass: %p", renderPass);
-    // qDebug("  Vert shader: %p", m_vertCircleModule);
-    // qDebug("  Frag shader: %p", m_fragCircleModule);
+    result = _vkManager->vkCreateGraphicsPipelines(VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_graphicsPointPipeline);
+    if (result != VK_SUCCESS) {
+        qWarning("Failed to create point pipeline: %d", result);
+        m_graphicsPointPipeline = VK_NULL_HANDLE;
+        return;
+    }
+
+    m_pointPipelineCreated = true;
+    qDebug("Graphics point pipeline created successfully!");
+}
+
+void VulkanRenderNode::createRasterPipeline(VkRenderPass renderPass)
+{
+    if (renderPass == VK_NULL_HANDLE) {
+        qWarning("Cannot create pipeline: invalid render pass");
+        return;
+    }
+
+    if (m_rasterPipelineCreated && m_graphicsRasterPipeline != VK_NULL_HANDLE) {
+        return;
+    }
+
+    if (m_vertRasterModule == VK_NULL_HANDLE || m_fragRasterModule == VK_NULL_HANDLE) {
+        qWarning("Shader modules not created!");
+        return;
+    }
+
+    VkResult result;
+
+    // Pipeline layout, the atlas is the only set
+    if (m_pipelineRasterLayout == VK_NULL_HANDLE) {
+        VkPushConstantRange pushConstantRange = {};
+        pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+        pushConstantRange.offset = 0;
+        pushConstantRange.size = sizeof(RasterView::PushConstants);
+
+        VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
+        pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        pipelineLayoutInfo.setLayoutCount = 1;
+        pipelineLayoutInfo.pSetLayouts = &m_rasterSetLayout;
+        pipelineLayoutInfo.pushConstantRangeCount = 1;
+        pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+        result = _vkManager->vkCreatePipelineLayout(&pipelineLayoutInfo, nullptr, &m_pipelineRasterLayout);
+        if (result != VK_SUCCESS) {
+            qWarning("Failed to create pipeline layout: %d", result);
+            return;
+        }
+    }
+
+    // Shader stages
+    VkPipelineShaderStageCreateInfo shaderStages[2] = {};
+
+    shaderStages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    shaderStages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
+    shaderStages[0].module = m_vertRasterModule;
+    shaderStages[0].pName = "main";
 
-    result = _vkManager->vkCreateGraphicsPipelines(VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_graphicsCirclePipeline);
+    shaderStages[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    shaderStages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+    shaderStages[1].module = m_fragRasterModule;
+    shaderStages[1].pName = "main";
+
+    // No vertex input, the corners of the tile come from the vertex index
+    VkPipelineVertexInputStateCreateInfo vertexInputInfo = {};
+    vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+
+    // Input assembly, a quad per tile
+    VkPipelineInputAssemblyStateCreateInfo inputAssembly = {};
+    inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+    inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP;
+    inputAssembly.primitiveRestartEnable = VK_FALSE;
+
+    // Viewport and scissor (dynamic)
+    VkPipelineViewportStateCreateInfo viewportState = {};
+    viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+    viewportState.viewportCount = 1;
+    viewportState.pViewports = nullptr; // Dynamic
+    viewportState.scissorCount = 1;
+    viewportState.pScissors = nullptr; // Dynamic
+
+    // Rasterizer
+    VkPipelineRasterizationStateCreateInfo rasterizer = {};
+    rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+    rasterizer.depthClampEnable = VK_FALSE;
+    rasterizer.rasterizerDiscardEnable = VK_FALSE;
+    rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
+    rasterizer.lineWidth = 1.0f;
+    rasterizer.cullMode = VK_CULL_MODE_NONE;
+    rasterizer.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+    rasterizer.depthBiasEnable = VK_FALSE;
+
+    // Multisampling
+    VkPipelineMultisampleStateCreateInfo multisampling = {};
+    multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+    multisampling.sampleShadingEnable = VK_FALSE;
+    multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+    multisampling.minSampleShading = 1.0f;
+
+    // Depth stencil
+    VkPipelineDepthStencilStateCreateInfo depthStencil = {};
+    depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+    depthStencil.depthTestEnable = VK_FALSE;
+    depthStencil.depthWriteEnable = VK_FALSE;
+    depthStencil.depthCompareOp = VK_COMPARE_OP_ALWAYS;
+    depthStencil.minDepthBounds = 0.0f;
+    depthStencil.maxDepthBounds = 1.0f;
+
+    // Color blending, the images are transparent outside their footprint and where they have no data
+    VkPipelineColorBlendAttachmentState colorBlendAttachment = {};
+    colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |
+                                          VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+    colorBlendAttachment.blendEnable = VK_TRUE;
+    colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+    colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+    colorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
+    colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+    colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+    colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
+
+    VkPipelineColorBlendStateCreateInfo colorBlending = {};
+    colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+    colorBlending.logicOpEnable = VK_FALSE;
+    colorBlending.logicOp = VK_LOGIC_OP_COPY;
+    colorBlending.attachmentCount = 1;
+    colorBlending.pAttachments = &colorBlendAttachment;
+
+    // Dynamic state
+    VkDynamicState dynamicStates[] = {
+        VK_DYNAMIC_STATE_VIEWPORT,
+        VK_DYNAMIC_STATE_SCISSOR
+    };
+
+    VkPipelineDynamicStateCreateInfo dynamicState = {};
+    dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+    dynamicState.dynamicStateCount = 2;
+    dynamicState.pDynamicStates = dynamicStates;
+
+    // Create pipeline
+    VkGraphicsPipelineCreateInfo pipelineInfo = {};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    pipelineInfo.stageCount = 2;
+    pipelineInfo.pStages = shaderStages;
+    pipelineInfo.pVertexInputState = &vertexInputInfo;
+    pipelineInfo.pInputAssemblyState = &inputAssembly;
+    pipelineInfo.pTessellationState = nullptr;
+    pipelineInfo.pViewportState = &viewportState;
+    pipelineInfo.pRasterizationState = &rasterizer;
+    pipelineInfo.pMultisampleState = &multisampling;
+    pipelineInfo.pDepthStencilState = &depthStencil;
+    pipelineInfo.pColorBlendState = &colorBlending;
+    pipelineInfo.pDynamicState = &dynamicState;
+    pipelineInfo.layout = m_pipelineRasterLayout;
+    pipelineInfo.renderPass = renderPass;
+    pipelineInfo.subpass = 0;
+    pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+    pipelineInfo.basePipelineIndex = -1;
+
+    result = _vkManager->vkCreateGraphicsPipelines(VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_graphicsRasterPipeline);
     if (result != VK_SUCCESS) {
-        qWarning("Failed to create graphics pipeline: %d", result);
-        m_graphicsCirclePipeline = VK_NULL_HANDLE;
+        qWarning("Failed to create raster pipeline: %d", result);
+        m_graphicsRasterPipeline = VK_NULL_HANDLE;
         return;
     }
 
-    m_circlePipelineCreated = true;
-    qDebug("Graphics line pipeline created successfully!");
+    m_rasterPipelineCreated = true;
+    qDebug("Graphics raster pipeline created successfully!");
 }
 
-void VulkanRenderNode::updateVertexBuffer()
+void VulkanRenderNode::createTinPipeline(VkRenderPass renderPass)
 {
-    bufferTriangle.updateMemory(0, m_verticesTriangle.data(), m_verticesTriangle.size() * sizeof(decltype(m_verticesTriangle)::value_type));
+    if (renderPass == VK_NULL_HANDLE) {
+        qWarning("Cannot create pipeline: invalid render pass");
+        return;
+    }
+
+    if (m_tinPipelineCreated && m_graphicsTinPipeline != VK_NULL_HANDLE) {
+        return;
+    }
+
+    if (m_vertTinModule == VK_NULL_HANDLE || m_fragTinModule == VK_NULL_HANDLE) {
+        qWarning("Shader modules not created!");
+        return;
+    }
+
+    VkResult result;
+
+    // Pipeline layout, no sets; the fragment shader reads the color, range and flags too
+    if (m_pipelineTinLayout == VK_NULL_HANDLE) {
+        VkPushConstantRange pushConstantRange = {};
+        pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+        pushConstantRange.offset = 0;
+        pushConstantRange.size = sizeof(TinView::PushConstants);
+
+        VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
+        pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        pipelineLayoutInfo.setLayoutCount = 0;
+        pipelineLayoutInfo.pSetLayouts = nullptr;
+        pipelineLayoutInfo.pushConstantRangeCount = 1;
+        pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+        result = _vkManager->vkCreatePipelineLayout(&pipelineLayoutInfo, nullptr, &m_pipelineTinLayout);
+        if (result != VK_SUCCESS) {
+            qWarning("Failed to create pipeline layout: %d", result);
+            return;
+        }
+    }
+
+    // Shader stages
+    VkPipelineShaderStageCreateInfo shaderStages[2] = {};
+
+    shaderStages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    shaderStages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
+    shaderStages[0].module = m_vertTinModule;
+    shaderStages[0].pName = "main";
+
+    shaderStages[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    shaderStages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+    shaderStages[1].module = m_fragTinModule;
+    shaderStages[1].pName = "main";
+
+    // Vertex input, the corners of the triangles one after another, relative to the surface's origin
+    VkVertexInputBindingDescription bindingDescription = {};
+    bindingDescription.binding = 0;
+    bindingDescription.stride = 3 * sizeof(float);
+    bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+    VkVertexInputAttributeDescription attributeDescription = {};
+    attributeDescription.binding = 0;
+    attributeDescription.location = 0;
+    attributeDescription.format = VK_FORMAT_R32G32B32_SFLOAT;
+    attributeDescription.offset = 0;
+
+    VkPipelineVertexInputStateCreateInfo vertexInputInfo = {};
+    vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+    vertexInputInfo.vertexBindingDescriptionCount = 1;
+    vertexInputInfo.pVertexBindingDescriptions = &bindingDescription;
+    vertexInputInfo.vertexAttributeDescriptionCount = 1;
+    vertexInputInfo.pVertexAttributeDescriptions = &attributeDescription;
+
+    // Input assembly, not indexed so every corner knows its place in the triangle for the wireframe
+    VkPipelineInputAssemblyStateCreateInfo inputAssembly = {};
+    inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+    inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+    inputAssembly.primitiveRestartEnable = VK_FALSE;
+
+    // Viewport and scissor (dynamic)
+    VkPipelineViewportStateCreateInfo viewportState = {};
+    viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+    viewportState.viewportCount = 1;
+    viewportState.pViewports = nullptr; // Dynamic
+    viewportState.scissorCount = 1;
+    viewportState.pScissors = nullptr; // Dynamic
+
+    // Rasterizer
+    VkPipelineRasterizationStateCreateInfo rasterizer = {};
+    rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+    rasterizer.depthClampEnable = VK_FALSE;
+    rasterizer.rasterizerDiscardEnable = VK_FALSE;
+    rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
+    rasterizer.lineWidth = 1.0f;
+    rasterizer.cullMode = VK_CULL_MODE_NONE;
+    rasterizer.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+    rasterizer.depthBiasEnable = VK_FALSE;
+
+    // Multisampling
+    VkPipelineMultisampleStateCreateInfo multisampling = {};
+    multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+    multisampling.sampleShadingEnable = VK_FALSE;
+    multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+    multisampling.minSampleShading = 1.0f;
+
+    // Depth stencil
+    VkPipelineDepthStencilStateCreateInfo depthStencil = {};
+    depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+    depthStencil.depthTestEnable = VK_FALSE;
+    depthStencil.depthWriteEnable = VK_FALSE;
+    depthStencil.depthCompareOp = VK_COMPARE_OP_ALWAYS;
+    depthStencil.minDepthBounds = 0.0f;
+    depthStencil.maxDepthBounds = 1.0f;
+
+    // Color blending, the wireframe fades out at the edges of its lines
+    VkPipelineColorBlendAttachmentState colorBlendAttachment = {};
+    colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |
+                                          VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+    colorBlendAttachment.blendEnable = VK_TRUE;
+    colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+    colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+    colorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
+    colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+    colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+    colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
+
+    VkPipelineColorBlendStateCreateInfo colorBlending = {};
+    colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+    colorBlending.logicOpEnable = VK_FALSE;
+    colorBlending.logicOp = VK_LOGIC_OP_COPY;
+    colorBlending.attachmentCount = 1;
+    colorBlending.pAttachments = &colorBlendAttachment;
+
+    // Dynamic state
+    VkDynamicState dynamicStates[] = {
+        VK_DYNAMIC_STATE_VIEWPORT,
+        VK_DYNAMIC_STATE_SCISSOR
+    };
+
+    VkPipelineDynamicStateCreateInfo dynamicState = {};
+    dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+    dynamicState.dynamicStateCount = 2;
+    dynamicState.pDynamicStates = dynamicStates;
+
+    // Create pipeline
+    VkGraphicsPipelineCreateInfo pipelineInfo = {};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    pipelineInfo.stageCount = 2;
+    pipelineInfo.pStages = shaderStages;
+    pipelineInfo.pVertexInputState = &vertexInputInfo;
+    pipelineInfo.pInputAssemblyState = &inputAssembly;
+    pipelineInfo.pTessellationState = nullptr;
+    pipelineInfo.pViewportState = &viewportState;
+    pipelineInfo.pRasterizationState = &rasterizer;
+    pipelineInfo.pMultisampleState = &multisampling;
+    pipelineInfo.pDepthStencilState = &depthStencil;
+    pipelineInfo.pColorBlendState = &colorBlending;
+    pipelineInfo.pDynamicState = &dynamicState;
+    pipelineInfo.layout = m_pipelineTinLayout;
+    pipelineInfo.renderPass = renderPass;
+    pipelineInfo.subpass = 0;
+    pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+    pipelineInfo.basePipelineIndex = -1;
+
+    result = _vkManager->vkCreateGraphicsPipelines(VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_graphicsTinPipeline);
+    if (result != VK_SUCCESS) {
+        qWarning("Failed to create TIN pipeline: %d", result);
+        m_graphicsTinPipeline = VK_NULL_HANDLE;
+        return;
+    }
+
+    m_tinPipelineCreated = true;
+    qDebug("Graphics TIN pipeline created successfully!");
 }
 
-void VulkanRenderNode::updateVertexAddedLinesBuffer(const Geometry::Line& line, size_t index)
+void VulkanRenderNode::updateVertexBuffer()
 {
-    decltype(m_verticesAddedLines)::value_type* data = new decltype(m_verticesAddedLines)::value_type;
-    *data = m_verticesAddedLines.at(index);
-    bufferAddedLines.updateMemory(index * sizeof(decltype(m_verticesAddedLines)::value_type), data, sizeof(decltype(m_verticesAddedLines)::value_type));
-    m_verticesAddedLinesDirty = false;
+    bufferTriangle.updateMemory(0, m_verticesTriangle.data(), m_verticesTriangle.size() * sizeof(decltype(m_verticesTriangle)::value_type));
 }
 
 void VulkanRenderNode::updateVertexPosition(const QPointF& position)
@@ -940,6 +1560,137 @@ void VulkanRenderNode::updateVertexPosition(const QPointF& position)
     updateVertexBuffer();
 }
 
+void VulkanRenderNode::applyCommand(const RenderCommand& command)
+{
+    if (auto camera = std::get_if<RenderCommands::SetCamera>(&command)) {
+        m_camera = camera->camera;
+    } else if (auto document = std::get_if<RenderCommands::SetDocument>(&command)) {
+        if (!m_documentView.store() || m_documentView.store()->document() != document->document) {
+            m_documentView.setStore(DocumentGpuStore::shared(_vkManager, document->document));
+        }
+        m_documentView.store()->setSnapshot(document->snapshot);
+        m_pointCloudView.setSnapshot(document->snapshot);
+        m_rasterView.setSnapshot(document->snapshot);
+        m_tinView.setSnapshot(document->snapshot);
+        // the hovered entity may have moved
+        if (m_hovered) {
+            m_highlight = highlightLines(*m_documentView.store(), m_hovered, highlightCapacity);
+            m_highlightDirty = true;
+        }
+    } else if (auto preview = std::get_if<RenderCommands::SetPreview>(&command)) {
+        m_preview = preview->lines;
+        // a handful of circles, drawn as lines like the rest of the preview
+        for (const Geometry::Circle& circle : preview->circles) {
+            appendCircle(m_preview, circle, Geometry::unpackColor(circle.color));
+        }
+        if (m_preview.size() > previewCapacity) {
+            qWarning("Preview has %zu lines, only %zu are drawn", m_preview.size(), previewCapacity);
+            m_preview.resize(previewCapacity);
+        }
+        m_previewDirty = true;
+    } else if (auto pick = std::get_if<RenderCommands::SetPickPoint>(&command)) {
+        m_pickPoint = pick->position;
+        if (!m_pickPoint) {
+            setHovered({});
+        }
+    }
+}
+
+void VulkanRenderNode::setHovered(const Geometry::EntityRef& hovered)
+{
+    if (hovered == m_hovered)
+        return;
+
+    m_hovered = hovered;
+    m_highlight = m_documentView.store() ? highlightLines(*m_documentView.store(), m_hovered, highlightCapacity)
+                                         : std::vector<Geometry::Line>{};
+    m_highlightDirty = true;
+    if (m_onHovered) {
+        m_onHovered(m_hovered);
+    }
+}
+
+void VulkanRenderNode::prepare()
+{
+    if (!m_initialized)
+        return;
+
+    // prepare() runs first in every frame, so everything rendered below sees the same state
+    m_commands->drain([this](const RenderCommand& command) { applyCommand(command); });
+
+    // copies can't be recorded inside the render pass render() is called in
+    VkCommandBuffer commandBuffer = *_vkManager->getResource<VkCommandBuffer>(QSGRendererInterface::CommandListResource);
+    if (commandBuffer == VK_NULL_HANDLE)
+        return;
+
+    QQuickWindow::GraphicsStateInfo stateInfo = _vkManager->itemWindow()->graphicsStateInfo();
+    _vkManager->memoryAllocator().beginFrame(stateInfo.framesInFlight);
+    m_stagingRing.beginFrame(stateInfo.currentFrameSlot, stateInfo.framesInFlight);
+
+    // Qt waited for the slot, what the pick recorded in it the last time is readable now
+    if (m_picker && m_documentView.store()) {
+        std::optional<Geometry::EntityRef> picked = m_picker->collect(stateInfo.currentFrameSlot, *m_documentView.store());
+        if (picked && m_pickPoint) {
+            setHovered(*picked);
+        }
+    }
+
+    if (!m_staticBuffersUploaded) {
+        m_staticBuffersUploaded =
+            bufferLine.upload(m_stagingRing, 0, m_verticesLine.data(),
+                              m_verticesLine.size() * sizeof(decltype(m_verticesLine)::value_type)) &&
+            bufferNet.upload(m_stagingRing, 0, m_verticesNet.data(),
+                             m_verticesNet.size() * sizeof(decltype(m_verticesNet)::value_type));
+    }
+    if (m_documentView.store()) {
+        m_documentView.store()->upload(m_stagingRing);
+    }
+
+    // everything visible in clip space [-1, 1] mapped back to document coordinates
+    QMatrix4x4 transform = addedLinesTransform();
+    QRectF view = transform.inverted().mapRect(QRectF(-1, -1, 2, 2));
+    if (!m_pointCloudView.empty() || !m_rasterView.empty() || !m_tinView.empty()) {
+        // clip space is 2 wide across the item, the camera doesn't shear so a column's length is the scale
+        double pixelsPerUnit = std::hypot(transform(0, 0), transform(1, 0)) * 0.5 *
+                               _vkManager->item()->width() * _vkManager->itemWindow()->devicePixelRatio();
+        if (!m_pointCloudView.empty()) {
+            m_pointCloudView.prepare(m_stagingRing, view, pixelsPerUnit);
+        }
+        if (!m_rasterView.empty()) {
+            m_rasterView.prepare(m_stagingRing, view, pixelsPerUnit);
+        }
+        if (!m_tinView.empty()) {
+            m_tinView.prepare(m_stagingRing, view, pixelsPerUnit);
+        }
+    }
+    if (m_previewDirty && (m_preview.empty() ||
+                           bufferPreview.upload(m_stagingRing, 0, m_preview.data(),
+                                                m_preview.size() * sizeof(Geometry::Line)))) {
+        m_previewDirty = false;
+        m_previewUploaded = m_preview.size();
+    }
+    if (m_highlightDirty && (m_highlight.empty() ||
+                             bufferHighlight.upload(m_stagingRing, 0, m_highlight.data(),
+                                                    m_highlight.size() * sizeof(Geometry::Line)))) {
+        m_highlightDirty = false;
+        m_highlightUploaded = m_highlight.size();
+    }
+
+    m_stagingRing.flush(commandBuffer);
+
+    m_documentView.cull(commandBuffer, view);
+
+    // the ids come back when the slot is used again, one or two frames from now
+    if (m_pickPoint && m_documentView.store()) {
+        if (!m_picker) {
+            m_picker = std::make_unique<Picker>(_vkManager);
+        }
+        qreal dpr = _vkManager->itemWindow()->devicePixelRatio();
+        m_picker->record(commandBuffer, stateInfo.currentFrameSlot, stateInfo.framesInFlight, *m_documentView.store(),
+                         addedLinesTransform(), _vkManager->item()->size() * dpr, *m_pickPoint);
+    }
+}
+
 void VulkanRenderNode::render(const RenderState *state)
 {
     if (!m_initialized || m_commandBuffer == VK_NULL_HANDLE)
@@ -956,10 +1707,10 @@ void VulkanRenderNode::render(const RenderState *state)
     if (!m_trianglePipelineCreated) {
         createTrianglePipeline(currentRenderPass);
         createLinePipeline(currentRenderPass);
-    }
-
-    if (m_circlePipelineCreated) {
         createCirclePipeline(currentRenderPass);
+        createPointPipeline(currentRenderPass);
+        createRasterPipeline(currentRenderPass);
+        createTinPipeline(currentRenderPass);
     }
 
     if (m_graphicsTrianglePipeline == VK_NULL_HANDLE)
@@ -980,10 +1731,45 @@ void VulkanRenderNode::recordCommandBuffer(const RenderState *state)
 
     // Use Qt's command buffer instead of our own
     VkCommandBuffer commandBuffer = qtCommandBuffer;
+    drawRasters(commandBuffer);
     drawNet(commandBuffer);
     drawLine(commandBuffer);
     // drawTriangle(commandBuffer);
+    drawTins(commandBuffer);
+    drawPointClouds(commandBuffer);
     drawAddedLines(commandBuffer);
+    drawCurves(commandBuffer);
+    drawHighlight(commandBuffer);
+    drawPreview(commandBuffer);
+}
+
+void VulkanRenderNode::drawRasters(VkCommandBuffer commandBuffer)
+{
+    if (m_rasterView.empty() || m_graphicsRasterPipeline == VK_NULL_HANDLE)
+        return;
+
+    // Set viewport and scissor, the first pass of the frame
+    QRectF rect = matrix()->mapRect(QRectF(0, 0, _vkManager->item()->width(), _vkManager->item()->height()));
+    qreal dpr = _vkManager->itemWindow()->devicePixelRatio();
+    rect.setWidth(dpr*rect.width());
+    rect.setHeight(dpr*rect.height());
+    _viewPort= rect;
+    VkViewport viewport = {};
+    viewport.x = rect.x() * dpr;
+    viewport.y = rect.y() * dpr;
+    viewport.width = rect.width();
+    viewport.height = rect.height();
+    viewport.minDepth = 0.0f;
+    viewport.maxDepth = 1.0f;
+    _vkManager->vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+
+    VkRect2D scissor = {};
+    scissor.offset = {(int32_t)rect.x(), (int32_t)rect.y()};
+    scissor.extent = {(uint32_t)rect.width(), (uint32_t)rect.height()};
+    _vkManager->vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+
+    _vkManager->vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_graphicsRasterPipeline);
+    m_rasterView.draw(commandBuffer, m_pipelineRasterLayout, addedLinesTransform());
 }
 
 void VulkanRenderNode::drawTriangle(VkCommandBuffer commandBuffer)
@@ -1001,7 +1787,7 @@ void VulkanRenderNode::drawTriangle(VkCommandBuffer commandBuffer)
     projection.perspective(qDegreesToRadians(90), 1.0f, 1.0f, 5.0f);
     // projection.data()[1 + 1*4] *= -1;
     QMatrix4x4 mvp = projection * view * model;
-    mvp.scale(VulkanRenderNode::z);
+    mvp.scale(m_camera.zoom);
 
     vkCmdPushConstants(
         commandBuffer,
@@ -1052,12 +1838,8 @@ void VulkanRenderNode::drawNet(VkCommandBuffer commandBuffer)
     float angle = time;
 
     QMatrix4x4 mvp = {};
-    static float localZ = 1;
-    // static float localMax = 1.0f;
-    // if (localZ < 0.3) {
-    //     localMax = 1 / z;
-    // }
-    localZ = z;
+    float localZ = m_camera.zoom;
+    QPointF pos = m_camera.offset;
     mvp.scale(localZ);
     mvp.translate((float)(pos.x()/itemSize.width())/localZ, (float)(pos.y()/itemSize.height())/localZ, 0);
     if (itemSize.width() > itemSize.height()) {
@@ -1106,30 +1888,14 @@ void VulkanRenderNode::drawNet(VkCommandBuffer commandBuffer)
     _vkManager->vkCmdDraw(commandBuffer, m_verticesNet.size(), 1, 0, 0);
 }
 
-void VulkanRenderNode::drawAddedLines(VkCommandBuffer commandBuffer)
+QMatrix4x4 VulkanRenderNode::addedLinesTransform() const
 {
-    auto itemSize = _vkManager->item()->size();
-
-    QMatrix4x4 mvp = {};
-    static float localZ = 1;
-    // static float localMax = 1.0f;
-    // if (localZ < 0.3) {
-    //     localMax = 1 / z;
-    // }
-    localZ = z;
-    mvp.scale(localZ);
-    mvp.translate((float)(pos.x()/itemSize.width())/localZ, (float)(pos.y()/itemSize.height())/localZ, 0);
-    vkCmdPushConstants(
-        commandBuffer,
-        m_pipelineLineLayout,
-        VK_SHADER_STAGE_VERTEX_BIT,
-        0,
-        sizeof(QMatrix4x4),
-        mvp.constData()
-    );
+    return m_camera.documentToClip(_vkManager->item()->size());
+}
 
-    // Bind pipeline
-    _vkManager->vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_graphicsLinePipeline);
+void VulkanRenderNode::drawAddedLines(VkCommandBuffer commandBuffer)
+{
+    QMatrix4x4 mvp = addedLinesTransform();
 
     // Set viewport and scissor
     QRectF rect = matrix()->mapRect(QRectF(0, 0, _vkManager->item()->width(), _vkManager->item()->height()));
@@ -1151,13 +1917,170 @@ void VulkanRenderNode::drawAddedLines(VkCommandBuffer commandBuffer)
     scissor.extent = {(uint32_t)rect.width(), (uint32_t)rect.height()};
    _vkManager->vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
 
+    if (!m_documentView.store() || m_graphicsDocumentLinePipeline == VK_NULL_HANDLE ||
+        m_graphicsDocumentStripPipeline == VK_NULL_HANDLE)
+        return;
+
+    DocumentPushConstants constants = {};
+    std::copy(mvp.constData(), mvp.constData() + 16, constants.transform);
+    constants.viewport[0] = viewport.x;
+    constants.viewport[1] = viewport.y;
+    constants.viewport[2] = viewport.width;
+    constants.viewport[3] = viewport.height;
+
+    // chunks were culled in prepare()
+    VkDescriptorSet styles = m_documentView.store()->styleTable().descriptorSet();
+    _vkManager->vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelineDocumentLayout,
+                                        0, 1, &styles, 0, nullptr);
+    drawDocumentLayers(commandBuffer, m_graphicsDocumentLinePipeline, constants, &DocumentView::draw);
+    drawDocumentLayers(commandBuffer, m_graphicsDocumentStripPipeline, constants, &DocumentView::drawPolylines);
+}
+
+void VulkanRenderNode::drawDocumentLayers(VkCommandBuffer commandBuffer, VkPipeline pipeline,
+                                          DocumentPushConstants& constants,
+                                          void (DocumentView::*draw)(VkCommandBuffer, size_t))
+{
+    _vkManager->vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+    const std::vector<Geometry::LayerStyle>& styles = m_documentView.store()->styles();
+    for (size_t layer = 0; layer < m_documentView.layerCount(); ++layer) {
+        if (!m_documentView.layerVisible(layer))
+            continue;
+        constants.layer = (uint32_t)layer;
+        _vkManager->vkCmdPushConstants(
+            commandBuffer,
+            m_pipelineDocumentLayout,
+            VK_SHADER_STAGE_VERTEX_BIT,
+            0,
+            sizeof(DocumentPushConstants),
+            &constants
+        );
+        // the width is rasterizer state, the shaders can't take it from the table
+        _vkManager->vkCmdSetLineWidth(commandBuffer, styles[layer].width);
+        (m_documentView.*draw)(commandBuffer, layer);
+    }
+}
+
+void VulkanRenderNode::drawCurves(VkCommandBuffer commandBuffer)
+{
+    // viewport and scissor are still the ones drawAddedLines() set
+    if (!m_documentView.store() || m_graphicsCirclePipeline == VK_NULL_HANDLE || m_graphicsArcPipeline == VK_NULL_HANDLE)
+        return;
+
+    // the push constant ranges differ from the document line layout, so the set has to be bound again
+    VkDescriptorSet styles = m_documentView.store()->styleTable().descriptorSet();
+    _vkManager->vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelineCircleLayout,
+                                        0, 1, &styles, 0, nullptr);
+
+    CirclePushConstants constants = {};
+    QMatrix4x4 mvp = addedLinesTransform();
+    std::copy(mvp.constData(), mvp.constData() + 16, constants.transform);
+    constants.viewportSize[0] = (float)_viewPort.width();
+    constants.viewportSize[1] = (float)_viewPort.height();
+
+    for (VkPipeline pipeline : {m_graphicsCirclePipeline, m_graphicsArcPipeline}) {
+        _vkManager->vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+        for (size_t layer = 0; layer < m_documentView.layerCount(); ++layer) {
+            if (!m_documentView.layerVisible(layer))
+                continue;
+            constants.layer = (uint32_t)layer;
+            _vkManager->vkCmdPushConstants(
+                commandBuffer,
+                m_pipelineCircleLayout,
+                VK_SHADER_STAGE_VERTEX_BIT,
+                0,
+                sizeof(CirclePushConstants),
+                &constants
+            );
+            if (pipeline == m_graphicsCirclePipeline) {
+                m_documentView.drawCircles(commandBuffer, layer);
+            } else {
+                m_documentView.drawArcs(commandBuffer, layer);
+            }
+        }
+    }
+}
+
+void VulkanRenderNode::drawTins(VkCommandBuffer commandBuffer)
+{
+    // viewport and scissor are the ones drawLine() set
+    if (m_tinView.empty() || m_graphicsTinPipeline == VK_NULL_HANDLE)
+        return;
+
+    _vkManager->vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_graphicsTinPipeline);
+    m_tinView.draw(commandBuffer, m_pipelineTinLayout, addedLinesTransform());
+}
+
+void VulkanRenderNode::drawPointClouds(VkCommandBuffer commandBuffer)
+{
+    // viewport and scissor are the ones drawLine() set, the scans lie under every entity
+    if (m_pointCloudView.empty() || m_graphicsPointPipeline == VK_NULL_HANDLE)
+        return;
+
+    PointPushConstants constants = {};
+    QMatrix4x4 mvp = addedLinesTransform();
+    std::copy(mvp.constData(), mvp.constData() + 16, constants.transform);
+    constants.viewportSize[0] = (float)_viewPort.width();
+    constants.viewportSize[1] = (float)_viewPort.height();
+    constants.pointSize = 2.0f * (float)_vkManager->itemWindow()->devicePixelRatio();
+
+    _vkManager->vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_graphicsPointPipeline);
+    _vkManager->vkCmdPushConstants(
+        commandBuffer,
+        m_pipelinePointLayout,
+        VK_SHADER_STAGE_VERTEX_BIT,
+        0,
+        sizeof(PointPushConstants),
+        &constants
+    );
+    m_pointCloudView.draw(commandBuffer);
+}
+
+void VulkanRenderNode::drawPreview(VkCommandBuffer commandBuffer)
+{
+    if (m_previewUploaded == 0)
+        return;
+
+    // on top of everything, the curve pipelines may have been bound since drawAddedLines()
+    QMatrix4x4 mvp = addedLinesTransform();
+    _vkManager->vkCmdPushConstants(
+        commandBuffer,
+        m_pipelineLineLayout,
+        VK_SHADER_STAGE_VERTEX_BIT,
+        0,
+        sizeof(QMatrix4x4),
+        mvp.constData()
+    );
+    _vkManager->vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_graphicsLinePipeline);
     _vkManager->vkCmdSetLineWidth(commandBuffer, 3);
 
-    VkBuffer vertexBuffers[] = {bufferAddedLines};
+    VkBuffer vertexBuffers[] = {bufferPreview};
     VkDeviceSize offsets[] = {0};
     _vkManager->vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
+    _vkManager->vkCmdDraw(commandBuffer, m_previewUploaded * 2, 1, 0, 0);
+}
+
+void VulkanRenderNode::drawHighlight(VkCommandBuffer commandBuffer)
+{
+    if (m_highlightUploaded == 0)
+        return;
 
-    _vkManager->vkCmdDraw(commandBuffer, m_verticesAddedLines.size() * 2, 1, 0, 0);
+    // over the document and under the preview, wider than any entity so the outline shows
+    QMatrix4x4 mvp = addedLinesTransform();
+    _vkManager->vkCmdPushConstants(
+        commandBuffer,
+        m_pipelineLineLayout,
+        VK_SHADER_STAGE_VERTEX_BIT,
+        0,
+        sizeof(QMatrix4x4),
+        mvp.constData()
+    );
+    _vkManager->vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_graphicsLinePipeline);
+    _vkManager->vkCmdSetLineWidth(commandBuffer, 6);
+
+    VkBuffer vertexBuffers[] = {bufferHighlight};
+    VkDeviceSize offsets[] = {0};
+    _vkManager->vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
+    _vkManager->vkCmdDraw(commandBuffer, m_highlightUploaded * 2, 1, 0, 0);
 }
 
 void VulkanRenderNode::drawLine(VkCommandBuffer commandBuffer)
@@ -1165,6 +2088,7 @@ void VulkanRenderNode::drawLine(VkCommandBuffer commandBuffer)
     auto itemSize = _vkManager->item()->size();
 
 
+    QPointF pos = m_camera.offset;
     QMatrix4x4 i = {};
     i.translate((float)(pos.x()/itemSize.width()), (float)(pos.y()/itemSize.height()), 0);
 
@@ -1230,11 +2154,81 @@ void VulkanRenderNode::releaseResources()
         m_graphicsLinePipeline = VK_NULL_HANDLE;
     }
 
+    if (m_graphicsDocumentLinePipeline != VK_NULL_HANDLE) {
+        _vkManager->vkDestroyPipeline(m_graphicsDocumentLinePipeline, nullptr);
+        m_graphicsDocumentLinePipeline = VK_NULL_HANDLE;
+    }
+
+    if (m_graphicsDocumentStripPipeline != VK_NULL_HANDLE) {
+        _vkManager->vkDestroyPipeline(m_graphicsDocumentStripPipeline, nullptr);
+        m_graphicsDocumentStripPipeline = VK_NULL_HANDLE;
+    }
+
+    if (m_pipelineDocumentLayout != VK_NULL_HANDLE) {
+        _vkManager->vkDestroyPipelineLayout(m_pipelineDocumentLayout, nullptr);
+        m_pipelineDocumentLayout = VK_NULL_HANDLE;
+    }
+
     if (m_pipelineLineLayout != VK_NULL_HANDLE) {
         _vkManager->vkDestroyPipelineLayout(m_pipelineLineLayout, nullptr);
         m_pipelineLineLayout = VK_NULL_HANDLE;
     }
 
+    if (m_graphicsCirclePipeline != VK_NULL_HANDLE) {
+        _vkManager->vkDestroyPipeline(m_graphicsCirclePipeline, nullptr);
+        m_graphicsCirclePipeline = VK_NULL_HANDLE;
+    }
+
+    if (m_graphicsArcPipeline != VK_NULL_HANDLE) {
+        _vkManager->vkDestroyPipeline(m_graphicsArcPipeline, nullptr);
+        m_graphicsArcPipeline = VK_NULL_HANDLE;
+    }
+
+    if (m_pipelineCircleLayout != VK_NULL_HANDLE) {
+        _vkManager->vkDestroyPipelineLayout(m_pipelineCircleLayout, nullptr);
+        m_pipelineCircleLayout = VK_NULL_HANDLE;
+    }
+
+    if (m_graphicsPointPipeline != VK_NULL_HANDLE) {
+        _vkManager->vkDestroyPipeline(m_graphicsPointPipeline, nullptr);
+        m_graphicsPointPipeline = VK_NULL_HANDLE;
+    }
+
+    if (m_pipelinePointLayout != VK_NULL_HANDLE) {
+        _vkManager->vkDestroyPipelineLayout(m_pipelinePointLayout, nullptr);
+        m_pipelinePointLayout = VK_NULL_HANDLE;
+    }
+
+    if (m_graphicsRasterPipeline != VK_NULL_HANDLE) {
+        _vkManager->vkDestroyPipeline(m_graphicsRasterPipeline, nullptr);
+        m_graphicsRasterPipeline = VK_NULL_HANDLE;
+    }
+
+    if (m_pipelineRasterLayout != VK_NULL_HANDLE) {
+        _vkManager->vkDestroyPipelineLayout(m_pipelineRasterLayout, nullptr);
+        m_pipelineRasterLayout = VK_NULL_HANDLE;
+    }
+
+    if (m_graphicsTinPipeline != VK_NULL_HANDLE) {
+        _vkManager->vkDestroyPipeline(m_graphicsTinPipeline, nullptr);
+        m_graphicsTinPipeline = VK_NULL_HANDLE;
+    }
+
+    if (m_pipelineTinLayout != VK_NULL_HANDLE) {
+        _vkManager->vkDestroyPipelineLayout(m_pipelineTinLayout, nullptr);
+        m_pipelineTinLayout = VK_NULL_HANDLE;
+    }
+
+    if (m_rasterSetLayout != VK_NULL_HANDLE) {
+        _vkManager->vkDestroyDescriptorSetLayout(m_rasterSetLayout, nullptr);
+        m_rasterSetLayout = VK_NULL_HANDLE;
+    }
+
+    if (m_styleSetLayout != VK_NULL_HANDLE) {
+        _vkManager->vkDestroyDescriptorSetLayout(m_styleSetLayout, nullptr);
+        m_styleSetLayout = VK_NULL_HANDLE;
+    }
+
     // if (m_vertShaderModule != VK_NULL_HANDLE) {
     //     _vkManager->devFuncs()->vkDestroyShaderModule(_vkManager->device(), m_vertShaderModule, nullptr);
     //     m_vertShaderModule = VK_NULL_HANDLE;
@@ -1298,6 +2292,8 @@ void VulkanRenderNode::releaseResources()
     //     m_vertexAddedLinesBufferMemory = VK_NULL_HANDLE;
     // }
 
+    m_picker.reset();
+
     if (m_commandBuffer != VK_NULL_HANDLE && m_commandPool != VK_NULL_HANDLE) {
         _vkManager->vkFreeCommandBuffers(m_commandPool, 1, &m_commandBuffer);
         m_commandBuffer = VK_NULL_HANDLE;
@@ -1321,10 +2317,3 @@ QSGRenderNode::RenderingFlags VulkanRenderNode::flags() const
     return BoundedRectRendering | DepthAwareRendering;
 }
 
-void VulkanRenderNode::connectController(MainWindow* controller)
-{
-    m_verticesAddedLines = controller->lines;
-    m_verticesAddedLines.subscribe([this](const Geometry::Line& line, size_t index) {
-        updateVertexAddedLinesBuffer(line, index);
-    });
-}
\ No newline at end of file
@@ -5,25 +5,37 @@
 #include <QVulkanInstance>
 #include <QVulkanFunctions>
 #include <QVulkanDeviceFunctions>
+#include <functional>
 #include <memory>
+#include <optional>
 
 #include "Geometry/Line.h"
-#include "Library/Flux/MutableList.h"
 #include "Library/Flux/Mutable.h"
 #include "Library/Vulkan/Buffer.h"
 #include "Library/Vulkan/ShaderModule.h"
 #include "Library/Vulkan/SpirvByteCode.h"
+#include "Library/Vulkan/StagingRing.h"
 #include "Library/Vulkan/VulkanManager.h"
-#include "UI/cpp/MainWindow.h"
-
-class MainWindow;
+#include "UI/cpp/Camera.h"
+#include "UI/cpp/DocumentGpuStore.h"
+#include "UI/cpp/DocumentView.h"
+#include "UI/cpp/Geometry/EntityRef.h"
+#include "UI/cpp/Picker.h"
+#include "UI/cpp/PointCloudView.h"
+#include "UI/cpp/RasterView.h"
+#include "UI/cpp/TinView.h"
+#include "UI/cpp/RenderCommandQueue.h"
 
 class VulkanRenderNode : public QSGRenderNode
 {
 public:
-    VulkanRenderNode(QQuickItem *item, MainWindow* controller);
+    // called on the render thread whenever the entity under the pick point changes
+    using HoveredCallback = std::function<void(const Geometry::EntityRef&)>;
+
+    VulkanRenderNode(QQuickItem *item, std::shared_ptr<RenderCommandQueue> commands, HoveredCallback hovered);
     ~VulkanRenderNode();
 
+    void prepare() override;
     void render(const RenderState *state) override;
     void releaseResources() override;
     StateFlags changedStates() const override;
@@ -31,12 +43,26 @@ public:
 
     void updateVertexPosition(const QPointF& position);
 
-    void connectController(MainWindow* controller);
-
-    static float z;
-    static QPointF pos;
-
 private:
+    // layout of the push constants in vertex_document.vert
+    struct DocumentPushConstants {
+        float transform[16];
+        // x, y, width, height in framebuffer pixels
+        float viewport[4];
+        // index into the style table
+        uint32_t layer;
+    };
+
+    // layout of the push constants in vertex_circle.vert
+    struct CirclePushConstants {
+        float transform[16];
+        float viewportSize[2];
+        // index into the style table
+        uint32_t layer;
+        // only read by the pick pass
+        uint32_t firstId;
+    };
+
     void initVulkan(QQuickItem* item);
     void createCommandPool();
     void createTriangleVertexBuffer();
@@ -51,17 +77,40 @@ private:
     void createTrianglePipeline(VkRenderPass renderPass);
     void createLinePipeline(VkRenderPass renderPass);
     void createCirclePipeline(VkRenderPass renderPass);
+    void createPointPipeline(VkRenderPass renderPass);
+    void createRasterPipeline(VkRenderPass renderPass);
+    void createTinPipeline(VkRenderPass renderPass);
 
     void recordCommandBuffer(const RenderState *state);
     void updateVertexBuffer();
-    void updateVertexAddedLinesBuffer(const Geometry::Line& line, size_t index);
 
     void drawTriangle(VkCommandBuffer);
+    // the images of the document, under the grid and everything else
+    void drawRasters(VkCommandBuffer);
     void drawLine(VkCommandBuffer);
     void drawNet(VkCommandBuffer);
     void drawAddedLines(VkCommandBuffer);
+    // the document lines or polylines of every visible layer with the pipeline bound
+    void drawDocumentLayers(VkCommandBuffer, VkPipeline pipeline, DocumentPushConstants& constants,
+                            void (DocumentView::*draw)(VkCommandBuffer, size_t));
+    void drawCurves(VkCommandBuffer);
+    // the surfaces of the document, under the point clouds
+    void drawTins(VkCommandBuffer);
+    void drawPointClouds(VkCommandBuffer);
+    void drawPreview(VkCommandBuffer);
+    void drawHighlight(VkCommandBuffer);
+
+    void applyCommand(const RenderCommand& command);
+    // rebuilds the highlight outline and tells the item
+    void setHovered(const Geometry::EntityRef& hovered);
+
+    // document to clip space for the added lines, also gives the culling rectangle
+    QMatrix4x4 addedLinesTransform() const;
 
     std::shared_ptr<Vulkan::VulkanManager> _vkManager;
+    std::shared_ptr<RenderCommandQueue> m_commands;
+    // render thread copy of the item's camera, only changed by commands
+    Camera m_camera;
 
     VkQueue m_graphicsQueue = VK_NULL_HANDLE;
     VkCommandBuffer m_commandBuffer = VK_NULL_HANDLE;
@@ -87,13 +136,37 @@ private:
     Vulkan::Buffer bufferTriangle;
     Vulkan::Buffer bufferLine;
     Vulkan::Buffer bufferNet;
-    Vulkan::Buffer bufferAddedLines;
+    Vulkan::Buffer bufferPreview;
+    Vulkan::Buffer bufferHighlight;
+
+    Vulkan::StagingRing m_stagingRing;
+    // the geometry lives in the document's DocumentGpuStore, shared with the other views
+    DocumentView m_documentView;
+    // the point clouds of the document, streamed into memory of this view
+    PointCloudView m_pointCloudView;
+    // the images of the document, their tiles streamed into the atlas of this view
+    RasterView m_rasterView;
+    // the surfaces of the document, their chunks streamed into memory of this view
+    TinView m_tinView;
 
     Vulkan::ShaderModule m_vertShaderModule;
     Vulkan::ShaderModule m_fragShaderModule;
     Vulkan::ShaderModule m_fragDashShaderModule;
     Vulkan::ShaderModule m_vertCircleModule;
     Vulkan::ShaderModule m_fragCircleModule;
+    Vulkan::ShaderModule m_vertDocumentModule;
+    Vulkan::ShaderModule m_fragDocumentModule;
+    Vulkan::ShaderModule m_vertPointModule;
+    Vulkan::ShaderModule m_fragPointModule;
+    Vulkan::ShaderModule m_vertRasterModule;
+    Vulkan::ShaderModule m_fragRasterModule;
+    Vulkan::ShaderModule m_vertTinModule;
+    Vulkan::ShaderModule m_fragTinModule;
+
+    // set 0 of the document pipelines, defined like the set of the store's StyleTable
+    VkDescriptorSetLayout m_styleSetLayout = VK_NULL_HANDLE;
+    // set 0 of the raster pipeline, defined like the set of the view's TileAtlas
+    VkDescriptorSetLayout m_rasterSetLayout = VK_NULL_HANDLE;
 
     VkPipelineLayout m_pipelineTriangleLayout = VK_NULL_HANDLE;
     VkPipeline m_graphicsTrianglePipeline = VK_NULL_HANDLE;
@@ -101,28 +174,66 @@ private:
     VkPipelineLayout m_pipelineLineLayout = VK_NULL_HANDLE;
     VkPipeline m_graphicsLinePipeline = VK_NULL_HANDLE;
 
+    VkPipelineLayout m_pipelineDocumentLayout = VK_NULL_HANDLE;
+    // document lines styled by their layer
+    VkPipeline m_graphicsDocumentLinePipeline = VK_NULL_HANDLE;
+    // the same drawing indexed strips with primitive restart
+    VkPipeline m_graphicsDocumentStripPipeline = VK_NULL_HANDLE;
+
     VkPipelineLayout m_pipelineCircleLayout = VK_NULL_HANDLE;
     VkPipeline m_graphicsCirclePipeline = VK_NULL_HANDLE;
+    VkPipeline m_graphicsArcPipeline = VK_NULL_HANDLE;
+
+    // layout of the push constants in vertex_point.vert
+    struct PointPushConstants {
+        float transform[16];
+        float viewportSize[2];
+        // in framebuffer pixels
+        float pointSize;
+    };
+    VkPipelineLayout m_pipelinePointLayout = VK_NULL_HANDLE;
+    VkPipeline m_graphicsPointPipeline = VK_NULL_HANDLE;
+
+    // the push constants are RasterView::PushConstants
+    VkPipelineLayout m_pipelineRasterLayout = VK_NULL_HANDLE;
+    VkPipeline m_graphicsRasterPipeline = VK_NULL_HANDLE;
+
+    // the push constants are TinView::PushConstants
+    VkPipelineLayout m_pipelineTinLayout = VK_NULL_HANDLE;
+    VkPipeline m_graphicsTinPipeline = VK_NULL_HANDLE;
 
     bool m_initialized = false;
     bool m_trianglePipelineCreated = false;
     bool m_linePipelineCreated = false;
     bool m_circlePipelineCreated = false;
+    bool m_pointPipelineCreated = false;
+    bool m_rasterPipelineCreated = false;
+    bool m_tinPipelineCreated = false;
 
     // Store vertices for dynamic updates
     std::vector<Geometry::Vertex> m_verticesTriangle;
     std::vector<Geometry::Vertex> m_verticesLine;
     std::vector<Geometry::Vertex> m_verticesNet;
-    Flux::MutableList<Geometry::Line> m_verticesAddedLines;
+    std::vector<Geometry::Line> m_preview;
+    // lines of the preview already in bufferPreview
+    size_t m_previewUploaded = 0;
+    static constexpr size_t previewCapacity = 1024;
+
+    // framebuffer pixels of the item, nullopt while the cursor is away or picking is off
+    std::optional<QPointF> m_pickPoint;
+    // created with the first pick point
+    std::unique_ptr<Picker> m_picker;
+    Geometry::EntityRef m_hovered;
+    HoveredCallback m_onHovered;
+    // the hovered entity as lines, circles and arcs tessellated
+    std::vector<Geometry::Line> m_highlight;
+    size_t m_highlightUploaded = 0;
+    bool m_highlightDirty = false;
+    static constexpr size_t highlightCapacity = 1024;
 
     QRectF _viewPort {};
 
     bool m_verticesDirty = false;
-    bool m_verticesAddedLinesDirty = true;
-
-    Vulkan::SpirvByteCode vertShaderCode;
-    Vulkan::SpirvByteCode fragShaderCode;
-    Vulkan::SpirvByteCode fragDashShaderCode;
-    Vulkan::SpirvByteCode fragCircleShaderCode;
-    Vulkan::SpirvByteCode vertCircleShaderCode;
+    bool m_staticBuffersUploaded = false;
+    bool m_previewDirty = false;
 };
\ No newline at end of file
@@ -68,24 +68,47 @@ ApplicationWindow {
                         mainWindow.addLineWithAngleMode();
                     }
                 }
+                GeoButton {
+                    text: "addCircle"
+                    onClicked: {
+                        mainWindow.addCircleMode();
+                    }
+                }
             }
         }
         spacing: 0
-        VulkanItem {
-            id: vulkanItem
+        SplitView {
             Layout.fillWidth: true
             Layout.fillHeight: true
-            controller: mainWindow
-            Rectangle {
-                anchors.fill: parent
-                color: '#9db0c4'
-                border.color: "white"
-                anchors.margins: 0
+            orientation: Qt.Horizontal
+
+            // overview and detail of the same drawing, each view keeps its own camera
+            VulkanItem {
+                id: overviewItem
+                SplitView.preferredWidth: parent.width / 3
+                SplitView.minimumWidth: 100
+                controller: mainWindow
+                Rectangle {
+                    anchors.fill: parent
+                    color: '#9db0c4'
+                    border.color: "white"
+                    anchors.margins: 0
+                }
+            }
+            VulkanItem {
+                id: vulkanItem
+                SplitView.fillWidth: true
+                controller: mainWindow
+                Rectangle {
+                    anchors.fill: parent
+                    color: '#9db0c4'
+                    border.color: "white"
+                    anchors.margins: 0
+                }
+                // Component.onCompleted: {
+                //     vulkanItem.addingLine.connect(mainWindow.lineSignal);
+                // } 
             }
-            anchors.margins: 0
-            // Component.onCompleted: {
-            //     vulkanItem.addingLine.connect(mainWindow.lineSignal);
-            // } 
         }
     }
 }
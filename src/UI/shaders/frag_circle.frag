@@ -1,14 +1,46 @@
 #version 450
 
-layout(location = 0) in vec2 v_uv;
+layout(constant_id = 0) const bool isArc = false;
+
+layout(location = 0) in vec2 localPos;
+layout(location = 1) flat in float radius;
+layout(location = 2) flat in vec4 color;
+layout(location = 3) flat in vec2 angles;
+layout(location = 4) flat in float lineWidth;
+layout(location = 5) flat in float dash;
+
 layout(location = 0) out vec4 outColor;
-layout(push_constant) uniform PC { vec2 center; float radius; vec4 color; } pc;
-
-void main() {
-    vec2 p = v_uv;
-    float dist = distance(p, pc.center);
-    float edge = abs(fwidth(dist));
-    float alpha = 1.0 - smoothstep(pc.radius - edge, pc.radius + edge, dist);
-    if (alpha <= 0.0) discard;
-    outColor = vec4(pc.color.rgb, pc.color.a * alpha);
+
+const float twoPi = 6.28318530718;
+
+void main()
+{
+    float centerDistance = length(localPos);
+    // distance to the curve in document units
+    float dist = abs(centerDistance - radius);
+    // one pixel in document units, keeps the edge a pixel wide at any zoom
+    float pixel = fwidth(centerDistance);
+
+    // from the start of the arc, from angle 0 for circles
+    float angle = mod(atan(localPos.y, localPos.x) - angles.x, twoPi);
+    if (dash > 0.0 && mod(angle * radius / pixel, 2.0 * dash) > dash) {
+        discard;
+    }
+
+    if (isArc) {
+        if (angle > angles.y) {
+            // outside the sweep only the round caps at the end points are drawn
+            float endAngle = angles.x + angles.y;
+            vec2 start = radius * vec2(cos(angles.x), sin(angles.x));
+            vec2 end = radius * vec2(cos(endAngle), sin(endAngle));
+            dist = min(distance(localPos, start), distance(localPos, end));
+        }
+    }
+
+    float halfWidth = lineWidth * 0.5 * pixel;
+    float alpha = 1.0 - smoothstep(halfWidth - pixel * 0.5, halfWidth + pixel * 0.5, dist);
+    if (alpha <= 0.0) {
+        discard;
+    }
+    outColor = vec4(color.rgb, color.a * alpha);
 }
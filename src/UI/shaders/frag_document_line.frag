@@ -0,0 +1,16 @@
+#version 450
+
+layout(location = 0) in vec3 fragColor;
+layout(location = 1) flat in vec2 dashOrigin;
+layout(location = 2) flat in float dash;
+
+layout(location = 0) out vec4 outColor;
+
+void main()
+{
+    // dash, gap of the same length, dash; a pattern of 0 draws solid
+    if (dash > 0.0 && mod(distance(gl_FragCoord.xy, dashOrigin), 2.0 * dash) > dash) {
+        discard;
+    }
+    outColor = vec4(fragColor, 1.0);
+}
@@ -0,0 +1,15 @@
+#version 450
+
+layout(location = 0) in vec2 localPos;
+layout(location = 1) flat in vec4 color;
+
+layout(location = 0) out vec4 outColor;
+
+void main()
+{
+    // round sprites, the corners of the square are cut
+    if (dot(localPos, localPos) > 1.0) {
+        discard;
+    }
+    outColor = color;
+}
@@ -0,0 +1,17 @@
+#version 450
+
+layout(location = 0) in vec2 localPos;
+layout(location = 1) flat in vec2 slotOrigin;
+layout(location = 2) flat in float slotSize;
+
+layout(set = 0, binding = 0) uniform sampler2D atlas;
+
+layout(location = 0) out vec4 outColor;
+
+void main()
+{
+    // half a texel inside the slot, the linear filter never reaches the neighbouring tiles
+    float texels = slotSize * textureSize(atlas, 0).x;
+    vec2 local = clamp(localPos, vec2(0.5 / texels), vec2(1.0 - 0.5 / texels));
+    outColor = texture(atlas, slotOrigin + local * slotSize);
+}
@@ -0,0 +1,49 @@
+#version 450
+
+layout(location = 0) in vec3 position;
+layout(location = 1) in vec3 barycentric;
+
+layout(location = 0) out vec4 outColor;
+
+layout(push_constant) uniform PushConstants {
+    mat4 transform;
+    vec4 color;
+    vec2 elevationRange;
+    uint flags;
+} pushConstants;
+
+// low to high: green, yellow, brown, white
+vec3 ramp(float t)
+{
+    vec3 colors[4] = vec3[](vec3(0.25, 0.55, 0.3), vec3(0.85, 0.8, 0.45), vec3(0.6, 0.42, 0.3), vec3(0.95, 0.95, 0.95));
+    float scaled = clamp(t, 0.0, 1.0) * 3.0;
+    int index = min(int(scaled), 2);
+    return mix(colors[index], colors[index + 1], scaled - float(index));
+}
+
+void main()
+{
+    if ((pushConstants.flags & 1u) != 0u) {
+        // about a pixel wide whatever the size of the triangle, faded at the border
+        vec3 pixels = barycentric / fwidth(barycentric);
+        float alpha = 1.0 - clamp(min(min(pixels.x, pixels.y), pixels.z) - 0.5, 0.0, 1.0);
+        if (alpha <= 0.0) {
+            discard;
+        }
+        outColor = vec4(pushConstants.color.rgb, alpha);
+        return;
+    }
+
+    // the facet's normal, turned up; y of the document points south
+    vec3 normal = normalize(cross(dFdx(position), dFdy(position)));
+    if (normal.z < 0.0) {
+        normal = -normal;
+    }
+    // lit from the northwest, 45 degrees up
+    const vec3 light = normalize(vec3(-1.0, -1.0, 1.4142));
+    float shade = 0.35 + 0.65 * max(dot(normal, light), 0.0);
+    vec2 range = pushConstants.elevationRange;
+    float t = range.y > range.x ? (position.z - range.x) / (range.y - range.x) : 0.5;
+    vec3 base = (pushConstants.flags & 2u) != 0u ? pushConstants.color.rgb : ramp(t);
+    outColor = vec4(base * shade, 1.0);
+}
@@ -0,0 +1,10 @@
+#version 450
+
+layout(location = 0) flat in uint id;
+
+layout(location = 0) out uint outId;
+
+void main()
+{
+    outId = id;
+}
@@ -0,0 +1,34 @@
+#version 450
+
+// The coverage test of frag_circle.frag without antialiasing and dashes, writing the entity id
+
+layout(constant_id = 0) const bool isArc = false;
+
+layout(location = 0) in vec2 localPos;
+layout(location = 1) flat in float radius;
+layout(location = 3) flat in vec2 angles;
+layout(location = 4) flat in float lineWidth;
+layout(location = 6) flat in uint id;
+
+layout(location = 0) out uint outId;
+
+const float twoPi = 6.28318530718;
+
+void main()
+{
+    float centerDistance = length(localPos);
+    float dist = abs(centerDistance - radius);
+    float pixel = fwidth(centerDistance);
+
+    if (isArc && mod(atan(localPos.y, localPos.x) - angles.x, twoPi) > angles.y) {
+        float endAngle = angles.x + angles.y;
+        vec2 start = radius * vec2(cos(angles.x), sin(angles.x));
+        vec2 end = radius * vec2(cos(endAngle), sin(endAngle));
+        dist = min(distance(localPos, start), distance(localPos, end));
+    }
+
+    if (dist > (lineWidth * 0.5 + 0.5) * pixel) {
+        discard;
+    }
+    outId = id;
+}
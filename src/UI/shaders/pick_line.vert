@@ -0,0 +1,25 @@
+#version 450
+
+// Document lines or polylines into the pick buffer, every segment carries the id of its entity
+
+// polylines are drawn as indexed strips, their id is the pool vertex the segment starts at
+layout(constant_id = 0) const bool isStrip = false;
+
+layout(location = 0) in vec2 inPos;
+
+layout(location = 0) flat out uint id;
+
+layout(push_constant) uniform PushConstants {
+    mat4 transform;
+    vec2 viewportSize;
+    uint layer;
+    // id of the first entity of the draw, 0 is left for nothing
+    uint firstId;
+} pushConstants;
+
+void main()
+{
+    gl_Position = pushConstants.transform * vec4(inPos, 0, 1.0);
+    // the provoking vertex is the first of the segment
+    id = pushConstants.firstId + uint(isStrip ? gl_VertexIndex : gl_VertexIndex / 2);
+}
@@ -1,10 +1,64 @@
 #version 450
 
-layout(location = 0) out vec2 v_uv;
+// one instance per circle or arc, expanded to a quad around it
+layout(constant_id = 0) const bool isArc = false;
 
-void main() {
-    vec2 pos = vec2((gl_VertexIndex==0)?-1.0:3.0, (gl_VertexIndex==1)?-1.0:3.0);
-    gl_Position = vec4(pos, 0.0, 1.0);
+layout(location = 0) in vec2 inCenter;
+layout(location = 1) in float inRadius;
+layout(location = 2) in vec4 inColor;
+// start angle and sweep, not read for circles
+layout(location = 3) in vec2 inAngles;
 
-    v_uv = gl_Position.xy * 0.5 + 0.5;
+layout(location = 0) out vec2 localPos;
+layout(location = 1) flat out float radius;
+layout(location = 2) flat out vec4 color;
+layout(location = 3) flat out vec2 angles;
+// in pixels, from the style of the layer
+layout(location = 4) flat out float lineWidth;
+layout(location = 5) flat out float dash;
+// for the pick pass, see pick_circle.frag
+layout(location = 6) flat out uint id;
+
+// Geometry::LayerStyle
+struct Style {
+    uint color;
+    float width;
+    float dash;
+    uint flags;
+};
+
+const uint overrideColor = 2;
+
+layout(std430, set = 0, binding = 0) readonly buffer Styles {
+    Style styles[];
+};
+
+layout(push_constant) uniform PushConstants {
+    mat4 transform;
+    vec2 viewportSize;
+    uint layer;
+    // id of the first instance in the pick pass
+    uint firstId;
+} pushConstants;
+
+void main()
+{
+    Style style = styles[pushConstants.layer];
+    lineWidth = style.width;
+    dash = style.dash;
+
+    // document units per pixel, the quad is grown by the line width plus a pixel for the edge
+    vec2 clipPerUnit = vec2(length(pushConstants.transform[0].xy), length(pushConstants.transform[1].xy));
+    vec2 unitsPerPixel = 2.0 / (pushConstants.viewportSize * clipPerUnit);
+    float pad = (lineWidth * 0.5 + 1.0) * max(unitsPerPixel.x, unitsPerPixel.y);
+
+    // triangle strip: (-1,-1) (1,-1) (-1,1) (1,1)
+    vec2 corner = vec2((gl_VertexIndex & 1) * 2 - 1, (gl_VertexIndex >> 1) * 2 - 1);
+    localPos = corner * (inRadius + pad);
+    gl_Position = pushConstants.transform * vec4(inCenter + localPos, 0.0, 1.0);
+
+    radius = inRadius;
+    color = (style.flags & overrideColor) != 0 ? unpackUnorm4x8(style.color) : inColor;
+    angles = isArc ? inAngles : vec2(0.0);
+    id = pushConstants.firstId + uint(gl_InstanceIndex);
 }
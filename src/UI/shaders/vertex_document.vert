@@ -0,0 +1,43 @@
+#version 450
+
+// Document lines and polylines, styled by the entry of their layer in the style table
+
+layout(location = 0) in vec2 inPos;
+layout(location = 1) in vec3 inColor;
+
+layout(location = 0) out vec3 fragColor;
+// where the segment starts in framebuffer pixels, dashes are measured from there
+layout(location = 1) flat out vec2 dashOrigin;
+layout(location = 2) flat out float dash;
+
+// Geometry::LayerStyle
+struct Style {
+    uint color;
+    float width;
+    float dash;
+    uint flags;
+};
+
+const uint overrideColor = 2;
+
+layout(std430, set = 0, binding = 0) readonly buffer Styles {
+    Style styles[];
+};
+
+layout(push_constant) uniform PushConstants {
+    mat4 transform;
+    // x, y, width, height of the viewport in framebuffer pixels
+    vec4 viewport;
+    uint layer;
+} pushConstants;
+
+void main()
+{
+    gl_Position = pushConstants.transform * vec4(inPos, 0, 1.0);
+
+    Style style = styles[pushConstants.layer];
+    fragColor = (style.flags & overrideColor) != 0 ? unpackUnorm4x8(style.color).rgb : inColor;
+    // the provoking vertex is the first of the segment
+    dashOrigin = pushConstants.viewport.xy + (gl_Position.xy / gl_Position.w * 0.5 + 0.5) * pushConstants.viewport.zw;
+    dash = style.dash;
+}
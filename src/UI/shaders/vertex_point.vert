@@ -0,0 +1,26 @@
+#version 450
+
+// one instance per point of a point cloud, expanded to a square sprite around it
+layout(location = 0) in vec2 inPosition;
+layout(location = 1) in vec4 inColor;
+
+layout(location = 0) out vec2 localPos;
+layout(location = 1) flat out vec4 color;
+
+layout(push_constant) uniform PushConstants {
+    mat4 transform;
+    vec2 viewportSize;
+    // side of the sprite in pixels
+    float pointSize;
+} pushConstants;
+
+void main()
+{
+    // triangle strip: (-1,-1) (1,-1) (-1,1) (1,1)
+    vec2 corner = vec2((gl_VertexIndex & 1) * 2 - 1, (gl_VertexIndex >> 1) * 2 - 1);
+    vec4 center = pushConstants.transform * vec4(inPosition, 0.0, 1.0);
+    // the size stays in pixels at any zoom
+    gl_Position = center + vec4(corner * pushConstants.pointSize / pushConstants.viewportSize, 0.0, 0.0) * center.w;
+    localPos = corner;
+    color = inColor;
+}
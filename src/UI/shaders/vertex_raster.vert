@@ -0,0 +1,26 @@
+#version 450
+
+// one tile of an image, drawn from its slot in the tile atlas
+layout(location = 0) out vec2 localPos;
+layout(location = 1) flat out vec2 slotOrigin;
+layout(location = 2) flat out float slotSize;
+
+layout(push_constant) uniform PushConstants {
+    // from level 0 pixels of the image to clip space
+    mat4 transform;
+    // left, top, right, bottom of the tile in level 0 pixels
+    vec4 rect;
+    vec2 slotOrigin;
+    float slotSize;
+} pushConstants;
+
+void main()
+{
+    // triangle strip: (0,0) (1,0) (0,1) (1,1)
+    vec2 corner = vec2(gl_VertexIndex & 1, gl_VertexIndex >> 1);
+    vec2 position = mix(pushConstants.rect.xy, pushConstants.rect.zw, corner);
+    gl_Position = pushConstants.transform * vec4(position, 0.0, 1.0);
+    localPos = corner;
+    slotOrigin = pushConstants.slotOrigin;
+    slotSize = pushConstants.slotSize;
+}
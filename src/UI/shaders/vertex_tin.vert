@@ -0,0 +1,27 @@
+#version 450
+
+// the triangles of a surface, three vertices each, none shared
+layout(location = 0) in vec3 inPosition;
+
+layout(location = 0) out vec3 position;
+layout(location = 1) out vec3 barycentric;
+
+layout(push_constant) uniform PushConstants {
+    // from the surface's origin to clip space
+    mat4 transform;
+    // of the wireframe, or of the whole surface with flag 2
+    vec4 color;
+    // lowest and highest elevation of the surface
+    vec2 elevationRange;
+    // 1 wireframe, 2 the color instead of the elevation ramp
+    uint flags;
+} pushConstants;
+
+void main()
+{
+    gl_Position = pushConstants.transform * vec4(inPosition.xy, 0.0, 1.0);
+    position = inPosition;
+    // the corners of a triangle are consecutive, its edges are where a coordinate is 0
+    barycentric = vec3(0.0);
+    barycentric[gl_VertexIndex % 3] = 1.0;
+}